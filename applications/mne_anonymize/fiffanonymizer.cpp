@@ -42,6 +42,8 @@
 
 #include "fiffanonymizer.h"
 #include <fiff/fiff_dir_entry.h>
+#include <utils/generics/readaheadbuffer.h>
+#include <utils/generics/writebehindbuffer.h>
 
 //=============================================================================================================
 // QT INCLUDES
@@ -235,13 +237,35 @@ int FiffAnonymizer::anonymizeFile()
     processHeaderTags();
 
 
-    while( (m_pTag->next != -1) && (!m_pInStream->device()->atEnd()))
+    // The next tags are read ahead while the current one is censored, the censored tags are written in the
+    // background.
+    bool bLastTag = (m_pTag->next == -1);
+
+    UTILSLIB::ReadAheadBuffer<FIFFLIB::FiffTag::SPtr> readBuffer([this, &bLastTag](FIFFLIB::FiffTag::SPtr& pTag) {
+        if(bLastTag || m_pInStream->device()->atEnd())
+        {
+            return false;
+        }
+
+        m_pInStream->read_tag(pTag,-1);
+        bLastTag = (pTag->next == -1);
+        return true;
+    }, 64);
+
+    UTILSLIB::WriteBehindBuffer<FIFFLIB::FiffTag::SPtr> writeBuffer([this](FIFFLIB::FiffTag::SPtr& pTag) {
+        writeTag(pTag);
+        return true;
+    }, 64);
+
+    while(readBuffer.pop(m_pTag))
     {
-        readTag();
+        updateBlockTypeList();
         censorTag();
-        writeTag();
+        writeBuffer.push(m_pTag);
     }
 
+    writeBuffer.finish();
+
     closeInOutStreams();
 
     emit outFileReady();
@@ -581,15 +605,22 @@ void FiffAnonymizer::readTag()
 //=============================================================================================================
 
 void FiffAnonymizer::writeTag()
+{
+    writeTag(m_pTag);
+}
+
+//=============================================================================================================
+
+void FiffAnonymizer::writeTag(FIFFLIB::FiffTag::SPtr pTag)
 {
     //make output tag list linear
-    if(m_pTag->next > 0)
+    if(pTag->next > 0)
     {
-        m_pTag->next = FIFFV_NEXT_SEQ;
+        pTag->next = FIFFV_NEXT_SEQ;
     }
 
-    FIFFLIB::FiffTag::convert_tag_data(m_pTag,FIFFV_NATIVE_ENDIAN,FIFFV_BIG_ENDIAN);
-    m_pOutStream->write_tag(m_pTag, -1);
+    FIFFLIB::FiffTag::convert_tag_data(pTag,FIFFV_NATIVE_ENDIAN,FIFFV_BIG_ENDIAN);
+    m_pOutStream->write_tag(pTag, -1);
 }
 
 //=============================================================================================================
@@ -779,6 +779,14 @@ private:
      */
     void writeTag();
 
+    //=========================================================================================================
+    /**
+     * Will overwrite the 'next' field of the given tag and write it into the output file stream.
+     *
+     * @param[in] pTag   The tag to write.
+     */
+    void writeTag(FIFFLIB::FiffTag::SPtr pTag);
+
     //=========================================================================================================
 
     FIFFLIB::FiffStream::SPtr m_pInStream;  /**< Pointer to FiffStream object for reading.*/
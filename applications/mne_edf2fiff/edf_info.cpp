@@ -66,6 +66,13 @@ using namespace FIFFLIB;
 //=============================================================================================================
 
 EDFInfo::EDFInfo()
+: m_iNumBytesInHeader(0),
+  m_iNumDataRecords(0),
+  m_fDataRecordsDuration(0.0f),
+  m_iNumChannels(0),
+  m_iNumBytesPerDataRecord(0),
+  m_iNumBytesPerSample(2),
+  m_bIsBDF(false)
 {
 
 }
@@ -87,7 +94,12 @@ EDFInfo::EDFInfo(QIODevice* pDev)
     }
 
     // general info, which is not dependent on individual signals
-    m_sEDFVersionNo = QString::fromLatin1(pDev->read(EDF_VERSION)).trimmed();
+    // BDF files (BioSemi) share the EDF header layout, but are tagged with 0xFF followed by "BIOSEMI" in the version
+    // field and store 24 bit instead of 16 bit integers
+    QByteArray baVersion = pDev->read(EDF_VERSION);
+    m_bIsBDF = (baVersion.size() == EDF_VERSION && static_cast<unsigned char>(baVersion.at(0)) == 0xFF && baVersion.mid(1).startsWith("BIOSEMI"));
+    m_iNumBytesPerSample = m_bIsBDF ? 3 : 2;
+    m_sEDFVersionNo = QString::fromLatin1(m_bIsBDF ? baVersion.mid(1) : baVersion).trimmed();
     m_sLocalPatientIdentification = QString::fromLatin1(pDev->read(LOCAL_PATIENT_INFO)).trimmed();
     m_sLocalRecordingIdentification = QString::fromLatin1(pDev->read(LOCAL_RECORD_INFO)).trimmed();
     m_startDateTime.setDate(QDate::fromString(QString::fromLatin1(pDev->read(STARTDATE)), "dd.MM.yy"));
@@ -158,7 +170,7 @@ EDFInfo::EDFInfo(QIODevice* pDev)
     // calculate number of bytes per data record for later usage in read_raw function
     m_iNumBytesPerDataRecord = 0;
     for(const auto& chan : m_vAllChannels) {
-        m_iNumBytesPerDataRecord += chan.getNumberOfSamplesPerRecord() * 2;  // 2 integer representation, this might be different for bdf files
+        m_iNumBytesPerDataRecord += chan.getNumberOfSamplesPerRecord() * m_iNumBytesPerSample;
     }
 
     // do post-processing: variable channel frequencies are not supported, take highest available frequency as main frequency.
@@ -213,6 +225,7 @@ QString EDFInfo::getAsString() const
     QString sDescription;
     sDescription += "== EDF INFO START ==";
     sDescription += "\nEDF Version Number: " + m_sEDFVersionNo;
+    sDescription += "\nFormat: " + QString(m_bIsBDF ? "BDF (24 bit)" : "EDF (16 bit)");
     sDescription += "\nLocal Patient Identification: " + m_sLocalPatientIdentification;
     sDescription += "\nLocal Recording Identification: " + m_sLocalRecordingIdentification;
     sDescription += "\nDate of Recording: " + m_startDateTime.date().toString("dd.MM.yyyy");
@@ -158,6 +158,8 @@ public:
     inline int getNumSamplesPerRecord() const;
     inline int getNumberOfBytesInHeader() const;
     inline int getNumberOfBytesPerDataRecord() const;
+    inline int getNumberOfBytesPerSample() const;
+    inline bool isBDF() const;
     inline float getFrequency() const;
 
 private:
@@ -171,8 +173,10 @@ private:
     float       m_fDataRecordsDuration;
     int         m_iNumChannels;
 
-    // convenience field, calculated by using the EDF fields
+    // convenience fields, calculated by using the EDF fields
     int         m_iNumBytesPerDataRecord;
+    int         m_iNumBytesPerSample;       // 2 for EDF, 3 for BDF (24 bit BioSemi format)
+    bool        m_bIsBDF;
 
     // vector of all signals / channels contained in the file. We need to know the original order of signals when reading
     // raw data from data records, otherwise misalignments are inevitable.
@@ -259,6 +263,22 @@ inline int EDFInfo::getNumberOfBytesPerDataRecord() const
 }
 
 
+//*************************************************************************************************************
+
+inline int EDFInfo::getNumberOfBytesPerSample() const
+{
+    return m_iNumBytesPerSample;
+}
+
+
+//*************************************************************************************************************
+
+inline bool EDFInfo::isBDF() const
+{
+    return m_bIsBDF;
+}
+
+
 //*************************************************************************************************************
 
 inline float EDFInfo::getFrequency() const
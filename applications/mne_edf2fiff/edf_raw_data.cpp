@@ -40,6 +40,13 @@
 
 #include "edf_raw_data.h"
 
+#include <fiff/fiff_stream.h>
+
+#include <utils/generics/readaheadbuffer.h>
+#include <utils/generics/writebehindbuffer.h>
+
+#include <cstring>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -48,6 +55,7 @@
 
 #include <QDebug>
 #include <QIODevice>
+#include <QtEndian>
 
 
 //*************************************************************************************************************
@@ -57,9 +65,18 @@
 
 using namespace EDF2FIFF;
 using namespace FIFFLIB;
+using namespace UTILSLIB;
 using namespace Eigen;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define EDF_READ_BLOCK_BYTES (4*1024*1024)  // upper bound for the number of bytes fetched from the device at once
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -73,7 +90,26 @@ EDFRawData::EDFRawData(QIODevice* pDev,
   m_fScaleFactor(fScaleFactor),
   m_edfInfo(m_pDev)
 {
-
+    // precompute where the measurement channels are located within a data record and fold the digital to physical
+    // conversion and the raw value scaling into one affine transform per channel
+    QVector<EDFChannelInfo> vMeasChannels = m_edfInfo.getMeasurementChannelInfos();
+    m_vecGain.resize(vMeasChannels.size());
+    m_vecOffset.resize(vMeasChannels.size());
+
+    int iByteOffset = 0;
+    int iMeasChanIdx = 0;
+    for(const auto& chan : m_edfInfo.getAllChannelInfos()) {
+        if(chan.isMeasurementChannel() && iMeasChanIdx < vMeasChannels.size()) {
+            m_vMeasByteOffsets.push_back(iByteOffset);
+
+            float fDigitalRange = static_cast<float>(chan.digitalMax() - chan.digitalMin());
+            float fGain = fDigitalRange != 0.0f ? (chan.physicalMax() - chan.physicalMin()) / fDigitalRange : 0.0f;
+            m_vecGain[iMeasChanIdx] = fGain / m_fScaleFactor;
+            m_vecOffset[iMeasChanIdx] = (chan.physicalMin() - chan.digitalMin() * fGain) / m_fScaleFactor;
+            ++iMeasChanIdx;
+        }
+        iByteOffset += chan.getNumberOfSamplesPerRecord() * m_edfInfo.getNumberOfBytesPerSample();
+    }
 }
 
 
@@ -89,100 +125,116 @@ EDFInfo EDFRawData::getInfo() const
 //*************************************************************************************************************
 
 MatrixXf EDFRawData::read_raw_segment(int iStartSampleIdx, int iEndSampleIdx) const
+{
+    MatrixXfRowMajor matData;
+    if(!read_raw_segment(iStartSampleIdx, iEndSampleIdx, matData)) {
+        return MatrixXf();  // return empty matrix
+    }
+
+    return matData;
+}
+
+
+//*************************************************************************************************************
+
+bool EDFRawData::read_raw_segment(int iStartSampleIdx, int iEndSampleIdx, MatrixXfRowMajor& matData) const
 {
     // basic sanity checks for indices:
     if(iStartSampleIdx < 0 || iStartSampleIdx >= m_edfInfo.getSampleCount() || iEndSampleIdx < 0 || iEndSampleIdx > m_edfInfo.getSampleCount()) {
         qDebug() << "[EDFRawData::read_raw_segment] An index seems to be out of bounds:";
         qDebug() << "Start: " << iStartSampleIdx << " End: " << iEndSampleIdx;
-        return MatrixXf();  // return empty matrix
+        return false;
     }
 
     int iNumSamples = iEndSampleIdx - iStartSampleIdx;
     if(iNumSamples <= 0) {
         qDebug() << "[EDFRawData::read_raw_segment] Timeslice is empty or negative";
         qDebug() << "Start: " << iStartSampleIdx << " End: " << iEndSampleIdx;
-        return MatrixXf();  // return empty matrix
+        return false;
     }
 
     // print what segment is being read
     qDebug() << "Reading " << iStartSampleIdx << " ... " << iEndSampleIdx << "  =   " << iStartSampleIdx / m_edfInfo.getFrequency() << " ... " << iEndSampleIdx / m_edfInfo.getFrequency() << " secs...";
 
     // calculate which is the first needed data record, the relative first sample number and the number of data records we need to read
-    int iFirstDataRecordIdx = (iStartSampleIdx - (iStartSampleIdx % m_edfInfo.getNumSamplesPerRecord())) / m_edfInfo.getNumSamplesPerRecord();
-    int iRelativeFirstSampleIdx = iStartSampleIdx % m_edfInfo.getNumSamplesPerRecord();
-    int iNumDataRecords = static_cast<int>(std::ceil(static_cast<float>(iNumSamples + iRelativeFirstSampleIdx) / m_edfInfo.getNumSamplesPerRecord()));
-
-    // because of the data-record-wise organisation of EDF, we need to patch together the channels later
-    QVector<QVector<int>> vRawPatches(m_edfInfo.getNumberOfAllChannels(), QVector<int>());
-
-    // finally start reading the file, put file pointer to beginning of first needed data record
-    m_pDev->seek(m_edfInfo.getNumberOfBytesInHeader() + iFirstDataRecordIdx * m_edfInfo.getNumberOfBytesPerDataRecord());
+    const int iSamplesPerRecord = m_edfInfo.getNumSamplesPerRecord();
+    const int iBytesPerRecord = m_edfInfo.getNumberOfBytesPerDataRecord();
+    int iFirstDataRecordIdx = iStartSampleIdx / iSamplesPerRecord;
+    int iRelativeFirstSampleIdx = iStartSampleIdx % iSamplesPerRecord;
+    int iNumDataRecords = (iNumSamples + iRelativeFirstSampleIdx + iSamplesPerRecord - 1) / iSamplesPerRecord;
+
+    // the result is written in place, only allocate if the caller did not pass a matching matrix
+    if(matData.rows() != m_vMeasByteOffsets.size() || matData.cols() != iNumSamples) {
+        matData.resize(m_vMeasByteOffsets.size(), iNumSamples);
+    }
 
-    // since measurement channels make up the bulk part of most edf files, we can simply read the data records as a whole
-    QVector<QByteArray> vRecords;
-    for(int i = 0; i < iNumDataRecords; ++i) {
-        vRecords.push_back(m_pDev->read(m_edfInfo.getNumberOfBytesPerDataRecord()));
+    // put file pointer to beginning of first needed data record
+    if(!m_pDev->seek(static_cast<qint64>(m_edfInfo.getNumberOfBytesInHeader()) + static_cast<qint64>(iFirstDataRecordIdx) * iBytesPerRecord)) {
+        qDebug() << "[EDFRawData::read_raw_segment] Could not seek to data record " << iFirstDataRecordIdx;
+        return false;
     }
 
-    // again, extra channels are mostly insignificant compared to measurement channels, so we just filter them out later
-    for(int iRecIdx = 0; iRecIdx < vRecords.size(); ++iRecIdx) {  // go through each record
-        int iRecordSampIdx = 0;  // this is the sample idx counter for the records
-        for(int iChanIdx = 0; iChanIdx < m_edfInfo.getNumberOfAllChannels(); ++iChanIdx) {  // go through all channels
-            const EDFChannelInfo sig = m_edfInfo.getAllChannelInfos()[iChanIdx];
-            QVector<int> rawPatch(sig.getNumberOfSamplesPerRecord());
-            for(int iTemporarySampIdx = iRecordSampIdx; iTemporarySampIdx < iRecordSampIdx + sig.getNumberOfSamplesPerRecord(); ++iTemporarySampIdx) {  // we need a temporary sample index in order to handle the channel-dependent offsets
-                // factor 2 because of 2 byte integer representation, this might be different for bdf files
-                // we need the unary AND operation with '0x00ff' on the right side in order to prevent sign flipping through unintential interpretation as 2's complement integer.
-                rawPatch[iTemporarySampIdx - iRecordSampIdx] = (vRecords[iRecIdx].at(iTemporarySampIdx * 2 + 1) << 8) | (vRecords[iRecIdx].at(iTemporarySampIdx * 2) & 0x00ff);
-            }
-            iRecordSampIdx += sig.getNumberOfSamplesPerRecord();
-            vRawPatches[iChanIdx] += rawPatch;  // append raw patch
+    // fetch as many whole data records at once as fit into the read block and decode them right away,
+    // extra channels are skipped during decoding
+    const int iRecordsPerBlock = qBound(1, EDF_READ_BLOCK_BYTES / qMax(1, iBytesPerRecord), iNumDataRecords);
+    QByteArray baBlock(iRecordsPerBlock * iBytesPerRecord, Qt::Uninitialized);
+
+    int iColIdx = 0;
+    int iFirstSample = iRelativeFirstSampleIdx;
+    for(int iRecIdx = 0; iRecIdx < iNumDataRecords; iRecIdx += iRecordsPerBlock) {
+        const int iNumBlockRecords = qMin(iRecordsPerBlock, iNumDataRecords - iRecIdx);
+        const qint64 iNumBlockBytes = static_cast<qint64>(iNumBlockRecords) * iBytesPerRecord;
+        if(m_pDev->read(baBlock.data(), iNumBlockBytes) != iNumBlockBytes) {
+            qDebug() << "[EDFRawData::read_raw_segment] Could not read data records " << iFirstDataRecordIdx + iRecIdx << " to " << iFirstDataRecordIdx + iRecIdx + iNumBlockRecords;
+            return false;
         }
-    }
 
-    // post-processing: filter out extra channels, start in the back to avoid ugly index offsets
-    QVector<EDFChannelInfo> vAllChannels = m_edfInfo.getAllChannelInfos();
-    for(int iChanIdx = vRawPatches.size() - 1; iChanIdx >= 0; --iChanIdx) {
-        if(vAllChannels[iChanIdx].isMeasurementChannel() == false) {
-            vRawPatches.remove(iChanIdx);
+        for(int iBlockRecIdx = 0; iBlockRecIdx < iNumBlockRecords; ++iBlockRecIdx) {
+            // by only decoding as many samples as are left, we automatically exclude unwanted samples in the end
+            const int iNumRecordSamples = qMin(iSamplesPerRecord - iFirstSample, iNumSamples - iColIdx);
+            decodeRecordSamples(baBlock.constData() + iBlockRecIdx * iBytesPerRecord, iFirstSample, iNumRecordSamples, matData, iColIdx);
+            iColIdx += iNumRecordSamples;
+            iFirstSample = 0;
         }
     }
 
-    // quick sanity check
-    QVector<EDFChannelInfo> vMeasChannels = m_edfInfo.getMeasurementChannelInfos();
-    if(vRawPatches.size() != vMeasChannels.size()) {
-       qDebug() << "[EDFRawData::read_raw_segment] Dimension mismatch for filtered raw patches";
-    }
+    return true;
+}
+
 
-    // prepare result matrix
-    MatrixXf result(vRawPatches.size(), iNumSamples);
-
-    // scale raw values according to digital und physical min/max and copy scaled values into result matrix while omitting unwanted samples in the beginning and end
-    for(int iMeasChanIdx = 0; iMeasChanIdx < vRawPatches.size(); ++iMeasChanIdx) {
-        vRawPatches[iMeasChanIdx] = vRawPatches[iMeasChanIdx].mid(iRelativeFirstSampleIdx);  // cut away unwanted samples in the beginning
-        const EDFChannelInfo chan = vMeasChannels[iMeasChanIdx];
-        for(int iSampIdx = 0; iSampIdx < iNumSamples; ++iSampIdx) {  // by only letting sampIdx go so far, we automatically exclude unwanted samples in the end
-            result(iMeasChanIdx, iSampIdx) = static_cast<float>(vRawPatches[iMeasChanIdx][iSampIdx] - chan.digitalMin()) / (chan.digitalMax() - chan.digitalMin()) * (chan.physicalMax() - chan.physicalMin()) + chan.physicalMin();
-            if(chan.isMeasurementChannel()) {
-                // probably uV values, need to scale them with raw value scaling factor
-                result(iMeasChanIdx, iSampIdx) = result(iMeasChanIdx, iSampIdx) / m_fScaleFactor;
+//*************************************************************************************************************
+
+void EDFRawData::decodeRecordSamples(const char* pRecord, int iFirstSample, int iNumSamples, MatrixXfRowMajor& matData, int iColIdx) const
+{
+    const int iBytesPerSample = m_edfInfo.getNumberOfBytesPerSample();
+
+    if(iBytesPerSample == 2) {
+        // EDF: 16 bit little endian two's complement. Copy the samples of one channel into an aligned integer vector
+        // and let Eigen do the int to float conversion and the scaling for the whole channel row at once.
+        Matrix<qint16, 1, Dynamic> vecRaw(iNumSamples);
+        for(int iMeasChanIdx = 0; iMeasChanIdx < m_vMeasByteOffsets.size(); ++iMeasChanIdx) {
+            const char* pSrc = pRecord + m_vMeasByteOffsets[iMeasChanIdx] + iFirstSample * 2;
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+            std::memcpy(vecRaw.data(), pSrc, static_cast<size_t>(iNumSamples) * 2);
+#else
+            for(int i = 0; i < iNumSamples; ++i) {
+                vecRaw[i] = qFromLittleEndian<qint16>(reinterpret_cast<const uchar*>(pSrc + i * 2));
             }
+#endif
+            matData.row(iMeasChanIdx).segment(iColIdx, iNumSamples) = (vecRaw.cast<float>().array() * m_vecGain[iMeasChanIdx] + m_vecOffset[iMeasChanIdx]).matrix();
         }
-    }
-
-    /* Mattis version: do scaling by adjusting range and cal in the conversion from EDF to Fiff. */
-    /*
-    // copy scaled values into result matrix while omitting unwanted samples in the beginning and end
-    for(int iMeasChanIdx = 0; iMeasChanIdx < vRawPatches.size(); ++iMeasChanIdx) {
-        vRawPatches[iMeasChanIdx] = vRawPatches[iMeasChanIdx].mid(iRelativeFirstSampleIdx);  // cut away unwanted samples in the beginning
-        const EDFChannelInfo chan = vMeasChannels[iMeasChanIdx];
-        for(int iSampIdx = 0; iSampIdx < iNumSamples; ++iSampIdx) {  // by only letting sampIdx go so far, we automatically exclude unwanted samples in the end
-            result(iMeasChanIdx, iSampIdx) = vRawPatches[iMeasChanIdx][iSampIdx];
+    } else {
+        // BDF: 24 bit little endian two's complement, sign extend to 32 bit before the conversion
+        Matrix<qint32, 1, Dynamic> vecRaw(iNumSamples);
+        for(int iMeasChanIdx = 0; iMeasChanIdx < m_vMeasByteOffsets.size(); ++iMeasChanIdx) {
+            const uchar* pSrc = reinterpret_cast<const uchar*>(pRecord + m_vMeasByteOffsets[iMeasChanIdx] + iFirstSample * 3);
+            for(int i = 0; i < iNumSamples; ++i, pSrc += 3) {
+                const quint32 uValue = static_cast<quint32>(pSrc[0]) << 8 | static_cast<quint32>(pSrc[1]) << 16 | static_cast<quint32>(pSrc[2]) << 24;
+                vecRaw[i] = static_cast<qint32>(uValue) >> 8;
+            }
+            matData.row(iMeasChanIdx).segment(iColIdx, iNumSamples) = (vecRaw.cast<float>().array() * m_vecGain[iMeasChanIdx] + m_vecOffset[iMeasChanIdx]).matrix();
         }
     }
-    */
-
-    return result;
 }
 
 
@@ -217,3 +269,72 @@ FiffRawData EDFRawData::toFiffRawData() const
 
     return fiffRawData;
 }
+
+
+//*************************************************************************************************************
+
+bool EDFRawData::toFiffRawData(QIODevice& p_IODevice, float fChunkSeconds) const
+{
+    const int iSampleCount = m_edfInfo.getSampleCount();
+    if(iSampleCount <= 0) {
+        qWarning() << "[EDFRawData::toFiffRawData] No measurement samples to convert.";
+        return false;
+    }
+
+    FiffRawData fiffRaw = toFiffRawData();
+    const int iChunkSamples = qMax(1, static_cast<int>(std::ceil(fChunkSeconds * fiffRaw.info.sfreq)));
+
+    RowVectorXd cals;
+    FiffStream::SPtr outfid = FiffStream::start_writing_raw(p_IODevice, fiffRaw.info, cals);
+    if(!outfid) {
+        qWarning() << "[EDFRawData::toFiffRawData] Could not start writing raw data.";
+        return false;
+    }
+
+    fiff_int_t first = 0;  // EDF files start at index 0
+    outfid->write_int(FIFF_FIRST_SAMPLE, &first);
+
+    // decode the next chunks in the background while the current one is written. The decode buffer is reused for
+    // every chunk and at most a few chunks are in flight, which keeps the memory consumption constant.
+    int iSamplesRead = 0;
+    MatrixXfRowMajor matChunk;
+    bool bReadOk = true;
+
+    ReadAheadBuffer<MatrixXd> readBuffer([&](MatrixXd& data) {
+        if(iSamplesRead >= iSampleCount) {
+            return false;
+        }
+
+        int iNextChunkSize = std::min(iChunkSamples, iSampleCount - iSamplesRead);
+        if(!read_raw_segment(iSamplesRead, iSamplesRead + iNextChunkSize, matChunk)) {
+            bReadOk = false;
+            return false;
+        }
+        data = matChunk.cast<double>();
+
+        iSamplesRead += iNextChunkSize;
+
+        return true;
+    });
+
+    WriteBehindBuffer<MatrixXd> writeBuffer([&](MatrixXd& data) {
+        return outfid->write_raw_buffer(data, cals);
+    });
+
+    MatrixXd data;
+    while(readBuffer.pop(data)) {
+        writeBuffer.push(std::move(data));
+    }
+
+    bool bWriteOk = writeBuffer.finish();
+    if(!bWriteOk) {
+        qWarning() << "[EDFRawData::toFiffRawData] Error while writing raw data buffers.";
+    }
+    if(!bReadOk) {
+        qWarning() << "[EDFRawData::toFiffRawData] Error while reading raw data, the output file is incomplete.";
+    }
+
+    outfid->finish_writing_raw();
+
+    return bReadOk && bWriteOk;
+}
@@ -85,12 +85,14 @@ namespace EDF2FIFF
 /**
 * DECLARE CLASS EDFRawData
 *
-* @brief The EDFRawData is the top level container class for EDF data.
+* @brief The EDFRawData is the top level container class for EDF and BDF data.
 */
 class EDFRawData : public QObject
 {
     Q_OBJECT
 public:
+    typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> MatrixXfRowMajor;  /**< Channel-major float matrix, one contiguous row per channel. */
+
     //=========================================================================================================
     /**
     * @brief EDFRawData Constructor for EDFRawData
@@ -118,6 +120,20 @@ public:
     */
     Eigen::MatrixXf read_raw_segment(int iStartSampleIdx, int iEndSampleIdx) const;
 
+    //=========================================================================================================
+    /**
+    * @brief read_raw_segment Reads a timeslice of data straight into a channel-major matrix. The data records are
+    *        decoded one block at a time, so that no intermediate copies of the timeslice are made. The matrix is
+    *        only reallocated if its dimensions do not match the timeslice, which allows to reuse it for
+    *        consecutive segments.
+    * @param[in] iStartSampleIdx First sample index of timeslice.
+    * @param[in] iEndSampleIdx Last sample index of timeslice (exclusive).
+    * @param[out] matData Measurement channels x samples matrix that receives the scaled timeslice.
+    *
+    * @return true if the timeslice was read successfully, false otherwise.
+    */
+    bool read_raw_segment(int iStartSampleIdx, int iEndSampleIdx, MatrixXfRowMajor& matData) const;
+
     //=========================================================================================================
     /**
     * @brief read_raw_segment Reads a timeslice of data. This function simply converts the passed timepoints
@@ -137,14 +153,41 @@ public:
     */
     FIFFLIB::FiffRawData toFiffRawData() const;
 
+    //=========================================================================================================
+    /**
+    * @brief toFiffRawData Converts the EDF data into a FIFF raw data file. The file is converted chunk by chunk,
+    *        while the next chunk is decoded in the background, so the memory consumption does not depend on the
+    *        length of the recording.
+    * @param[in] p_IODevice The device to write the FIFF file to.
+    * @param[in] fChunkSeconds Length of the chunks in seconds.
+    *
+    * @return true if the file was written successfully, false otherwise.
+    */
+    bool toFiffRawData(QIODevice& p_IODevice, float fChunkSeconds = 10.0f) const;
+
 signals:
 
 public slots:
 
 private:
-    QIODevice* m_pDev;      /** The device that is reflected by this EDFRawData object. */
-    float m_fScaleFactor;   /** Raw value scaling factor. */
-    EDFInfo m_edfInfo;      /** EDF info that holds all the relevant information. */
+    //=========================================================================================================
+    /**
+    * @brief decodeRecordSamples Decodes and scales a range of samples of all measurement channels of one data record.
+    * @param[in] pRecord Pointer to the raw bytes of the data record.
+    * @param[in] iFirstSample First sample within the data record.
+    * @param[in] iNumSamples Number of samples to decode.
+    * @param[in, out] matData The matrix to write to.
+    * @param[in] iColIdx Column of matData that receives the first decoded sample.
+    */
+    void decodeRecordSamples(const char* pRecord, int iFirstSample, int iNumSamples, MatrixXfRowMajor& matData, int iColIdx) const;
+
+    QIODevice* m_pDev;                  /** The device that is reflected by this EDFRawData object. */
+    float m_fScaleFactor;               /** Raw value scaling factor. */
+    EDFInfo m_edfInfo;                  /** EDF info that holds all the relevant information. */
+
+    QVector<int> m_vMeasByteOffsets;    /** Byte offset of each measurement channel within a data record. */
+    Eigen::VectorXf m_vecGain;          /** Per measurement channel gain from digital to scaled physical values. */
+    Eigen::VectorXf m_vecOffset;        /** Per measurement channel offset from digital to scaled physical values. */
 };
 
 } // NAMESPACE
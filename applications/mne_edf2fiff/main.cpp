@@ -89,7 +89,7 @@ int main(int argc, char *argv[])
 
     // command line parser
     QCommandLineParser parser;
-    parser.setApplicationDescription("EDF to Fiff conversion. Variable channel frequencies are supported. Interrupted recordings are not supported.");
+    parser.setApplicationDescription("EDF/BDF to Fiff conversion. Variable channel frequencies are supported. Interrupted recordings are not supported.");
     parser.addHelpOption();
 
     QCommandLineOption inputOption("fileIn", "The input file. Needs to be specified.", "in", "");
@@ -110,8 +110,8 @@ int main(int argc, char *argv[])
     if(sInputFile.isEmpty()) {
         parser.showHelp(0);
     }
-    if(!sInputFile.toUpper().endsWith(".EDF")) {
-        qDebug() << "Not an EDF file: " << sInputFile;
+    if(!sInputFile.toUpper().endsWith(".EDF") && !sInputFile.toUpper().endsWith(".BDF")) {
+        qDebug() << "Not an EDF or BDF file: " << sInputFile;
         return 0;
     }
 
@@ -123,7 +123,7 @@ int main(int argc, char *argv[])
     // if the user did not specify an output file, simply use the same location as the input file:
     if(sOutputFile.isEmpty()) {
         qDebug() << "No output file specified, using same filename for output FIFF file";
-        sOutputFile = sInputFile.left(sInputFile.size() - 3);  // cut the 'edf'
+        sOutputFile = sInputFile.left(sInputFile.size() - 3);  // cut the 'edf' or 'bdf'
         sOutputFile = sOutputFile.append("fif"); // append 'fif'
     }
 
@@ -137,34 +137,12 @@ int main(int argc, char *argv[])
     EDFInfo edfInfo = edfRaw.getInfo();
     // qDebug().noquote() << edfInfo.getAsString();
 
-    // convert to fiff
-    FiffRawData fiffRaw = edfRaw.toFiffRawData();
-
-    // set up the reading parameters
-    float fTimesliceSeconds = 10.0f; //read and write in 10 sec chunks
-    int iTimesliceSamples = static_cast<int>(ceil(fTimesliceSeconds * fiffRaw.info.sfreq));
-
-    RowVectorXd cals;
-    FiffStream::SPtr outfid = FiffStream::start_writing_raw(t_fileOut, fiffRaw.info, cals);
-
-    // copied from read/write example
-    fiff_int_t first = 0;  // EDF files start at index 0
-    outfid->write_int(FIFF_FIRST_SAMPLE, &first);
-
-    // read chunks, remember how many samples were already read
-    int iSamplesRead = 0;
-
-    while(iSamplesRead < edfInfo.getSampleCount()) {
-        int iNextChunkSize = std::min(iTimesliceSamples, edfInfo.getSampleCount() - iSamplesRead);
-        // EDF sample indexing starts at 0, simply use samplesRead as argument to read_raw_segment
-        MatrixXd data = edfRaw.read_raw_segment(iSamplesRead, iSamplesRead + iNextChunkSize).cast<double>();
-
-        iSamplesRead += iNextChunkSize;
-
-        outfid->write_raw_buffer(data, cals);
+    // convert to fiff chunk by chunk
+    if(!edfRaw.toFiffRawData(t_fileOut)) {
+        qWarning() << "Conversion to FIFF failed.";
+        return 1;
     }
 
-    outfid->finish_writing_raw();
     qDebug() << "Writing finished !";
 
     return 0;
@@ -195,7 +195,15 @@ public:
 signals:
     void remitMeasInfo(qint32, FIFFLIB::FiffInfo);
 
-    void remitRawBuffer(QSharedPointer<Eigen::MatrixXf>);
+    //=========================================================================================================
+    /**
+     * Emitted for every raw buffer the connector produces.
+     *
+     * @param[in] pMatRawData        The raw buffer.
+     * @param[in] iTimeStampUSecs    Emission time in microseconds since the epoch, -1 if the buffer is not stamped.
+     * @param[in] iFirstSample       Index of the first sample of the buffer since the start of the stream.
+     */
+    void remitRawBuffer(QSharedPointer<Eigen::MatrixXf> pMatRawData, qint64 iTimeStampUSecs = -1, qint32 iFirstSample = 0);
 
 protected:
 
@@ -44,6 +44,8 @@
 
 #include "mne_rt_server.h"
 
+#include <fiff/fiff_stream.h>
+
 #include <stdlib.h>
 
 //=============================================================================================================
@@ -352,10 +354,40 @@ void FiffStreamServer::forwardMeasInfo(qint32 ID, const FiffInfo& p_fiffInfo)
 }
 
 //=============================================================================================================
-//ToDo increase preformance --> try inline
-void FiffStreamServer::forwardRawBuffer(QSharedPointer<Eigen::MatrixXf> m_pMatRawData)
+
+void FiffStreamServer::forwardRawBuffer(QSharedPointer<Eigen::MatrixXf> m_pMatRawData,
+                                        qint64 iTimeStampUSecs,
+                                        qint32 iFirstSample)
 {
-    emit remitRawBuffer(m_pMatRawData);
+    bool t_bHasReceivers = false;
+    QMap<qint32, FiffStreamThread*>::const_iterator i;
+    for (i = m_qClientList.constBegin(); i != m_qClientList.constEnd(); ++i)
+    {
+        if(i.value()->m_bIsSendingRawBuffer)
+        {
+            t_bHasReceivers = true;
+            break;
+        }
+    }
+
+    if(!t_bHasReceivers)
+        return;
+
+    //
+    // Encode once, all client threads share the same immutable block
+    //
+    QByteArray t_blockRawBuffer;
+    FiffStream t_FiffStreamOut(&t_blockRawBuffer, QIODevice::WriteOnly);
+    if(iTimeStampUSecs >= 0)
+    {
+        fiff_int_t t_timeStamp[3] = {static_cast<fiff_int_t>(iTimeStampUSecs / 1000000),
+                                     static_cast<fiff_int_t>(iTimeStampUSecs % 1000000),
+                                     iFirstSample};
+        t_FiffStreamOut.write_int(FIFF_TIME_STAMP, t_timeStamp, 3);
+    }
+    t_FiffStreamOut.write_float(FIFF_DATA_BUFFER, m_pMatRawData->data(), m_pMatRawData->rows()*m_pMatRawData->cols());
+
+    emit remitRawBuffer(t_blockRawBuffer);
 }
 
 //=============================================================================================================
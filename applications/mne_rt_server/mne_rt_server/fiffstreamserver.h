@@ -108,7 +108,17 @@ public:
 
 //public slots: --> in Qt 5 not anymore declared as slot
     void forwardMeasInfo(qint32 ID, const FIFFLIB::FiffInfo& p_fiffInfo);
-    void forwardRawBuffer(QSharedPointer<Eigen::MatrixXf> m_pMatRawData);
+    //=========================================================================================================
+    /**
+     * Serializes the raw buffer once into a FIFF_DATA_BUFFER tag and hands the implicitly shared block to all
+     * clients. Nothing is serialized if no client is receiving raw buffers. Stamped buffers are preceded by a
+     * FIFF_TIME_STAMP tag holding the emission time and the first sample.
+     *
+     * @param[in] m_pMatRawData      The raw buffer.
+     * @param[in] iTimeStampUSecs    Emission time in microseconds since the epoch, -1 if the buffer is not stamped.
+     * @param[in] iFirstSample       Index of the first sample of the buffer since the start of the stream.
+     */
+    void forwardRawBuffer(QSharedPointer<Eigen::MatrixXf> m_pMatRawData, qint64 iTimeStampUSecs, qint32 iFirstSample);
 
 signals:
     void requestMeasInfo(qint32 ID);
@@ -117,7 +127,7 @@ signals:
     void stopMeasFiffStreamClient(qint32 ID);
 
     void remitMeasInfo(qint32 ID, const FIFFLIB::FiffInfo& p_fiffInfo);
-    void remitRawBuffer(QSharedPointer<Eigen::MatrixXf>);
+    void remitRawBuffer(const QByteArray& p_blockRawBuffer);
 
     void closeFiffStreamServer();
 
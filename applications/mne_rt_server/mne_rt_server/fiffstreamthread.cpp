@@ -67,6 +67,13 @@ using namespace UTILSLIB;
 using namespace RTSERVER;
 using namespace FIFFLIB;
 
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define MAX_QUEUED_RAW_BUFFERS      64                  // raw buffers a client may lag behind before the oldest ones are dropped
+#define MAX_SOCKET_BYTES_TO_WRITE   (4*1024*1024)       // high water mark of the socket write buffer
+
 //=============================================================================================================
 // DEFINE MEMBER METHODS
 //=============================================================================================================
@@ -76,8 +83,10 @@ FiffStreamThread::FiffStreamThread(qint32 id, int socketDescriptor, QObject *par
 , m_iDataClientId(id)
 , m_sDataClientAlias(QString(""))
 , m_iSocketDescriptor(socketDescriptor)
+, m_iNumQueuedRawBuffers(0)
+, m_iNumDroppedRawBuffers(0)
+, m_bWritePending(false)
 , m_bIsSendingRawBuffer(false)
-, m_bIsRunning(false)
 {
 }
 
@@ -90,7 +99,7 @@ FiffStreamThread::~FiffStreamThread()
     if(t_pFiffStreamServer)
         t_pFiffStreamServer->m_qClientList.remove(m_iDataClientId);
 
-    m_bIsRunning = false;
+    QThread::quit();
     QThread::wait();
 }
 
@@ -102,12 +111,11 @@ void FiffStreamThread::startMeas(qint32 ID)
     {
         qDebug() << "Activate raw buffer sending.";
 
-        m_qMutex.lock();
-        // ToDo send start meas
-        FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
+        QByteArray t_blockStart;
+        FiffStream t_FiffStreamOut(&t_blockStart, QIODevice::WriteOnly);
         t_FiffStreamOut.start_block(FIFFB_RAW_DATA);
+        enqueueBlock(t_blockStart, false);
         m_bIsSendingRawBuffer = true;
-        m_qMutex.unlock();
     }
 }
 
@@ -120,11 +128,11 @@ void FiffStreamThread::stopMeas(qint32 ID)
     {
         qDebug() << "stop raw buffer sending.";
 
-        m_qMutex.lock();
-        FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
-        t_FiffStreamOut.end_block(FIFFB_RAW_DATA);
         m_bIsSendingRawBuffer = false;
-        m_qMutex.unlock();
+        QByteArray t_blockEnd;
+        FiffStream t_FiffStreamOut(&t_blockEnd, QIODevice::WriteOnly);
+        t_FiffStreamOut.end_block(FIFFB_RAW_DATA);
+        enqueueBlock(t_blockEnd, false);
     }
 }
 
@@ -167,24 +175,119 @@ void FiffStreamThread::parseCommand(FiffTag::SPtr p_pTag)
 
 //=============================================================================================================
 
-void FiffStreamThread::sendRawBuffer(QSharedPointer<Eigen::MatrixXf> m_pMatRawData)
+void FiffStreamThread::sendRawBuffer(const QByteArray& p_blockRawBuffer)
 {
     if(m_bIsSendingRawBuffer)
     {
-//        qDebug() << "Send RawBuffer to client";
+        enqueueBlock(p_blockRawBuffer, true);
+    }
+}
+
+//=============================================================================================================
+
+void FiffStreamThread::enqueueBlock(const QByteArray& p_block, bool p_bIsRawBuffer)
+{
+    bool t_bWakeUp = false;
+
+    m_qMutex.lock();
+
+    SendBlock t_sendBlock;
+    t_sendBlock.block = p_block;
+    t_sendBlock.bIsRawBuffer = p_bIsRawBuffer;
+    m_qSendQueue.enqueue(t_sendBlock);
+
+    if(p_bIsRawBuffer)
+    {
+        ++m_iNumQueuedRawBuffers;
+
+        //
+        // Slow consumer: drop the oldest raw buffers, keep control blocks to preserve the stream structure
+        //
+        QQueue<SendBlock>::iterator it = m_qSendQueue.begin();
+        while(m_iNumQueuedRawBuffers > MAX_QUEUED_RAW_BUFFERS && it != m_qSendQueue.end())
+        {
+            if(it->bIsRawBuffer)
+            {
+                it = m_qSendQueue.erase(it);
+                --m_iNumQueuedRawBuffers;
+
+                if(m_iNumDroppedRawBuffers++ % 100 == 0)
+                    printf("FiffStreamClient (ID %d): client is too slow, %lld raw buffers dropped so far\r\n", m_iDataClientId, (long long)m_iNumDroppedRawBuffers);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    if(!m_bWritePending)
+    {
+        m_bWritePending = true;
+        t_bWakeUp = true;
+    }
+
+    m_qMutex.unlock();
 
-        m_qMutex.lock();
+    if(t_bWakeUp)
+        emit blocksQueued();
+}
 
-        FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
-        t_FiffStreamOut.write_float(FIFF_DATA_BUFFER,m_pMatRawData->data(),m_pMatRawData->rows()*m_pMatRawData->cols());
+//=============================================================================================================
 
-        m_qMutex.unlock();
+void FiffStreamThread::writeQueuedBlocks(QTcpSocket& p_qTcpSocket)
+{
+    QMutexLocker t_locker(&m_qMutex);
+    m_bWritePending = false;
 
+    if(p_qTcpSocket.state() != QAbstractSocket::ConnectedState)
+        return;
+
+    while(!m_qSendQueue.isEmpty() && p_qTcpSocket.bytesToWrite() < MAX_SOCKET_BYTES_TO_WRITE)
+    {
+        SendBlock t_sendBlock = m_qSendQueue.dequeue();
+        if(t_sendBlock.bIsRawBuffer)
+            --m_iNumQueuedRawBuffers;
+
+        p_qTcpSocket.write(t_sendBlock.block);
+    }
+}
+
+//=============================================================================================================
+
+void FiffStreamThread::readCommands(QTcpSocket& p_qTcpSocket, FiffStream& p_FiffStreamIn, FiffTag::SPtr& p_pPendingTag)
+{
+    forever
+    {
+        //
+        // Read the tag header as soon as it is complete
+        //
+        if(!p_pPendingTag)
+        {
+            if(p_qTcpSocket.bytesAvailable() < (int)sizeof(qint32)*4)
+                return;
+
+            p_FiffStreamIn.read_tag_info(p_pPendingTag, false);
+        }
+
+        //
+        // The tag data may arrive with a later readyRead
+        //
+        if(p_qTcpSocket.bytesAvailable() < p_pPendingTag->size())
+            return;
+
+        p_FiffStreamIn.read_tag_data(p_pPendingTag);
+
+        //
+        // Parse the tag
+        //
+        if(p_pPendingTag->kind == FIFF_MNE_RT_COMMAND)
+        {
+            parseCommand(p_pPendingTag);
+        }
+
+        p_pPendingTag.clear();
     }
-//    else
-//    {
-//        qDebug() << "Send RawBuffer is not activated";
-//    }
 }
 
 //=============================================================================================================
@@ -212,9 +315,8 @@ void FiffStreamThread::sendMeasurementInfo(qint32 ID, const FiffInfo& p_fiffInfo
 {
     if(ID == m_iDataClientId)
     {
-        m_qMutex.lock();
-
-        FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
+        QByteArray t_blockMeasInfo;
+        FiffStream t_FiffStreamOut(&t_blockMeasInfo, QIODevice::WriteOnly);
 
 //        qint32 init_info[2];
 //        init_info[0] = FIFF_MNE_RT_CLIENT_ID;
@@ -225,7 +327,7 @@ void FiffStreamThread::sendMeasurementInfo(qint32 ID, const FiffInfo& p_fiffInfo
 //FiffStream::start_writing_raw
 
         p_fiffInfo.writeToStream(&t_FiffStreamOut);
-        m_qMutex.unlock();
+        enqueueBlock(t_blockMeasInfo, false);
 
 //        qDebug() << "MeasInfo Blocksize: " << m_qSendBlock.size();
     }
@@ -235,9 +337,11 @@ void FiffStreamThread::sendMeasurementInfo(qint32 ID, const FiffInfo& p_fiffInfo
 
 void FiffStreamThread::writeClientId()
 {
-    FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
+    QByteArray t_blockClientId;
+    FiffStream t_FiffStreamOut(&t_blockClientId, QIODevice::WriteOnly);
 
     t_FiffStreamOut.write_int(FIFF_MNE_RT_CLIENT_ID, &m_iDataClientId);
+    enqueueBlock(t_blockClientId, false);
 }
 
 //=============================================================================================================
@@ -280,8 +384,6 @@ void FiffStreamThread::writeClientId()
 
 void FiffStreamThread::run()
 {
-    m_bIsRunning = true;
-
     FiffStreamServer* t_pParentServer = qobject_cast<FiffStreamServer*>(this->parent());
 
     connect(t_pParentServer, &FiffStreamServer::remitMeasInfo,
@@ -307,64 +409,36 @@ void FiffStreamThread::run()
     }
 
     FiffStream t_FiffStreamIn(&t_qTcpSocket);
+    FiffTag::SPtr t_pPendingTag;
+
+    //
+    // Socket I/O is driven by the event loop of this thread: commands are read on readyRead, queued blocks are
+    // written when they arrive and whenever the socket has drained its write buffer
+    //
+    connect(&t_qTcpSocket, &QTcpSocket::readyRead, &t_qTcpSocket, [&]() {
+        readCommands(t_qTcpSocket, t_FiffStreamIn, t_pPendingTag);
+    });
+    connect(&t_qTcpSocket, &QTcpSocket::bytesWritten, &t_qTcpSocket, [&]() {
+        writeQueuedBlocks(t_qTcpSocket);
+    });
+    connect(this, &FiffStreamThread::blocksQueued, &t_qTcpSocket, [&]() {
+        writeQueuedBlocks(t_qTcpSocket);
+    }, Qt::QueuedConnection);
+    connect(&t_qTcpSocket, &QTcpSocket::disconnected, &t_qTcpSocket, [this]() {
+        QThread::quit();
+    });
+
+    // handle what arrived or was queued before the connections were made
+    writeQueuedBlocks(t_qTcpSocket);
+    readCommands(t_qTcpSocket, t_FiffStreamIn, t_pPendingTag);
 
-//    int i = 0;
-    while(t_qTcpSocket.state() != QAbstractSocket::UnconnectedState && m_bIsRunning)
-    {
-        //
-        // Write available data
-        //
-        m_qMutex.lock();
-        qint32 t_iBlockSize = m_qSendBlock.size();
-//        qDebug() << "data available" << t_iBlockSize;
-        if(t_iBlockSize > 0)
-        {
-            qint32 t_iBytesWritten = t_qTcpSocket.write(m_qSendBlock);
-//            qDebug() << ++i<< "[wrote bytes] " << t_iBytesWritten;
-            t_qTcpSocket.waitForBytesWritten();
-            if(t_iBytesWritten == t_iBlockSize)
-            {
-                m_qSendBlock.clear();
-            }
-            else
-            {
-                //we have to store bytes which were not written to the socket, due to writing limit
-                //m_qSendBlock = m_qSendBlock.mid(t_iBytesWritten, t_iBlockSize-t_iBytesWritten);
-                m_qSendBlock.remove(0,t_iBytesWritten); //higher performance then mid
-            }
-        }
-        m_qMutex.unlock();
-
-        //
-        // Read: Wait 10ms for incomming tag header, read and continue
-        //
-        t_qTcpSocket.waitForReadyRead(10);
-
-        if (t_qTcpSocket.bytesAvailable() >= (int)sizeof(qint32)*4)
-        {
-//            qDebug() << "goes to read bytes " ;
-            FiffTag::SPtr t_pTag;
-            t_FiffStreamIn.read_tag_info(t_pTag, false);
-
-            //
-            // wait until tag size data are available and read the data
-            //
-            while (t_qTcpSocket.bytesAvailable() < t_pTag->size())
-            {
-                t_qTcpSocket.waitForReadyRead(10);
-            }
-            t_FiffStreamIn.read_tag_data(t_pTag);
+    if(t_qTcpSocket.state() != QAbstractSocket::UnconnectedState)
+        exec();
 
-            //
-            // Parse the tag
-            //
-            if(t_pTag->kind == FIFF_MNE_RT_COMMAND)
-            {
-                parseCommand(t_pTag);
-            }
-        }
-    }
+    if(m_iNumDroppedRawBuffers > 0)
+        printf("FiffStreamClient (ID %d): %lld raw buffers were dropped\r\n\n", m_iDataClientId, (long long)m_iNumDroppedRawBuffers);
 
+    t_qTcpSocket.disconnect();
     t_qTcpSocket.disconnectFromHost();
     if(t_qTcpSocket.state() != QAbstractSocket::UnconnectedState)
         t_qTcpSocket.waitForDisconnected();
@@ -52,6 +52,8 @@
 #include <QThread>
 #include <QTcpSocket>
 #include <QMutex>
+#include <QQueue>
+#include <QByteArray>
 #include <QSharedPointer>
 
 //=============================================================================================================
@@ -69,6 +71,8 @@ class FiffStreamThread : public QThread
 {
     Q_OBJECT
 
+    friend class FiffStreamServer;
+
 public:
     FiffStreamThread(qint32 id, int socketDescriptor, QObject *parent);
 
@@ -91,26 +95,78 @@ public:
 signals:
     void error(QTcpSocket::SocketError socketError);
 
+    //=========================================================================================================
+    /**
+     * Emitted when new blocks were queued while no write was pending. Wakes up the socket thread.
+     */
+    void blocksQueued();
+
 private:
+    /**
+     * A serialized block waiting to be written to the client. Raw buffer blocks are shared between all clients.
+     */
+    struct SendBlock {
+        QByteArray  block;          /**< The serialized tags. */
+        bool        bIsRawBuffer;   /**< Whether this is a raw data buffer, which may be dropped for slow clients. */
+    };
+
     qint32 m_iDataClientId;
     QString m_sDataClientAlias;
 
     int m_iSocketDescriptor;
 
     QMutex m_qMutex;
-    QByteArray m_qSendBlock;
+    QQueue<SendBlock> m_qSendQueue;     /**< Blocks waiting to be handed to the socket, guarded by m_qMutex. */
+    int m_iNumQueuedRawBuffers;         /**< Number of raw buffer blocks in m_qSendQueue. */
+    qint64 m_iNumDroppedRawBuffers;     /**< Number of raw buffers dropped because the client did not keep up. */
+    bool m_bWritePending;               /**< Whether a blocksQueued wake up is already on its way. */
 
     bool m_bIsSendingRawBuffer;
 
-    bool m_bIsRunning;
-
     void startMeas(qint32 ID);
 
     void stopMeas(qint32 ID);
 
     void sendMeasurementInfo(qint32 ID, const FIFFLIB::FiffInfo& p_fiffInfo);
 
-    void sendRawBuffer(QSharedPointer<Eigen::MatrixXf> m_pMatRawData);
+    //=========================================================================================================
+    /**
+     * Queues an already serialized raw buffer block. The block is implicitly shared, no copy is made.
+     *
+     * @param[in] p_blockRawBuffer   The FIFF_DATA_BUFFER tag, serialized once for all clients.
+     */
+    void sendRawBuffer(const QByteArray& p_blockRawBuffer);
+
+    //=========================================================================================================
+    /**
+     * Appends a block to the send queue. If the client has more than the allowed number of raw buffers
+     * waiting, the oldest raw buffers are dropped. Control blocks are never dropped.
+     *
+     * @param[in] p_block        The serialized block.
+     * @param[in] p_bIsRawBuffer Whether the block is a raw data buffer.
+     */
+    void enqueueBlock(const QByteArray& p_block, bool p_bIsRawBuffer);
+
+    //=========================================================================================================
+    /**
+     * Hands queued blocks to the socket until its write buffer is filled up to the high water mark.
+     * Called from the socket thread when new blocks were queued and whenever the socket wrote bytes.
+     *
+     * @param[in] p_qTcpSocket   The client socket.
+     */
+    void writeQueuedBlocks(QTcpSocket& p_qTcpSocket);
+
+    //=========================================================================================================
+    /**
+     * Reads and parses all complete command tags available on the socket. A tag whose data did not fully
+     * arrive yet is kept in p_pPendingTag until the next readyRead.
+     *
+     * @param[in] p_qTcpSocket       The client socket.
+     * @param[in] p_FiffStreamIn     The fiff stream reading from the socket.
+     * @param[in, out] p_pPendingTag Tag whose header was read, but whose data is still missing.
+     */
+    void readCommands(QTcpSocket& p_qTcpSocket, FIFFLIB::FiffStream& p_FiffStreamIn, QSharedPointer<FIFFLIB::FiffTag>& p_pPendingTag);
+
     //void readToBuffer1();
 //    void readProc(QTcpSocket& p_qTcpSocket);
 };
@@ -136,64 +136,44 @@ void FiffProducer::run()
 //    for(qint32 i = 0; i < nchan; ++i)
 //        inv_calsMat.insert(i, i) = 1.0f/m_pFiffSimulator->m_RawInfo.info.chs[i].cal;
 
-    //Not good cause production time is not accurate
-    //loading and thread sleep is longer than thread sleep time - better to have a extra loading thread
-    // ToDo restructure this producer as laoding buffer --> and thread sleep to simulator buffer
-    fiff_int_t t_iDiff;
-    bool t_bRestart = false;
+    //
+    // This thread only decodes ahead into the raw matrix buffer, FiffSimulator::run paces the emission
+    //
+    fiff_int_t t_iNumRead;
+    MatrixXf matBlock(m_pFiffSimulator->m_RawInfo.info.nchan, quantum);
 
     while(m_bIsRunning)
     {
-        last = first+quantum-1;
-        if (last > to)
-        {
-            t_iDiff = last - to;
-            t_bRestart = true;
-
-            last = to;
-        }
-
-        if (!m_pFiffSimulator->m_RawInfo.read_raw_segment(data,times,first,last))
-        {
-            printf("error during read_raw_segment\n");
-        }
-
-        MatrixXf tmp = data.cast<float>();//(inv_calsMat*data).cast<float>();
-
-        if(t_bRestart)
+        //
+        // Fill the block segment by segment, restarting the file from the beginning when it ends
+        //
+        for(t_iNumRead = 0; t_iNumRead < quantum; )
         {
-            //
-            // Case end of Simulation: restart file from the beginning and read remaining bytes
-            //
-            printf("### RESTART Simulation File ###\r\n");
+            last = qMin(first + quantum - t_iNumRead - 1, to);
 
-            first = from;
-            last = first+t_iDiff-1;
-
-            if (!m_pFiffSimulator->m_RawInfo.read_raw_segment(data,times,first,last))
+            if (!m_pFiffSimulator->m_RawInfo.read_raw_segment(data,times,first,last)
+                || data.rows() != matBlock.rows() || data.cols() != last - first + 1)
             {
                 printf("error during read_raw_segment\n");
+                matBlock.middleCols(t_iNumRead, last - first + 1).setZero();
+            }
+            else
+            {
+                matBlock.middleCols(t_iNumRead, last - first + 1) = data.cast<float>();
             }
 
-            MatrixXf tmp2 = data.cast<float>();//(inv_calsMat*data).cast<float>();
-
-            MatrixXf tmp3(tmp.rows(), tmp.cols()+tmp2.cols());
-
-            tmp3.block(0,0,tmp.rows(),tmp.cols()) = tmp;
-            tmp3.block(0,tmp.cols(),tmp.rows(),tmp2.cols()) = tmp2;
-
-            tmp = tmp3;
+            t_iNumRead += last - first + 1;
+            first = last + 1;
 
-            t_bRestart = false;
-            first += t_iDiff;
-        }
-        else
-        {
-            first += quantum;
+            if(first > to)
+            {
+                printf("### RESTART Simulation File ###\r\n");
+                first = from;
+            }
         }
 
         // call blocks until there is free space in the buffer
-        while(!m_pFiffSimulator->m_pRawMatrixBuffer->push(tmp) && m_bIsRunning) {
+        while(!m_pFiffSimulator->m_pRawMatrixBuffer->push(matBlock) && m_bIsRunning) {
             //Do nothing until the circular buffer is ready to accept new data again
         }
     }
@@ -53,8 +53,12 @@
 #include <QtCore/QtPlugin>
 #include <QFile>
 #include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QtMath>
 #include <QDebug>
 
+#include <chrono>
+
 //=============================================================================================================
 // USED NAMESPACES
 //=============================================================================================================
@@ -74,6 +78,8 @@ const QString FiffSimulator::Commands::GETBUFSIZE   = "getbufsize";
 const QString FiffSimulator::Commands::ACCEL        = "accel";
 const QString FiffSimulator::Commands::GETACCEL     = "getaccel";
 const QString FiffSimulator::Commands::SIMFILE      = "simfile";
+const QString FiffSimulator::Commands::REPLAYSPEED  = "replayspeed";
+const QString FiffSimulator::Commands::GETREPLAYSTATS = "getreplaystats";
 
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -87,6 +93,11 @@ FiffSimulator::FiffSimulator()
 , m_TrueSamplingRate(0.0)
 , m_pRawMatrixBuffer(NULL)
 , m_bIsRunning(false)
+, m_fReplaySpeed(1.0f)
+, m_iNumEmittedBuffers(0)
+, m_iNumUnderruns(0)
+, m_dSumDriftMSecs(0.0)
+, m_dMaxDriftMSecs(0.0)
 {
     this->init();
 }
@@ -255,6 +266,59 @@ void FiffSimulator::comSimfile(Command p_command)
 
 //=============================================================================================================
 
+void FiffSimulator::comReplaySpeed(Command p_command)
+{
+    bool t_bOk = false;
+    float t_fSpeed = p_command.pValues()[0].toFloat(&t_bOk);
+
+    if(t_bOk && t_fSpeed >= 0)
+    {
+        // Read by the emission loop before every buffer, so no restart is needed
+        m_fReplaySpeed.store(t_fSpeed);
+
+        QString str = t_fSpeed > 0 ? QString("\tSet replay speed to %1x\r\n\n").arg(t_fSpeed)
+                                   : QString("\tSet replay speed to maximum\r\n\n");
+
+        m_commandManager[Commands::REPLAYSPEED].reply(str);
+    }
+    else
+        m_commandManager[Commands::REPLAYSPEED].reply("Replay speed not set\r\n");
+}
+
+//=============================================================================================================
+
+void FiffSimulator::comGetReplayStats(Command p_command)
+{
+    m_qMutexReplayStats.lock();
+    qint64 t_iNumEmittedBuffers = m_iNumEmittedBuffers;
+    qint64 t_iNumUnderruns = m_iNumUnderruns;
+    double t_dMeanDriftMSecs = m_iNumEmittedBuffers > 0 ? m_dSumDriftMSecs / m_iNumEmittedBuffers : 0.0;
+    double t_dMaxDriftMSecs = m_dMaxDriftMSecs;
+    m_qMutexReplayStats.unlock();
+
+    if(p_command.isJson())
+    {
+        QJsonObject t_qJsonObjectRoot;
+        t_qJsonObjectRoot.insert("speed", QJsonValue((double)m_fReplaySpeed.load()));
+        t_qJsonObjectRoot.insert("buffers", QJsonValue((double)t_iNumEmittedBuffers));
+        t_qJsonObjectRoot.insert("underruns", QJsonValue((double)t_iNumUnderruns));
+        t_qJsonObjectRoot.insert("meandrift", QJsonValue(t_dMeanDriftMSecs));
+        t_qJsonObjectRoot.insert("maxdrift", QJsonValue(t_dMaxDriftMSecs));
+        QJsonDocument p_qJsonDocument(t_qJsonObjectRoot);
+
+        m_commandManager[Commands::GETREPLAYSTATS].reply(p_qJsonDocument.toJson());
+    }
+    else
+    {
+        QString str = QString("\tspeed %1, buffers %2, underruns %3, mean drift %4 ms, max drift %5 ms\r\n\n")
+                      .arg(m_fReplaySpeed.load()).arg(t_iNumEmittedBuffers).arg(t_iNumUnderruns)
+                      .arg(t_dMeanDriftMSecs, 0, 'f', 3).arg(t_dMaxDriftMSecs, 0, 'f', 3);
+        m_commandManager[Commands::GETREPLAYSTATS].reply(str);
+    }
+}
+
+//=============================================================================================================
+
 void FiffSimulator::connectCommandManager()
 {
     //Connect slots
@@ -263,6 +327,8 @@ void FiffSimulator::connectCommandManager()
     QObject::connect(&m_commandManager[Commands::ACCEL], &Command::executed, this, &FiffSimulator::comAccel);
     QObject::connect(&m_commandManager[Commands::GETACCEL], &Command::executed, this, &FiffSimulator::comGetAccel);
     QObject::connect(&m_commandManager[Commands::SIMFILE], &Command::executed, this, &FiffSimulator::comSimfile);
+    QObject::connect(&m_commandManager[Commands::REPLAYSPEED], &Command::executed, this, &FiffSimulator::comReplaySpeed);
+    QObject::connect(&m_commandManager[Commands::GETREPLAYSTATS], &Command::executed, this, &FiffSimulator::comGetReplayStats);
 }
 
 //=============================================================================================================
@@ -320,7 +386,7 @@ void FiffSimulator::init()
     m_pRawMatrixBuffer = NULL;
 
     if(!m_RawInfo.isEmpty())
-        m_pRawMatrixBuffer = new CircularBuffer_Matrix_float(RAW_BUFFFER_SIZE);
+        m_pRawMatrixBuffer = new CircularBuffer_Matrix_float(preloadBufferCount());
 }
 
 //=============================================================================================================
@@ -466,7 +532,7 @@ bool FiffSimulator::readRawInfo()
         //
         if(m_pRawMatrixBuffer)
             delete m_pRawMatrixBuffer;
-        m_pRawMatrixBuffer = new CircularBuffer_Matrix_float(10);
+        m_pRawMatrixBuffer = new CircularBuffer_Matrix_float(preloadBufferCount());
 
         mutex.unlock();
     }
@@ -476,27 +542,91 @@ bool FiffSimulator::readRawInfo()
 
 //=============================================================================================================
 
+int FiffSimulator::preloadBufferCount() const
+{
+    if(m_uiBufferSampleSize == 0 || m_TrueSamplingRate <= 0)
+        return RAW_BUFFFER_SIZE;
+
+    return qMax(RAW_BUFFFER_SIZE, qCeil(RAW_PRELOAD_SECONDS * m_TrueSamplingRate / m_uiBufferSampleSize));
+}
+
+//=============================================================================================================
+
 void FiffSimulator::run()
 {
     m_bIsRunning = true;
 
-    float t_fSamplingFrequency = m_RawInfo.info.sfreq;
-    float t_fBuffSampleSize = (float)m_uiBufferSampleSize;
+    const double t_dBufferUSecs = 1000000.0 * m_uiBufferSampleSize / m_RawInfo.info.sfreq;
 
-    quint32 uiSamplePeriod = (unsigned int) ((t_fBuffSampleSize/t_fSamplingFrequency)*1000000.0f);
+    m_qMutexReplayStats.lock();
+    m_iNumEmittedBuffers = 0;
+    m_iNumUnderruns = 0;
+    m_dSumDriftMSecs = 0.0;
+    m_dMaxDriftMSecs = 0.0;
+    m_qMutexReplayStats.unlock();
+
+    //
+    // Buffers are due at fixed offsets from a monotonic clock, so sleeping never accumulates an error
+    //
+    QElapsedTimer t_clock;
+    t_clock.start();
+    double t_dScheduleUSecs = 0.0;
+    float t_fSpeed = m_fReplaySpeed.load();
+    qint32 t_iFirstSample = 0;
 
-//    quint32 count = 0;
     Eigen::MatrixXf matData;
 
     while(m_bIsRunning)
     {
-        if(m_pRawMatrixBuffer->pop(matData) ) {
-            QSharedPointer<Eigen::MatrixXf> t_pRawBuffer(new Eigen::MatrixXf(matData));
-            //        ++count;
-            //        printf("%d raw buffer (%d x %d) generated\r\n", count, t_pRawBuffer->rows(), t_pRawBuffer->cols());
+        if(!m_pRawMatrixBuffer->pop(matData))
+            continue;
+
+        qint64 t_iNowUSecs = t_clock.nsecsElapsed() / 1000;
+
+        // A new speed starts a new schedule at the current buffer
+        float t_fNewSpeed = m_fReplaySpeed.load();
+        if(t_fNewSpeed != t_fSpeed)
+        {
+            t_fSpeed = t_fNewSpeed;
+            t_dScheduleUSecs = t_iNowUSecs;
+        }
+
+        double t_dDriftMSecs = 0.0;
+        bool t_bUnderrun = false;
+        if(t_fSpeed > 0)
+        {
+            if(t_iNowUSecs < t_dScheduleUSecs)
+            {
+                usleep(static_cast<unsigned long>(t_dScheduleUSecs - t_iNowUSecs));
+                t_iNowUSecs = t_clock.nsecsElapsed() / 1000;
+            }
+
+            t_dDriftMSecs = (t_iNowUSecs - t_dScheduleUSecs) / 1000.0;
 
-            emit remitRawBuffer(t_pRawBuffer);
-            usleep(uiSamplePeriod);
+            // More than one buffer behind: the producer could not decode in time. Restart the schedule instead of
+            // emitting a burst to catch up.
+            if(t_iNowUSecs - t_dScheduleUSecs > t_dBufferUSecs / t_fSpeed)
+            {
+                t_bUnderrun = true;
+                t_dScheduleUSecs = t_iNowUSecs;
+            }
+
+            t_dScheduleUSecs += t_dBufferUSecs / t_fSpeed;
         }
+
+        QSharedPointer<Eigen::MatrixXf> t_pRawBuffer(new Eigen::MatrixXf);
+        t_pRawBuffer->swap(matData);
+
+        qint64 t_iTimeStampUSecs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        emit remitRawBuffer(t_pRawBuffer, t_iTimeStampUSecs, t_iFirstSample);
+        t_iFirstSample += t_pRawBuffer->cols();
+
+        m_qMutexReplayStats.lock();
+        ++m_iNumEmittedBuffers;
+        if(t_bUnderrun)
+            ++m_iNumUnderruns;
+        m_dSumDriftMSecs += t_dDriftMSecs;
+        m_dMaxDriftMSecs = qMax(m_dMaxDriftMSecs, t_dDriftMSecs);
+        m_qMutexReplayStats.unlock();
     }
 }
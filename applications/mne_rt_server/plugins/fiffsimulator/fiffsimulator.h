@@ -54,10 +54,18 @@
 #include <QString>
 #include <QMutex>
 
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <atomic>
+
 //=============================================================================================================
 // FORWARD DECLARATIONS
 //=============================================================================================================
 
+#define RAW_PRELOAD_SECONDS    2.0    /**< Amount of data the producer decodes ahead of the emission. */
+
 //=============================================================================================================
 // DEFINE NAMESPACE FIFFSIMULATORRTSERVERPLUGIN
 //=============================================================================================================
@@ -94,6 +102,8 @@ public:
         static const QString ACCEL;
         static const QString GETACCEL;
         static const QString SIMFILE;
+        static const QString REPLAYSPEED;
+        static const QString GETREPLAYSTATS;
     };
 
     //=========================================================================================================
@@ -164,6 +174,24 @@ private:
      */
     void comSimfile(COMMUNICATIONLIB::Command p_command);
 
+    //=========================================================================================================
+    /**
+     * Sets the replay speed. 1 replays in real time, N N times faster and 0 as fast as the producer decodes the
+     * buffers. Unlike the acceleration factor the advertised sampling rate is not changed.
+     *
+     * @param[in] p_command  The replay speed command.
+     */
+    void comReplaySpeed(COMMUNICATIONLIB::Command p_command);
+
+    //=========================================================================================================
+    /**
+     * Returns the replay statistics of the current run: emitted buffers, underruns and the drift of the emission
+     * times from the schedule.
+     *
+     * @param[in] p_command  The replay statistics command.
+     */
+    void comGetReplayStats(COMMUNICATIONLIB::Command p_command);
+
     //=========================================================================================================
     /**
      * Initialise the FiffSimulator.
@@ -176,7 +204,16 @@ private:
      */
     bool readRawInfo();
 
+    //=========================================================================================================
+    /**
+     * Returns the number of raw buffers the producer decodes ahead, which covers RAW_PRELOAD_SECONDS of data.
+     *
+     * @return the capacity of the raw matrix buffer.
+     */
+    int preloadBufferCount() const;
+
     QMutex mutex;
+    QMutex                                  m_qMutexReplayStats;    /**< Guards the replay statistics. */
 
     FiffProducer*                           m_pFiffProducer;        /**< Holds the DataProducer.*/
     UTILSLIB::CircularBuffer_Matrix_float*  m_pRawMatrixBuffer;     /**< The Circular Raw Matrix Buffer. */
@@ -186,6 +223,12 @@ private:
     float                                   m_AccelerationFactor;   /**< Acceleration factor to simulate different sampling rates. */
     float                                   m_TrueSamplingRate;     /**< The true sampling rate of the fif file. */
     bool                                    m_bIsRunning;           /**< Flag whether the producer is running.*/
+
+    std::atomic<float>                      m_fReplaySpeed;         /**< Replay speed relative to real time, 0 for as fast as possible. Set by the command thread, read by run(). */
+    qint64                                  m_iNumEmittedBuffers;   /**< Number of buffers emitted since the last start. */
+    qint64                                  m_iNumUnderruns;        /**< Number of buffers which were not decoded in time. */
+    double                                  m_dSumDriftMSecs;       /**< Sum of the emission delays behind the schedule in ms. */
+    double                                  m_dMaxDriftMSecs;       /**< Largest emission delay behind the schedule in ms. */
 };
 } // NAMESPACE
 
@@ -39,6 +39,12 @@
 
 #include "measurement.h"
 
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <chrono>
+
 //=============================================================================================================
 // USED NAMESPACES
 //=============================================================================================================
@@ -54,6 +60,7 @@ Measurement::Measurement(int type,
 : QObject(parent)
 , m_iMetaTypeId(type)
 , m_bVisibility(true)
+, m_iTimeStamp(-1)
 {
 //    qWarning() << "QMetaType" << type;
 }
@@ -63,3 +70,10 @@ Measurement::Measurement(int type,
 Measurement::~Measurement()
 {
 }
+
+//=============================================================================================================
+
+qint64 Measurement::currentTimeStamp()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
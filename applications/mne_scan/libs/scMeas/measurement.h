@@ -122,6 +122,31 @@ public:
      */
     inline int type() const;
 
+    //=========================================================================================================
+    /**
+     * Returns the time stamp of the data currently held by the Measurement, i.e. the wall clock time at which
+     * the oldest contained block entered the plugin graph.
+     *
+     * @return the time stamp in microseconds since epoch, -1 if no time stamp was set.
+     */
+    inline qint64 getTimeStamp() const;
+
+    //=========================================================================================================
+    /**
+     * Sets the time stamp of the data currently held by the Measurement.
+     *
+     * @param[in] iTimeStamp     the time stamp in microseconds since epoch, -1 to unset.
+     */
+    inline void setTimeStamp(qint64 iTimeStamp);
+
+    //=========================================================================================================
+    /**
+     * Returns the current wall clock time in the unit used for Measurement time stamps.
+     *
+     * @return the current time in microseconds since epoch.
+     */
+    static qint64 currentTimeStamp();
+
 signals:
     void notify();
 
@@ -139,6 +164,7 @@ private:
     int                                 m_iMetaTypeId;      /**< QMetaType id of the Measurement. */
     QString                             m_qString_Name;     /**< Name of the Measurement. */
     bool                                m_bVisibility;      /**< Visibility status. */
+    qint64                              m_iTimeStamp;       /**< Time stamp of the held data in microseconds since epoch, -1 if unset. */
 };
 
 //=============================================================================================================
@@ -191,6 +217,22 @@ inline int Measurement::type() const
     return m_iMetaTypeId;
 }
 
+//=============================================================================================================
+
+inline qint64 Measurement::getTimeStamp() const
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_iTimeStamp;
+}
+
+//=============================================================================================================
+
+inline void Measurement::setTimeStamp(qint64 iTimeStamp)
+{
+    QMutexLocker locker(&m_qMutex);
+    m_iTimeStamp = iTimeStamp;
+}
+
 } //NAMESPACE
 
 Q_DECLARE_METATYPE(SCMEASLIB::Measurement::SPtr)
@@ -129,8 +129,11 @@ const QStringList& RealTimeEvokedSet::getResponsibleTriggerTypes()
 
 void RealTimeEvokedSet::setValue(const FiffEvokedSet &v,
                                  const FiffInfo::SPtr &p_fiffinfo,
-                                 const QStringList &lResponsibleTriggerTypes)
+                                 const QStringList &lResponsibleTriggerTypes,
+                                 qint64 iTimeStamp)
 {
+    setTimeStamp(iTimeStamp >= 0 ? iTimeStamp : currentTimeStamp());
+
     //Store
     m_qMutex.lock();
      *m_pFiffEvokedSet = v;
@@ -177,10 +177,13 @@ public:
      * @param[in] v                         the evoked set which should be distributed.
      * @param[in] p_fiffinfo                the evoked fiff info as shared pointer.
      * @param[in] lResponsibleTriggerTypes  List of all trigger types which lead to the recent emit of a new evoked set.
+     * @param[in] iTimeStamp                The time stamp (microseconds since epoch) of the data which completed the evoked set.
+     *                                      Defaults to -1, which stamps the set with the current time.
      */
     virtual void setValue(const FIFFLIB::FiffEvokedSet &v,
                           const QSharedPointer<FIFFLIB::FiffInfo>& p_fiffinfo,
-                          const QStringList& lResponsibleTriggerTypes);
+                          const QStringList& lResponsibleTriggerTypes,
+                          qint64 iTimeStamp = -1);
 
     //=========================================================================================================
     /**
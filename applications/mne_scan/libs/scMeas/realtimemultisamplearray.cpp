@@ -227,7 +227,8 @@ void RealTimeMultiSampleArray::initFromFiffInfo(FiffInfo::SPtr pFiffInfo)
 
 //=============================================================================================================
 
-void RealTimeMultiSampleArray::setValue(const MatrixXd& mat)
+void RealTimeMultiSampleArray::setValue(const MatrixXd& mat,
+                                        qint64 iTimeStamp)
 {
     if(!m_bChInfoIsInit)
         return;
@@ -246,6 +247,9 @@ void RealTimeMultiSampleArray::setValue(const MatrixXd& mat)
 //    }
 
     //Store
+    if(m_matSamples.isEmpty()) {
+        setTimeStamp(iTimeStamp >= 0 ? iTimeStamp : currentTimeStamp());
+    }
     m_matSamples.push_back(mat);
 
     m_qMutex.unlock();
@@ -203,9 +203,13 @@ public:
     /**
      * Attaches a value to the sample array list.
      *
-     * @param[in] mat   the value which is attached to the sample array list.
+     * @param[in] mat           the value which is attached to the sample array list.
+     * @param[in] iTimeStamp    the time stamp (microseconds since epoch) at which mat entered the plugin graph. Defaults to -1,
+     *                          which stamps the block with the current time. The oldest block stamp of a gathered list
+     *                          becomes the Measurement time stamp.
      */
-    virtual void setValue(const Eigen::MatrixXd& mat);
+    virtual void setValue(const Eigen::MatrixXd& mat,
+                          qint64 iTimeStamp = -1);
 
 private:
     mutable QMutex              m_qMutex;           /**< Mutex to ensure thread safety. */
@@ -81,11 +81,15 @@ QList<MNESourceEstimate::SPtr>& RealTimeSourceEstimate::getValue()
 
 //=============================================================================================================
 
-void RealTimeSourceEstimate::setValue(MNESourceEstimate& v)
+void RealTimeSourceEstimate::setValue(MNESourceEstimate& v,
+                                      qint64 iTimeStamp)
 {
     m_qMutex.lock();
 
     //Store
+    if(m_pMNEStc.isEmpty()) {
+        setTimeStamp(iTimeStamp >= 0 ? iTimeStamp : currentTimeStamp());
+    }
     MNESourceEstimate::SPtr pMNESourceEstimate = MNESourceEstimate::SPtr::create(v);
     m_pMNEStc.append(pMNESourceEstimate);
 
@@ -166,9 +166,13 @@ public:
      * Attaches a value to the sample array vector.
      * This method is inherited by Measurement.
      *
-     * @param[in] v the value which is attached to the sample array vector.
+     * @param[in] v             the value which is attached to the sample array vector.
+     * @param[in] iTimeStamp    the time stamp (microseconds since epoch) of the data v was computed from. Defaults to -1,
+     *                          which stamps v with the current time. The oldest stamp of a gathered list becomes the
+     *                          Measurement time stamp.
      */
-    virtual void setValue(MNELIB::MNESourceEstimate &v);
+    virtual void setValue(MNELIB::MNESourceEstimate &v,
+                          qint64 iTimeStamp = -1);
 
     //=========================================================================================================
     /**
@@ -40,11 +40,15 @@
 #include "plugininputconnector.h"
 #include "../Plugins/abstractplugin.h"
 
+#include <utils/mnetracer.h>
+
 //=============================================================================================================
 // USED NAMESPACES
 //=============================================================================================================
 
 using namespace SCSHAREDLIB;
+using namespace SCMEASLIB;
+using namespace UTILSLIB;
 
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -73,7 +77,56 @@ bool PluginInputConnector::isOutputConnector() const
 
 //=============================================================================================================
 
-void PluginInputConnector::update(SCMEASLIB::Measurement::SPtr pMeasurement)
+PluginInputStatistics PluginInputConnector::getStatistics() const
+{
+    QMutexLocker locker(&m_qMutexStatistics);
+    return m_statistics;
+}
+
+//=============================================================================================================
+
+void PluginInputConnector::resetStatistics()
 {
+    QMutexLocker locker(&m_qMutexStatistics);
+    m_statistics = PluginInputStatistics();
+}
+
+//=============================================================================================================
+
+void PluginInputConnector::update(Measurement::SPtr pMeasurement)
+{
+    qint64 iLatency = -1;
+    if(pMeasurement && pMeasurement->getTimeStamp() >= 0) {
+        iLatency = Measurement::currentTimeStamp() - pMeasurement->getTimeStamp();
+    }
+
+    // The plugins' update slots are directly connected, so this covers the time until the plugin accepted the data
+    long long iBeginTime = MNETracer::getTimeNow();
     emit notify(pMeasurement);
+    qint64 iAcceptTime = MNETracer::getTimeNow() - iBeginTime;
+
+    int iQueueDepth = m_pPlugin->getInputQueueDepth();
+
+    m_qMutexStatistics.lock();
+    ++m_statistics.iNumUpdates;
+    m_statistics.iSumAcceptTime += iAcceptTime;
+    m_statistics.iMaxAcceptTime = qMax(m_statistics.iMaxAcceptTime, iAcceptTime);
+    if(iLatency >= 0) {
+        ++m_statistics.iNumLatencies;
+        m_statistics.iSumLatency += iLatency;
+        m_statistics.iMaxLatency = qMax(m_statistics.iMaxLatency, iLatency);
+    }
+    m_statistics.iQueueDepth = iQueueDepth;
+    m_qMutexStatistics.unlock();
+
+    if(MNETracer::isEnabled()) {
+        std::string sName = QString("%1/%2").arg(m_pPlugin->getName(), getName()).toStdString();
+        MNETracer::traceCompleteEvent(sName + " accept", "mne_scan", iBeginTime, iAcceptTime);
+        if(iLatency >= 0) {
+            MNETracer::traceQuantity(sName + " latency [us]", static_cast<long>(iLatency));
+        }
+        if(iQueueDepth >= 0) {
+            MNETracer::traceQuantity(sName + " queue depth", iQueueDepth);
+        }
+    }
 }
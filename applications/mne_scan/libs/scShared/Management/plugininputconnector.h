@@ -50,6 +50,7 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
+#include <QMutex>
 
 //=============================================================================================================
 // DEFINE NAMESPACE SCSHAREDLIB
@@ -58,6 +59,20 @@
 namespace SCSHAREDLIB
 {
 
+//=============================================================================================================
+/**
+ * Throughput and latency counters gathered by a PluginInputConnector. All times are in microseconds.
+ */
+struct PluginInputStatistics {
+    qint64 iNumUpdates = 0;             /**< Number of measurements delivered to the plugin. */
+    qint64 iSumAcceptTime = 0;          /**< Accumulated time the plugin spent in its update slot, i.e. queueing the data. See AbstractPlugin::getProcessingStatistics() for the processing time. */
+    qint64 iMaxAcceptTime = 0;          /**< Longest time the plugin spent in its update slot. */
+    qint64 iNumLatencies = 0;           /**< Number of delivered measurements which carried a time stamp. */
+    qint64 iSumLatency = 0;             /**< Accumulated age of the delivered measurements on arrival. */
+    qint64 iMaxLatency = 0;             /**< Largest age of a delivered measurement on arrival. */
+    int iQueueDepth = -1;               /**< Input queue depth of the plugin after the last update, -1 if unknown. */
+};
+
 //=============================================================================================================
 /**
  * Base class to connect plug-in data streams.
@@ -106,12 +121,38 @@ public:
      */
     virtual bool isOutputConnector() const;
 
+    //=========================================================================================================
+    /**
+     * Returns the throughput and latency counters gathered since construction or the last reset.
+     *
+     * @return the current statistics.
+     */
+    PluginInputStatistics getStatistics() const;
+
+    //=========================================================================================================
+    /**
+     * Resets the throughput and latency counters.
+     */
+    void resetStatistics();
+
 signals:
     void notify(SCMEASLIB::Measurement::SPtr pMeasurement);
 
 public slots:
+    //=========================================================================================================
+    /**
+     * Forwards the measurement to the plugin and records how long the plugin took to accept it, how old the
+     * measurement was on arrival and the resulting input queue depth. If the MNETracer is enabled, the update is
+     * additionally written to the trace file as complete event and counters. The time the plugin needs to process
+     * the data is traced by the plugin itself, see AbstractPlugin::traceCompleteEvent().
+     *
+     * @param[in] pMeasurement   the incoming measurement.
+     */
     void update(SCMEASLIB::Measurement::SPtr pMeasurement);
 
+private:
+    mutable QMutex              m_qMutexStatistics;     /**< Guards the statistics. */
+    PluginInputStatistics       m_statistics;           /**< Throughput and latency counters. */
 };
 } // NAMESPACE
 
@@ -46,6 +46,8 @@
 
 #include <disp/viewers/abstractview.h>
 
+#include <utils/mnetracer.h>
+
 //=============================================================================================================
 // QT INCLUDES
 //=============================================================================================================
@@ -54,6 +56,7 @@
 #include <QCoreApplication>
 #include <QSharedPointer>
 #include <QAction>
+#include <QMutex>
 
 //=============================================================================================================
 // DEFINE NAMESPACE SCSHAREDLIB
@@ -70,6 +73,16 @@ namespace SCSHAREDLIB
 // SCSHAREDLIB FORWARD DECLARATIONS
 //=============================================================================================================
 
+//=============================================================================================================
+/**
+ * Processing time counters gathered by a plugin in its run() loop. All times are in microseconds.
+ */
+struct PluginProcessingStatistics {
+    qint64 iNumBlocks = 0;              /**< Number of processed data blocks. */
+    qint64 iSumProcessingTime = 0;      /**< Accumulated time from taking a block off the input queue until its result was emitted. */
+    qint64 iMaxProcessingTime = 0;      /**< Longest time spent processing a single block. */
+};
+
 //=============================================================================================================
 /**
  * DECLARE CLASS AbstractPlugin
@@ -183,6 +196,29 @@ public:
      */
     virtual QWidget* setupWidget() = 0; //setup()
 
+    //=========================================================================================================
+    /**
+     * Returns the number of incoming data blocks which were accepted by the plugin but are not processed yet.
+     * Plugins which queue their input, i.e. in a circular buffer, should reimplement this to report the fill level.
+     *
+     * @return the number of queued input blocks, -1 if the plugin does not queue its input.
+     */
+    virtual int getInputQueueDepth() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the processing time counters gathered since construction or the last reset.
+     *
+     * @return the current processing statistics.
+     */
+    inline PluginProcessingStatistics getProcessingStatistics() const;
+
+    //=========================================================================================================
+    /**
+     * Resets the processing time counters.
+     */
+    inline void resetProcessingStatistics();
+
     inline InputConnectorList& getInputConnectors(){return m_inputConnectors;}
     inline OutputConnectorList& getOutputConnectors(){return m_outputConnectors;}
 
@@ -223,6 +259,16 @@ protected:
      */
     inline void addPluginAction(QAction* pAction);
 
+    //=========================================================================================================
+    /**
+     * Records the time the plugin spent on one data block in its run() loop, i.e. from popping the block off its
+     * input queue until the result was handed to the output. If the MNETracer is enabled, the block is additionally
+     * written to the trace file as complete event.
+     *
+     * @param[in] iBeginTime   The time processing of the block started, as returned by MNETracer::getTimeNow().
+     */
+    inline void traceCompleteEvent(long long iBeginTime);
+
     InputConnectorList m_inputConnectors;       /**< Set of input connectors associated with this plug-in. */
     OutputConnectorList m_outputConnectors;     /**< Set of output connectors associated with this plug-in. */
 
@@ -230,6 +276,9 @@ protected:
 
 private:
     QList< QAction* >   m_qListPluginActions;  /**< List of plugin actions. */
+
+    mutable QMutex              m_qMutexProcessingStatistics;   /**< Guards the processing statistics. */
+    PluginProcessingStatistics  m_processingStatistics;         /**< Processing time counters. */
 };
 
 //=============================================================================================================
@@ -243,6 +292,29 @@ inline bool AbstractPlugin::multiInstanceAllowed() const
 
 //=============================================================================================================
 
+inline int AbstractPlugin::getInputQueueDepth() const
+{
+    return -1;
+}
+
+//=============================================================================================================
+
+inline PluginProcessingStatistics AbstractPlugin::getProcessingStatistics() const
+{
+    QMutexLocker locker(&m_qMutexProcessingStatistics);
+    return m_processingStatistics;
+}
+
+//=============================================================================================================
+
+inline void AbstractPlugin::resetProcessingStatistics()
+{
+    QMutexLocker locker(&m_qMutexProcessingStatistics);
+    m_processingStatistics = PluginProcessingStatistics();
+}
+
+//=============================================================================================================
+
 inline QList< QAction* > AbstractPlugin::getPluginActions()
 {
     return m_qListPluginActions;
@@ -257,6 +329,23 @@ inline void AbstractPlugin::addPluginAction(QAction* pAction)
 
 //=============================================================================================================
 
+inline void AbstractPlugin::traceCompleteEvent(long long iBeginTime)
+{
+    qint64 iProcessingTime = UTILSLIB::MNETracer::getTimeNow() - iBeginTime;
+
+    m_qMutexProcessingStatistics.lock();
+    ++m_processingStatistics.iNumBlocks;
+    m_processingStatistics.iSumProcessingTime += iProcessingTime;
+    m_processingStatistics.iMaxProcessingTime = qMax(m_processingStatistics.iMaxProcessingTime, iProcessingTime);
+    m_qMutexProcessingStatistics.unlock();
+
+    if(UTILSLIB::MNETracer::isEnabled()) {
+        UTILSLIB::MNETracer::traceCompleteEvent(QString("%1/run").arg(getName()).toStdString(), "mne_scan", iBeginTime, iProcessingTime);
+    }
+}
+
+//=============================================================================================================
+
 //inline void AbstractPlugin::addPluginWidget(QWidget* pWidget)
 //{
 //    m_qListPluginWidgets.append(pWidget);
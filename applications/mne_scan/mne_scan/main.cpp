@@ -50,6 +50,7 @@
 #include <scShared/Plugins/abstractplugin.h>
 
 #include <utils/generics/applicationlogger.h>
+#include <utils/mnetracer.h>
 
 //=============================================================================================================
 // EIGEN INCLUDES
@@ -64,6 +65,7 @@
 #include <QtGui>
 #include <QApplication>
 #include <QSharedPointer>
+#include <QCommandLineParser>
 
 //=============================================================================================================
 // USED NAMESPACES
@@ -163,6 +165,29 @@ int main(int argc, char *argv[])
     QCoreApplication::setApplicationName(CInfo::AppNameShort());
     QCoreApplication::setOrganizationDomain("www.mne-cpp.org");
 
+    // Command Line Parser
+    QCommandLineParser parser;
+    parser.setApplicationDescription("MNE Scan");
+    parser.addHelpOption();
+
+    QCommandLineOption traceOpt(QStringList() << "t" << "trace",
+                                QCoreApplication::translate("main","Write per plugin latency, queue depth and processing times to a Chrome trace (json) file."),
+                                QCoreApplication::translate("main","filePath"));
+
+    parser.addOption(traceOpt);
+
+    parser.process(app);
+
+    if(parser.isSet(traceOpt)) {
+        UTILSLIB::MNETracer::enable(parser.value(traceOpt).toStdString());
+
+        if(UTILSLIB::MNETracer::isEnabled()) {
+            qInfo() << QString("[MNEScan::main] Writing trace to %1").arg(parser.value(traceOpt));
+        } else {
+            qWarning() << QString("[MNEScan::main] Could not open trace file %1").arg(parser.value(traceOpt));
+        }
+    }
+
     SCMEASLIB::MeasurementTypes::registerTypes();
 
     MainWindow mainWin;
@@ -173,5 +198,7 @@ int main(int argc, char *argv[])
 
     int returnValue(app.exec());
 
+    UTILSLIB::MNETracer::disable();
+
     return returnValue;
 }
@@ -77,6 +77,7 @@ using namespace Eigen;
 
 Averaging::Averaging()
 : m_pCircularBuffer(CircularBuffer<FIFFLIB::FiffEvokedSet>::SPtr::create(40))
+, m_pCircularTimeStampBuffer(CircularBuffer<qint64>::SPtr::create(40))
 {
 }
 
@@ -147,6 +148,13 @@ QWidget* Averaging::setupWidget()
 
 //=============================================================================================================
 
+int Averaging::getInputQueueDepth() const
+{
+    return m_pCircularBuffer->getFreeElementsRead();
+}
+
+//=============================================================================================================
+
 void Averaging::update(SCMEASLIB::Measurement::SPtr pMeasurement)
 {
     if(QSharedPointer<RealTimeMultiSampleArray> pRTMSA = pMeasurement.dynamicCast<RealTimeMultiSampleArray>()) {
@@ -176,7 +184,8 @@ void Averaging::update(SCMEASLIB::Measurement::SPtr pMeasurement)
                     // m_pRtAve->append() returns. m_pRtAve->append() returns without a copy since it communicates
                     // via signals with the worker thread of RtCov.
                     matData = pRTMSA->getMultiSampleArray()[i];
-                    m_pRtAve->append(matData);
+                    m_pRtAve->append(matData,
+                                     pRTMSA->getTimeStamp());
                 }
             }
         }
@@ -404,7 +413,8 @@ void Averaging::onChangeBaselineActive(bool state)
 //=============================================================================================================
 
 void Averaging::onNewEvokedSet(const FIFFLIB::FiffEvokedSet& evokedSet,
-                               const QStringList& lResponsibleTriggerTypes)
+                               const QStringList& lResponsibleTriggerTypes,
+                               qint64 iTimeStamp)
 {
     if(!this->isRunning()) {
         return;
@@ -413,6 +423,7 @@ void Averaging::onNewEvokedSet(const FIFFLIB::FiffEvokedSet& evokedSet,
     while(!m_pCircularBuffer->push(evokedSet)) {
         //Do nothing until the circular buffer is ready to accept new data again
     }
+    m_pCircularTimeStampBuffer->push(iTimeStamp);
 
     emit evokedSetChanged(evokedSet);
 
@@ -438,16 +449,27 @@ void Averaging::run()
 {
     FIFFLIB::FiffEvokedSet evokedSet;
     QStringList lResponsibleTriggerTypes;
+    qint64 iTimeStamp;
 
     while(!isInterruptionRequested()){
         if(m_pCircularBuffer->pop(evokedSet)) {
+            long long iBeginTime = UTILSLIB::MNETracer::getTimeNow();
+
+            // Forward the time stamp of the data which completed the evoked set so latencies are measured end-to-end
+            if(!m_pCircularTimeStampBuffer->pop(iTimeStamp)) {
+                iTimeStamp = -1;
+            }
+
             m_qMutex.lock();
             lResponsibleTriggerTypes = m_lResponsibleTriggerTypes;
             m_qMutex.unlock();
 
             m_pAveragingOutput->measurementData()->setValue(evokedSet,
                                                  m_pFiffInfo,
-                                                 lResponsibleTriggerTypes);
+                                                 lResponsibleTriggerTypes,
+                                                 iTimeStamp);
+
+            traceCompleteEvent(iBeginTime);
         }
     }
 }
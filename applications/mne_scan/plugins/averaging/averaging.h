@@ -120,6 +120,7 @@ public:
     virtual SCSHAREDLIB::AbstractPlugin::PluginType getType() const;
     virtual QString getName() const;
     virtual QWidget* setupWidget();
+    virtual int getInputQueueDepth() const;
     void update(SCMEASLIB::Measurement::SPtr pMeasurement);
 
     //=========================================================================================================
@@ -206,9 +207,11 @@ public:
      *
      * @param[in] evokedSet                  The new FiffEvokedSet.
      * @param[in] lResponsibleTriggerTypes   List of all trigger types which lead to the recent emit of a new evoked set.
+     * @param[in] iTimeStamp                 The time stamp of the data block which completed the evoked set, -1 if unknown.
      */
     void onNewEvokedSet(const FIFFLIB::FiffEvokedSet& evokedSet,
-                        const QStringList &lResponsibleTriggerTypes);
+                        const QStringList &lResponsibleTriggerTypes,
+                        qint64 iTimeStamp);
 
     //=========================================================================================================
     /**
@@ -225,6 +228,7 @@ private:
     SCSHAREDLIB::PluginOutputData<SCMEASLIB::RealTimeEvokedSet>::SPtr           m_pAveragingOutput;     /**< The RealTimeEvoked of the Averaging output.*/
 
     UTILSLIB::CircularBuffer<FIFFLIB::FiffEvokedSet>::SPtr                      m_pCircularBuffer;      /**< Holds incoming fiff evoked sets. */
+    UTILSLIB::CircularBuffer<qint64>::SPtr                                      m_pCircularTimeStampBuffer; /**< Holds the time stamps of the incoming fiff evoked sets, in the same order. */
 
     QMutex                                          m_qMutex;                           /**< Provides access serialization between threads. */
 
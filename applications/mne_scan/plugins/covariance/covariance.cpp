@@ -81,6 +81,7 @@ using namespace Eigen;
 
 Covariance::Covariance()
 : m_iEstimationSamples(2000)
+, m_dForgettingFactor(1.0)
 , m_pCircularBuffer(CircularBuffer_Matrix_double::SPtr::create(40))
 {
 }
@@ -108,6 +109,7 @@ void Covariance::init()
     // Load Settings
     QSettings settings("MNECPP");
     m_iEstimationSamples = settings.value(QString("MNESCAN/%1/estimationSamples").arg(this->getName()), 5000).toInt();
+    m_dForgettingFactor = settings.value(QString("MNESCAN/%1/forgettingFactor").arg(this->getName()), 1.0).toDouble();
 
     // Input
     m_pCovarianceInput = PluginInputData<RealTimeMultiSampleArray>::create(this, "CovarianceIn", "Covariance input data");
@@ -133,8 +135,11 @@ void Covariance::initPluginControlWidgets()
                 pCovarianceWidget, &CovarianceSettingsView::setGuiMode);
         connect(pCovarianceWidget, &CovarianceSettingsView::samplesChanged,
                 this, &Covariance::changeSamples);
+        connect(pCovarianceWidget, &CovarianceSettingsView::forgettingFactorChanged,
+                this, &Covariance::changeForgettingFactor);
         pCovarianceWidget->setMinSamples(m_pFiffInfo->sfreq);
         pCovarianceWidget->setCurrentSamples(m_iEstimationSamples);
+        pCovarianceWidget->setCurrentForgettingFactor(m_dForgettingFactor);
         pCovarianceWidget->setObjectName("group_Settings");
         plControlWidgets.append(pCovarianceWidget);
 
@@ -151,6 +156,7 @@ void Covariance::unload()
     // Save Settings
     QSettings settings("MNECPP");
     settings.setValue(QString("MNESCAN/%1/estimationSamples").arg(this->getName()), m_iEstimationSamples);
+    settings.setValue(QString("MNESCAN/%1/forgettingFactor").arg(this->getName()), m_dForgettingFactor);
 }
 
 //=============================================================================================================
@@ -205,6 +211,13 @@ QWidget* Covariance::setupWidget()
 
 //=============================================================================================================
 
+int Covariance::getInputQueueDepth() const
+{
+    return m_pCircularBuffer->getFreeElementsRead();
+}
+
+//=============================================================================================================
+
 void Covariance::update(SCMEASLIB::Measurement::SPtr pMeasurement)
 {
     if(QSharedPointer<RealTimeMultiSampleArray> pRTMSA = pMeasurement.dynamicCast<RealTimeMultiSampleArray>()) {
@@ -239,6 +252,15 @@ void Covariance::changeSamples(qint32 samples)
 
 //=============================================================================================================
 
+void Covariance::changeForgettingFactor(double dForgettingFactor)
+{
+    m_mutex.lock();
+    m_dForgettingFactor = dForgettingFactor;
+    m_mutex.unlock();
+}
+
+//=============================================================================================================
+
 void Covariance::run()
 {
     // Wait for fiff info
@@ -256,8 +278,10 @@ void Covariance::run()
     FiffCov fiffCov;
     m_mutex.lock();
     int iEstimationSamples = m_iEstimationSamples;
+    double dForgettingFactor = m_dForgettingFactor;
     m_mutex.unlock();
     RTPROCESSINGLIB::RtCov rtCov(m_pFiffInfo);
+    rtCov.setForgettingFactor(dForgettingFactor);
 
     // Start processing data
     while(!isInterruptionRequested()) {
@@ -265,6 +289,11 @@ void Covariance::run()
         if(m_pCircularBuffer->pop(matData)) {
             m_mutex.lock();
             iEstimationSamples = m_iEstimationSamples;
+            if(dForgettingFactor != m_dForgettingFactor) {
+                dForgettingFactor = m_dForgettingFactor;
+                rtCov.setForgettingFactor(dForgettingFactor);
+                rtCov.reset();
+            }
             m_mutex.unlock();
 
             fiffCov = rtCov.estimateCovariance(matData, iEstimationSamples);
@@ -141,6 +141,7 @@ public:
     virtual QString getName() const;
 
     virtual QWidget* setupWidget();
+    virtual int getInputQueueDepth() const;
 
     void update(SCMEASLIB::Measurement::SPtr pMeasurement);
 
@@ -148,12 +149,15 @@ public:
 
     void changeSamples(qint32 samples);
 
+    void changeForgettingFactor(double dForgettingFactor);
+
 protected:
     virtual void run();
 
 private:
     QMutex      m_mutex;
     qint32      m_iEstimationSamples;
+    double      m_dForgettingFactor;
 
     UTILSLIB::CircularBuffer_Matrix_double::SPtr        m_pCircularBuffer;              /**< Matrix data circular buffer. */
 
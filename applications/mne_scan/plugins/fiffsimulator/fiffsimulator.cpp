@@ -82,6 +82,7 @@ FiffSimulator::FiffSimulator()
 , m_iActiveConnectorId(0)
 , m_iBufferSize(-1)
 , m_pCircularBuffer(QSharedPointer<CircularBuffer_Matrix_float>(new CircularBuffer_Matrix_float(40)))
+, m_pCircularTimeStampBuffer(QSharedPointer<CircularBuffer<qint64> >::create(40))
 , m_pRtCmdClient(QSharedPointer<RtCmdClient>::create())
 , m_iDefaultPortCmdClient(4217)
 {
@@ -180,6 +181,7 @@ bool FiffSimulator::stop()
     // Clear all data in the buffer connected to displays and other plugins
     m_pRTMSA_FiffSimulator->measurementData()->clear();
     m_pCircularBuffer->clear();
+    m_pCircularTimeStampBuffer->clear();
 
     return true;
 }
@@ -212,13 +214,20 @@ QWidget* FiffSimulator::setupWidget()
 void FiffSimulator::run()
 {
     MatrixXf matValue;
+    qint64 iTimeStamp;
 
     while(!isInterruptionRequested()) {
         //pop matrix
         if(m_pCircularBuffer->pop(matValue)) {
+            // Forward the mne_rt_server time stamp so latencies are measured end-to-end
+            if(!m_pCircularTimeStampBuffer->pop(iTimeStamp)) {
+                iTimeStamp = -1;
+            }
+
             //emit values
             if(!isInterruptionRequested()) {
-                m_pRTMSA_FiffSimulator->measurementData()->setValue(matValue.cast<double>());
+                m_pRTMSA_FiffSimulator->measurementData()->setValue(matValue.cast<double>(),
+                                                                    iTimeStamp);
             }
         }
     }
@@ -194,6 +194,7 @@ protected:
     QSharedPointer<FIFFLIB::FiffInfo>                           m_pFiffInfo;                /**< Fiff measurement info.*/
     QSharedPointer<COMMUNICATIONLIB::RtCmdClient>               m_pRtCmdClient;             /**< The command client.*/
     QSharedPointer<UTILSLIB::CircularBuffer_Matrix_float>       m_pCircularBuffer;          /**< Holds incoming raw data. */
+    QSharedPointer<UTILSLIB::CircularBuffer<qint64> >           m_pCircularTimeStampBuffer; /**< Holds the mne_rt_server time stamps of the incoming raw data, in the same order. */
 
     bool                    m_bCmdClientIsConnected;        /**< If the command client is connected.*/
     QString                 m_sFiffSimulatorIP;             /**< The IP Adress of mne_rt_server.*/
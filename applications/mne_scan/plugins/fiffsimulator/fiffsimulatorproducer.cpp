@@ -45,6 +45,10 @@
 //=============================================================================================================
 
 #include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QDebug>
+
+#include <chrono>
 
 //=============================================================================================================
 // EIGEN INCLUDES
@@ -162,6 +166,14 @@ void FiffSimulatorProducer::run()
     qint32 from = 0;
     qint32 to = -1;
 
+    // Transport latency of the time stamped buffers, summarised every LATENCY_REPORT_MSECS
+    qint64 iLastTimeStamp = -1;
+    qint64 iNumStampedBuffers = 0;
+    double dSumLatencyMSecs = 0.0;
+    double dMaxLatencyMSecs = 0.0;
+    QElapsedTimer reportTimer;
+    reportTimer.start();
+
     while(!isInterruptionRequested()) {
         m_producerMutex.lock();
         if(m_bFlagInfoRequest) {
@@ -182,9 +194,32 @@ void FiffSimulatorProducer::run()
             if(kind == FIFF_DATA_BUFFER) {
                 to += matData.cols();
                 from += matData.cols();
+
+                // Buffers which were not stamped by mne_rt_server are stamped on emission
+                qint64 iTimeStamp = -1;
+
+                if(m_pRtDataClient->lastTimeStamp() != iLastTimeStamp) {
+                    iLastTimeStamp = m_pRtDataClient->lastTimeStamp();
+                    iTimeStamp = iLastTimeStamp;
+                    qint64 iNowUSecs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+                    double dLatencyMSecs = (iNowUSecs - iLastTimeStamp) / 1000.0;
+                    dSumLatencyMSecs += dLatencyMSecs;
+                    dMaxLatencyMSecs = qMax(dMaxLatencyMSecs, dLatencyMSecs);
+                    ++iNumStampedBuffers;
+                }
+
+                if(iNumStampedBuffers > 0 && reportTimer.elapsed() >= LATENCY_REPORT_MSECS) {
+                    qDebug() << "[FiffSimulatorProducer::run] Transport latency of" << iNumStampedBuffers << "buffers: mean" << dSumLatencyMSecs / iNumStampedBuffers << "ms, max" << dMaxLatencyMSecs << "ms";
+                    iNumStampedBuffers = 0;
+                    dSumLatencyMSecs = 0.0;
+                    dMaxLatencyMSecs = 0.0;
+                    reportTimer.restart();
+                }
+
                 while(!m_pFiffSimulator->m_pCircularBuffer->push(matData) && !isInterruptionRequested()) {
                     //Do nothing until the circular buffer is ready to accept new data again
                 }
+                m_pFiffSimulator->m_pCircularTimeStampBuffer->push(iTimeStamp);
             } else if(FIFF_DATA_BUFFER == FIFF_BLOCK_END) {
                 break;
             }
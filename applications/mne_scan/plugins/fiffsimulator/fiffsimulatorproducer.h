@@ -53,6 +53,8 @@
 // FORWARD DECLARATIONS
 //=============================================================================================================
 
+#define LATENCY_REPORT_MSECS    10000   /**< Interval of the transport latency summary of time stamped buffers. */
+
 //=============================================================================================================
 // DEFINE NAMESPACE FIFFSIMULATORPLUGIN
 //=============================================================================================================
@@ -47,7 +47,7 @@
 #include <disp/viewers/compensatorview.h>
 #include <disp/viewers/spharasettingsview.h>
 
-#include <rtprocessing/filter.h>
+#include <rtprocessing/filterpartitioned.h>
 #include <rtprocessing/sphara.h>
 
 #include <utils/ioutils.h>
@@ -89,8 +89,10 @@ NoiseReduction::NoiseReduction()
 , m_bFilterActivated(false)
 , m_iMaxFilterLength(1)
 , m_iMaxFilterTapSize(-1)
+, m_iFilterPartitionSize(0)
 , m_sCurrentSystem("VectorView")
-, m_pCircularBuffer(QSharedPointer<UTILSLIB::CircularBuffer_Matrix_double>::create(40))
+, m_pCircularBuffer(QSharedPointer<UTILSLIB::RingBuffer_Matrix_double>::create(40))
+, m_pCircularTimeStampBuffer(QSharedPointer<UTILSLIB::RingBuffer<qint64> >::create(40))
 , m_pNoiseReductionInput(Q_NULLPTR)
 , m_pNoiseReductionOutput(Q_NULLPTR)
 {
@@ -193,6 +195,13 @@ QWidget* NoiseReduction::setupWidget()
 
 //=============================================================================================================
 
+int NoiseReduction::getInputQueueDepth() const
+{
+    return m_pCircularBuffer->getFreeElementsRead();
+}
+
+//=============================================================================================================
+
 void NoiseReduction::update(SCMEASLIB::Measurement::SPtr pMeasurement)
 {
     if(QSharedPointer<RealTimeMultiSampleArray> pRTMSA = pMeasurement.dynamicCast<RealTimeMultiSampleArray>()) {
@@ -227,6 +236,8 @@ void NoiseReduction::update(SCMEASLIB::Measurement::SPtr pMeasurement)
                 QThread::start();
             }
 
+            qint64 iTimeStamp = pRTMSA->getTimeStamp();
+
             for(unsigned char i = 0; i < pRTMSA->getMultiSampleArray().size(); ++i) {
                 // Please note that we do not need a copy here since this function will block until
                 // the buffer accepts new data again. Hence, the data is not deleted in the actual
@@ -234,6 +245,7 @@ void NoiseReduction::update(SCMEASLIB::Measurement::SPtr pMeasurement)
                 while(!m_pCircularBuffer->push(pRTMSA->getMultiSampleArray()[i])) {
                     //Do nothing until the circular buffer is ready to accept new data again
                 }
+                m_pCircularTimeStampBuffer->push(iTimeStamp);
             }
         }
     }
@@ -286,10 +298,15 @@ void NoiseReduction::initPluginControlWidgets()
         connect(pFilterSettingsView, &FilterSettingsView::filterActivationChanged,
                 this, &NoiseReduction::setFilterActive);
 
+        connect(pFilterSettingsView, &FilterSettingsView::filterPartitionSizeChanged,
+                this, &NoiseReduction::setFilterPartitionSize);
+
+        pFilterSettingsView->setPartitionSizeVisible(true);
         pFilterSettingsView->setSamplingRate(m_pFiffInfo->sfreq);
         pFilterSettingsView->getFilterView()->setMaxAllowedFilterTaps(m_iMaxFilterTapSize);
 
         this->setFilterActive(pFilterSettingsView->getFilterActive());
+        this->setFilterPartitionSize(pFilterSettingsView->getFilterPartitionSize());
         this->setFilterChannelType(pFilterSettingsView->getFilterView()->getChannelType());
 
         // SPHARA settings
@@ -343,11 +360,20 @@ void NoiseReduction::run()
 
     // Init
     MatrixXd matData;
-    QScopedPointer<RTPROCESSINGLIB::FilterOverlapAdd> pRtFilter(new RTPROCESSINGLIB::FilterOverlapAdd());
+    qint64 iTimeStamp;
+    int iFilterPartitionSize = 0;
+    QScopedPointer<RTPROCESSINGLIB::FilterPartitioned> pRtFilter(new RTPROCESSINGLIB::FilterPartitioned(iFilterPartitionSize));
 
     while(!isInterruptionRequested()) {
         // Get the current data
         if(m_pCircularBuffer->pop(matData)) {
+            long long iBeginTime = UTILSLIB::MNETracer::getTimeNow();
+
+            // Forward the time stamp of the input block so latencies are measured end-to-end
+            if(!m_pCircularTimeStampBuffer->pop(iTimeStamp)) {
+                iTimeStamp = -1;
+            }
+
             m_mutex.lock();
             //Do SSP's and compensators here
             if(m_bCompActivated) {
@@ -367,8 +393,13 @@ void NoiseReduction::run()
                 }
             }
 
-            //Do temporal filtering here
+            //Do temporal filtering here. The output is causal and delayed by half the filter length plus less than one partition.
             if(m_bFilterActivated) {
+                if(iFilterPartitionSize != m_iFilterPartitionSize) {
+                    iFilterPartitionSize = m_iFilterPartitionSize;
+                    pRtFilter->setPartitionSize(iFilterPartitionSize);
+                }
+
                 matData = pRtFilter->calculate(matData,
                                                m_filterKernel,
                                                m_lFilterChannelList);
@@ -410,8 +441,11 @@ void NoiseReduction::run()
 
             //Send the data to the connected plugins and the display
             if(!isInterruptionRequested()) {
-                m_pNoiseReductionOutput->measurementData()->setValue(matData);
+                m_pNoiseReductionOutput->measurementData()->setValue(matData,
+                                                                     iTimeStamp);
             }
+
+            traceCompleteEvent(iBeginTime);
         }
     }
 }
@@ -578,6 +612,15 @@ void NoiseReduction::setFilterActive(bool state)
 
 //=============================================================================================================
 
+void NoiseReduction::setFilterPartitionSize(int iPartitionSize)
+{
+    m_mutex.lock();
+    m_iFilterPartitionSize = iPartitionSize;
+    m_mutex.unlock();
+}
+
+//=============================================================================================================
+
 void NoiseReduction::initSphara()
 {
     //Load SPHARA matrix
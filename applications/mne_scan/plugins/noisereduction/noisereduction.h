@@ -42,7 +42,7 @@
 
 #include "noisereduction_global.h"
 
-#include <utils/generics/circularbuffer.h>
+#include <utils/generics/ringbuffer.h>
 
 #include <fiff/fiff_proj.h>
 
@@ -125,6 +125,7 @@ public:
     virtual AbstractPlugin::PluginType getType() const;
     virtual QString getName() const;
     virtual QWidget* setupWidget();
+    virtual int getInputQueueDepth() const;
 
     //=========================================================================================================
     /**
@@ -205,6 +206,14 @@ protected:
      */
     void setFilterActive(bool state);
 
+    //=========================================================================================================
+    /**
+     * Sets the partition size of the real-time filter
+     *
+     * @param[in] iPartitionSize    the partition size in samples, 0 derives it from the incoming blocks.
+     */
+    void setFilterPartitionSize(int iPartitionSize);
+
     //=========================================================================================================
     /**
      * Init the SPHARA method.
@@ -229,6 +238,7 @@ private:
     int                             m_iNBaseFctsSecond;                         /**< The number of grad/outer base functions to use for calculating the sphara opreator.*/
     int                             m_iMaxFilterLength;                         /**< Max order of the current filters. */
     int                             m_iMaxFilterTapSize;                        /**< maximum number of allowed filter taps. This number depends on the size of the receiving blocks. */
+    int                             m_iFilterPartitionSize;                     /**< Partition size of the real-time filter, 0 for automatic. */
 
     QString                         m_sCurrentSystem;                           /**< The current acquisition system (EEG, babyMEG, VectorView).*/
     QString                         m_sFilterChannelType;                       /**< Kind of channel which is to be filtered. */
@@ -257,7 +267,8 @@ private:
 
     QSharedPointer<FIFFLIB::FiffInfo>                               m_pFiffInfo;            /**< Fiff measurement info.*/
 
-    QSharedPointer<UTILSLIB::CircularBuffer_Matrix_double>          m_pCircularBuffer;      /**< Holds incoming raw data. */
+    QSharedPointer<UTILSLIB::RingBuffer_Matrix_double>              m_pCircularBuffer;      /**< Holds incoming raw data. */
+    QSharedPointer<UTILSLIB::RingBuffer<qint64> >                   m_pCircularTimeStampBuffer; /**< Holds the time stamps of the incoming raw data, in the same order. */
 
     SCSHAREDLIB::PluginInputData<SCMEASLIB::RealTimeMultiSampleArray>::SPtr      m_pNoiseReductionInput;      /**< The RealTimeMultiSampleArray of the NoiseReduction input.*/
     SCSHAREDLIB::PluginOutputData<SCMEASLIB::RealTimeMultiSampleArray>::SPtr     m_pNoiseReductionOutput;     /**< The RealTimeMultiSampleArray of the NoiseReduction output.*/
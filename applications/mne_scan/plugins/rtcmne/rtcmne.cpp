@@ -71,6 +71,7 @@
 #include <QtCore/QtPlugin>
 #include <QtConcurrent>
 #include <QDebug>
+#include <QHash>
 
 //=============================================================================================================
 // USED NAMESPACES
@@ -93,8 +94,10 @@ using namespace Eigen;
 //=============================================================================================================
 
 RtcMne::RtcMne()
-: m_pCircularMatrixBuffer(CircularBuffer_Matrix_double::SPtr(new CircularBuffer_Matrix_double(40)))
+: m_pCircularMatrixBuffer(RingBuffer_Matrix_double::SPtr::create(40))
 , m_pCircularEvokedBuffer(CircularBuffer<FIFFLIB::FiffEvoked>::SPtr::create(40))
+, m_pCircularMatrixTimeStampBuffer(QSharedPointer<RingBuffer<qint64> >::create(40))
+, m_pCircularEvokedTimeStampBuffer(QSharedPointer<RingBuffer<qint64> >::create(40))
 , m_bEvokedInput(false)
 , m_bRawInput(false)
 , m_iNumAverages(1)
@@ -357,6 +360,13 @@ QWidget* RtcMne::setupWidget()
 
 //=============================================================================================================
 
+int RtcMne::getInputQueueDepth() const
+{
+    return m_pCircularMatrixBuffer->getFreeElementsRead() + m_pCircularEvokedBuffer->getFreeElementsRead();
+}
+
+//=============================================================================================================
+
 void RtcMne::updateRTFS(SCMEASLIB::Measurement::SPtr pMeasurement)
 {
     if(QSharedPointer<RealTimeFwdSolution> pRTFS = pMeasurement.dynamicCast<RealTimeFwdSolution>()) {
@@ -417,6 +427,7 @@ void RtcMne::updateRTMSA(SCMEASLIB::Measurement::SPtr pMeasurement)
                         while(!m_pCircularMatrixBuffer->push(pRTMSA->getMultiSampleArray()[i])) {
                             //Do nothing until the circular buffer is ready to accept new data again
                         }
+                        m_pCircularMatrixTimeStampBuffer->push(pRTMSA->getTimeStamp());
                     } else {
                         qDebug() << "RtcMne::updateRTMSA - Reject data block";
                     }
@@ -503,6 +514,7 @@ void RtcMne::updateRTE(SCMEASLIB::Measurement::SPtr pMeasurement)
                         while(!m_pCircularEvokedBuffer->push(pFiffEvokedSet->evoked.at(i).pick_channels(m_qListPickChannels))) {
                             //Do nothing until the circular buffer is ready to accept new data again
                         }
+                        m_pCircularEvokedTimeStampBuffer->push(pRTES->getTimeStamp());
 
                             //qDebug()<<"RtcMne::updateRTE - average found type" << m_sAvrType;
                             break;
@@ -555,6 +567,8 @@ void RtcMne::onTimePointValueChanged(int iTimePointMs)
             while(!m_pCircularEvokedBuffer->push(m_currentEvoked)) {
                 //Do nothing until the circular buffer is ready to accept new data again
             }
+            // The re-dispatched evoked is stamped on emission, since it was triggered by the user and not by new data
+            m_pCircularEvokedTimeStampBuffer->push(-1);
         }
     }
 }
@@ -575,17 +589,20 @@ void RtcMne::run()
     MatrixXd matDataResized;
     qint32 j;
     int iTimePointSps = 0;
-    int iNumberChannels = 0;
     int iDownSample = 1;
     float tstep;
     float lambda2 = 1.0f / pow(1.0f, 2); //ToDo estimate lambda using covariance
     MNESourceEstimate sourceEstimate;
+    qint64 iTimeStamp;
     bool bEvokedInput = false;
     bool bRawInput = false;
     bool bUpdateMinimumNorm = false;
     QSharedPointer<INVERSELIB::MinimumNorm> pMinimumNorm;
     QStringList lChNamesFiffInfo;
     QStringList lChNamesInvOp;
+    QStringList lChNamesEvoked;
+    VectorXi vecPicksRaw;
+    VectorXi vecPicksEvoked;
 
     // Start processing data
     while(!isInterruptionRequested()) {
@@ -594,7 +611,6 @@ void RtcMne::run()
         bEvokedInput = m_bEvokedInput;
         bRawInput = m_bRawInput;
         iDownSample = m_iDownSample;
-        iNumberChannels = m_invOp.noise_cov->names.size();
         tstep = 1.0f / m_pFiffInfoInput->sfreq;
         lChNamesFiffInfo = m_pFiffInfoInput->ch_names;
         lChNamesInvOp = m_invOp.noise_cov->names;
@@ -610,6 +626,10 @@ void RtcMne::run()
             // Set up the inverse according to the parameters.
             // Use 1 nave here because in case of evoked data as input the minimum norm will always be updated when the source estimate is calculated (see run method).
             pMinimumNorm->doInverseSetup(1,true);
+
+            // The channels of the inverse operator might have changed, rebuild the pick maps
+            createPickMap(lChNamesFiffInfo, lChNamesInvOp, vecPicksRaw);
+            lChNamesEvoked.clear();
         }
 
         //Process data from raw data input
@@ -617,50 +637,113 @@ void RtcMne::run()
             if(((skip_count % iDownSample) == 0)) {
                 // Get the current raw data
                 if(m_pCircularMatrixBuffer->pop(matData)) {
-                    //Pick the same channels as in the inverse operator
-                    matDataResized.resize(iNumberChannels, matData.cols());
+                    long long iBeginTime = UTILSLIB::MNETracer::getTimeNow();
 
-                    for(j = 0; j < iNumberChannels; ++j) {
-                        matDataResized.row(j) = matData.row(lChNamesFiffInfo.indexOf(lChNamesInvOp.at(j)));
+                    // Forward the time stamp of the input block so latencies are measured end-to-end
+                    if(!m_pCircularMatrixTimeStampBuffer->pop(iTimeStamp)) {
+                        iTimeStamp = -1;
                     }
 
-                    //TODO: Add picking here. See evoked part as input.
-                    sourceEstimate = pMinimumNorm->calculateInverse(matDataResized,
-                                                                    0.0f,
-                                                                    tstep,
-                                                                    true);
+                    if(vecPicksRaw.size() > 0) {
+                        //Pick the same channels as in the inverse operator. Only the selected time point is evaluated
+                        //if it lies within the block.
+                        if(iTimePointSps < matData.cols() && iTimePointSps >= 0) {
+                            matDataResized.resize(vecPicksRaw.size(), 1);
 
-                    if(!sourceEstimate.isEmpty()) {
-                        if(iTimePointSps < sourceEstimate.data.cols() && iTimePointSps >= 0) {
-                            sourceEstimate = sourceEstimate.reduce(iTimePointSps,1);
-                            m_pRTSEOutput->measurementData()->setValue(sourceEstimate);
+                            for(j = 0; j < vecPicksRaw.size(); ++j) {
+                                matDataResized(j,0) = matData(vecPicksRaw[j], iTimePointSps);
+                            }
+
+                            sourceEstimate = pMinimumNorm->calculateInverse(matDataResized,
+                                                                            iTimePointSps * tstep,
+                                                                            tstep,
+                                                                            true);
                         } else {
-                            m_pRTSEOutput->measurementData()->setValue(sourceEstimate);
+                            matDataResized.resize(vecPicksRaw.size(), matData.cols());
+
+                            for(j = 0; j < vecPicksRaw.size(); ++j) {
+                                matDataResized.row(j) = matData.row(vecPicksRaw[j]);
+                            }
+
+                            sourceEstimate = pMinimumNorm->calculateInverse(matDataResized,
+                                                                            0.0f,
+                                                                            tstep,
+                                                                            true);
+                        }
+
+                        if(!sourceEstimate.isEmpty()) {
+                            m_pRTSEOutput->measurementData()->setValue(sourceEstimate,
+                                                                       iTimeStamp);
                         }
                     }
+
+                    traceCompleteEvent(iBeginTime);
                 }
             } else {
-                m_pCircularMatrixBuffer->pop(matData);
+                if(m_pCircularMatrixBuffer->pop(matData)) {
+                    m_pCircularMatrixTimeStampBuffer->pop(iTimeStamp);
+                }
             }
         }
 
         //Process data from averaging input
         if(bEvokedInput && pMinimumNorm) {
             if(m_pCircularEvokedBuffer->pop(evoked)) {
+                long long iBeginTime = UTILSLIB::MNETracer::getTimeNow();
+
+                // Forward the time stamp of the evoked so latencies are measured end-to-end
+                if(!m_pCircularEvokedTimeStampBuffer->pop(iTimeStamp)) {
+                    iTimeStamp = -1;
+                }
+
                 // Get the current evoked data
                 if(((skip_count % iDownSample) == 0)) {
-                    sourceEstimate = pMinimumNorm->calculateInverse(evoked);
+                    if(evoked.info.ch_names != lChNamesEvoked) {
+                        lChNamesEvoked = evoked.info.ch_names;
+                        createPickMap(lChNamesEvoked, lChNamesInvOp, vecPicksEvoked);
+                    }
+
+                    if(vecPicksEvoked.size() > 0) {
+                        // Only the noise normalization is updated for the number of averages of this evoked
+                        pMinimumNorm->doInverseSetup(evoked.nave, false);
+
+                        float tstepEvoked = 1.0f / evoked.info.sfreq;
+
+                        if(iTimePointSps < evoked.data.cols() && iTimePointSps >= 0) {
+                            matDataResized.resize(vecPicksEvoked.size(), 1);
+
+                            for(j = 0; j < vecPicksEvoked.size(); ++j) {
+                                matDataResized(j,0) = evoked.data(vecPicksEvoked[j], iTimePointSps);
+                            }
 
-                    if(!sourceEstimate.isEmpty()) {
-                        if(iTimePointSps < sourceEstimate.data.cols() && iTimePointSps >= 0) {
-                            sourceEstimate = sourceEstimate.reduce(iTimePointSps,1);
-                            m_pRTSEOutput->measurementData()->setValue(sourceEstimate);
+                            sourceEstimate = pMinimumNorm->calculateInverse(matDataResized,
+                                                                            evoked.times[iTimePointSps],
+                                                                            tstepEvoked,
+                                                                            false);
                         } else {
-                            m_pRTSEOutput->measurementData()->setValue(sourceEstimate);
+                            matDataResized.resize(vecPicksEvoked.size(), evoked.data.cols());
+
+                            for(j = 0; j < vecPicksEvoked.size(); ++j) {
+                                matDataResized.row(j) = evoked.data.row(vecPicksEvoked[j]);
+                            }
+
+                            sourceEstimate = pMinimumNorm->calculateInverse(matDataResized,
+                                                                            evoked.times[0],
+                                                                            tstepEvoked,
+                                                                            false);
+                        }
+
+                        if(!sourceEstimate.isEmpty()) {
+                            m_pRTSEOutput->measurementData()->setValue(sourceEstimate,
+                                                                       iTimeStamp);
                         }
+
+                        traceCompleteEvent(iBeginTime);
                     }
                 } else {
-                    m_pCircularEvokedBuffer->pop(evoked);
+                    if(m_pCircularEvokedBuffer->pop(evoked)) {
+                        m_pCircularEvokedTimeStampBuffer->pop(iTimeStamp);
+                    }
                 }
             }
         }
@@ -668,3 +751,33 @@ void RtcMne::run()
         ++skip_count;
     }
 }
+
+//=============================================================================================================
+
+bool RtcMne::createPickMap(const QStringList& lChNamesData,
+                           const QStringList& lChNamesInvOp,
+                           VectorXi& vecPicks)
+{
+    QHash<QString, int> hashChNamesData;
+    hashChNamesData.reserve(lChNamesData.size());
+
+    for(int i = 0; i < lChNamesData.size(); ++i) {
+        hashChNamesData.insert(lChNamesData.at(i), i);
+    }
+
+    vecPicks.resize(lChNamesInvOp.size());
+
+    for(int i = 0; i < lChNamesInvOp.size(); ++i) {
+        QHash<QString, int>::const_iterator it = hashChNamesData.constFind(lChNamesInvOp.at(i));
+
+        if(it == hashChNamesData.constEnd()) {
+            qWarning() << "[RtcMne::createPickMap] Channel" << lChNamesInvOp.at(i) << "of the inverse operator not found in the data.";
+            vecPicks.resize(0);
+            return false;
+        }
+
+        vecPicks[i] = it.value();
+    }
+
+    return true;
+}
@@ -45,6 +45,7 @@
 #include <scShared/Plugins/abstractalgorithm.h>
 
 #include <utils/generics/circularbuffer.h>
+#include <utils/generics/ringbuffer.h>
 
 #include <fiff/fiff_evoked.h>
 
@@ -155,6 +156,7 @@ public:
     virtual SCSHAREDLIB::AbstractPlugin::PluginType getType() const;
     virtual QString getName() const;
     virtual QWidget* setupWidget();
+    virtual int getInputQueueDepth() const;
 
     //=========================================================================================================
     /**
@@ -223,13 +225,29 @@ protected:
 
     virtual void run();
 
+    //=========================================================================================================
+    /**
+     * Builds the map from the channels of the inverse operator to the rows of the data.
+     *
+     * @param[in] lChNamesData       The channel names of the data.
+     * @param[in] lChNamesInvOp      The channel names of the inverse operator.
+     * @param[out] vecPicks          The data row for each channel of the inverse operator. Empty on failure.
+     *
+     * @return Whether all channels of the inverse operator were found in the data.
+     */
+    static bool createPickMap(const QStringList& lChNamesData,
+                              const QStringList& lChNamesInvOp,
+                              Eigen::VectorXi& vecPicks);
+
     QSharedPointer<SCSHAREDLIB::PluginInputData<SCMEASLIB::RealTimeFwdSolution> >           m_pRTFSInput;               /**< The RealTimeFwdSolution input.*/
     QSharedPointer<SCSHAREDLIB::PluginInputData<SCMEASLIB::RealTimeMultiSampleArray> >      m_pRTMSAInput;              /**< The RealTimeMultiSampleArray input.*/
     QSharedPointer<SCSHAREDLIB::PluginInputData<SCMEASLIB::RealTimeEvokedSet> >             m_pRTESInput;               /**< The RealTimeEvoked input.*/
     QSharedPointer<SCSHAREDLIB::PluginInputData<SCMEASLIB::RealTimeCov> >                   m_pRTCInput;                /**< The RealTimeCov input.*/
     QSharedPointer<SCSHAREDLIB::PluginOutputData<SCMEASLIB::RealTimeSourceEstimate> >       m_pRTSEOutput;              /**< The RealTimeSourceEstimate output.*/
-    QSharedPointer<UTILSLIB::CircularBuffer_Matrix_double >                                 m_pCircularMatrixBuffer;    /**< Holds incoming RealTimeMultiSampleArray data.*/
+    QSharedPointer<UTILSLIB::RingBuffer_Matrix_double >                                     m_pCircularMatrixBuffer;    /**< Holds incoming RealTimeMultiSampleArray data.*/
     QSharedPointer<UTILSLIB::CircularBuffer<FIFFLIB::FiffEvoked> >                          m_pCircularEvokedBuffer;    /**< Holds incoming RealTimeMultiSampleArray data.*/
+    QSharedPointer<UTILSLIB::RingBuffer<qint64> >                                           m_pCircularMatrixTimeStampBuffer;   /**< Holds the time stamps of the incoming raw data, in the same order. */
+    QSharedPointer<UTILSLIB::RingBuffer<qint64> >                                           m_pCircularEvokedTimeStampBuffer;   /**< Holds the time stamps of the incoming evoked data, in the same order. */
     QSharedPointer<RTPROCESSINGLIB::RtInvOp>                                                m_pRtInvOp;                 /**< Real-time inverse operator. */
     QSharedPointer<MNELIB::MNEForwardSolution>                                              m_pFwd;                     /**< Forward solution. */
     QSharedPointer<FIFFLIB::FiffCov>                                                        m_pNoiseCov;                     /**< Noise Covariance Matrix. */
@@ -38,6 +38,8 @@
 
 #include "writetofilesetupwidget.h"
 
+#include <fiff/fiff_file.h>
+
 //=============================================================================================================
 // QT INCLUDES
 //=============================================================================================================
@@ -65,6 +67,15 @@ WriteToFileSetupWidget::WriteToFileSetupWidget(WriteToFile* toolbox, QWidget *pa
     connect(ui.checkBox, &QCheckBox::stateChanged,
             m_pWriteToFile, &WriteToFile::setContinuous);
     m_pWriteToFile->setContinuous(ui.checkBox->checkState());
+
+    ui.m_qComboBox_RawDataType->addItem("Float (32 bit)", FIFFT_FLOAT);
+    ui.m_qComboBox_RawDataType->addItem("Short (16 bit ADC)", FIFFT_SHORT);
+    ui.m_qComboBox_RawDataType->addItem("Int (24/32 bit ADC)", FIFFT_INT);
+    ui.m_qComboBox_RawDataType->setCurrentIndex(ui.m_qComboBox_RawDataType->findData(m_pWriteToFile->getRawDataType()));
+
+    connect(ui.m_qComboBox_RawDataType, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), [this](int index) {
+        m_pWriteToFile->setRawDataType(ui.m_qComboBox_RawDataType->itemData(index).toInt());
+    });
 }
 
 //=============================================================================================================
@@ -75,7 +75,8 @@ WriteToFile::WriteToFile()
 , m_iBlinkStatus(0)
 , m_iSplitCount(0)
 , m_iRecordingMSeconds(5*60*1000)
-, m_pCircularBuffer(CircularBuffer_Matrix_double::SPtr(new CircularBuffer_Matrix_double(40)))
+, m_iRawDataType(FIFFT_FLOAT)
+, m_pCircularBuffer(RingBuffer_Matrix_double::SPtr::create(40))
 {
     m_pActionRecordFile = new QAction(QIcon(":/images/record.png"), tr("Start Recording"),this);
     m_pActionRecordFile->setStatusTip(tr("Start Recording"));
@@ -125,6 +126,10 @@ QSharedPointer<AbstractPlugin> WriteToFile::clone() const
 
 void WriteToFile::init()
 {
+    // Load Settings
+    QSettings settings("MNECPP");
+    setRawDataType(settings.value(QString("MNESCAN/%1/rawDataType").arg(this->getName()), FIFFT_FLOAT).toInt());
+
     // Input
     m_pWriteToFileInput = PluginInputData<RealTimeMultiSampleArray>::create(this, "WriteToFileIn", "WriteToFile input data");
     connect(m_pWriteToFileInput.data(), &PluginInputConnector::notify,
@@ -136,6 +141,9 @@ void WriteToFile::init()
 
 void WriteToFile::unload()
 {
+    // Save Settings
+    QSettings settings("MNECPP");
+    settings.setValue(QString("MNESCAN/%1/rawDataType").arg(this->getName()), m_iRawDataType);
 }
 
 //=============================================================================================================
@@ -183,6 +191,13 @@ QWidget* WriteToFile::setupWidget()
 
 //=============================================================================================================
 
+int WriteToFile::getInputQueueDepth() const
+{
+    return m_pCircularBuffer->getFreeElementsRead();
+}
+
+//=============================================================================================================
+
 void WriteToFile::update(SCMEASLIB::Measurement::SPtr pMeasurement)
 {
     if(QSharedPointer<RealTimeMultiSampleArray> pRTMSA = pMeasurement.dynamicCast<RealTimeMultiSampleArray>()) {
@@ -291,10 +306,12 @@ void WriteToFile::run()
             //pop matrix
 
             if(m_pCircularBuffer->pop(matData)) {
+                long long iBeginTime = UTILSLIB::MNETracer::getTimeNow();
+
                 //Write raw data to fif file
                 m_mutex.lock();
                 if(m_bWriteToFile) {
-                    size += matData.rows()*matData.cols() * 4;
+                    size += matData.rows()*matData.cols() * (m_pOutfid && m_pOutfid->raw_data_type() == FIFFT_SHORT ? 2 : 4);
 
                     if(size > MAX_DATA_LEN) {
                         size = 0;
@@ -308,6 +325,8 @@ void WriteToFile::run()
                     size = 0;
                 }
                 m_mutex.unlock();
+
+                traceCompleteEvent(iBeginTime);
             }
         }
     }
@@ -406,9 +425,13 @@ void WriteToFile::toggleRecordingFile()
 
         //Start/Prepare writing process. Actual writing is done in run() method.
         m_mutex.lock();
+        MatrixXi sel;
         m_pOutfid = FiffStream::start_writing_raw(m_qFileOut,
                                                   *m_pFiffInfo,
-                                                  m_mCals);
+                                                  m_mCals,
+                                                  sel,
+                                                  true,
+                                                  m_iRawDataType);
 
         fiff_int_t first = 0;
         m_pOutfid->write_int(FIFF_FIRST_SAMPLE, &first);
@@ -457,7 +480,8 @@ void WriteToFile::splitRecordingFile()
                                               *m_pFiffInfo,
                                               m_mCals,
                                               sel,
-                                              false);
+                                              false,
+                                              m_pOutfid->raw_data_type());
 
     fiff_int_t first = 0;
     m_pOutfid->write_int(FIFF_FIRST_SAMPLE, &first);
@@ -507,6 +531,26 @@ bool WriteToFile::isContinuous()
 }
 
 //=============================================================================================================
+
+void WriteToFile::setRawDataType(int iDataType)
+{
+    if(iDataType != FIFFT_FLOAT && iDataType != FIFFT_SHORT && iDataType != FIFFT_INT) {
+        qWarning() << "[WriteToFile::setRawDataType] Unsupported raw data type" << iDataType << ". Using floats.";
+        iDataType = FIFFT_FLOAT;
+    }
+
+    m_iRawDataType = iDataType;
+}
+
+//=============================================================================================================
+
+int WriteToFile::getRawDataType() const
+{
+    return m_iRawDataType;
+}
+
+//=============================================================================================================
+
 // This needs to be connected to Hpi fitting plugin
 //void WriteToFile::doContinousHPI(MatrixXf& matData)
 //{
@@ -41,7 +41,7 @@
 
 #include "writetofile_global.h"
 
-#include <utils/generics/circularbuffer.h>
+#include <utils/generics/ringbuffer.h>
 #include <scShared/Plugins/abstractalgorithm.h>
 #include <fiff/fifffilesharer.h>
 
@@ -124,6 +124,7 @@ public:
     virtual AbstractPlugin::PluginType getType() const;
     virtual QString getName() const;
     virtual QWidget* setupWidget();
+    virtual int getInputQueueDepth() const;
 
     //=========================================================================================================
     /**
@@ -155,6 +156,22 @@ public:
      */
     bool isContinuous();
 
+    //=========================================================================================================
+    /**
+     * Sets the data type used to store the raw buffers. Takes effect with the next recording.
+     *
+     * @param[in] iDataType     FIFFT_FLOAT, FIFFT_SHORT (16 bit ADC data) or FIFFT_INT (24/32 bit ADC data).
+     */
+    void setRawDataType(int iDataType);
+
+    //=========================================================================================================
+    /**
+     * Returns the data type used to store the raw buffers.
+     *
+     * @return FIFFT_FLOAT, FIFFT_SHORT or FIFFT_INT.
+     */
+    int getRawDataType() const;
+
 private:
     //=========================================================================================================
     /**
@@ -219,6 +236,7 @@ private:
     qint16                                  m_iBlinkStatus;                 /**< The blink status of the recording button.*/
     qint32                                  m_iSplitCount;                  /**< File split count. */
     int                                     m_iRecordingMSeconds;           /**< Recording length in mseconds.*/
+    int                                     m_iRawDataType;                 /**< Storage type of the raw buffers (FIFFT_FLOAT, FIFFT_SHORT or FIFFT_INT).*/
 
     QMutex                                  m_mutex;                        /**< The threads mutex.*/
 
@@ -236,7 +254,7 @@ private:
     QPointer<QAction>                       m_pActionRecordFile;            /**< start recording action. */
     QPointer<QAction>                       m_pActionClipRecording;
 
-    QSharedPointer<UTILSLIB::CircularBuffer_Matrix_double>                      m_pCircularBuffer;      /**< Holds incoming raw data. */
+    QSharedPointer<UTILSLIB::RingBuffer_Matrix_double>                          m_pCircularBuffer;      /**< Holds incoming raw data. */
 
     SCSHAREDLIB::PluginInputData<SCMEASLIB::RealTimeMultiSampleArray>::SPtr      m_pWriteToFileInput;   /**< The RealTimeMultiSampleArray of the WriteToFile input.*/
 
@@ -280,8 +280,19 @@ public:
                 m_pEpochSignalCoursePlot->show();
             }
 
-            if(iRowNumber < m_settings.at(iTrialNumber).vecTapSpectra.size()) {
-                Eigen::RowVectorXd plotVec = m_settings.at(iTrialNumber).vecTapSpectra.at(iRowNumber).cwiseAbs().row(0);
+            // Coherency based metrics store one row per signal with one block of iNFreqs columns per taper in matTapSpectra,
+            // the cross correlation still stores one taper x frequency matrix per signal in vecTapSpectra.
+            Eigen::RowVectorXd plotVec;
+            const Eigen::MatrixXcd& matTapSpectra = m_settings.at(iTrialNumber).matTapSpectra;
+            int iNFreqs = m_settings.getFFTSize() / 2 + 1;
+
+            if(iRowNumber < matTapSpectra.rows() && iNFreqs <= matTapSpectra.cols()) {
+                plotVec = matTapSpectra.block(iRowNumber, 0, 1, iNFreqs).cwiseAbs();
+            } else if(iRowNumber < m_settings.at(iTrialNumber).vecTapSpectra.size()) {
+                plotVec = m_settings.at(iTrialNumber).vecTapSpectra.at(iRowNumber).cwiseAbs().row(0);
+            }
+
+            if(plotVec.size() > 0) {
                 Eigen::Map<Eigen::VectorXd> v1(plotVec.data(), plotVec.size());
                 Eigen::VectorXd temp =v1;
                 if(!m_pSpectrumPlot) {
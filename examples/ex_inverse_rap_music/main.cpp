@@ -68,6 +68,7 @@
 #include <QApplication>
 #include <QCommandLineParser>
 #include <QVector3D>
+#include <QElapsedTimer>
 
 //=============================================================================================================
 // USED NAMESPACES
@@ -115,6 +116,7 @@ int main(int argc, char *argv[])
     QCommandLineOption annotOption("annotType", "Annotation type <type>.", "type", "aparc.a2009s");
     QCommandLineOption numDipolePairsOption("numDip", "<number> of dipole pairs to localize.", "number", "1");
     QCommandLineOption surfOption("surfType", "Surface type <type>.", "type", "orig");
+    QCommandLineOption benchmarkOption("benchmark", "Compare the precomputed subspace scan against the exhaustive pair scan.", "benchmark", "false");
 
     parser.addOption(fwdFileOption);
     parser.addOption(evokedFileOption);
@@ -124,6 +126,7 @@ int main(int argc, char *argv[])
     parser.addOption(annotOption);
     parser.addOption(numDipolePairsOption);
     parser.addOption(surfOption);
+    parser.addOption(benchmarkOption);
     parser.process(a);
 
     //Load data
@@ -146,6 +149,11 @@ int main(int argc, char *argv[])
         doMovie = true;
     }
 
+    bool doBenchmark = false;
+    if(parser.value(benchmarkOption) == "true" || parser.value(benchmarkOption) == "1") {
+        doBenchmark = true;
+    }
+
     qDebug() << "Start calculation with stc:" << t_sFileNameStc;
 
     // Load data
@@ -179,6 +187,29 @@ int main(int argc, char *argv[])
         t_rapMusic.setStcAttr(iWinSize, 0.6f);
     }
 
+    if(doBenchmark) {
+        QElapsedTimer timer;
+        QList< DipolePair<double> > dipolesExhaustive, dipolesPrecomputed;
+
+        t_rapMusic.setUsePrecomputedSubspaces(false);
+        timer.start();
+        t_rapMusic.calculateInverse(pickedEvoked.data, dipolesExhaustive);
+        qint64 iTimeExhaustive = timer.elapsed();
+
+        t_rapMusic.setUsePrecomputedSubspaces(true);
+        timer.restart();
+        t_rapMusic.calculateInverse(pickedEvoked.data, dipolesPrecomputed);
+        qint64 iTimePrecomputed = timer.elapsed();
+
+        qInfo() << "Exhaustive pair scan:" << iTimeExhaustive << "ms, precomputed subspaces:" << iTimePrecomputed << "ms";
+
+        for(int i = 0; i < qMin(dipolesExhaustive.size(), dipolesPrecomputed.size()); ++i) {
+            qInfo() << "Pair" << i
+                    << "exhaustive:" << dipolesExhaustive.at(i).m_iIdx1 << dipolesExhaustive.at(i).m_iIdx2 << dipolesExhaustive.at(i).m_vCorrelation
+                    << "precomputed:" << dipolesPrecomputed.at(i).m_iIdx1 << dipolesPrecomputed.at(i).m_iIdx2 << dipolesPrecomputed.at(i).m_vCorrelation;
+        }
+    }
+
     MNESourceEstimate sourceEstimate = t_rapMusic.calculateInverse(pickedEvoked);
 
     if(doMovie) {
@@ -56,6 +56,8 @@ using namespace Eigen;
 RtDataClient::RtDataClient(QObject *parent)
 : QTcpSocket(parent)
 , m_clientID(-1)
+, m_iLastTimeStampUSecs(-1)
+, m_iLastTimeStampSample(0)
 {
     getClientId();
 }
@@ -371,22 +373,44 @@ void RtDataClient::readRawBuffer(qint32 p_nChannels,
                                  fiff_int_t& kind)
 {
     FiffStream t_fiffStream(this);
+
     //
-    // Find the start
+    // Read the tag header
     //
-    FiffTag::SPtr t_pTag;
+    while(this->bytesAvailable() < 16)
+        this->waitForReadyRead(10);
 
-    t_fiffStream.read_rt_tag(t_pTag);
+    fiff_int_t type, size, next;
+    t_fiffStream >> kind;
+    t_fiffStream >> type;
+    t_fiffStream >> size;
+    t_fiffStream >> next;
 
-    kind = t_pTag->kind;
+    while(this->bytesAvailable() < size)
+        this->waitForReadyRead(10);
 
-    if(kind == FIFF_DATA_BUFFER)
+    if(kind == FIFF_DATA_BUFFER && type == FIFFT_FLOAT && p_nChannels > 0)
+    {
+        //
+        // Decode the samples straight into data, which keeps its memory if the buffer size did not change
+        //
+        qint32 nSamples = (size/4)/p_nChannels;
+        if(data.rows() != p_nChannels || data.cols() != nSamples)
+            data.resize(p_nChannels, nSamples);
+        t_fiffStream.read_array_data(data.data(), static_cast<qint64>(p_nChannels)*nSamples, 4);
+        t_fiffStream.skipRawData(size - 4*p_nChannels*nSamples);
+    }
+    else if(kind == FIFF_TIME_STAMP && type == FIFFT_INT && size == 12)
+    {
+        fiff_int_t t_timeStamp[3];
+        t_fiffStream.read_array_data(t_timeStamp, 3, 4);
+        m_iLastTimeStampUSecs = static_cast<qint64>(t_timeStamp[0]) * 1000000 + t_timeStamp[1];
+        m_iLastTimeStampSample = t_timeStamp[2];
+    }
+    else
     {
-        qint32 nSamples = (t_pTag->size()/4)/p_nChannels;
-        data = MatrixXf(Map< MatrixXf >(t_pTag->toFloat(), p_nChannels, nSamples));
+        t_fiffStream.skipRawData(size);
     }
-//        else
-//            data = tag.data;
 }
 
 //=============================================================================================================
@@ -110,7 +110,8 @@ public:
 
     //=========================================================================================================
     /**
-     * Reads fiff measurement information of a data the connection
+     * Reads fiff measurement information of a data the connection. A FIFF_TIME_STAMP tag is kept and can be
+     * queried with lastTimeStamp.
      *
      * @param[in] p_nChannels    Number of channels to reshape the received data.
      * @param[out] data          The read data - ToDo change this to raw buffer data object.
@@ -128,10 +129,43 @@ public:
      */
     void setClientAlias(const QString &p_sAlias);
 
+    //=========================================================================================================
+    /**
+     * Returns the emission time of the last time stamped raw buffer, as sent by mne_rt_server in front of it.
+     *
+     * @return the emission time in microseconds since the epoch, -1 if no time stamp was received.
+     */
+    inline qint64 lastTimeStamp() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the first sample of the last time stamped raw buffer.
+     *
+     * @return the index of the first sample since the start of the stream.
+     */
+    inline qint32 lastTimeStampSample() const;
+
 private:
     qint32 m_clientID;  /**< Corresponding client id of the data client at mne_rt_server. */
+    qint64 m_iLastTimeStampUSecs;   /**< Emission time of the last time stamped buffer in microseconds since the epoch. */
+    qint32 m_iLastTimeStampSample;  /**< First sample of the last time stamped buffer. */
     
 };
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline qint64 RtDataClient::lastTimeStamp() const
+{
+    return m_iLastTimeStampUSecs;
+}
+
+//=============================================================================================================
+
+inline qint32 RtDataClient::lastTimeStampSample() const
+{
+    return m_iLastTimeStampSample;
+}
 } // NAMESPACE
 
 #endif // RTDATACLIENT_H
@@ -97,6 +97,7 @@ void ConnectivitySettings::clearIntermediateData()
     for (int i = 0; i < m_trialData.size(); ++i) {
         m_trialData[i].matPsd.resize(0,0);
         m_trialData[i].vecPairCsd.clear();
+        m_trialData[i].matTapSpectra.resize(0,0);
         m_trialData[i].vecTapSpectra.clear();
         m_trialData[i].vecPairCsdNormalized.clear();
         m_trialData[i].vecPairCsdImagSign.clear();
@@ -98,6 +98,7 @@ public:
     struct IntermediateTrialData {
         Eigen::MatrixXd     matData;
         Eigen::MatrixXd     matPsd;
+        Eigen::MatrixXcd    matTapSpectra;
         QVector<Eigen::MatrixXcd>               vecTapSpectra;
         QVector<QPair<int,Eigen::MatrixXcd> >   vecPairCsd;
         QVector<QPair<int,Eigen::MatrixXcd> >   vecPairCsdNormalized;
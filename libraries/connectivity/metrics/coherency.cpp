@@ -53,6 +53,7 @@
 
 #include <QDebug>
 #include <QtConcurrent>
+#include <QThread>
 
 //=============================================================================================================
 // EIGEN INCLUDES
@@ -72,6 +73,60 @@ using namespace UTILSLIB;
 // DEFINE GLOBAL METHODS
 //=============================================================================================================
 
+namespace {
+
+template<typename T>
+void prepareSum(QVector<QPair<int,T> >& vecSum,
+                int iNRows,
+                int iNBins)
+{
+    if(vecSum.size() == iNRows) {
+        return;
+    }
+
+    vecSum.clear();
+
+    for(int i = 0; i < iNRows; ++i) {
+        vecSum.append(QPair<int,T>(i, T::Zero(iNRows, iNBins)));
+    }
+}
+
+//=============================================================================================================
+
+template<typename T>
+void prepareTrial(QVector<QPair<int,T> >& vecTrial,
+                  int iNRows,
+                  bool bStore)
+{
+    vecTrial.clear();
+
+    if(bStore) {
+        vecTrial.resize(iNRows);
+    }
+}
+
+//=============================================================================================================
+
+template<typename T, typename Derived>
+void addRows(QVector<QPair<int,T> >& vecSum,
+             QVector<QPair<int,T> >& vecTrial,
+             int i,
+             const MatrixBase<Derived>& matRows)
+{
+    // matRows holds the pairs (i,j) with j >= i
+    T& matSum = vecSum[i].second;
+    matSum.bottomRows(matRows.rows()) += matRows;
+
+    // In storage mode the trial keeps its contribution in order to be able to remove it from the sums later on
+    if(!vecTrial.isEmpty()) {
+        vecTrial[i].first = i;
+        vecTrial[i].second = T::Zero(matSum.rows(), matSum.cols());
+        vecTrial[i].second.bottomRows(matRows.rows()) = matRows;
+    }
+}
+
+}
+
 //=============================================================================================================
 // DEFINE MEMBER METHODS
 //=============================================================================================================
@@ -85,10 +140,6 @@ Coherency::Coherency()
 void Coherency::calculateAbs(Network& finalNetwork,
                              ConnectivitySettings &connectivitySettings)
 {
-//    QElapsedTimer timer;
-//    qint64 iTime = 0;
-//    timer.start();
-
     if(connectivitySettings.isEmpty()) {
         qDebug() << "Coherency::calculateReal - Input data is empty";
         return;
@@ -98,46 +149,14 @@ void Coherency::calculateAbs(Network& finalNetwork,
         fftw_make_planner_thread_safe();
     #endif
 
-    int iSignalLength = connectivitySettings.at(0).matData.cols();
-    int iNfft = connectivitySettings.getFFTSize();
-
-    // Generate tapers
-    QPair<MatrixXd, VectorXd> tapers = Spectral::generateTapers(iSignalLength, connectivitySettings.getWindowType());
-
-    // Initialize vecPsdAvg and vecCsdAvg
-    int iNRows = connectivitySettings.at(0).matData.rows();
-    int iNFreqs = int(floor(iNfft / 2.0)) + 1;
-
     // Compute PSD/CSD for each trial
-    QMutex mutex;
-
-    std::function<void(ConnectivitySettings::IntermediateTrialData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData) {
-        compute(inputData,
-                connectivitySettings.getIntermediateSumData().matPsdSum,
-                connectivitySettings.getIntermediateSumData().vecPairCsdSum,
-                mutex,
-                iNRows,
-                iNFreqs,
-                iNfft,
-                tapers);
-    };
-
-//    iTime = timer.elapsed();
-//    qWarning() << "Preparation" << iTime;
-//    timer.restart();
-
-    QFuture<void> result = QtConcurrent::map(connectivitySettings.getTrialData(),
-                                             computeLambda);
-    result.waitForFinished();
-
-//    iTime = timer.elapsed();
-//    qWarning() << "ComputeSpectraPSDCSD" << iTime;
-//    timer.restart();
+    computeCsd(connectivitySettings);
 
     // Compute CSD/sqrt(PSD_X * PSD_Y)
+    finalNetwork.resizeEdgeWeights(m_iNumberBinAmount);
+
     std::function<void(QPair<int,MatrixXcd>&)> computePSDCSDLambda = [&](QPair<int,MatrixXcd>& pairInput) {
-        computePSDCSDAbs(mutex,
-                         finalNetwork,
+        computePSDCSDAbs(finalNetwork,
                          pairInput,
                          connectivitySettings.getIntermediateSumData().matPsdSum);
     };
@@ -146,9 +165,7 @@ void Coherency::calculateAbs(Network& finalNetwork,
                                                    computePSDCSDLambda);
     resultCSDPSD.waitForFinished();
 
-//    iTime = timer.elapsed();
-//    qWarning() << "Compute" << iTime;
-//    timer.restart();
+    finalNetwork.updateEdgeWeights();
 }
 
 //=============================================================================================================
@@ -156,10 +173,6 @@ void Coherency::calculateAbs(Network& finalNetwork,
 void Coherency::calculateImag(Network& finalNetwork,
                               ConnectivitySettings &connectivitySettings)
 {
-//    QElapsedTimer timer;
-//    qint64 iTime = 0;
-//    timer.start();
-
     if(connectivitySettings.isEmpty()) {
         qDebug() << "Coherency::calculateImag - Input data is empty";
         return;
@@ -169,46 +182,14 @@ void Coherency::calculateImag(Network& finalNetwork,
         fftw_make_planner_thread_safe();
     #endif
 
-    int iSignalLength = connectivitySettings.at(0).matData.cols();
-    int iNfft = connectivitySettings.getFFTSize();
-
-    // Generate tapers
-    QPair<MatrixXd, VectorXd> tapers = Spectral::generateTapers(iSignalLength, connectivitySettings.getWindowType());
-
-    // Initialize vecPsdAvg and vecCsdAvg
-    int iNRows = connectivitySettings.at(0).matData.rows();
-    int iNFreqs = int(floor(iNfft / 2.0)) + 1;
-
     // Compute PSD/CSD for each trial
-    QMutex mutex;
-
-    std::function<void(ConnectivitySettings::IntermediateTrialData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData) {
-        compute(inputData,
-                connectivitySettings.getIntermediateSumData().matPsdSum,
-                connectivitySettings.getIntermediateSumData().vecPairCsdSum,
-                mutex,
-                iNRows,
-                iNFreqs,
-                iNfft,
-                tapers);
-    };
-
-//    iTime = timer.elapsed();
-//    qWarning() << "Preparation" << iTime;
-//    timer.restart();
-
-    QFuture<void> result = QtConcurrent::map(connectivitySettings.getTrialData(),
-                                             computeLambda);
-    result.waitForFinished();
-
-//    iTime = timer.elapsed();
-//    qWarning() << "ComputeSpectraPSDCSD" << iTime;
-//    timer.restart();
+    computeCsd(connectivitySettings);
 
     // Compute CSD/sqrt(PSD_X * PSD_Y)
+    finalNetwork.resizeEdgeWeights(m_iNumberBinAmount);
+
     std::function<void(QPair<int,MatrixXcd>&)> computePSDCSDLambda = [&](QPair<int,MatrixXcd>& pairInput) {
-        computePSDCSDImag(mutex,
-                          finalNetwork,
+        computePSDCSDImag(finalNetwork,
                           pairInput,
                           connectivitySettings.getIntermediateSumData().matPsdSum);
     };
@@ -217,222 +198,320 @@ void Coherency::calculateImag(Network& finalNetwork,
                                                    computePSDCSDLambda);
     resultCSDPSD.waitForFinished();
 
-//    iTime = timer.elapsed();
-//    qWarning() << "Compute" << iTime;
-//    timer.restart();
+    finalNetwork.updateEdgeWeights();
 }
 
 //=============================================================================================================
 
-void Coherency::compute(ConnectivitySettings::IntermediateTrialData& inputData,
-                        MatrixXd& matPsdSum,
-                        QVector<QPair<int,MatrixXcd> >& vecPairCsdSum,
-                        QMutex& mutex,
-                        int iNRows,
-                        int iNFreqs,
-                        int iNfft,
-                        const QPair<MatrixXd, VectorXd>& tapers)
+void Coherency::computeCsd(ConnectivitySettings &connectivitySettings,
+                           int iQuantities)
 {
-//    QElapsedTimer timer;
-//    qint64 iTime = 0;
-//    timer.start();
+    int iSignalLength = connectivitySettings.at(0).matData.cols();
+    int iNfft = connectivitySettings.getFFTSize();
+    int iNRows = connectivitySettings.at(0).matData.rows();
+    int iNFreqs = int(floor(iNfft / 2.0)) + 1;
+    int i;
+
+    ConnectivitySettings::IntermediateSumData& sumData = connectivitySettings.getIntermediateSumData();
+    QList<ConnectivitySettings::IntermediateTrialData>& lTrialData = connectivitySettings.getTrialData();
+
+    // Only what was not added to the sums yet needs to be computed. In storage mode another metric might already
+    // have added the CSD of a trial, which is then reused.
+    QList<TrialTask> lTasks;
+    QList<ConnectivitySettings::IntermediateTrialData*> lSpectraTrials;
+
+    for(i = 0; i < lTrialData.size(); ++i) {
+        ConnectivitySettings::IntermediateTrialData& trialData = lTrialData[i];
+
+        TrialTask task;
+        task.pData = &trialData;
+        task.bCsd = trialData.vecPairCsd.size() != iNRows;
+        task.bPsd = trialData.matPsd.rows() != iNRows || trialData.matPsd.cols() != m_iNumberBinAmount;
+        task.iQuantities = 0;
+
+        if((iQuantities & CsdNormalized) && trialData.vecPairCsdNormalized.size() != iNRows) {
+            task.iQuantities |= CsdNormalized;
+        }
+        if((iQuantities & CsdImagSign) && trialData.vecPairCsdImagSign.size() != iNRows) {
+            task.iQuantities |= CsdImagSign;
+        }
+        if((iQuantities & CsdImagAbs) && trialData.vecPairCsdImagAbs.size() != iNRows) {
+            task.iQuantities |= CsdImagAbs;
+        }
+        if((iQuantities & CsdImagSqrd) && trialData.vecPairCsdImagSqrd.size() != iNRows) {
+            task.iQuantities |= CsdImagSqrd;
+        }
+
+        if(!task.bCsd && !task.bPsd && task.iQuantities == 0) {
+            continue;
+        }
+
+        if(task.bCsd || task.bPsd) {
+            lSpectraTrials.append(&trialData);
+        }
+
+        // Size the per trial storage here, so that the rows can be written in parallel
+        if(task.bCsd) {
+            prepareTrial(trialData.vecPairCsd, iNRows, m_bStorageModeIsActive);
+        }
+        if(task.iQuantities & CsdNormalized) {
+            prepareTrial(trialData.vecPairCsdNormalized, iNRows, m_bStorageModeIsActive);
+        }
+        if(task.iQuantities & CsdImagSign) {
+            prepareTrial(trialData.vecPairCsdImagSign, iNRows, m_bStorageModeIsActive);
+        }
+        if(task.iQuantities & CsdImagAbs) {
+            prepareTrial(trialData.vecPairCsdImagAbs, iNRows, m_bStorageModeIsActive);
+        }
+        if(task.iQuantities & CsdImagSqrd) {
+            prepareTrial(trialData.vecPairCsdImagSqrd, iNRows, m_bStorageModeIsActive);
+        }
 
-    if(inputData.vecPairCsd.size() == iNRows) {
-        //qDebug() << "Coherency::compute - vecPairCsd were already computed for this trial.";
+        lTasks.append(task);
+    }
+
+    if(lTasks.isEmpty()) {
         return;
     }
 
-    //qDebug() << "Coherency::compute - vecPairCsdSum and matPsdSum are computed for this trial.";
+    // Generate tapers
+    QPair<MatrixXd, VectorXd> tapers = Spectral::generateTapers(iSignalLength, connectivitySettings.getWindowType());
+
+    // Normalization per frequency bin. The first and last bin are halved due to the half spectrum.
+    RowVectorXd vecScale = RowVectorXd::Constant(m_iNumberBinAmount, 2.0 / tapers.second.cwiseAbs2().sum());
+
+    if(m_iNumberBinStart == 0) {
+        vecScale(0) /= 2.0;
+    }
+
+    if(iNfft % 2 == 0 && m_iNumberBinStart + m_iNumberBinAmount >= iNFreqs) {
+        vecScale.tail(1) /= 2.0;
+    }
+
+    // Compute tapered spectra and PSD, parallel over trials
+    std::function<void(ConnectivitySettings::IntermediateTrialData*)> computeSpectraLambda = [&](ConnectivitySettings::IntermediateTrialData* pInputData) {
+        computeTaperedSpectra(*pInputData,
+                              iNFreqs,
+                              iNfft,
+                              tapers,
+                              vecScale);
+    };
+
+    QFuture<void> resultSpectra = QtConcurrent::map(lSpectraTrials,
+                                                    computeSpectraLambda);
+    resultSpectra.waitForFinished();
+
+    // Reduce the PSD
+    if(sumData.matPsdSum.rows() != iNRows || sumData.matPsdSum.cols() != m_iNumberBinAmount) {
+        sumData.matPsdSum = MatrixXd::Zero(iNRows, m_iNumberBinAmount);
+    }
+
+    for(i = 0; i < lTasks.size(); ++i) {
+        if(lTasks.at(i).bPsd) {
+            sumData.matPsdSum += lTasks.at(i).pData->matPsd;
+        }
+    }
+
+    // Prepare the sums, so that the rows can be written in parallel
+    prepareSum(sumData.vecPairCsdSum, iNRows, m_iNumberBinAmount);
 
-    // Substract mean, compute tapered spectra and PSD
-    // This code was copied and changed modified Utils/Spectra since we do not want to call the function due to time loss.
-    bool bNfftEven = false;
-    if (iNfft % 2 == 0){
-        bNfftEven = true;
+    if(iQuantities & CsdNormalized) {
+        prepareSum(sumData.vecPairCsdNormalizedSum, iNRows, m_iNumberBinAmount);
+    }
+    if(iQuantities & CsdImagSign) {
+        prepareSum(sumData.vecPairCsdImagSignSum, iNRows, m_iNumberBinAmount);
+    }
+    if(iQuantities & CsdImagAbs) {
+        prepareSum(sumData.vecPairCsdImagAbsSum, iNRows, m_iNumberBinAmount);
     }
+    if(iQuantities & CsdImagSqrd) {
+        prepareSum(sumData.vecPairCsdImagSqrdSum, iNRows, m_iNumberBinAmount);
+    }
+
+    // Split the upper triangle into row blocks of roughly equal work. Row i holds iNRows - i pairs.
+    int iNumberBlocks = qMin(iNRows, 4 * qMax(QThread::idealThreadCount(), 1));
+    double dWorkPerBlock = 0.5 * iNRows * (iNRows + 1) / iNumberBlocks;
+    double dWork = 0.0;
+    int iRowStart = 0;
 
-    FFT<double> fft;
-    fft.SetFlag(fft.HalfSpectrum);
+    QList<QPair<int,int> > lRowBlocks;
 
-    double denomPSD = tapers.second.cwiseAbs2().sum() / 2.0;
+    for(i = 0; i < iNRows; ++i) {
+        dWork += iNRows - i;
 
-    RowVectorXd vecInputFFT, rowData;
-    RowVectorXcd vecTmpFreq;
+        if(dWork >= dWorkPerBlock * (lRowBlocks.size() + 1) || i == iNRows - 1) {
+            lRowBlocks.append(QPair<int,int>(iRowStart, i + 1));
+            iRowStart = i + 1;
+        }
+    }
 
-    MatrixXcd matTapSpectrum(tapers.first.rows(), iNFreqs);
+    // Compute CSD and the derived quantities, parallel over row blocks
+    RowVectorXcd vecScaleCsd = vecScale.cast<std::complex<double> >();
+    int iNTapers = tapers.first.rows();
+
+    std::function<void(QPair<int,int>&)> computeCsdLambda = [&](QPair<int,int>& pairRows) {
+        computeCsdRows(lTasks,
+                       sumData,
+                       pairRows.first,
+                       pairRows.second,
+                       iNFreqs,
+                       iNTapers,
+                       vecScaleCsd);
+    };
 
+    QFuture<void> resultCsd = QtConcurrent::map(lRowBlocks,
+                                                computeCsdLambda);
+    resultCsd.waitForFinished();
+
+    //Do not store data to save memory
+    if(!m_bStorageModeIsActive) {
+        for(i = 0; i < lSpectraTrials.size(); ++i) {
+            lSpectraTrials[i]->matTapSpectra.resize(0,0);
+        }
+    }
+}
+
+//=============================================================================================================
+
+void Coherency::computeTaperedSpectra(ConnectivitySettings::IntermediateTrialData& inputData,
+                                      int iNFreqs,
+                                      int iNfft,
+                                      const QPair<MatrixXd, VectorXd>& tapers,
+                                      const RowVectorXd& vecScale)
+{
+    int iNRows = inputData.matData.rows();
+    int iNTapers = tapers.first.rows();
     int i,j;
 
-    inputData.matPsd = MatrixXd(iNRows, m_iNumberBinAmount);
+    // Calculate tapered spectra if not available already
+    if(inputData.matTapSpectra.rows() != iNRows || inputData.matTapSpectra.cols() != iNTapers * iNFreqs) {
+        // This code was copied and changed modified Utils/Spectra since we do not want to call the function due to time loss.
+        FFT<double> fft;
+        fft.SetFlag(fft.HalfSpectrum);
+
+        RowVectorXd vecInputFFT, rowData;
+        RowVectorXcd vecTmpFreq;
 
-    for (i = 0; i < iNRows; ++i) {
-        // Substract mean
-        rowData.array() = inputData.matData.row(i).array() - inputData.matData.row(i).mean();
+        inputData.matTapSpectra.resize(iNRows, iNTapers * iNFreqs);
 
-        // Calculate tapered spectra if not available already
-        if(inputData.vecTapSpectra.size() != iNRows) {
-            for(j = 0; j < tapers.first.rows(); j++) {
+        for (i = 0; i < iNRows; ++i) {
+            // Substract mean
+            rowData.array() = inputData.matData.row(i).array() - inputData.matData.row(i).mean();
+
+            for(j = 0; j < iNTapers; j++) {
                 // Zero padd if necessary. The zero padding in Eigen's FFT is only working for column vectors.
                 if (rowData.cols() < iNfft) {
                     vecInputFFT.setZero(iNfft);
-                    vecInputFFT.block(0,0,1,rowData.cols()) = rowData.cwiseProduct(tapers.first.row(j));;
+                    vecInputFFT.block(0,0,1,rowData.cols()) = rowData.cwiseProduct(tapers.first.row(j));
                 } else {
                     vecInputFFT = rowData.cwiseProduct(tapers.first.row(j));
                 }
 
                 // FFT for freq domain returning the half spectrum and multiply taper weights
                 fft.fwd(vecTmpFreq, vecInputFFT, iNfft);
-                matTapSpectrum.row(j) = vecTmpFreq * tapers.second(j);
+                inputData.matTapSpectra.block(i, j * iNFreqs, 1, iNFreqs) = vecTmpFreq * tapers.second(j);
             }
-
-            inputData.vecTapSpectra.append(matTapSpectrum);
-        }
-
-        // Compute PSD (average over tapers if necessary).
-        inputData.matPsd.row(i) = inputData.vecTapSpectra.at(i).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(i).rows(),m_iNumberBinAmount).cwiseAbs2().colwise().sum() / denomPSD;
-
-        // Divide first and last element by 2 due to half spectrum
-        if(m_iNumberBinStart == 0) {
-            inputData.matPsd.row(i)(0) /= 2.0;
-        }
-
-        if(bNfftEven && m_iNumberBinStart + m_iNumberBinAmount >= iNFreqs) {
-            inputData.matPsd.row(i).tail(1) /= 2.0;
         }
     }
 
-    mutex.lock();
+    // Compute PSD (average over tapers if necessary)
+    inputData.matPsd = MatrixXd::Zero(iNRows, m_iNumberBinAmount);
 
-    if(matPsdSum.rows() == 0 || matPsdSum.cols() == 0) {
-        matPsdSum = inputData.matPsd;
-    } else {
-        matPsdSum += inputData.matPsd;
+    for(j = 0; j < iNTapers; j++) {
+        inputData.matPsd += inputData.matTapSpectra.middleCols(j * iNFreqs + m_iNumberBinStart, m_iNumberBinAmount).cwiseAbs2();
     }
 
-    mutex.unlock();
+    inputData.matPsd.array().rowwise() *= vecScale.array();
+}
 
-//    iTime = timer.elapsed();
-//    qWarning() << QThread::currentThreadId() << "Coherency::compute timer - compute - Tapered spectra and PSD (summing):" << iTime;
-//    timer.restart();
+//=============================================================================================================
 
-    // Compute CSD
-    if(inputData.vecPairCsd.size() != iNRows) {
-        inputData.vecPairCsd.clear();
+void Coherency::computeCsdRows(const QList<TrialTask>& lTasks,
+                               ConnectivitySettings::IntermediateSumData& sumData,
+                               int iRowStart,
+                               int iRowEnd,
+                               int iNFreqs,
+                               int iNTapers,
+                               const RowVectorXcd& vecScale)
+{
+    int iNRows = sumData.vecPairCsdSum.size();
+    MatrixXcd matCsd;
+    RowVectorXcd vecRowScaled;
+    int i,j,k,iNPairs;
 
-        //MatrixXcd matCsd = MatrixXcd(iNRows, iNFreqs);
-        MatrixXcd matCsd = MatrixXcd(iNRows, m_iNumberBinAmount);
+    for(i = iRowStart; i < iRowEnd; ++i) {
+        iNPairs = iNRows - i;
 
-        double denomCSD = sqrt(tapers.second.cwiseAbs2().sum()) * sqrt(tapers.second.cwiseAbs2().sum()) / 2.0;
+        for(k = 0; k < lTasks.size(); ++k) {
+            const TrialTask& task = lTasks.at(k);
+            ConnectivitySettings::IntermediateTrialData* pTrial = task.pData;
 
-        for (i = 0; i < iNRows; ++i) {
-            for (j = i; j < iNRows; ++j) {
-                // Compute CSD (average over tapers if necessary)
-                matCsd.row(j) = inputData.vecTapSpectra.at(i).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(i).rows(),m_iNumberBinAmount).cwiseProduct(inputData.vecTapSpectra.at(j).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(j).rows(),m_iNumberBinAmount).conjugate()).colwise().sum() / denomCSD;
+            if(task.bCsd) {
+                // Compute CSD (average over tapers if necessary) of row i with all rows j >= i at once
+                matCsd.setZero(iNPairs, m_iNumberBinAmount);
 
-                // Divide first and last element by 2 due to half spectrum
-                if(m_iNumberBinStart == 0) {
-                    matCsd.row(j)(0) /= 2.0;
-                }
+                for(j = 0; j < iNTapers; ++j) {
+                    const auto matSpectra = pTrial->matTapSpectra.middleCols(j * iNFreqs + m_iNumberBinStart, m_iNumberBinAmount);
+                    vecRowScaled = matSpectra.row(i).cwiseProduct(vecScale);
 
-                if(bNfftEven && m_iNumberBinStart + m_iNumberBinAmount >= iNFreqs) {
-                    matCsd.row(j).tail(1) /= 2.0;
+                    matCsd.array() += matSpectra.bottomRows(iNPairs).conjugate().array().rowwise() * vecRowScaled.array();
                 }
-            }
 
-            inputData.vecPairCsd.append(QPair<int,MatrixXcd>(i,matCsd));
-        }
-
-        mutex.lock();
+                addRows(sumData.vecPairCsdSum, pTrial->vecPairCsd, i, matCsd);
+            } else if(task.iQuantities != 0) {
+                // Reuse the CSD stored by a previous metric
+                matCsd = pTrial->vecPairCsd.at(i).second.bottomRows(iNPairs);
+            }
 
-        if(vecPairCsdSum.isEmpty()) {
-            vecPairCsdSum = inputData.vecPairCsd;
-        } else {
-            for (j = 0; j < vecPairCsdSum.size(); ++j) {
-                vecPairCsdSum[j].second += inputData.vecPairCsd.at(j).second;
+            if(task.iQuantities & CsdNormalized) {
+                addRows(sumData.vecPairCsdNormalizedSum, pTrial->vecPairCsdNormalized, i, matCsd.cwiseQuotient(matCsd.cwiseAbs()));
+            }
+            if(task.iQuantities & CsdImagSign) {
+                addRows(sumData.vecPairCsdImagSignSum, pTrial->vecPairCsdImagSign, i, matCsd.imag().cwiseSign());
+            }
+            if(task.iQuantities & CsdImagAbs) {
+                addRows(sumData.vecPairCsdImagAbsSum, pTrial->vecPairCsdImagAbs, i, matCsd.imag().cwiseAbs());
+            }
+            if(task.iQuantities & CsdImagSqrd) {
+                addRows(sumData.vecPairCsdImagSqrdSum, pTrial->vecPairCsdImagSqrd, i, matCsd.imag().cwiseAbs2());
             }
         }
-
-        mutex.unlock();
     }
-
-//    iTime = timer.elapsed();
-//    qWarning() << QThread::currentThreadId() << "Coherency::compute timer - compute - CSD summing:" << iTime;
-//    timer.restart();
-
-    //Do not store data to save memory
-    if(!m_bStorageModeIsActive) {
-        inputData.vecPairCsd.clear();
-        inputData.vecTapSpectra.clear();
-    }
-
-//    iTime = timer.elapsed();
-//    qWarning() << QThread::currentThreadId() << "Coherency::compute timer - compute - Deleting data:" << iTime;
-//    timer.restart();
 }
 
 //=============================================================================================================
 
-void Coherency::computePSDCSDAbs(QMutex& mutex,
-                                 Network& finalNetwork,
+void Coherency::computePSDCSDAbs(Network& finalNetwork,
                                  const QPair<int,MatrixXcd>& pairInput,
                                  const MatrixXd& matPsdSum)
 {
-    MatrixXd matPSDtmp(matPsdSum.rows(), matPsdSum.cols());
-    RowVectorXd rowPsdSum = matPsdSum.row(pairInput.first);
-
-    for(int j = 0; j < matPSDtmp.rows(); ++j) {
-        matPSDtmp.row(j) = rowPsdSum.cwiseProduct(matPsdSum.row(j));
-    }
-
-    // Average. Note that the number of trials cancel each other out.
-    MatrixXcd matCohy = pairInput.second.cwiseQuotient(matPSDtmp.cwiseSqrt());
-
-    QSharedPointer<NetworkEdge> pEdge;
-    MatrixXd matWeight;
-    int j;
     int i = pairInput.first;
+    int iNPairs = matPsdSum.rows() - i;
 
-    for(j = i; j < matCohy.rows(); ++j) {
-        matWeight = matCohy.row(j).cwiseAbs().transpose();
-        pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(i, j, matWeight));
+    // Average. Note that the number of trials cancel each other out.
+    MatrixXd matPSDtmp = matPsdSum.bottomRows(iNPairs).array().rowwise() * matPsdSum.row(i).array();
+    MatrixXd matCohy = pairInput.second.bottomRows(iNPairs).cwiseQuotient(matPSDtmp.cwiseSqrt()).cwiseAbs();
 
-        mutex.lock();
-        finalNetwork.getNodeAt(i)->append(pEdge);
-        finalNetwork.getNodeAt(j)->append(pEdge);
-        finalNetwork.append(pEdge);
-        mutex.unlock();
+    // Different rows write different node pairs, so no locking is needed
+    for(int j = 1; j < iNPairs; ++j) {
+        finalNetwork.setEdgeWeights(i, i + j, matCohy.row(j).transpose());
     }
 }
 
 //=============================================================================================================
 
-void Coherency::computePSDCSDImag(QMutex& mutex,
-                                  Network& finalNetwork,
+void Coherency::computePSDCSDImag(Network& finalNetwork,
                                   const QPair<int,MatrixXcd>& pairInput,
                                   const MatrixXd& matPsdSum)
 {
-    MatrixXd matPSDtmp(matPsdSum.rows(), matPsdSum.cols());
-    RowVectorXd rowPsdSum = matPsdSum.row(pairInput.first);
-
-    for(int j = 0; j < matPSDtmp.rows(); ++j) {
-        matPSDtmp.row(j) = rowPsdSum.cwiseProduct(matPsdSum.row(j));
-    }
-
-    MatrixXcd matCohy = pairInput.second.cwiseQuotient(matPSDtmp.cwiseSqrt());
-
-    QSharedPointer<NetworkEdge> pEdge;
-    MatrixXd matWeight;
-    int j;
     int i = pairInput.first;
+    int iNPairs = matPsdSum.rows() - i;
 
-    for(j = i; j < matCohy.rows(); ++j) {
-        matWeight = matCohy.row(j).imag().transpose();
-        pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(i, j, matWeight));
+    MatrixXd matPSDtmp = matPsdSum.bottomRows(iNPairs).array().rowwise() * matPsdSum.row(i).array();
+    MatrixXd matCohy = pairInput.second.bottomRows(iNPairs).cwiseQuotient(matPSDtmp.cwiseSqrt()).imag();
 
-        mutex.lock();
-        finalNetwork.getNodeAt(i)->append(pEdge);
-        finalNetwork.getNodeAt(j)->append(pEdge);
-        finalNetwork.append(pEdge);
-        mutex.unlock();
+    // Different rows write different node pairs, so no locking is needed
+    for(int j = 1; j < iNPairs; ++j) {
+        finalNetwork.setEdgeWeights(i, i + j, matCohy.row(j).transpose());
     }
 }
@@ -90,6 +90,14 @@ public:
     typedef QSharedPointer<Coherency> SPtr;            /**< Shared pointer type for Coherency. */
     typedef QSharedPointer<const Coherency> ConstSPtr; /**< Const shared pointer type for Coherency. */
 
+    /** The per trial quantities which can be derived from the CSD and accumulated by computeCsd(). */
+    enum CsdQuantity {
+        CsdNormalized   = 0x1,      /**< CSD/|CSD|, summed in vecPairCsdNormalizedSum. */
+        CsdImagSign     = 0x2,      /**< sign(imag(CSD)), summed in vecPairCsdImagSignSum. */
+        CsdImagAbs      = 0x4,      /**< abs(imag(CSD)), summed in vecPairCsdImagAbsSum. */
+        CsdImagSqrd     = 0x8       /**< imag(CSD)^2, summed in vecPairCsdImagSqrdSum. */
+    };
+
     //=========================================================================================================
     /**
      * Constructs a Coherency object.
@@ -116,39 +124,82 @@ public:
     static void calculateImag(Network& finalNetwork,
                               ConnectivitySettings &connectivitySettings);
 
+    //=========================================================================================================
+    /**
+     * Adds the PSD, the CSD and the requested per trial quantities derived from the CSD of all trials, which were not
+     * yet accounted for, to the intermediate sum data. This is the engine shared by all coherency based metrics.
+     * The tapered spectra are computed in parallel over trials, the CSD in parallel over blocks of rows of the upper
+     * triangle. Each block owns its rows of the sums, so no locking is needed during the accumulation.
+     * In storage mode the tapered spectra, the CSD and the derived quantities of each trial are kept, so that other
+     * metrics can reuse them and the trial can be removed from the sums later on.
+     *
+     * @param[in, out]  connectivitySettings  The input data and parameters.
+     * @param[in]       iQuantities           The CsdQuantity flags to accumulate in addition to the PSD and the CSD.
+     */
+    static void computeCsd(ConnectivitySettings &connectivitySettings,
+                           int iQuantities = 0);
+
 private:
+    /** A trial and what still needs to be added to the sums for it. */
+    struct TrialTask {
+        ConnectivitySettings::IntermediateTrialData* pData;     /**< The trial. */
+        bool    bCsd;                                           /**< Whether the CSD needs to be computed and added. */
+        bool    bPsd;                                           /**< Whether the PSD needs to be added. */
+        int     iQuantities;                                    /**< The CsdQuantity flags which need to be added. */
+    };
+
     //=========================================================================================================
     /**
-     * Computes the coherency values. This function gets called in parallel.
+     * Computes the tapered spectra, if not available already, and the PSD of a single trial. This function gets
+     * called in parallel. The tapered spectra are stored in inputData.matTapSpectra with one block of iNFreqs columns
+     * per taper.
      *
-     * @param[in]   inputData           The input data.
-     * @param[out]   matPsdSum           The sum of all PSD matrices for each trial.
-     * @param[out]   vecPairCsdSum       The sum of all CSD matrices for each trial.
-     * @param[in]   mutex               The mutex used to safely access matPsdSum and vecPairCsdSum.
-     * @param[in]   iNRows              The number of rows.
-     * @param[in]   iNFreqs             The number of frequenciy bins.
-     * @param[in]   iNfft               The FFT length.
-     * @param[in]   tapers              The taper information.
+     * @param[in, out]  inputData           The input data.
+     * @param[in]       iNFreqs             The number of frequenciy bins.
+     * @param[in]       iNfft               The FFT length.
+     * @param[in]       tapers              The taper information.
+     * @param[in]       vecScale            The per bin normalization of the selected frequency bins.
      */
-    static void compute(ConnectivitySettings::IntermediateTrialData& inputData,
-                        Eigen::MatrixXd& matPsdSum,
-                        QVector<QPair<int,Eigen::MatrixXcd> >& vecPairCsdSum,
-                        QMutex& mutex,
-                        int iNRows,
-                        int iNFreqs,
-                        int iNfft,
-                        const QPair<Eigen::MatrixXd, Eigen::VectorXd>& tapers);
+    static void computeTaperedSpectra(ConnectivitySettings::IntermediateTrialData& inputData,
+                                      int iNFreqs,
+                                      int iNfft,
+                                      const QPair<Eigen::MatrixXd, Eigen::VectorXd>& tapers,
+                                      const Eigen::RowVectorXd& vecScale);
 
     //=========================================================================================================
     /**
-     * Computes the PSD and CSD. This function gets called in parallel.
+     * Accumulates the rows [iRowStart, iRowEnd) of the upper triangle of the CSD and of the derived quantities over
+     * the given trials. This function gets called in parallel.
+     *
+     * @param[in]       lTasks              The trials to accumulate.
+     * @param[in, out]  sumData             The sums. Only the rows [iRowStart, iRowEnd) are written.
+     * @param[in]       iRowStart           The first row to compute.
+     * @param[in]       iRowEnd             The row after the last row to compute.
+     * @param[in]       iNFreqs             The number of frequenciy bins.
+     * @param[in]       iNTapers            The number of tapers.
+     * @param[in]       vecScale            The per bin normalization of the selected frequency bins.
+     */
+    static void computeCsdRows(const QList<TrialTask>& lTasks,
+                               ConnectivitySettings::IntermediateSumData& sumData,
+                               int iRowStart,
+                               int iRowEnd,
+                               int iNFreqs,
+                               int iNTapers,
+                               const Eigen::RowVectorXcd& vecScale);
+
+    //=========================================================================================================
+    /**
+     * Computes the coherency of one row of the summed CSD and writes the edge weights to the network.
+     * This function gets called in parallel.
+     *
+     * @param[out]  finalNetwork        The resulting network.
+     * @param[in]   pairInput           The row index and the summed CSD of this row.
+     * @param[in]   matPsdSum           The summed PSD.
      */
-    static void computePSDCSDAbs(QMutex& mutex,
-                                 Network& finalNetwork,
+    static void computePSDCSDAbs(Network& finalNetwork,
                                  const QPair<int,Eigen::MatrixXcd>& pairInput,
                                  const Eigen::MatrixXd& matPsdSum);
-    static void computePSDCSDImag(QMutex& mutex,
-                                  Network& finalNetwork,
+    static void computePSDCSDImag(Network& finalNetwork,
                                   const QPair<int,Eigen::MatrixXcd>& pairInput,
                                   const Eigen::MatrixXd& matPsdSum);
 };
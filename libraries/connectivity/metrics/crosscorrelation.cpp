@@ -151,22 +151,18 @@ Network CrossCorrelation::calculate(ConnectivitySettings& connectivitySettings)
 //    timer.restart();
 
     //Add edges to network
-    MatrixXd matWeight(1,1);
-    QSharedPointer<NetworkEdge> pEdge;
     int j;
 
-    for(int i = 0; i < matDist.rows(); ++i) {
-        for(j = i; j < matDist.cols(); ++j) {
-            matWeight << matDist(i,j);
-
-            pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(i, j, matWeight));
+    finalNetwork.resizeEdgeWeights(1);
 
-            finalNetwork.getNodeAt(i)->append(pEdge);
-            finalNetwork.getNodeAt(j)->append(pEdge);
-            finalNetwork.append(pEdge);
+    for(int i = 0; i < matDist.rows(); ++i) {
+        for(j = i + 1; j < matDist.cols(); ++j) {
+            finalNetwork.setEdgeWeights(i, j, matDist.col(j).segment(i, 1));
         }
     }
 
+    finalNetwork.updateEdgeWeights();
+
 //    iTime = timer.elapsed();
 //    qWarning() << "Compute" << iTime;
 //    timer.restart();
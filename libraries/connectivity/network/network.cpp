@@ -51,6 +51,7 @@
 //=============================================================================================================
 
 #include <QDebug>
+#include <QMutexLocker>
 
 //=============================================================================================================
 // EIGEN INCLUDES
@@ -74,7 +75,10 @@ using namespace UTILSLIB;
 
 Network::Network(const QString& sConnectivityMethod,
                  double dThreshold)
-: m_sConnectivityMethod(sConnectivityMethod)
+: m_pMatEdgeWeights(QSharedPointer<MatrixXd>::create())
+, m_minMaxFreqBins(QPair<int,int>(-1,-1))
+, m_pEdgeCache(QSharedPointer<EdgeCache>::create())
+, m_sConnectivityMethod(sConnectivityMethod)
 , m_minMaxFullWeights(QPair<double,double>(std::numeric_limits<double>::max(),0.0))
 , m_minMaxThresholdedWeights(QPair<double,double>(std::numeric_limits<double>::max(),0.0))
 , m_dThreshold(dThreshold)
@@ -95,6 +99,22 @@ MatrixXd Network::getFullConnectivityMatrix(bool bGetMirroredVersion) const
     MatrixXd matDist(m_lNodes.size(), m_lNodes.size());
     matDist.setZero();
 
+    if(hasEdgeWeights()) {
+        int p = 0;
+
+        for(int i = 0; i < matDist.rows(); ++i) {
+            for(int j = i + 1; j < matDist.cols(); ++j, ++p) {
+                matDist(i,j) = m_vecAveragedEdgeWeights(p);
+
+                if(bGetMirroredVersion) {
+                    matDist(j,i) = m_vecAveragedEdgeWeights(p);
+                }
+            }
+        }
+
+        return matDist;
+    }
+
     for(int i = 0; i < m_lFullEdges.size(); ++i) {
         int row = m_lFullEdges.at(i)->getStartNodeID();
         int col = m_lFullEdges.at(i)->getEndNodeID();
@@ -119,6 +139,18 @@ MatrixXd Network::getThresholdedConnectivityMatrix(bool bGetMirroredVersion) con
     MatrixXd matDist(m_lNodes.size(), m_lNodes.size());
     matDist.setZero();
 
+    if(hasEdgeWeights()) {
+        for(int i = 0; i < m_matThresholdedAdjacency.outerSize(); ++i) {
+            for(SparseMatrix<double, RowMajor>::InnerIterator it(m_matThresholdedAdjacency, i); it; ++it) {
+                if(bGetMirroredVersion || it.col() > i) {
+                    matDist(i, it.col()) = it.value();
+                }
+            }
+        }
+
+        return matDist;
+    }
+
     for(int i = 0; i < m_lThresholdedEdges.size(); ++i) {
         int row = m_lThresholdedEdges.at(i)->getStartNodeID();
         int col = m_lThresholdedEdges.at(i)->getEndNodeID();
@@ -138,8 +170,148 @@ MatrixXd Network::getThresholdedConnectivityMatrix(bool bGetMirroredVersion) con
 
 //=============================================================================================================
 
+SparseMatrix<double, RowMajor> Network::getThresholdedAdjacency() const
+{
+    if(hasEdgeWeights()) {
+        return m_matThresholdedAdjacency;
+    }
+
+    // Build from the edge objects
+    QList<Triplet<double> > lTriplets;
+
+    for(int i = 0; i < m_lThresholdedEdges.size(); ++i) {
+        int row = m_lThresholdedEdges.at(i)->getStartNodeID();
+        int col = m_lThresholdedEdges.at(i)->getEndNodeID();
+
+        if(row < m_lNodes.size() && col < m_lNodes.size()) {
+            lTriplets.append(Triplet<double>(row, col, m_lThresholdedEdges.at(i)->getWeight()));
+            lTriplets.append(Triplet<double>(col, row, m_lThresholdedEdges.at(i)->getWeight()));
+        }
+    }
+
+    SparseMatrix<double, RowMajor> matAdjacency(m_lNodes.size(), m_lNodes.size());
+    matAdjacency.setFromTriplets(lTriplets.begin(), lTriplets.end());
+
+    return matAdjacency;
+}
+
+//=============================================================================================================
+
+const MatrixXd& Network::getEdgeWeights() const
+{
+    return *m_pMatEdgeWeights;
+}
+
+//=============================================================================================================
+
+const VectorXd& Network::getAveragedEdgeWeights() const
+{
+    return m_vecAveragedEdgeWeights;
+}
+
+//=============================================================================================================
+
+int Network::getPairIndex(int iStartNodeID, int iEndNodeID) const
+{
+    int i = qMin(iStartNodeID, iEndNodeID);
+    int j = qMax(iStartNodeID, iEndNodeID);
+
+    return i * (2 * m_lNodes.size() - i - 1) / 2 + j - i - 1;
+}
+
+//=============================================================================================================
+
+void Network::resizeEdgeWeights(int iNumberFreqBins)
+{
+    int iNumberNodes = m_lNodes.size();
+
+    m_pMatEdgeWeights = QSharedPointer<MatrixXd>::create(MatrixXd::Zero(iNumberFreqBins, iNumberNodes * (iNumberNodes - 1) / 2));
+    m_vecAveragedEdgeWeights = VectorXd::Zero(m_pMatEdgeWeights->cols());
+    m_matThresholdedAdjacency.resize(iNumberNodes, iNumberNodes);
+
+    invalidateEdges();
+}
+
+//=============================================================================================================
+
+void Network::setEdgeWeights(int iStartNodeID,
+                             int iEndNodeID,
+                             const Ref<const VectorXd, 0, InnerStride<> >& vecWeights)
+{
+    if(iStartNodeID == iEndNodeID) {
+        return;
+    }
+
+    if(vecWeights.rows() != m_pMatEdgeWeights->rows()) {
+        qWarning() << "Network::setEdgeWeights - Number of weights does not match the number of frequency bins. Returning.";
+        return;
+    }
+
+    m_pMatEdgeWeights->col(getPairIndex(iStartNodeID, iEndNodeID)) = vecWeights;
+}
+
+//=============================================================================================================
+
+void Network::updateEdgeWeights()
+{
+    if(!hasEdgeWeights()) {
+        return;
+    }
+
+    updateAveragedEdgeWeights();
+
+    m_minMaxFullWeights.first = m_vecAveragedEdgeWeights.cwiseAbs().minCoeff();
+    m_minMaxFullWeights.second = m_vecAveragedEdgeWeights.cwiseAbs().maxCoeff();
+
+    updateThresholdedAdjacency();
+
+    invalidateEdges();
+}
+
+//=============================================================================================================
+
+VectorXi Network::getThresholdedDegrees() const
+{
+    VectorXi vecDegrees = VectorXi::Zero(m_lNodes.size());
+
+    if(hasEdgeWeights()) {
+        for(int i = 0; i < vecDegrees.rows(); ++i) {
+            vecDegrees(i) = m_matThresholdedAdjacency.outerIndexPtr()[i+1] - m_matThresholdedAdjacency.outerIndexPtr()[i];
+        }
+    } else {
+        for(int i = 0; i < vecDegrees.rows(); ++i) {
+            vecDegrees(i) = m_lNodes.at(i)->getThresholdedDegree();
+        }
+    }
+
+    return vecDegrees;
+}
+
+//=============================================================================================================
+
+MatrixX3f Network::getNodeVertices() const
+{
+    MatrixX3f matVert = MatrixX3f::Zero(m_lNodes.size(), 3);
+
+    for(int i = 0; i < m_lNodes.size(); ++i) {
+        const RowVectorXf& vecVert = m_lNodes.at(i)->getVert();
+
+        for(int j = 0; j < 3 && j < vecVert.cols(); ++j) {
+            matVert(i,j) = vecVert(j);
+        }
+    }
+
+    return matVert;
+}
+
+//=============================================================================================================
+
 const QList<NetworkEdge::SPtr>& Network::getFullEdges() const
 {
+    if(hasEdgeWeights()) {
+        return getEdgeCache().lFullEdges;
+    }
+
     return m_lFullEdges;
 }
 
@@ -147,6 +319,10 @@ const QList<NetworkEdge::SPtr>& Network::getFullEdges() const
 
 const QList<NetworkEdge::SPtr>& Network::getThresholdedEdges() const
 {
+    if(hasEdgeWeights()) {
+        return getEdgeCache().lThresholdedEdges;
+    }
+
     return m_lThresholdedEdges;
 }
 
@@ -154,6 +330,10 @@ const QList<NetworkEdge::SPtr>& Network::getThresholdedEdges() const
 
 const QList<NetworkNode::SPtr>& Network::getNodes() const
 {
+    if(hasEdgeWeights()) {
+        return getEdgeCache().lNodes;
+    }
+
     return m_lNodes;
 }
 
@@ -161,14 +341,18 @@ const QList<NetworkNode::SPtr>& Network::getNodes() const
 
 NetworkNode::SPtr Network::getNodeAt(int i)
 {
-    return m_lNodes.at(i);
+    return getNodes().at(i);
 }
 
 //=============================================================================================================
 
-qint16 Network::getFullDistribution() const
+qint32 Network::getFullDistribution() const
 {
-    qint16 distribution = 0;
+    if(hasEdgeWeights()) {
+        return m_lNodes.size() * (m_lNodes.size() - 1);
+    }
+
+    qint32 distribution = 0;
 
     for(int i = 0; i < m_lNodes.size(); ++i) {
         distribution += m_lNodes.at(i)->getFullDegree();
@@ -179,9 +363,13 @@ qint16 Network::getFullDistribution() const
 
 //=============================================================================================================
 
-qint16 Network::getThresholdedDistribution() const
+qint32 Network::getThresholdedDistribution() const
 {
-    qint16 distribution = 0;
+    if(hasEdgeWeights()) {
+        return m_matThresholdedAdjacency.nonZeros();
+    }
+
+    qint32 distribution = 0;
 
     for(int i = 0; i < m_lNodes.size(); ++i) {
         distribution += m_lNodes.at(i)->getThresholdedDegree();
@@ -222,6 +410,13 @@ QPair<double, double> Network::getMinMaxThresholdedWeights() const
 
 QPair<int,int> Network::getMinMaxFullDegrees() const
 {
+    if(hasEdgeWeights()) {
+        VectorXi vecIndegrees, vecOutdegrees;
+        computeDegrees(false, vecIndegrees, vecOutdegrees);
+
+        return QPair<int,int>((vecIndegrees + vecOutdegrees).minCoeff(), (vecIndegrees + vecOutdegrees).maxCoeff());
+    }
+
     int maxDegree = 0;
     int minDegree = 1000000;
 
@@ -240,6 +435,13 @@ QPair<int,int> Network::getMinMaxFullDegrees() const
 
 QPair<int,int> Network::getMinMaxThresholdedDegrees() const
 {
+    if(hasEdgeWeights()) {
+        VectorXi vecIndegrees, vecOutdegrees;
+        computeDegrees(true, vecIndegrees, vecOutdegrees);
+
+        return QPair<int,int>((vecIndegrees + vecOutdegrees).minCoeff(), (vecIndegrees + vecOutdegrees).maxCoeff());
+    }
+
     int maxDegree = 0;
     int minDegree = 1000000;
 
@@ -258,6 +460,13 @@ QPair<int,int> Network::getMinMaxThresholdedDegrees() const
 
 QPair<int,int> Network::getMinMaxFullIndegrees() const
 {
+    if(hasEdgeWeights()) {
+        VectorXi vecIndegrees, vecOutdegrees;
+        computeDegrees(false, vecIndegrees, vecOutdegrees);
+
+        return QPair<int,int>(vecIndegrees.minCoeff(), vecIndegrees.maxCoeff());
+    }
+
     int maxDegree = 0;
     int minDegree = 1000000;
 
@@ -276,6 +485,13 @@ QPair<int,int> Network::getMinMaxFullIndegrees() const
 
 QPair<int,int> Network::getMinMaxThresholdedIndegrees() const
 {
+    if(hasEdgeWeights()) {
+        VectorXi vecIndegrees, vecOutdegrees;
+        computeDegrees(true, vecIndegrees, vecOutdegrees);
+
+        return QPair<int,int>(vecIndegrees.minCoeff(), vecIndegrees.maxCoeff());
+    }
+
     int maxDegree = 0;
     int minDegree = 1000000;
 
@@ -294,6 +510,13 @@ QPair<int,int> Network::getMinMaxThresholdedIndegrees() const
 
 QPair<int,int> Network::getMinMaxFullOutdegrees() const
 {
+    if(hasEdgeWeights()) {
+        VectorXi vecIndegrees, vecOutdegrees;
+        computeDegrees(false, vecIndegrees, vecOutdegrees);
+
+        return QPair<int,int>(vecOutdegrees.minCoeff(), vecOutdegrees.maxCoeff());
+    }
+
     int maxDegree = 0;
     int minDegree = 1000000;
 
@@ -312,6 +535,13 @@ QPair<int,int> Network::getMinMaxFullOutdegrees() const
 
 QPair<int,int> Network::getMinMaxThresholdedOutdegrees() const
 {
+    if(hasEdgeWeights()) {
+        VectorXi vecIndegrees, vecOutdegrees;
+        computeDegrees(true, vecIndegrees, vecOutdegrees);
+
+        return QPair<int,int>(vecOutdegrees.minCoeff(), vecOutdegrees.maxCoeff());
+    }
+
     int maxDegree = 0;
     int minDegree = 1000000;
 
@@ -331,19 +561,38 @@ QPair<int,int> Network::getMinMaxThresholdedOutdegrees() const
 void Network::setThreshold(double dThreshold)
 {
     m_dThreshold = dThreshold;
+
+    if(hasEdgeWeights()) {
+        updateThresholdedAdjacency();
+        invalidateEdges();
+        return;
+    }
+
     m_lThresholdedEdges.clear();
 
+    double dMinWeight = std::numeric_limits<double>::max();
+    double dMaxWeight = 0.0;
+
     for(int i = 0; i < m_lFullEdges.size(); ++i) {
-        if(fabs(m_lFullEdges.at(i)->getWeight()) >= m_dThreshold) {
+        double dWeight = fabs(m_lFullEdges.at(i)->getWeight());
+
+        if(dWeight >= m_dThreshold) {
             m_lFullEdges.at(i)->setActive(true);
             m_lThresholdedEdges.append(m_lFullEdges.at(i));
+
+            dMinWeight = qMin(dMinWeight, dWeight);
+            dMaxWeight = qMax(dMaxWeight, dWeight);
         } else {
             m_lFullEdges.at(i)->setActive(false);
         }
     }
 
-    m_minMaxThresholdedWeights.first = m_dThreshold;
-    m_minMaxThresholdedWeights.second = m_minMaxFullWeights.second;
+    if(m_lThresholdedEdges.isEmpty()) {
+        dMinWeight = 0.0;
+    }
+
+    m_minMaxThresholdedWeights.first = dMinWeight;
+    m_minMaxThresholdedWeights.second = dMaxWeight;
 }
 
 //=============================================================================================================
@@ -388,6 +637,17 @@ void Network::setFrequencyRange(float fLowerFreq, float fUpperFreq)
     // Update the min max values
     m_minMaxFullWeights = QPair<double,double>(std::numeric_limits<double>::max(),0.0);
 
+    if(hasEdgeWeights()) {
+        m_minMaxFreqBins = QPair<int,int>(iLowerBin,iUpperBin);
+        updateAveragedEdgeWeights();
+
+        m_minMaxFullWeights.first = m_vecAveragedEdgeWeights.cwiseAbs().minCoeff();
+        m_minMaxFullWeights.second = m_vecAveragedEdgeWeights.cwiseAbs().maxCoeff();
+
+        updateThresholdedAdjacency();
+        invalidateEdges();
+    }
+
     for(int i = 0; i < m_lFullEdges.size(); ++i) {
         m_lFullEdges.at(i)->setFrequencyBins(QPair<int,int>(iLowerBin,iUpperBin));
 
@@ -410,6 +670,11 @@ const QPair<float,float>& Network::getFrequencyRange() const
 
 void Network::append(NetworkEdge::SPtr newEdge)
 {
+    if(hasEdgeWeights()) {
+        qWarning() << "Network::append - The network uses packed edge weights. Use setEdgeWeights instead. Returning.";
+        return;
+    }
+
     if(newEdge->getEndNodeID() != newEdge->getStartNodeID()) {
         double dEdgeWeight = newEdge->getWeight();
         if(dEdgeWeight < m_minMaxFullWeights.first) {
@@ -437,6 +702,10 @@ void Network::append(NetworkNode::SPtr newNode)
 
 bool Network::isEmpty() const
 {
+    if(hasEdgeWeights()) {
+        return m_lNodes.isEmpty();
+    }
+
     if(m_lFullEdges.isEmpty() || m_lNodes.isEmpty()) {
         return true;
     }
@@ -454,15 +723,23 @@ void Network::normalize()
         return;
     }
 
+    if(hasEdgeWeights()) {
+        // Use a new matrix, since the old one is shared with copies of this network
+        m_pMatEdgeWeights = QSharedPointer<MatrixXd>::create(*m_pMatEdgeWeights / m_minMaxFullWeights.second);
+        m_vecAveragedEdgeWeights /= m_minMaxFullWeights.second;
+        m_matThresholdedAdjacency /= m_minMaxFullWeights.second;
+        invalidateEdges();
+    }
+
     for(int i = 0; i < m_lFullEdges.size(); ++i) {
         m_lFullEdges.at(i)->setWeight(m_lFullEdges.at(i)->getWeight()/m_minMaxFullWeights.second);
     }
 
+    m_minMaxThresholdedWeights.first = m_minMaxThresholdedWeights.first/m_minMaxFullWeights.second;
+    m_minMaxThresholdedWeights.second = m_minMaxThresholdedWeights.second/m_minMaxFullWeights.second;
+
     m_minMaxFullWeights.first = m_minMaxFullWeights.first/m_minMaxFullWeights.second;
     m_minMaxFullWeights.second = 1.0;
-
-    m_minMaxThresholdedWeights.first = m_minMaxThresholdedWeights.first/m_minMaxThresholdedWeights.second;
-    m_minMaxThresholdedWeights.second = 1.0;
 }
 
 //=============================================================================================================
@@ -521,3 +798,171 @@ int Network::getFFTSize()
     return m_iFFTSize;
 }
 
+//=============================================================================================================
+
+bool Network::hasEdgeWeights() const
+{
+    return m_pMatEdgeWeights->cols() > 0;
+}
+
+//=============================================================================================================
+
+const Network::EdgeCache& Network::getEdgeCache() const
+{
+    QMutexLocker locker(&m_pEdgeCache->mutex);
+
+    if(!m_pEdgeCache->bIsValid) {
+        createEdges(*m_pEdgeCache);
+        m_pEdgeCache->bIsValid = true;
+    }
+
+    return *m_pEdgeCache;
+}
+
+//=============================================================================================================
+
+void Network::invalidateEdges()
+{
+    // Copies of this network keep the old cache
+    m_pEdgeCache = QSharedPointer<EdgeCache>::create();
+}
+
+//=============================================================================================================
+
+void Network::createEdges(EdgeCache& edgeCache) const
+{
+    edgeCache.lFullEdges.clear();
+    edgeCache.lThresholdedEdges.clear();
+    edgeCache.lNodes.clear();
+
+    if(!hasEdgeWeights()) {
+        return;
+    }
+
+    // Use new node objects, since the appended ones do not hold the edges
+    for(int i = 0; i < m_lNodes.size(); ++i) {
+        NetworkNode::SPtr pNode = NetworkNode::SPtr(new NetworkNode(m_lNodes.at(i)->getId(), m_lNodes.at(i)->getVert()));
+        pNode->setHubStatus(m_lNodes.at(i)->getHubStatus());
+        edgeCache.lNodes.append(pNode);
+    }
+
+    NetworkEdge::SPtr pEdge;
+    bool bIsActive;
+    int p = 0;
+
+    for(int i = 0; i < edgeCache.lNodes.size(); ++i) {
+        for(int j = i + 1; j < edgeCache.lNodes.size(); ++j, ++p) {
+            bIsActive = fabs(m_vecAveragedEdgeWeights(p)) >= m_dThreshold;
+
+            pEdge = NetworkEdge::SPtr(new NetworkEdge(i, j, m_pMatEdgeWeights->col(p), bIsActive, m_minMaxFreqBins.first, m_minMaxFreqBins.second));
+            pEdge->setWeight(m_vecAveragedEdgeWeights(p));
+
+            edgeCache.lNodes.at(i)->append(pEdge);
+            edgeCache.lNodes.at(j)->append(pEdge);
+            edgeCache.lFullEdges.append(pEdge);
+
+            if(bIsActive) {
+                edgeCache.lThresholdedEdges.append(pEdge);
+            }
+        }
+    }
+}
+
+//=============================================================================================================
+
+void Network::updateAveragedEdgeWeights()
+{
+    int iStartWeightBin = m_minMaxFreqBins.first;
+    int iEndWeightBin = m_minMaxFreqBins.second;
+    int rows = m_pMatEdgeWeights->rows();
+
+    if(iEndWeightBin < iStartWeightBin || iStartWeightBin < -1 || iEndWeightBin < -1 ) {
+        return;
+    }
+
+    if(iEndWeightBin == -1 && iStartWeightBin == -1) {
+        m_vecAveragedEdgeWeights = m_pMatEdgeWeights->colwise().mean().transpose();
+    } else if(iStartWeightBin >= 0 && iStartWeightBin < rows) {
+        int iNumberBins = qMin(iEndWeightBin, rows - 1) - iStartWeightBin + 1;
+        m_vecAveragedEdgeWeights = m_pMatEdgeWeights->middleRows(iStartWeightBin, iNumberBins).colwise().mean().transpose();
+    }
+}
+
+//=============================================================================================================
+
+void Network::updateThresholdedAdjacency()
+{
+    int iNumberNodes = m_lNodes.size();
+    int i,j;
+
+    // Count the active edges per node first, so that the CSR matrix can be filled without reallocations
+    VectorXi vecDegrees = VectorXi::Zero(iNumberNodes);
+    int p = 0;
+
+    for(i = 0; i < iNumberNodes; ++i) {
+        for(j = i + 1; j < iNumberNodes; ++j, ++p) {
+            if(fabs(m_vecAveragedEdgeWeights(p)) >= m_dThreshold) {
+                vecDegrees(i)++;
+                vecDegrees(j)++;
+            }
+        }
+    }
+
+    m_matThresholdedAdjacency = SparseMatrix<double, RowMajor>(iNumberNodes, iNumberNodes);
+    m_matThresholdedAdjacency.reserve(vecDegrees);
+
+    double dWeight;
+
+    for(i = 0; i < iNumberNodes; ++i) {
+        for(j = 0; j < iNumberNodes; ++j) {
+            if(i != j) {
+                dWeight = m_vecAveragedEdgeWeights(getPairIndex(i, j));
+
+                if(fabs(dWeight) >= m_dThreshold) {
+                    m_matThresholdedAdjacency.insert(i, j) = dWeight;
+                }
+            }
+        }
+    }
+
+    m_matThresholdedAdjacency.makeCompressed();
+
+    // The range of the active edges only. The threshold itself is just a lower bound.
+    ArrayXd vecAbsWeights = m_vecAveragedEdgeWeights.array().abs();
+    Array<bool, Dynamic, 1> vecIsActive = vecAbsWeights >= m_dThreshold;
+
+    if(vecIsActive.any()) {
+        m_minMaxThresholdedWeights.first = vecIsActive.select(vecAbsWeights, std::numeric_limits<double>::max()).minCoeff();
+        m_minMaxThresholdedWeights.second = vecIsActive.select(vecAbsWeights, 0.0).maxCoeff();
+    } else {
+        m_minMaxThresholdedWeights = QPair<double,double>(0.0,0.0);
+    }
+}
+
+//=============================================================================================================
+
+void Network::computeDegrees(bool bThresholded,
+                             VectorXi& vecIndegrees,
+                             VectorXi& vecOutdegrees) const
+{
+    int iNumberNodes = m_lNodes.size();
+
+    vecIndegrees = VectorXi::Zero(iNumberNodes);
+    vecOutdegrees = VectorXi::Zero(iNumberNodes);
+
+    // The edges of the packed edge weights always point from the lower to the higher node id
+    for(int i = 0; i < iNumberNodes; ++i) {
+        if(bThresholded) {
+            for(SparseMatrix<double, RowMajor>::InnerIterator it(m_matThresholdedAdjacency, i); it; ++it) {
+                if(it.col() < i) {
+                    vecIndegrees(i)++;
+                } else {
+                    vecOutdegrees(i)++;
+                }
+            }
+        } else {
+            vecIndegrees(i) = i;
+            vecOutdegrees(i) = iNumberNodes - 1 - i;
+        }
+    }
+}
@@ -46,12 +46,14 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
+#include <QMutex>
 
 //=============================================================================================================
 // EIGEN INCLUDES
 //=============================================================================================================
 
 #include <Eigen/Core>
+#include <Eigen/SparseCore>
 
 //=============================================================================================================
 // FORWARD DECLARATIONS
@@ -81,6 +83,12 @@ struct VisualizationInfo {
 /**
  * This class holds information (nodes and connecting edges) about a network, can compute a distance table and provide network metrics.
  *
+ * Undirected networks are best created via resizeEdgeWeights(), setEdgeWeights() and updateEdgeWeights(). In this case
+ * the edge weights are kept in a packed upper-triangle matrix (one column of frequency bins per node pair) and the
+ * thresholded network as sparse adjacency matrix (CSR). These are the only storage of the edges. The NetworkEdge and
+ * NetworkNode objects are only created on the first call to getFullEdges(), getThresholdedEdges(), getNodes() or
+ * getNodeAt(), which may happen from several threads. Like append(), the packed edge weights hold no self edges.
+ *
  * @brief This class holds information about a network, can compute a distance table and provide network metrics.
  */
 
@@ -127,7 +135,86 @@ public:
 
     //=========================================================================================================
     /**
-     * Returns the full and non thresholded edges.
+     * Returns the thresholded network as symmetric sparse adjacency matrix (CSR). The values are the averaged edge weights.
+     *
+     * @return    The thresholded adjacency matrix.
+     */
+    Eigen::SparseMatrix<double, Eigen::RowMajor> getThresholdedAdjacency() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the packed upper-triangle edge weights. Each column holds the frequency bins of one node pair,
+     * see getPairIndex().
+     *
+     * @return    The packed edge weights. Empty if the network was created via append().
+     */
+    const Eigen::MatrixXd& getEdgeWeights() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the edge weights averaged over the current frequency range, one entry per node pair.
+     *
+     * @return    The averaged edge weights. Empty if the network was created via append().
+     */
+    const Eigen::VectorXd& getAveragedEdgeWeights() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the column index of the node pair (iStartNodeID, iEndNodeID) in the packed edge weights.
+     *
+     * @param[in] iStartNodeID      The first node id.
+     * @param[in] iEndNodeID        The second node id. Must differ from iStartNodeID.
+     *
+     * @return    The pair index.
+     */
+    int getPairIndex(int iStartNodeID, int iEndNodeID) const;
+
+    //=========================================================================================================
+    /**
+     * Allocates the packed edge weights for all pairs of the currently appended nodes and sets them to zero.
+     *
+     * @param[in] iNumberFreqBins   The number of frequency bins per edge.
+     */
+    void resizeEdgeWeights(int iNumberFreqBins);
+
+    //=========================================================================================================
+    /**
+     * Sets the weights of the undirected edge between two nodes. Self edges are ignored, like in append(). Different node pairs can be
+     * set from different threads. Call updateEdgeWeights() once all weights were set.
+     *
+     * @param[in] iStartNodeID      The start node id of the edge.
+     * @param[in] iEndNodeID        The end node id of the edge.
+     * @param[in] vecWeights        The edge weight for each frequency bin.
+     */
+    void setEdgeWeights(int iStartNodeID,
+                        int iEndNodeID,
+                        const Eigen::Ref<const Eigen::VectorXd, 0, Eigen::InnerStride<> >& vecWeights);
+
+    //=========================================================================================================
+    /**
+     * Updates the averaged weights, the weight range and the thresholded adjacency after the edge weights were set.
+     */
+    void updateEdgeWeights();
+
+    //=========================================================================================================
+    /**
+     * Returns the degree of each node corresponding to the thresholded network.
+     *
+     * @return   The node degrees.
+     */
+    Eigen::VectorXi getThresholdedDegrees() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the 3D positions of the nodes, one row per node.
+     *
+     * @return   The node positions.
+     */
+    Eigen::MatrixX3f getNodeVertices() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the full and non thresholded edges. For packed edge weights the edges are created on the first call.
      *
      * @return Returns the network edges.
      */
@@ -135,7 +222,7 @@ public:
 
     //=========================================================================================================
     /**
-     * Returns the thresholded edges.
+     * Returns the thresholded edges. For packed edge weights the edges are created on the first call.
      *
      * @return Returns the network edges.
      */
@@ -143,7 +230,7 @@ public:
 
     //=========================================================================================================
     /**
-     * Returns the nodes.
+     * Returns the nodes. For packed edge weights the nodes holding the edges are created on the first call.
      *
      * @return Returns the network nodes.
      */
@@ -175,7 +262,7 @@ public:
      *
      * @return   The network distribution calculated as degrees of all nodes together.
      */
-    qint16 getFullDistribution() const;
+    qint32 getFullDistribution() const;
 
     //=========================================================================================================
     /**
@@ -183,7 +270,7 @@ public:
      *
      * @return   The network distribution calculated as degrees of all nodes together.
      */
-    qint16 getThresholdedDistribution() const;
+    qint32 getThresholdedDistribution() const;
 
     //=========================================================================================================
     /**
@@ -393,11 +480,84 @@ public:
     int getFFTSize();
 
 protected:
-    QList<QSharedPointer<NetworkEdge> >     m_lFullEdges;               /**< List with all edges of the network.*/
-    QList<QSharedPointer<NetworkEdge> >     m_lThresholdedEdges;        /**< List with all the active (thresholded) edges of the network.*/
+    /**
+     * The NetworkEdge and NetworkNode objects created from the packed edge weights. Shared between copies until
+     * one of them changes its weights or threshold.
+     */
+    struct EdgeCache {
+        QMutex                                  mutex;                  /**< Guards the creation of the edges.*/
+        bool                                    bIsValid = false;       /**< Whether the edges were created.*/
+        QList<QSharedPointer<NetworkEdge> >     lFullEdges;             /**< All edges.*/
+        QList<QSharedPointer<NetworkEdge> >     lThresholdedEdges;      /**< The active edges.*/
+        QList<QSharedPointer<NetworkNode> >     lNodes;                 /**< The nodes holding the edges.*/
+    };
+
+    //=========================================================================================================
+    /**
+     * Returns whether the edges are kept in the packed edge weights.
+     *
+     * @return   Whether the packed edge weights are used.
+     */
+    bool hasEdgeWeights() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the edge cache and creates the NetworkEdge objects and the nodes holding them from the packed edge
+     * weights if this was not done yet. Can be called from several threads.
+     *
+     * @return   The edge cache.
+     */
+    const EdgeCache& getEdgeCache() const;
+
+    //=========================================================================================================
+    /**
+     * Drops the created edges after the packed edge weights, the frequency range or the threshold changed.
+     */
+    void invalidateEdges();
+
+    //=========================================================================================================
+    /**
+     * Creates the NetworkEdge objects and the nodes holding them from the packed edge weights.
+     *
+     * @param[out] edgeCache    The cache to store the edges and nodes in.
+     */
+    void createEdges(EdgeCache& edgeCache) const;
+
+    //=========================================================================================================
+    /**
+     * Averages the packed edge weights over the current frequency bins.
+     */
+    void updateAveragedEdgeWeights();
+
+    //=========================================================================================================
+    /**
+     * Rebuilds the thresholded adjacency from the averaged edge weights.
+     */
+    void updateThresholdedAdjacency();
+
+    //=========================================================================================================
+    /**
+     * Computes the in and out degrees of all nodes from the packed edge weights.
+     *
+     * @param[in] bThresholded      Whether to use the thresholded or the full network.
+     * @param[out] vecIndegrees     The indegree of each node.
+     * @param[out] vecOutdegrees    The outdegree of each node.
+     */
+    void computeDegrees(bool bThresholded,
+                        Eigen::VectorXi& vecIndegrees,
+                        Eigen::VectorXi& vecOutdegrees) const;
+
+    QList<QSharedPointer<NetworkEdge> >     m_lFullEdges;               /**< List with all edges of the network, if created via append().*/
+    QList<QSharedPointer<NetworkEdge> >     m_lThresholdedEdges;        /**< List with all the active (thresholded) edges of the network, if created via append().*/
 
     QList<QSharedPointer<NetworkNode> >     m_lNodes;                   /**< List with all nodes of the network.*/
 
+    QSharedPointer<Eigen::MatrixXd>                 m_pMatEdgeWeights;          /**< The packed upper-triangle edge weights (frequency bins x node pairs). Shared between copies like the edge objects.*/
+    Eigen::VectorXd                                 m_vecAveragedEdgeWeights;   /**< The edge weights averaged over the current frequency bins.*/
+    Eigen::SparseMatrix<double, Eigen::RowMajor>    m_matThresholdedAdjacency;  /**< The symmetric adjacency of the thresholded network.*/
+    QPair<int,int>                                  m_minMaxFreqBins;           /**< The lower/upper bin to average the packed edge weights from/to. -1 means all bins.*/
+    QSharedPointer<EdgeCache>                       m_pEdgeCache;               /**< The edge objects created on demand from the packed edge weights.*/
+
     Eigen::MatrixXd                         m_matDistMatrix;            /**< The distance matrix.*/
 
     QString                                 m_sConnectivityMethod;      /**< The connectivity measure method used to create the data of this network structure.*/
@@ -45,6 +45,7 @@
 
 #include <QGridLayout>
 #include <QSpinBox>
+#include <QDoubleSpinBox>
 #include <QLabel>
 #include <QSettings>
 
@@ -82,6 +83,24 @@ CovarianceSettingsView::CovarianceSettingsView(const QString& sSettingsPath,
     connect(m_pSpinBoxNumSamples, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged),
             this, &CovarianceSettingsView::samplesChanged);
     t_pGridLayout->addWidget(m_pSpinBoxNumSamples,0,1,1,1);
+
+    QLabel* t_pLabelForgettingFactor = new QLabel;
+    t_pLabelForgettingFactor->setText("Forgetting Factor");
+    t_pGridLayout->addWidget(t_pLabelForgettingFactor,1,0,1,1);
+
+    m_pDoubleSpinBoxForgettingFactor = new QDoubleSpinBox;
+    m_pDoubleSpinBoxForgettingFactor->setDecimals(5);
+    m_pDoubleSpinBoxForgettingFactor->setMinimum(0.99);
+    m_pDoubleSpinBoxForgettingFactor->setMaximum(1.0);
+    m_pDoubleSpinBoxForgettingFactor->setSingleStep(0.0001);
+    m_pDoubleSpinBoxForgettingFactor->setValue(1.0);
+    m_pDoubleSpinBoxForgettingFactor->setToolTip("Per sample forgetting factor. 1 weights all samples of a window equally. "
+                                                 "Below 1, older samples are down weighted exponentially, which results "
+                                                 "in a sliding window of about 1/(1-factor) samples.");
+    connect(m_pDoubleSpinBoxForgettingFactor, static_cast<void (QDoubleSpinBox::*)(double)>(&QDoubleSpinBox::valueChanged),
+            this, &CovarianceSettingsView::forgettingFactorChanged);
+    t_pGridLayout->addWidget(m_pDoubleSpinBoxForgettingFactor,1,1,1,1);
+
     this->setLayout(t_pGridLayout);
 
     loadSettings();
@@ -111,6 +130,13 @@ void CovarianceSettingsView::setMinSamples(int iSamples)
 
 //=============================================================================================================
 
+void CovarianceSettingsView::setCurrentForgettingFactor(double dForgettingFactor)
+{
+    m_pDoubleSpinBoxForgettingFactor->setValue(dForgettingFactor);
+}
+
+//=============================================================================================================
+
 void CovarianceSettingsView::saveSettings()
 {
     if(m_sSettingsPath.isEmpty()) {
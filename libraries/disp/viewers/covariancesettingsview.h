@@ -104,6 +104,14 @@ public:
      */
     void setMinSamples(int iSamples);
 
+    //=========================================================================================================
+    /**
+     * Set the per sample forgetting factor of the covariance estimation.
+     *
+     * @param[in] dForgettingFactor    new forgetting factor. 1 weights all samples equally.
+     */
+    void setCurrentForgettingFactor(double dForgettingFactor);
+
     //=========================================================================================================
     /**
      * Saves all important settings of this view via QSettings.
@@ -141,9 +149,11 @@ protected:
 
 signals:
     void samplesChanged(int iSamples);
+    void forgettingFactorChanged(double dForgettingFactor);
 
 private:
     QSpinBox*       m_pSpinBoxNumSamples;
+    QDoubleSpinBox* m_pDoubleSpinBoxForgettingFactor;
     QString         m_sSettingsPath;            /**< The settings path to store the GUI settings to. */
 
 };
@@ -50,6 +50,7 @@
 #include <QGridLayout>
 #include <QPushButton>
 #include <QSettings>
+#include <QSpinBox>
 
 //=============================================================================================================
 // EIGEN INCLUDES
@@ -76,6 +77,8 @@ FilterSettingsView::FilterSettingsView(const QString& sSettingsPath,
 
     m_pUi->setupUi(this);
 
+    setPartitionSizeVisible(false);
+
     loadSettings();
 
     //Create and connect design viewer
@@ -107,6 +110,8 @@ FilterSettingsView::FilterSettingsView(const QString& sSettingsPath,
             this, &FilterSettingsView::onFilterToChanged);
     connect(m_pUi->m_pcomboBoxChannelTypes, &QComboBox::currentTextChanged,
             this, &FilterSettingsView::onFilterChannelTypeChanged);
+    connect(m_pUi->m_pSpinBoxPartitionSize, &QSpinBox::editingFinished,
+            this, &FilterSettingsView::onFilterPartitionSizeChanged);
 }
 
 //=============================================================================================================
@@ -133,6 +138,13 @@ bool FilterSettingsView::getFilterActive()
 
 //=============================================================================================================
 
+int FilterSettingsView::getFilterPartitionSize()
+{
+    return m_pUi->m_pSpinBoxPartitionSize->value();
+}
+
+//=============================================================================================================
+
 void FilterSettingsView::setSamplingRate(double dSFreq)
 {
     //Update min max of spin boxes to nyquist
@@ -154,6 +166,15 @@ void FilterSettingsView::setSamplingRate(double dSFreq)
 
 //=============================================================================================================
 
+void FilterSettingsView::setPartitionSizeVisible(bool bVisible)
+{
+    m_pUi->m_pLabelPartitionSize->setVisible(bVisible);
+    m_pUi->m_pSpinBoxPartitionSize->setVisible(bVisible);
+    m_pUi->m_pLabelCausalFilter->setVisible(bVisible);
+}
+
+//=============================================================================================================
+
 void FilterSettingsView::saveSettings()
 {
     if(m_sSettingsPath.isEmpty()) {
@@ -166,6 +187,7 @@ void FilterSettingsView::saveSettings()
     settings.setValue(m_sSettingsPath + QString("/FilterSettingsView/filterFrom"), m_pUi->m_pDoubleSpinBoxFrom->value());
     settings.setValue(m_sSettingsPath + QString("/FilterSettingsView/filterTo"), m_pUi->m_pDoubleSpinBoxTo->value());
     settings.setValue(m_sSettingsPath + QString("/FilterSettingsView/filterChannelType"), m_pUi->m_pcomboBoxChannelTypes->currentText());
+    settings.setValue(m_sSettingsPath + QString("/FilterSettingsView/filterPartitionSize"), m_pUi->m_pSpinBoxPartitionSize->value());
 }
 
 //=============================================================================================================
@@ -182,6 +204,7 @@ void FilterSettingsView::loadSettings()
     m_pUi->m_pDoubleSpinBoxTo->setValue(settings.value(m_sSettingsPath + QString("/FilterSettingsView/filterTo"), 0).toDouble());
     m_pUi->m_pDoubleSpinBoxFrom->setValue(settings.value(m_sSettingsPath + QString("/FilterSettingsView/filterFrom"), 0).toDouble());
     m_pUi->m_pcomboBoxChannelTypes->setCurrentText(settings.value(m_sSettingsPath + QString("/FilterSettingsView/filterChannelType"), "All").toString());
+    m_pUi->m_pSpinBoxPartitionSize->setValue(settings.value(m_sSettingsPath + QString("/FilterSettingsView/filterPartitionSize"), 0).toInt());
 }
 
 //=============================================================================================================
@@ -267,6 +290,15 @@ void FilterSettingsView::onFilterChannelTypeChanged(const QString& sType)
 
 //=============================================================================================================
 
+void FilterSettingsView::onFilterPartitionSizeChanged()
+{
+    emit filterPartitionSizeChanged(m_pUi->m_pSpinBoxPartitionSize->value());
+
+    saveSettings();
+}
+
+//=============================================================================================================
+
 void FilterSettingsView::clearView()
 {
 
@@ -117,6 +117,14 @@ public:
      */
     bool getFilterActive();
 
+    //=========================================================================================================
+    /**
+     * Returns the partition size of the real-time filter.
+     *
+     * @return The partition size in samples. 0 derives the partition size from the incoming data blocks.
+     */
+    int getFilterPartitionSize();
+
     //=========================================================================================================
     /**
      * Sets the sampling frequency and setups this view accrodingly.
@@ -125,6 +133,15 @@ public:
      */
     void setSamplingRate(double dSFreq);
 
+    //=========================================================================================================
+    /**
+     * Shows or hides the partition size of the real-time filter. Only views whose filtering is done with
+     * RTPROCESSINGLIB::FilterPartitioned should show it. Hidden by default.
+     *
+     * @param[in] bVisible     Whether to show the partition size.
+     */
+    void setPartitionSizeVisible(bool bVisible);
+
     //=========================================================================================================
     /**
      * Saves all important settings of this view via QSettings.
@@ -150,6 +167,14 @@ signals:
      */
     void filterActivationChanged(bool activated);
 
+    //=========================================================================================================
+    /**
+     * Signal emited when the partition size of the real-time filter changed.
+     *
+     * @param[in] iPartitionSize   The partition size in samples, 0 for automatic.
+     */
+    void filterPartitionSizeChanged(int iPartitionSize);
+
 protected:
     //=========================================================================================================
     /**
@@ -199,6 +224,12 @@ protected:
      */
     void onFilterChannelTypeChanged(const QString& sType);
 
+    //=========================================================================================================
+    /**
+     * This function is called whenever the partition size changed
+     */
+    void onFilterPartitionSizeChanged();
+
     QString                                 m_sSettingsPath;                /**< The settings path to store the GUI settings to. */
 
     QSharedPointer<FilterDesignView>        m_pFilterView;                  /**< The filter view. */
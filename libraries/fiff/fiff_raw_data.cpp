@@ -43,6 +43,17 @@
 #include "fiff_stream.h"
 #include "cstdlib"
 
+#include <algorithm>
+#include <cstring>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+#include <QFile>
+#include <QMutexLocker>
+
 //=============================================================================================================
 // USED NAMESPACES
 //=============================================================================================================
@@ -50,6 +61,140 @@
 using namespace FIFFLIB;
 using namespace Eigen;
 
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+/**
+ * Reads one value of type T from a memory mapped raw buffer and converts it to the native byte order.
+ */
+template<typename T>
+static inline T read_mapped_value(const uchar* pSource,
+                                  bool bSwap)
+{
+    T value;
+
+    if(bSwap) {
+        uchar swapped[sizeof(T)];
+        for(size_t b = 0; b < sizeof(T); ++b) {
+            swapped[b] = pSource[sizeof(T) - 1 - b];
+        }
+        std::memcpy(&value, swapped, sizeof(T));
+    } else {
+        std::memcpy(&value, pSource, sizeof(T));
+    }
+
+    return value;
+}
+
+//=============================================================================================================
+/**
+ * Decodes the samples first_pick ... first_pick + dest.cols() - 1 of a channel x sample raw buffer stored as T.
+ * Rows are picked with sel (all channels if empty) and scaled with the per channel factors in scale (no scaling
+ * if empty).
+ */
+template<typename T>
+static void decode_mapped_buffer(const uchar* pBuffer,
+                                 bool bSwap,
+                                 qint32 nchan,
+                                 qint32 first_pick,
+                                 const RowVectorXi& sel,
+                                 const RowVectorXd& scale,
+                                 Ref<MatrixXd> dest)
+{
+    const bool bPick = sel.size() > 0;
+    const bool bScale = scale.size() > 0;
+
+    for(Index c = 0; c < dest.cols(); ++c) {
+        const uchar* pSample = pBuffer + (first_pick + c) * nchan * sizeof(T);
+
+        for(Index r = 0; r < dest.rows(); ++r) {
+            const qint32 ch = bPick ? sel[r] : r;
+            const double value = static_cast<double>(read_mapped_value<T>(pSample + ch * sizeof(T), bSwap));
+            dest(r,c) = bScale ? scale[ch] * value : value;
+        }
+    }
+}
+
+//=============================================================================================================
+/**
+ * Decodes the picked samples of a memory mapped raw buffer straight into dest, applying either the calibration
+ * (mult is empty) or the full compensation/projection/calibration operator. Returns false if the buffer type is not
+ * supported by the mapped route, in which case the caller falls back to reading the tag.
+ */
+static bool read_mapped_buffer(const uchar* pBuffer,
+                               fiff_int_t type,
+                               fiff_int_t size,
+                               bool bSwap,
+                               qint32 nchan,
+                               qint32 nsamp,
+                               qint32 first_pick,
+                               const RowVectorXi& sel,
+                               const RowVectorXd& cals,
+                               const SparseMatrix<double>& mult,
+                               MatrixXd& scratch,
+                               Ref<MatrixXd> dest)
+{
+    size_t iValueSize;
+    switch(type) {
+        case FIFFT_SHORT:
+        case FIFFT_DAU_PACK16:
+            iValueSize = sizeof(qint16);
+            break;
+        case FIFFT_INT:
+            iValueSize = sizeof(qint32);
+            break;
+        case FIFFT_FLOAT:
+            iValueSize = sizeof(float);
+            break;
+        case FIFFT_DOUBLE:
+            iValueSize = sizeof(double);
+            break;
+        default:
+            return false;
+    }
+
+    if(size < 0 || static_cast<size_t>(size) != static_cast<size_t>(nchan) * nsamp * iValueSize) {
+        return false;
+    }
+
+    //
+    //  Without projection the calibration is applied while decoding, otherwise all channels are decoded first
+    //
+    const RowVectorXi noSel;
+    const RowVectorXd noScale;
+
+    if(mult.cols() != 0) {
+        scratch.resize(nchan, dest.cols());
+    }
+
+    const RowVectorXi& decodeSel = mult.cols() == 0 ? sel : noSel;
+    const RowVectorXd& decodeScale = mult.cols() == 0 ? cals : noScale;
+    Ref<MatrixXd> decodeDest = mult.cols() == 0 ? dest : Ref<MatrixXd>(scratch);
+
+    switch(type) {
+        case FIFFT_SHORT:
+        case FIFFT_DAU_PACK16:
+            decode_mapped_buffer<qint16>(pBuffer, bSwap, nchan, first_pick, decodeSel, decodeScale, decodeDest);
+            break;
+        case FIFFT_INT:
+            decode_mapped_buffer<qint32>(pBuffer, bSwap, nchan, first_pick, decodeSel, decodeScale, decodeDest);
+            break;
+        case FIFFT_FLOAT:
+            decode_mapped_buffer<float>(pBuffer, bSwap, nchan, first_pick, decodeSel, decodeScale, decodeDest);
+            break;
+        case FIFFT_DOUBLE:
+            decode_mapped_buffer<double>(pBuffer, bSwap, nchan, first_pick, decodeSel, decodeScale, decodeDest);
+            break;
+    }
+
+    if(mult.cols() != 0) {
+        dest = mult * scratch;
+    }
+
+    return true;
+}
+
 //=============================================================================================================
 // DEFINE MEMBER METHODS
 //=============================================================================================================
@@ -57,6 +202,7 @@ using namespace Eigen;
 FiffRawData::FiffRawData()
 : first_samp(-1)
 , last_samp(-1)
+, m_pSegmentOperatorCache(new SegmentOperatorCache)
 {
 }
 
@@ -65,6 +211,7 @@ FiffRawData::FiffRawData()
 FiffRawData::FiffRawData(QIODevice &p_IODevice)
 : first_samp(-1)
 , last_samp(-1)
+, m_pSegmentOperatorCache(new SegmentOperatorCache)
 {
     //setup FiffRawData object
     if(!FiffStream::setup_read_raw(p_IODevice, *this))
@@ -80,6 +227,7 @@ FiffRawData::FiffRawData(QIODevice &p_IODevice)
 FiffRawData::FiffRawData(QIODevice &p_IODevice, bool b_littleEndian)
 : first_samp(-1)
 , last_samp(-1)
+, m_pSegmentOperatorCache(new SegmentOperatorCache)
 {
     //setup FiffRawData object
     if(!FiffStream::setup_read_raw(p_IODevice, *this, false, b_littleEndian))
@@ -101,6 +249,7 @@ FiffRawData::FiffRawData(const FiffRawData &p_FiffRawData)
 , rawdir(p_FiffRawData.rawdir)
 , proj(p_FiffRawData.proj)
 , comp(p_FiffRawData.comp)
+, m_pSegmentOperatorCache(new SegmentOperatorCache)
 {
 }
 
@@ -121,11 +270,13 @@ void FiffRawData::clear()
     rawdir.clear();
     proj = MatrixXd();
     comp.clear();
+
+    QMutexLocker locker(&m_pSegmentOperatorCache->mutex);
+    m_pSegmentOperatorCache->valid = false;
 }
 
 //=============================================================================================================
-#include <QElapsedTimer>
-#include <QDebug>
+
 bool FiffRawData::read_raw_segment(MatrixXd& data,
                                    MatrixXd& times,
                                    fiff_int_t from,
@@ -133,13 +284,20 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
                                    const RowVectorXi& sel,
                                    bool do_debug) const
 {
-    bool projAvailable = true;
+    SparseMatrix<double> multSegment;
+    return read_raw_segment(data, times, multSegment, from, to, sel, do_debug);
+}
 
-    if (this->proj.size() == 0) {
-        //qDebug() << "FiffRawData::read_raw_segment - No projectors setup. Consider calling MNE::setup_compensators.";
-        projAvailable = false;
-    }
+//=============================================================================================================
 
+bool FiffRawData::read_raw_segment(MatrixXd& data,
+                                   MatrixXd& times,
+                                   SparseMatrix<double>& multSegment,
+                                   fiff_int_t from,
+                                   fiff_int_t to,
+                                   const RowVectorXi& sel,
+                                   bool do_debug) const
+{
     if(from == -1)
         from = this->first_samp;
     if(to == -1)
@@ -159,280 +317,105 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
     }
     //printf("Reading %d ... %d  =  %9.3f ... %9.3f secs...", from, to, ((float)from)/this->info.sfreq, ((float)to)/this->info.sfreq);
     //
-    //  Initialize the data and calibration vector
+    //  Initialize the data and get the calibration and projection operators
     //
     qint32 nchan = this->info.nchan;
     qint32 dest  = 0;//1;
-    qint32 i, k, r;
-
-    typedef Eigen::Triplet<double> T;
-    std::vector<T> tripletList;
-    tripletList.reserve(nchan);
-    for(i = 0; i < nchan; ++i)
-        tripletList.push_back(T(i, i, this->cals[i]));
+    qint32 i, k;
 
-    SparseMatrix<double> cal(nchan, nchan);
-    cal.setFromTriplets(tripletList.begin(), tripletList.end());
-//    cal.makeCompressed();
+    SparseMatrix<double> cal, mult;
+    get_segment_operator(sel, cal, mult);
 
-    MatrixXd mult_full;
-    //
-    if (sel.size() == 0)
-    {
-        data = MatrixXd(nchan, to-from+1);
-//            data->setZero();
-        if (projAvailable || this->comp.kind != -1)
-        {
-            if (!projAvailable)
-                mult_full = this->comp.data->data*cal;
-            else if (this->comp.kind == -1)
-                mult_full = this->proj*cal;
-            else
-                mult_full = this->proj*this->comp.data->data*cal;
-        }
-    }
-    else
-    {
-        data = MatrixXd(sel.size(),to-from+1);
-//            data->setZero();
-
-        MatrixXd selVect(sel.size(), nchan);
+    data = MatrixXd(sel.size() == 0 ? nchan : sel.size(), to-from+1);
 
-        selVect.setZero();
-
-        if (!projAvailable && this->comp.kind == -1)
-        {
-            tripletList.clear();
-            tripletList.reserve(sel.size());
-            for(i = 0; i < sel.size(); ++i)
-                tripletList.push_back(T(i, i, this->cals[sel[i]]));
-            cal = SparseMatrix<double>(sel.size(), sel.size());
-            cal.setFromTriplets(tripletList.begin(), tripletList.end());
-        }
-        else
-        {
-            if (!projAvailable)
-            {
-                qDebug() << "This has to be debugged! #1";
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->comp.data->data.block(sel[i],0,1,nchan);
-                mult_full = selVect*cal;
-            }
-            else if (this->comp.kind == -1)
-            {
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->proj.block(sel[i],0,1,nchan);
-
-                mult_full = selVect*cal;
-            }
-            else
-            {
-                qDebug() << "This has to be debugged! #3";
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->proj.block(sel[i],0,1,nchan);
-
-                mult_full = selVect*this->comp.data->data*cal;
-            }
-        }
-    }
-
-    //
-    // Make mult sparse
-    //
-    tripletList.clear();
-    tripletList.reserve(mult_full.rows()*mult_full.cols());
-    for(i = 0; i < mult_full.rows(); ++i)
-        for(k = 0; k < mult_full.cols(); ++k)
-            if(mult_full(i,k) != 0)
-                tripletList.push_back(T(i, k, mult_full(i,k)));
-
-    SparseMatrix<double> mult(mult_full.rows(),mult_full.cols());
-    if(tripletList.size() > 0)
-        mult.setFromTriplets(tripletList.begin(), tripletList.end());
-//    mult.makeCompressed();
-
-    FiffStream::SPtr fid;
     if (!this->file->device()->isOpen())
     {
         if (!this->file->device()->open(QIODevice::ReadOnly))
         {
             printf("Cannot open file %s",this->info.filename.toUtf8().constData());
         }
-        fid = this->file;
-    }
-    else
-    {
-        fid = this->file;
     }
 
-    MatrixXd one, newData, tmp_data;
-    FiffRawDir thisRawDir;
-    FiffTag::SPtr t_pTag;
+    const qint32 kFirst = find_raw_buffer(from);
+
+    qint64 iMapOffset = 0;
+    uchar* pMapped = map_raw_buffers(kFirst, to, iMapOffset);
+
+    MatrixXd scratch;
     fiff_int_t first_pick, last_pick, picksamp;
-    for(k = 0; k < this->rawdir.size(); ++k)
+    for(k = kFirst; k < this->rawdir.size(); ++k)
     {
-        thisRawDir = this->rawdir[k];
+        const FiffRawDir& thisRawDir = this->rawdir[k];
         //
-        //  Do we need this buffer
+        //  The picking logic is a bit complicated
         //
-        if (thisRawDir.last > from)
+        if (to >= thisRawDir.last && from <= thisRawDir.first)
         {
-            if (thisRawDir.ent->kind == -1)
-            {
-                //
-                //  Take the easy route: skip is translated to zeros
-                //
-                if(do_debug)
-                    printf("S");
-                if (sel.cols() <= 0)
-                    one.resize(nchan,thisRawDir.nsamp);
-                else
-                    one.resize(sel.cols(),thisRawDir.nsamp);
-
-                one.setZero();
-            }
-            else
-            {
-                fid->read_tag(t_pTag, thisRawDir.ent->pos);
-                //
-                //   Depending on the state of the projection and selection
-                //   we proceed a little bit differently
-                //
-                if (mult.cols() == 0)
-                {
-                    if (sel.cols() == 0)
-                    {
-                        if (t_pTag->type == FIFFT_DAU_PACK16)
-                            one = cal*(Map< MatrixDau16 >( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else if(t_pTag->type == FIFFT_INT)
-                            one = cal*(Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else if(t_pTag->type == FIFFT_FLOAT)
-                            one = cal*(Map< MatrixXf >( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else if(t_pTag->type == FIFFT_SHORT)
-                            one = cal*(Map< MatrixShort >( t_pTag->toShort(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else
-                            printf("Data Storage Format not known yet [1]!! Type: %d\n", t_pTag->type);
-                    }
-                    else
-                    {
-                        //ToDo find a faster solution for this!! --> make cal and mul sparse like in MATLAB
-                        newData.resize(sel.cols(), thisRawDir.nsamp); //ToDo this can be done much faster, without newData
-
-                        if (t_pTag->type == FIFFT_DAU_PACK16)
-                        {
-                            tmp_data = (Map< MatrixDau16 > ( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
-
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else if(t_pTag->type == FIFFT_INT)
-                        {
-                            tmp_data = (Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
-
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else if(t_pTag->type == FIFFT_FLOAT)
-                        {
-                            tmp_data = (Map< MatrixXf > ( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
-
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else if(t_pTag->type == FIFFT_SHORT)
-                        {
-                            tmp_data = (Map< MatrixShort > ( t_pTag->toShort(),nchan, thisRawDir.nsamp)).cast<double>();
-
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else
-                        {
-                            printf("Data Storage Format not known yet [2]!! Type: %d\n", t_pTag->type);
-                        }
-
-                        one = cal*newData;
-                    }
-                }
-                else
-                {
-                    if (t_pTag->type == FIFFT_DAU_PACK16)
-                        one = mult*(Map< MatrixDau16 >( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
-                    else if(t_pTag->type == FIFFT_INT)
-                        one = mult*(Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
-                    else if(t_pTag->type == FIFFT_FLOAT)
-                        one = mult*(Map< MatrixXf >( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
-                    else
-                        printf("Data Storage Format not known yet [3]!! Type: %d\n", t_pTag->type);
-                }
-            }
             //
-            //  The picking logic is a bit complicated
+            //  We need the whole buffer
             //
-            if (to >= thisRawDir.last && from <= thisRawDir.first)
+            first_pick = 0;//1;
+            last_pick  = thisRawDir.nsamp - 1;
+            if (do_debug)
+                printf("W");
+        }
+        else if (from > thisRawDir.first)
+        {
+            first_pick = from - thisRawDir.first;// + 1;
+            if(to < thisRawDir.last)
             {
                 //
-                //  We need the whole buffer
+                //  Something from the middle
                 //
-                first_pick = 0;//1;
-                last_pick  = thisRawDir.nsamp - 1;
+                last_pick = thisRawDir.nsamp + to - thisRawDir.last - 1;
                 if (do_debug)
-                    printf("W");
-            }
-            else if (from > thisRawDir.first)
-            {
-                first_pick = from - thisRawDir.first;// + 1;
-                if(to < thisRawDir.last)
-                {
-                    //
-                    //  Something from the middle
-                    //
-//                    qDebug() << "This needs to be debugged!";
-                    last_pick = thisRawDir.nsamp + to - thisRawDir.last - 1;//is this alright?
-                    if (do_debug)
-                        printf("M");
-                }
-                else
-                {
-                    //
-                    //  From the middle to the end
-                    //
-                    last_pick = thisRawDir.nsamp - 1;
-                    if (do_debug)
-                        printf("E");
-                }
+                    printf("M");
             }
             else
             {
                 //
-                //  From the beginning to the middle
+                //  From the middle to the end
                 //
-                first_pick = 0;//1;
-                last_pick  = to - thisRawDir.first;// + 1;
+                last_pick = thisRawDir.nsamp - 1;
                 if (do_debug)
-                    printf("B");
+                    printf("E");
             }
+        }
+        else
+        {
             //
-            //  Now we are ready to pick
+            //  From the beginning to the middle
             //
-            picksamp = last_pick - first_pick + 1;
-
-            if(do_debug)
-            {
-                qDebug() << "first_pick: " << first_pick;
-                qDebug() << "last_pick: " << last_pick;
-                qDebug() << "picksamp: " << picksamp;
-            }
+            first_pick = 0;//1;
+            last_pick  = to - thisRawDir.first;// + 1;
+            if (do_debug)
+                printf("B");
+        }
+        //
+        //  Now we are ready to pick
+        //
+        picksamp = last_pick - first_pick + 1;
 
-            if (picksamp > 0)
-            {
-//                    for(r = 0; r < data->rows(); ++r)
-//                        for(c = 0; c < picksamp; ++c)
-//                            (*data)(r,dest + c) = one(r,first_pick + c);
-                data.block(0,dest,data.rows(),picksamp) = one.block(0, first_pick, data.rows(), picksamp);
+        if(do_debug)
+        {
+            qDebug() << "first_pick: " << first_pick;
+            qDebug() << "last_pick: " << last_pick;
+            qDebug() << "picksamp: " << picksamp;
+        }
 
-                dest += picksamp;
-            }
+        if (picksamp > 0)
+        {
+            read_raw_buffer(thisRawDir,
+                            pMapped,
+                            iMapOffset,
+                            first_pick,
+                            sel,
+                            cal,
+                            mult,
+                            scratch,
+                            data.block(0,dest,data.rows(),picksamp));
+
+            dest += picksamp;
         }
         //
         //  Done?
@@ -444,9 +427,12 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
         }
     }
 
-    if (!this->file->device()->isOpen()) {
-        this->file->device()->close();
-    }
+    unmap_raw_buffers(pMapped);
+
+    if(mult.cols()==0)
+        multSegment = cal;
+    else
+        multSegment = mult;
 
     times = MatrixXd(1, to-from+1);
 
@@ -458,45 +444,181 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
 
 //=============================================================================================================
 
-bool FiffRawData::read_raw_segment(MatrixXd& data,
-                                   MatrixXd& times,
-                                   SparseMatrix<double>& multSegment,
-                                   fiff_int_t from,
-                                   fiff_int_t to,
-                                   const RowVectorXi& sel,
-                                   bool do_debug) const
+bool FiffRawData::read_raw_segments(QList<MatrixXd>& data,
+                                    const QVector<QPair<int,int> >& ranges,
+                                    const RowVectorXi& sel,
+                                    const std::function<void(int)>& segmentRead) const
 {
-    bool projAvailable = true;
+    data.clear();
 
-    if (this->proj.size() == 0) {
-        //qInfo() << "FiffRawData::read_raw_segment - No projectors setup. Consider calling MNE::setup_compensators.";
-        projAvailable = false;
+    if(ranges.isEmpty()) {
+        return true;
     }
 
-    if(from == -1)
-        from = this->first_samp;
-    if(to == -1)
-        to = this->last_samp;
+    qint32 nchan = this->info.nchan;
+    qint32 nrow = sel.size() == 0 ? nchan : sel.size();
+    qint32 i, k;
+    bool bAllRead = true;
+
     //
-    //  Initial checks
+    //  Clamp the ranges to the available data and order them by their first sample
     //
-    if(from < this->first_samp)
-        from = this->first_samp;
-    if(to > this->last_samp)
-        to = this->last_samp;
+    QVector<QPair<int,int> > clamped(ranges.size());
+    QVector<int> order;
+    order.reserve(ranges.size());
+
+    for(i = 0; i < ranges.size(); ++i) {
+        clamped[i].first = qMax(ranges[i].first, static_cast<int>(this->first_samp));
+        clamped[i].second = qMin(ranges[i].second, static_cast<int>(this->last_samp));
+
+        if(clamped[i].first > clamped[i].second) {
+            printf("No data in this range %d ... %d\n", ranges[i].first, ranges[i].second);
+            data.append(MatrixXd());
+            bAllRead = false;
+        } else {
+            data.append(MatrixXd(nrow, clamped[i].second - clamped[i].first + 1));
+            order.append(i);
+        }
+    }
+
+    std::stable_sort(order.begin(), order.end(), [&clamped](int a, int b) {
+        return clamped[a].first < clamped[b].first;
+    });
+
     //
-    if(from > to)
+    //  Segments which cannot be read are reported right away
+    //
+    if(segmentRead) {
+        for(i = 0; i < data.size(); ++i) {
+            if(data[i].size() == 0) {
+                segmentRead(i);
+            }
+        }
+    }
+
+    if(order.isEmpty()) {
+        return bAllRead;
+    }
+
+    SparseMatrix<double> cal, mult;
+    get_segment_operator(sel, cal, mult);
+
+    if (!this->file->device()->isOpen())
     {
-        printf("No data in this range\n");
-        return false;
+        if (!this->file->device()->open(QIODevice::ReadOnly))
+        {
+            printf("Cannot open file %s",this->info.filename.toUtf8().constData());
+        }
     }
-    //printf("Reading %d ... %d  =  %9.3f ... %9.3f secs...", from, to, ((float)from)/this->info.sfreq, ((float)to)/this->info.sfreq);
+
+    fiff_int_t to = clamped[order.first()].second;
+    for(i = 1; i < order.size(); ++i) {
+        to = qMax(to, static_cast<fiff_int_t>(clamped[order[i]].second));
+    }
+
+    const qint32 kFirst = find_raw_buffer(clamped[order.first()].first);
+
+    qint64 iMapOffset = 0;
+    uchar* pMapped = map_raw_buffers(kFirst, to, iMapOffset);
+
     //
-    //  Initialize the data and calibration vector
+    //  Sweep once over the raw buffers. Each buffer which is needed by at least one segment is decoded once and
+    //  scattered into all segments overlapping it. A segment is handed to segmentRead as soon as its last buffer
+    //  was scattered.
     //
+    MatrixXd one, scratch;
+    QList<int> active;
+    qint32 next = 0;
+
+    for(k = kFirst; k < this->rawdir.size() && (next < order.size() || !active.isEmpty()); ++k)
+    {
+        const FiffRawDir& thisRawDir = this->rawdir[k];
+
+        while(next < order.size() && clamped[order[next]].first <= thisRawDir.last) {
+            active.append(order[next]);
+            ++next;
+        }
+
+        if(active.isEmpty()) {
+            //
+            //  Skip ahead to the buffer holding the start of the next segment
+            //
+            k = find_raw_buffer(clamped[order[next]].first) - 1;
+            continue;
+        }
+
+        one.resize(nrow, thisRawDir.nsamp);
+        read_raw_buffer(thisRawDir,
+                        pMapped,
+                        iMapOffset,
+                        0,
+                        sel,
+                        cal,
+                        mult,
+                        scratch,
+                        one);
+
+        QMutableListIterator<int> itActive(active);
+        while(itActive.hasNext()) {
+            const int seg = itActive.next();
+            const fiff_int_t first_copy = qMax(clamped[seg].first, static_cast<int>(thisRawDir.first));
+            const fiff_int_t last_copy = qMin(clamped[seg].second, static_cast<int>(thisRawDir.last));
+
+            if(last_copy >= first_copy) {
+                data[seg].block(0, first_copy - clamped[seg].first, nrow, last_copy - first_copy + 1)
+                        = one.block(0, first_copy - thisRawDir.first, nrow, last_copy - first_copy + 1);
+            }
+
+            if(clamped[seg].second <= thisRawDir.last) {
+                itActive.remove();
+                if(segmentRead) {
+                    segmentRead(seg);
+                }
+            }
+        }
+    }
+
+    unmap_raw_buffers(pMapped);
+
+    return bAllRead;
+}
+
+//=============================================================================================================
+
+void FiffRawData::get_segment_operator(const RowVectorXi& sel,
+                                       SparseMatrix<double>& cal,
+                                       SparseMatrix<double>& mult) const
+{
+    QMutexLocker locker(&m_pSegmentOperatorCache->mutex);
+    SegmentOperatorCache& cache = *m_pSegmentOperatorCache;
+
+    const bool compAvailable = this->comp.kind != -1 && this->comp.data;
+
+    //
+    //  Reuse the operators if nothing they depend on changed
+    //
+    if(cache.valid
+       && cache.sel.size() == sel.size() && cache.sel == sel
+       && cache.cals.size() == this->cals.size() && cache.cals == this->cals
+       && cache.proj.rows() == this->proj.rows() && cache.proj.cols() == this->proj.cols() && cache.proj == this->proj
+       && cache.compKind == (compAvailable ? this->comp.kind : -1)
+       && (!compAvailable || (cache.comp.rows() == this->comp.data->data.rows()
+                              && cache.comp.cols() == this->comp.data->data.cols()
+                              && cache.comp == this->comp.data->data))) {
+        cal = cache.cal;
+        mult = cache.mult;
+        return;
+    }
+
+    bool projAvailable = true;
+
+    if (this->proj.size() == 0) {
+        //qInfo() << "FiffRawData::read_raw_segment - No projectors setup. Consider calling MNE::setup_compensators.";
+        projAvailable = false;
+    }
+
     qint32 nchan = this->info.nchan;
-    qint32 dest  = 0;//1;
-    qint32 i, k, r;
+    qint32 i, k;
 
     typedef Eigen::Triplet<double> T;
     std::vector<T> tripletList;
@@ -504,7 +626,7 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
     for(i = 0; i < nchan; ++i)
         tripletList.push_back(T(i, i, this->cals[i]));
 
-    SparseMatrix<double> cal(nchan, nchan);
+    cal = SparseMatrix<double>(nchan, nchan);
     cal.setFromTriplets(tripletList.begin(), tripletList.end());
 //    cal.makeCompressed();
 
@@ -512,8 +634,6 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
     //
     if (sel.size() == 0)
     {
-        data = MatrixXd(nchan, to-from+1);
-//            data->setZero();
         if (projAvailable || this->comp.kind != -1)
         {
             if (!projAvailable)
@@ -526,9 +646,6 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
     }
     else
     {
-        data = MatrixXd(sel.size(),to-from+1);
-//            data->setZero();
-
         MatrixXd selVect(sel.size(), nchan);
 
         selVect.setZero();
@@ -579,221 +696,223 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
             if(mult_full(i,k) != 0)
                 tripletList.push_back(T(i, k, mult_full(i,k)));
 
-    SparseMatrix<double> mult(mult_full.rows(),mult_full.cols());
+    mult = SparseMatrix<double>(mult_full.rows(),mult_full.cols());
     if(tripletList.size() > 0)
         mult.setFromTriplets(tripletList.begin(), tripletList.end());
 //    mult.makeCompressed();
 
     //
+    //  Remember what the operators were built from
+    //
+    cache.sel = sel;
+    cache.cals = this->cals;
+    cache.proj = this->proj;
+    cache.compKind = compAvailable ? this->comp.kind : -1;
+    cache.comp = compAvailable ? this->comp.data->data : MatrixXd();
+    cache.cal = cal;
+    cache.mult = mult;
+    cache.valid = true;
+}
 
-    FiffStream::SPtr fid;
-    if (!this->file->device()->isOpen())
-    {
-        if (!this->file->device()->open(QIODevice::ReadOnly))
-        {
-            printf("Cannot open file %s",this->info.filename.toUtf8().constData());
+//=============================================================================================================
+
+qint32 FiffRawData::find_raw_buffer(fiff_int_t samp) const
+{
+    qint32 lower = 0;
+    qint32 upper = this->rawdir.size();
+
+    while(lower < upper) {
+        const qint32 middle = lower + (upper - lower) / 2;
+
+        if(this->rawdir[middle].last < samp) {
+            lower = middle + 1;
+        } else {
+            upper = middle;
         }
-        fid = this->file;
     }
-    else
-    {
-        fid = this->file;
+
+    return lower;
+}
+
+//=============================================================================================================
+
+uchar* FiffRawData::map_raw_buffers(qint32 kFirst,
+                                    fiff_int_t to,
+                                    qint64& iMapOffset) const
+{
+    QFile* pFile = qobject_cast<QFile*>(this->file->device());
+
+    if(!pFile || !pFile->isOpen()) {
+        return Q_NULLPTR;
     }
 
-    MatrixXd one;
-    fiff_int_t first_pick, last_pick, picksamp;
-    for(k = 0; k < this->rawdir.size(); ++k)
+    iMapOffset = -1;
+    qint64 iMapEnd = -1;
+
+    for(qint32 k = kFirst; k < this->rawdir.size(); ++k) {
+        const FiffRawDir& thisRawDir = this->rawdir[k];
+
+        if(thisRawDir.first > to) {
+            break;
+        }
+
+        if(thisRawDir.ent->kind != -1) {
+            if(iMapOffset < 0) {
+                iMapOffset = thisRawDir.ent->pos;
+            }
+            iMapEnd = thisRawDir.ent->pos + FIFFC_DATA_OFFSET + thisRawDir.ent->size;
+        }
+    }
+
+    if(iMapOffset < 0 || iMapEnd > pFile->size()) {
+        return Q_NULLPTR;
+    }
+
+    return pFile->map(iMapOffset, iMapEnd - iMapOffset);
+}
+
+//=============================================================================================================
+
+void FiffRawData::unmap_raw_buffers(uchar* pMapped) const
+{
+    if(!pMapped) {
+        return;
+    }
+
+    if(QFile* pFile = qobject_cast<QFile*>(this->file->device())) {
+        pFile->unmap(pMapped);
+    }
+}
+
+//=============================================================================================================
+
+void FiffRawData::read_raw_buffer(const FiffRawDir& rawDir,
+                                  const uchar* pMapped,
+                                  qint64 iMapOffset,
+                                  fiff_int_t first_pick,
+                                  const RowVectorXi& sel,
+                                  const SparseMatrix<double>& cal,
+                                  const SparseMatrix<double>& mult,
+                                  MatrixXd& scratch,
+                                  Ref<MatrixXd> dest) const
+{
+    qint32 nchan = this->info.nchan;
+    qint32 r;
+
+    if (rawDir.ent->kind == -1)
     {
-        FiffRawDir thisRawDir = this->rawdir[k];
         //
-        //  Do we need this buffer
+        //  Take the easy route: skip is translated to zeros
         //
-        if (thisRawDir.last > from)
+        dest.setZero();
+        return;
+    }
+
+    //
+    //  Decode straight from the mapped file if possible
+    //
+    const bool bSwap = (this->file->byteOrder() == QDataStream::BigEndian) != (Q_BYTE_ORDER == Q_BIG_ENDIAN);
+
+    if (pMapped && read_mapped_buffer(pMapped + (rawDir.ent->pos - iMapOffset) + FIFFC_DATA_OFFSET,
+                                      rawDir.ent->type,
+                                      rawDir.ent->size,
+                                      bSwap,
+                                      nchan,
+                                      rawDir.nsamp,
+                                      first_pick,
+                                      sel,
+                                      this->cals,
+                                      mult,
+                                      scratch,
+                                      dest))
+    {
+        return;
+    }
+
+    MatrixXd one;
+    FiffTag::SPtr t_pTag;
+    this->file->read_tag(t_pTag, rawDir.ent->pos);
+    //
+    //   Depending on the state of the projection and selection
+    //   we proceed a little bit differently
+    //
+    if (mult.cols() == 0)
+    {
+        if (sel.cols() == 0)
         {
-            if (thisRawDir.ent->kind == -1)
-            {
-                //
-                //  Take the easy route: skip is translated to zeros
-                //
-                if(do_debug)
-                    printf("S");
-                if (sel.cols() <= 0)
-                    one.resize(nchan,thisRawDir.nsamp);
-                else
-                    one.resize(sel.cols(),thisRawDir.nsamp);
-
-                one.setZero();
-            }
+            if (t_pTag->type == FIFFT_DAU_PACK16)
+                one = cal*(Map< MatrixDau16 >( t_pTag->toDauPack16(),nchan, rawDir.nsamp)).cast<double>();
+            else if(t_pTag->type == FIFFT_INT)
+                one = cal*(Map< MatrixXi >( t_pTag->toInt(),nchan, rawDir.nsamp)).cast<double>();
+            else if(t_pTag->type == FIFFT_FLOAT)
+                one = cal*(Map< MatrixXf >( t_pTag->toFloat(),nchan, rawDir.nsamp)).cast<double>();
+            else if(t_pTag->type == FIFFT_SHORT)
+                one = cal*(Map< MatrixShort >( t_pTag->toShort(),nchan, rawDir.nsamp)).cast<double>();
             else
+                printf("Data Storage Format not known yet [1]!! Type: %d\n", t_pTag->type);
+        }
+        else
+        {
+
+            //ToDo find a faster solution for this!! --> make cal and mul sparse like in MATLAB
+            MatrixXd newData(sel.cols(), rawDir.nsamp); //ToDo this can be done much faster, without newData
+
+            if (t_pTag->type == FIFFT_DAU_PACK16)
             {
-                FiffTag::SPtr t_pTag;
-                fid->read_tag(t_pTag, thisRawDir.ent->pos);
-                //
-                //   Depending on the state of the projection and selection
-                //   we proceed a little bit differently
-                //
-                if (mult.cols() == 0)
-                {
-                    if (sel.cols() == 0)
-                    {
-                        if (t_pTag->type == FIFFT_DAU_PACK16)
-                            one = cal*(Map< MatrixDau16 >( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else if(t_pTag->type == FIFFT_INT)
-                            one = cal*(Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else if(t_pTag->type == FIFFT_FLOAT)
-                            one = cal*(Map< MatrixXf >( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else if(t_pTag->type == FIFFT_SHORT)
-                            one = cal*(Map< MatrixShort >( t_pTag->toShort(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else
-                            printf("Data Storage Format not known yet [1]!! Type: %d\n", t_pTag->type);
-                    }
-                    else
-                    {
-
-                        //ToDo find a faster solution for this!! --> make cal and mul sparse like in MATLAB
-                        MatrixXd newData(sel.cols(), thisRawDir.nsamp); //ToDo this can be done much faster, without newData
-
-                        if (t_pTag->type == FIFFT_DAU_PACK16)
-                        {
-                            MatrixXd tmp_data = (Map< MatrixDau16 > ( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
-
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else if(t_pTag->type == FIFFT_INT)
-                        {
-                            MatrixXd tmp_data = (Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
-
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else if(t_pTag->type == FIFFT_FLOAT)
-                        {
-                            MatrixXd tmp_data = (Map< MatrixXf > ( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
-
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else if(t_pTag->type == FIFFT_SHORT)
-                        {
-                            MatrixXd tmp_data = (Map< MatrixShort > ( t_pTag->toShort(),nchan, thisRawDir.nsamp)).cast<double>();
-
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else
-                        {
-                            printf("Data Storage Format not known yet [2]!! Type: %d\n", t_pTag->type);
-                        }
-
-                        one = cal*newData;
-                    }
-                }
-                else
-                {
-                    if (t_pTag->type == FIFFT_DAU_PACK16)
-                        one = mult*(Map< MatrixDau16 >( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
-                    else if(t_pTag->type == FIFFT_INT)
-                        one = mult*(Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
-                    else if(t_pTag->type == FIFFT_FLOAT)
-                        one = mult*(Map< MatrixXf >( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
-                    else
-                        printf("Data Storage Format not known yet [3]!! Type: %d\n", t_pTag->type);
-                }
+                MatrixXd tmp_data = (Map< MatrixDau16 > ( t_pTag->toDauPack16(),nchan, rawDir.nsamp)).cast<double>();
+
+                for(r = 0; r < sel.size(); ++r)
+                    newData.block(r,0,1,rawDir.nsamp) = tmp_data.block(sel[r],0,1,rawDir.nsamp);
             }
-            //
-            //  The picking logic is a bit complicated
-            //
-            if (to >= thisRawDir.last && from <= thisRawDir.first)
+            else if(t_pTag->type == FIFFT_INT)
             {
-                //
-                //  We need the whole buffer
-                //
-                first_pick = 0;//1;
-                last_pick  = thisRawDir.nsamp - 1;
-                if (do_debug)
-                    printf("W");
+                MatrixXd tmp_data = (Map< MatrixXi >( t_pTag->toInt(),nchan, rawDir.nsamp)).cast<double>();
+
+                for(r = 0; r < sel.size(); ++r)
+                    newData.block(r,0,1,rawDir.nsamp) = tmp_data.block(sel[r],0,1,rawDir.nsamp);
             }
-            else if (from > thisRawDir.first)
+            else if(t_pTag->type == FIFFT_FLOAT)
             {
-                first_pick = from - thisRawDir.first;// + 1;
-                if(to < thisRawDir.last)
-                {
-                    //
-                    //  Something from the middle
-                    //
-//                    qDebug() << "This needs to be debugged!";
-                    last_pick = thisRawDir.nsamp + to - thisRawDir.last - 1;//is this alright?
-                    if (do_debug)
-                        printf("M");
-                }
-                else
-                {
-                    //
-                    //  From the middle to the end
-                    //
-                    last_pick = thisRawDir.nsamp - 1;
-                    if (do_debug)
-                        printf("E");
-                }
+                MatrixXd tmp_data = (Map< MatrixXf > ( t_pTag->toFloat(),nchan, rawDir.nsamp)).cast<double>();
+
+                for(r = 0; r < sel.size(); ++r)
+                    newData.block(r,0,1,rawDir.nsamp) = tmp_data.block(sel[r],0,1,rawDir.nsamp);
             }
-            else
+            else if(t_pTag->type == FIFFT_SHORT)
             {
-                //
-                //  From the beginning to the middle
-                //
-                first_pick = 0;//1;
-                last_pick  = to - thisRawDir.first;// + 1;
-                if (do_debug)
-                    printf("B");
-            }
-            //
-            //  Now we are ready to pick
-            //
-            picksamp = last_pick - first_pick + 1;
+                MatrixXd tmp_data = (Map< MatrixShort > ( t_pTag->toShort(),nchan, rawDir.nsamp)).cast<double>();
 
-            if(do_debug)
-            {
-                qDebug() << "first_pick: " << first_pick;
-                qDebug() << "last_pick: " << last_pick;
-                qDebug() << "picksamp: " << picksamp;
+                for(r = 0; r < sel.size(); ++r)
+                    newData.block(r,0,1,rawDir.nsamp) = tmp_data.block(sel[r],0,1,rawDir.nsamp);
             }
-
-            if (picksamp > 0)
+            else
             {
-//                    for(r = 0; r < data->rows(); ++r)
-//                        for(c = 0; c < picksamp; ++c)
-//                            (*data)(r,dest + c) = one(r,first_pick + c);
-                data.block(0,dest,data.rows(),picksamp) = one.block(0, first_pick, data.rows(), picksamp);
-
-                dest += picksamp;
+                printf("Data Storage Format not known yet [2]!! Type: %d\n", t_pTag->type);
             }
-        }
-        //
-        //  Done?
-        //
-        if (thisRawDir.last >= to)
-        {
-            //printf(" [done]\n");
-            break;
+
+            one = cal*newData;
         }
     }
-
-    if(mult.cols()==0)
-        multSegment = cal;
     else
-        multSegment = mult;
-
-    if (!this->file->device()->isOpen()) {
-        this->file->device()->close();
+    {
+        if (t_pTag->type == FIFFT_DAU_PACK16)
+            one = mult*(Map< MatrixDau16 >( t_pTag->toDauPack16(),nchan, rawDir.nsamp)).cast<double>();
+        else if(t_pTag->type == FIFFT_INT)
+            one = mult*(Map< MatrixXi >( t_pTag->toInt(),nchan, rawDir.nsamp)).cast<double>();
+        else if(t_pTag->type == FIFFT_FLOAT)
+            one = mult*(Map< MatrixXf >( t_pTag->toFloat(),nchan, rawDir.nsamp)).cast<double>();
+        else if(t_pTag->type == FIFFT_SHORT)
+            one = mult*(Map< MatrixShort >( t_pTag->toShort(),nchan, rawDir.nsamp)).cast<double>();
+        else
+            printf("Data Storage Format not known yet [3]!! Type: %d\n", t_pTag->type);
     }
 
-    times = MatrixXd(1, to-from+1);
-
-    for (i = 0; i < times.cols(); ++i)
-        times(0, i) = ((float)(from+i)) / this->info.sfreq;
+    if(one.rows() != dest.rows() || one.cols() < first_pick + dest.cols()) {
+        dest.setZero();
+        return;
+    }
 
-    return true;
+    dest = one.block(0, first_pick, dest.rows(), dest.cols());
 }
 
 //=============================================================================================================
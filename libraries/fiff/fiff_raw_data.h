@@ -53,12 +53,21 @@
 #include <Eigen/Core>
 #include <Eigen/SparseCore>
 
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <functional>
+
 //=============================================================================================================
 // QT INCLUDES
 //=============================================================================================================
 
 #include <QList>
+#include <QMutex>
+#include <QPair>
 #include <QSharedPointer>
+#include <QVector>
 
 //=============================================================================================================
 // DEFINE NAMESPACE FIFFLIB
@@ -132,7 +141,8 @@ public:
     /**
      * ### MNE toolbox root function ###: Definition of the fiff_read_raw_segment function
      *
-     * Read a specific raw data segment
+     * Read a specific raw data segment. If the data are stored in a local file, the raw buffers are decoded
+     * directly from a memory mapping of the file. Other devices are read tag by tag.
      *
      * @param[out] data      returns the data matrix (channels x samples).
      * @param[out] times     returns the time values corresponding to the samples.
@@ -153,7 +163,8 @@ public:
     /**
      * ### MNE toolbox root function ###: Definition of the fiff_read_raw_segment function
      *
-     * Read a specific raw data segment
+     * Read a specific raw data segment. If the data are stored in a local file, the raw buffers are decoded
+     * directly from a memory mapping of the file. Other devices are read tag by tag.
      *
      * @param[out] data      returns the data matrix (channels x samples).
      * @param[out] times     returns the time values corresponding to the samples.
@@ -172,6 +183,26 @@ public:
                           const Eigen::RowVectorXi& sel = defaultRowVectorXi,
                           bool do_debug = false) const;
 
+    //=========================================================================================================
+    /**
+     * Read several raw data segments at once, e.g., the epochs around a list of events. The segments are sorted
+     * by their first sample and the raw buffers are swept once: every buffer is decoded a single time and scattered
+     * into all segments overlapping it, no matter how much the segments overlap.
+     *
+     * @param[out] data          returns one data matrix (channels x samples) per range, in the order of ranges.
+     *                           Ranges are clamped to the available samples; ranges without data give an empty matrix.
+     * @param[in] ranges         first and last sample of each segment.
+     * @param[in] sel            channel selection vector (optional).
+     * @param[in] segmentRead    called with the index of each segment as soon as it is complete (optional). Segments
+     *                           which cannot be read are reported first.
+     *
+     * @return true if all segments could be read, false otherwise.
+     */
+    bool read_raw_segments(QList<Eigen::MatrixXd>& data,
+                           const QVector<QPair<int,int> >& ranges,
+                           const Eigen::RowVectorXi& sel = defaultRowVectorXi,
+                           const std::function<void(int)>& segmentRead = std::function<void(int)>()) const;
+
     //=========================================================================================================
     /**
      * ### MNE toolbox root function ###: Definition of the fiff_read_raw_segment function
@@ -202,7 +233,99 @@ public:
     Eigen::MatrixXd proj;       /**< SSP operator to apply to the data. */
     FiffCtfComp comp;           /**< Compensator. */
 
+private:
+    //=========================================================================================================
+    /**
+     * Returns the calibration and the composite compensation/projection/calibration operator which
+     * read_raw_segment applies to the raw buffers of the given channel selection. The operator is only rebuilt if
+     * the selection, the calibration values, the projector or the compensator changed since the last call.
+     *
+     * @param[in] sel        channel selection vector.
+     * @param[out] cal       returns the sparse calibration matrix.
+     * @param[out] mult      returns the sparse composite operator. Empty if neither projector nor compensator is set.
+     */
+    void get_segment_operator(const Eigen::RowVectorXi& sel,
+                              Eigen::SparseMatrix<double>& cal,
+                              Eigen::SparseMatrix<double>& mult) const;
+
+    //=========================================================================================================
+    /**
+     * Returns the index of the first raw directory entry which contains samples at or after the given sample.
+     * The raw directory is sorted by sample number, so a binary search is used.
+     *
+     * @param[in] samp       sample to look for.
+     *
+     * @return index into rawdir, rawdir.size() if samp lies after the last buffer.
+     */
+    qint32 find_raw_buffer(fiff_int_t samp) const;
+
+    //=========================================================================================================
+    /**
+     * Memory maps the part of the file which holds the raw buffers from rawdir[kFirst] up to the buffer containing
+     * the sample to.
+     *
+     * @param[in] kFirst         index of the first raw directory entry to map.
+     * @param[in] to             last sample which needs to be accessible.
+     * @param[out] iMapOffset    returns the file offset of the first mapped byte.
+     *
+     * @return the mapped memory or NULL if the device is not a local file or cannot be mapped.
+     */
+    uchar* map_raw_buffers(qint32 kFirst,
+                           fiff_int_t to,
+                           qint64& iMapOffset) const;
+
+    //=========================================================================================================
+    /**
+     * Releases memory mapped by map_raw_buffers.
+     *
+     * @param[in] pMapped        the mapped memory, may be NULL.
+     */
+    void unmap_raw_buffers(uchar* pMapped) const;
+
+    //=========================================================================================================
+    /**
+     * Reads the samples first_pick ... first_pick + dest.cols() - 1 of a raw buffer into dest and applies the
+     * calibration or projection operator. The buffer is decoded from the memory mapped file if available,
+     * otherwise its tag is read from the stream.
+     *
+     * @param[in] rawDir         raw directory entry of the buffer.
+     * @param[in] pMapped        memory mapped by map_raw_buffers, may be NULL.
+     * @param[in] iMapOffset     file offset of pMapped.
+     * @param[in] first_pick     first sample within the buffer.
+     * @param[in] sel            channel selection vector.
+     * @param[in] cal            calibration matrix as returned by get_segment_operator.
+     * @param[in] mult           composite operator as returned by get_segment_operator.
+     * @param[in, out] scratch   scratch matrix reused between calls.
+     * @param[out] dest          the destination block (selected channels x picked samples).
+     */
+    void read_raw_buffer(const FiffRawDir& rawDir,
+                         const uchar* pMapped,
+                         qint64 iMapOffset,
+                         fiff_int_t first_pick,
+                         const Eigen::RowVectorXi& sel,
+                         const Eigen::SparseMatrix<double>& cal,
+                         const Eigen::SparseMatrix<double>& mult,
+                         Eigen::MatrixXd& scratch,
+                         Eigen::Ref<Eigen::MatrixXd> dest) const;
+
+    /**
+     * Cache of the operators built by get_segment_operator.
+     */
+    struct SegmentOperatorCache {
+        SegmentOperatorCache() : valid(false), compKind(-1) {}
+
+        QMutex                      mutex;      /**< Guards the cache against concurrent read_raw_segment calls. */
+        bool                        valid;      /**< Whether the cached operators can be used. */
+        Eigen::RowVectorXi          sel;        /**< Channel selection the operators were built for. */
+        Eigen::RowVectorXd          cals;       /**< Calibration values the operators were built from. */
+        Eigen::MatrixXd             proj;       /**< Projector the operators were built from. */
+        fiff_int_t                  compKind;   /**< Compensator kind the operators were built from. */
+        Eigen::MatrixXd             comp;       /**< Compensator the operators were built from. */
+        Eigen::SparseMatrix<double> cal;        /**< Cached calibration matrix. */
+        Eigen::SparseMatrix<double> mult;       /**< Cached composite operator. */
+    };
 
+    QSharedPointer<SegmentOperatorCache> m_pSegmentOperatorCache;    /**< The cached read_raw_segment operators. */
 };
 } // NAMESPACE
 
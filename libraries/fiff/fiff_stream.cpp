@@ -70,6 +70,7 @@
 
 #include <iostream>
 #include <time.h>
+#include <limits>
 
 //=============================================================================================================
 // EIGEN INCLUDES
@@ -93,12 +94,19 @@ using namespace FIFFLIB;
 using namespace UTILSLIB;
 using namespace Eigen;
 
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define FIFF_ARRAY_WRITE_CHUNK  (16*1024*1024)  // bytes byte-swapped and written per device write
+
 //=============================================================================================================
 // DEFINE MEMBER METHODS
 //=============================================================================================================
 
 FiffStream::FiffStream(QIODevice *p_pIODevice)
 : QDataStream(p_pIODevice)
+, m_iRawDataType(FIFFT_FLOAT)
 {
     this->setFloatingPointPrecision(QDataStream::SinglePrecision);
     this->setByteOrder(QDataStream::BigEndian);
@@ -110,6 +118,7 @@ FiffStream::FiffStream(QIODevice *p_pIODevice)
 FiffStream::FiffStream(QByteArray * a,
                        QIODevice::OpenMode mode)
 : QDataStream(a, mode)
+, m_iRawDataType(FIFFT_FLOAT)
 {
     this->setFloatingPointPrecision(QDataStream::SinglePrecision);
     this->setByteOrder(QDataStream::BigEndian);
@@ -2018,12 +2027,15 @@ FiffStream::SPtr FiffStream::start_writing_raw(QIODevice &p_IODevice,
                                                const FiffInfo& info,
                                                RowVectorXd& cals,
                                                MatrixXi sel,
-                                               bool bResetRange)
+                                               bool bResetRange,
+                                               fiff_int_t iDataType)
 {
-    //
-    //   We will always write floats
-    //
-    fiff_int_t data_type = 4;
+    fiff_int_t data_type = iDataType;
+    if(data_type != FIFFT_FLOAT && data_type != FIFFT_SHORT && data_type != FIFFT_INT) {
+        qWarning("[FiffStream::start_writing_raw] Raw data type %d is not supported. Writing floats instead.", data_type);
+        data_type = FIFFT_FLOAT;
+    }
+    const bool bIntegerData = data_type != FIFFT_FLOAT;
     qint32 k;
 
     if(sel.cols() == 0)
@@ -2044,6 +2056,9 @@ FiffStream::SPtr FiffStream::start_writing_raw(QIODevice &p_IODevice,
     //  Create the file and save the essentials
     //
     FiffStream::SPtr t_pStream = start_file(p_IODevice);//1, 2, 3
+    t_pStream->m_iRawDataType = data_type;
+    for(k = 0; k < nchan; ++k)
+        t_pStream->m_lRawChNames << chs[k].ch_name;
     t_pStream->start_block(FIFFB_MEAS);//4
     t_pStream->write_id(FIFF_BLOCK_ID);//5
     if(info.meas_id.version != -1)
@@ -2173,10 +2188,25 @@ FiffStream::SPtr FiffStream::start_writing_raw(QIODevice &p_IODevice,
         //    Scan numbers may have been messed up
         //
         chs[k].scanNo = k+1;
-        if(bResetRange) {
-            chs[k].range = 1.0; // Reset to 1.0 because we always write floats.
+        if(bIntegerData) {
+            //
+            //    Integers count ADC steps, so range*cal has to stay the size of one step to be lossless
+            //
+            if(chs[k].range == 0.0f) {
+                chs[k].range = 1.0;
+            }
+            cals[k] = chs[k].range*chs[k].cal;
+            if(cals[k] == 0.0) {
+                qWarning("[FiffStream::start_writing_raw] Channel %s has no calibration. Using 1.0.", chs[k].ch_name.toUtf8().constData());
+                chs[k].cal = 1.0;
+                cals[k] = chs[k].range;
+            }
+        } else {
+            if(bResetRange) {
+                chs[k].range = 1.0; // Reset to 1.0 because floats are stored in calibrated units.
+            }
+            cals[k] = chs[k].cal;
         }
-        cals[k] = chs[k].cal;
         t_pStream->write_ch_info(chs[k]);
     }
     //
@@ -2590,12 +2620,14 @@ fiff_long_t FiffStream::write_dir_entries(const QList<FiffDirEntry::SPtr> &dir,
     //
     //   Start writing FiffDirEntries
     //
+    std::vector<qint32> entries(4*nent);
     for(qint32 i = 0; i < nent; ++i) {
-        *this << (qint32)dir[i]->kind;
-        *this << (qint32)dir[i]->type;
-        *this << (qint32)dir[i]->size;
-        *this << (qint32)dir[i]->pos;
+        entries[4*i]   = (qint32)dir[i]->kind;
+        entries[4*i+1] = (qint32)dir[i]->type;
+        entries[4*i+2] = (qint32)dir[i]->size;
+        entries[4*i+3] = (qint32)dir[i]->pos;
     }
+    this->write_array_data(entries.data(), 4*nent, 4);
 
     return pos;
 }
@@ -2613,8 +2645,7 @@ fiff_long_t FiffStream::write_double(fiff_int_t kind, const double* data, fiff_i
     *this << (qint32)datasize;
     *this << (qint32)FIFFV_NEXT_SEQ;
 
-    for(qint32 i = 0; i < nel; ++i)
-        *this << data[i];
+    this->write_array_data(data, nel, 8);
 
     return pos;
 }
@@ -2632,8 +2663,7 @@ fiff_long_t FiffStream::write_float(fiff_int_t kind, const float* data, fiff_int
     *this << (qint32)datasize;
     *this << (qint32)FIFFV_NEXT_SEQ;
 
-    for(qint32 i = 0; i < nel; ++i)
-        *this << data[i];
+    this->write_array_data(data, nel, 4);
 
     return pos;
 }
@@ -2653,19 +2683,16 @@ fiff_long_t FiffStream::write_float_matrix(fiff_int_t kind, const MatrixXf& mat)
      *this << (qint32)datasize;
      *this << (qint32)FIFFV_NEXT_SEQ;
 
-    qint32 i, j;
     // Storage order: row-major
-    for(i = 0; i < mat.rows(); ++i)
-        for(j = 0; j < mat.cols(); ++j)
-            *this << mat(i,j);
+    Matrix<float, Dynamic, Dynamic, RowMajor> matRowMajor = mat;
+    this->write_array_data(matRowMajor.data(), numel, 4);
 
     qint32 dims[3];
     dims[0] = mat.cols();
     dims[1] = mat.rows();
     dims[2] = 2;
 
-    for(i = 0; i < 3; ++i)
-        *this << dims[i];
+    this->write_array_data(dims, 3, 4);
 
     return pos;
 }
@@ -2719,16 +2746,16 @@ fiff_long_t FiffStream::write_float_sparse_ccs(fiff_int_t kind, const SparseMatr
      *this << (qint32)FIFFV_NEXT_SEQ;
 
     //
-    //  The data values
+    //  The data values and row indices
     //
-    for(i = 0; i < s.size(); ++i)
-        *this << s[i].value();
-
-    //
-    //  Row indices
-    //
-    for(i = 0; i < s.size(); ++i)
-        *this << s[i].row();
+    std::vector<float> values(s.size());
+    std::vector<qint32> indices(s.size());
+    for(i = 0; i < s.size(); ++i) {
+        values[i] = s[i].value();
+        indices[i] = s[i].row();
+    }
+    this->write_array_data(values.data(), values.size(), 4);
+    this->write_array_data(indices.data(), indices.size(), 4);
 
     //
     //  Pointers
@@ -2746,8 +2773,7 @@ fiff_long_t FiffStream::write_float_sparse_ccs(fiff_int_t kind, const SparseMatr
        if(ptrs[k-1] < 0)
           ptrs[k-1] = ptrs[k];
     //
-    for(i = 0; i < (quint32)ptrs.size(); ++i)
-        *this << ptrs[i];
+    this->write_array_data(ptrs.data(), ptrs.size(), 4);
     //
     //   Dimensions
     //
@@ -2757,8 +2783,7 @@ fiff_long_t FiffStream::write_float_sparse_ccs(fiff_int_t kind, const SparseMatr
     dims[2] = mat.cols();
     dims[3] = 2;
 
-    for(i = 0; i < 4; ++i)
-        *this << dims[i];
+    this->write_array_data(dims, 4, 4);
 
     return pos;
 }
@@ -2815,16 +2840,16 @@ fiff_long_t FiffStream::write_float_sparse_rcs(fiff_int_t kind, const SparseMatr
      *this << (qint32)FIFFV_NEXT_SEQ;
 
     //
-    //  The data values
-    //
-    for(i = 0; i < s.size(); ++i)
-        *this << s[i].value();
-
-    //
-    //  Column indices
+    //  The data values and column indices
     //
-    for(i = 0; i < s.size(); ++i)
-        *this << s[i].col();
+    std::vector<float> values(s.size());
+    std::vector<qint32> indices(s.size());
+    for(i = 0; i < s.size(); ++i) {
+        values[i] = s[i].value();
+        indices[i] = s[i].col();
+    }
+    this->write_array_data(values.data(), values.size(), 4);
+    this->write_array_data(indices.data(), indices.size(), 4);
 
     //
     //  Pointers
@@ -2844,8 +2869,7 @@ fiff_long_t FiffStream::write_float_sparse_rcs(fiff_int_t kind, const SparseMatr
           ptrs[k-1] = ptrs[k];
 
     //
-    for(i = 0; i < (quint32)ptrs.size(); ++i)
-        *this << ptrs[i];
+    this->write_array_data(ptrs.data(), ptrs.size(), 4);
 
     //
     //  Dimensions
@@ -2856,8 +2880,7 @@ fiff_long_t FiffStream::write_float_sparse_rcs(fiff_int_t kind, const SparseMatr
     dims[2] = mat.cols();
     dims[3] = 2;
 
-    for(i = 0; i < 4; ++i)
-        *this << dims[i];
+    this->write_array_data(dims, 4, 4);
 
     return pos;
 }
@@ -2895,8 +2918,7 @@ fiff_long_t FiffStream::write_id(fiff_int_t kind, const FiffId& id)
     data[3] = t_id.time.secs;
     data[4] = t_id.time.usecs;
 
-    for(qint32 i = 0; i < 5; ++i)
-        *this << data[i];
+    this->write_array_data(data, 5, 4);
 
     return pos;
 }
@@ -2981,8 +3003,7 @@ fiff_long_t FiffStream::write_int(fiff_int_t kind, const fiff_int_t* data, fiff_
      *this << (qint32)datasize;
      *this << (qint32)next;
 
-    for(qint32 i = 0; i < nel; ++i)
-        *this << data[i];
+    this->write_array_data(data, nel, 4);
 
     return pos;
 }
@@ -3005,19 +3026,16 @@ fiff_long_t FiffStream::write_int_matrix(fiff_int_t kind, const MatrixXi& mat)
      *this << (qint32)datasize;
      *this << (qint32)FIFFV_NEXT_SEQ;
 
-    qint32 i, j;
     // Storage order: row-major
-    for(i = 0; i < mat.rows(); ++i)
-        for(j = 0; j < mat.cols(); ++j)
-            *this << mat(i,j);
+    Matrix<qint32, Dynamic, Dynamic, RowMajor> matRowMajor = mat;
+    this->write_array_data(matRowMajor.data(), numel, 4);
 
     qint32 dims[3];
     dims[0] = mat.cols();
     dims[1] = mat.rows();
     dims[2] = 2;
 
-    for(i = 0; i < 3; ++i)
-        *this << dims[i];
+    this->write_array_data(dims, 3, 4);
 
     return pos;
 }
@@ -3095,18 +3113,11 @@ bool FiffStream::write_raw_buffer(const MatrixXd& buf,
         return false;
     }
 
-    typedef Eigen::Triplet<double> T;
-    std::vector<T> tripletList;
-    tripletList.reserve(cals.cols());
-    for(qint32 i = 0; i < cals.cols(); ++i)
-        tripletList.push_back(T(i, i, 1.0/cals[i]));
-
-    SparseMatrix<double> inv_calsMat(cals.cols(), cals.cols());
-    inv_calsMat.setFromTriplets(tripletList.begin(), tripletList.end());
-
-    MatrixXf tmp = (inv_calsMat*buf).cast<float>();
-    this->write_float(FIFF_DATA_BUFFER,tmp.data(),tmp.rows()*tmp.cols());
-    return true;
+    //
+    //   Scale every row by its inverse calibration, which vectorises along the samples of a channel
+    //
+    MatrixXd scaled = buf.array().colwise() * cals.transpose().array().inverse();
+    return write_raw_samples(scaled);
 }
 
 //=============================================================================================================
@@ -3119,23 +3130,22 @@ bool FiffStream::write_raw_buffer(const MatrixXd& buf,
         return false;
     }
 
-    SparseMatrix<double> inv_mult(mult.rows(), mult.cols());
-    for (int k=0; k<inv_mult.outerSize(); ++k)
-      for (SparseMatrix<double>::InnerIterator it(mult,k); it; ++it)
-        inv_mult.coeffRef(it.row(),it.col()) = 1/it.value();
+    //
+    //   Keep the sparsity pattern and invert the stored coefficients only.
+    //   coeffs() covers exactly the nonzeros only in compressed mode.
+    //
+    SparseMatrix<double> inv_mult = mult;
+    inv_mult.makeCompressed();
+    inv_mult.coeffs() = inv_mult.coeffs().inverse();
 
-    MatrixXf tmp = (inv_mult*buf).cast<float>();
-    this->write_float(FIFF_DATA_BUFFER,tmp.data(),tmp.rows()*tmp.cols());
-    return true;
+    return write_raw_samples(inv_mult*buf);
 }
 
 //=============================================================================================================
 
 bool FiffStream::write_raw_buffer(const MatrixXd& buf)
 {
-    MatrixXf tmp = buf.cast<float>();
-    this->write_float(FIFF_DATA_BUFFER,tmp.data(),tmp.rows()*tmp.cols());
-    return true;
+    return write_raw_samples(buf);
 }
 
 //=============================================================================================================
@@ -3172,6 +3182,123 @@ void FiffStream::write_rt_command(fiff_int_t command, const QString& data)
 
 //=============================================================================================================
 
+bool FiffStream::write_array_data(const void* data, qint64 nel, int elementSize)
+{
+    const qint64 nbytes = nel * elementSize;
+    if(nbytes <= 0)
+        return true;
+
+    if(!needs_byte_swap())
+        return this->writeRawData(static_cast<const char*>(data), nbytes) == nbytes;
+
+    //
+    // Swap whole chunks into the scratch buffer, which keeps its capacity for the next call
+    //
+    const qint64 chunkElements = qMax<qint64>(1, FIFF_ARRAY_WRITE_CHUNK / elementSize);
+    const char* source = static_cast<const char*>(data);
+
+    for(qint64 first = 0; first < nel; first += chunkElements) {
+        const qint64 n = qMin(chunkElements, nel - first);
+        if(m_scratch.size() < n * elementSize)
+            m_scratch.resize(n * elementSize);
+
+        IOUtils::swap_array(source + first * elementSize, m_scratch.data(), n, elementSize);
+        if(this->writeRawData(m_scratch.constData(), n * elementSize) != n * elementSize)
+            return false;
+    }
+
+    return true;
+}
+
+//=============================================================================================================
+
+bool FiffStream::read_array_data(void* data, qint64 nel, int elementSize)
+{
+    const qint64 nbytes = nel * elementSize;
+    if(nbytes <= 0)
+        return true;
+
+    if(this->readRawData(static_cast<char*>(data), nbytes) != nbytes)
+        return false;
+
+    if(needs_byte_swap())
+        IOUtils::swap_array(data, data, nel, elementSize);
+
+    return true;
+}
+
+//=============================================================================================================
+
+bool FiffStream::write_raw_samples(const MatrixXd& buf)
+{
+    const qint64 nel = buf.size();
+
+    if(m_iRawDataType == FIFFT_FLOAT) {
+        MatrixXf tmp = buf.cast<float>();
+        this->write_float(FIFF_DATA_BUFFER,tmp.data(),tmp.size());
+        return true;
+    }
+
+    double dMin, dMax;
+    int iElementSize;
+    if(m_iRawDataType == FIFFT_SHORT) {
+        dMin = std::numeric_limits<qint16>::min();
+        dMax = std::numeric_limits<qint16>::max();
+        iElementSize = sizeof(qint16);
+    } else {
+        dMin = std::numeric_limits<qint32>::min();
+        dMax = std::numeric_limits<qint32>::max();
+        iElementSize = sizeof(qint32);
+    }
+
+    const ArrayXXd rounded = buf.array().round();
+    const Index iClipped = (rounded < dMin || rounded > dMax).count();
+    if(iClipped > 0) {
+        qWarning("[FiffStream::write_raw_samples] %lld samples exceed the range of the raw data type and were clipped.", static_cast<long long>(iClipped));
+    }
+
+    //
+    //   Integers only keep the signal if range*cal is the size of one ADC step. Warn once per channel if the
+    //   steps are too coarse, i.e. a nonzero channel became all zeros or the rounding error exceeds half the signal.
+    //
+    if(m_vecQuantisationWarned.size() != buf.rows()) {
+        m_vecQuantisationWarned.setConstant(buf.rows(), false);
+    }
+    const ArrayXd vecSignal = buf.array().square().rowwise().mean().sqrt();
+    const ArrayXd vecError = (buf.array() - rounded).square().rowwise().mean().sqrt();
+    const ArrayXd vecMaxRounded = rounded.abs().rowwise().maxCoeff();
+    for(Index i = 0; i < buf.rows(); ++i) {
+        if(m_vecQuantisationWarned(i) || vecSignal(i) == 0.0) {
+            continue;
+        }
+        if(vecMaxRounded(i) == 0.0 || vecError(i) > 0.5 * vecSignal(i)) {
+            QString sChName = i < m_lRawChNames.size() ? m_lRawChNames.at(i) : QString::number(i);
+            if(vecMaxRounded(i) == 0.0) {
+                qWarning("[FiffStream::write_raw_samples] Channel %s is nonzero but was quantised to all zeros. Its range*cal is not the size of one ADC step, store floats instead.", sChName.toUtf8().constData());
+            } else {
+                qWarning("[FiffStream::write_raw_samples] The rounding error of channel %s exceeds half of its signal. Its range*cal is not the size of one ADC step, store floats instead.", sChName.toUtf8().constData());
+            }
+            m_vecQuantisationWarned(i) = true;
+        }
+    }
+    const ArrayXXd clipped = rounded.max(dMin).min(dMax);
+
+    *this << (qint32)FIFF_DATA_BUFFER;
+    *this << (qint32)m_iRawDataType;
+    *this << (qint32)(nel * iElementSize);
+    *this << (qint32)FIFFV_NEXT_SEQ;
+
+    if(m_iRawDataType == FIFFT_SHORT) {
+        Matrix<qint16,Dynamic,Dynamic> tmp = clipped.cast<qint16>();
+        return this->write_array_data(tmp.data(), nel, iElementSize);
+    }
+
+    MatrixXi tmp = clipped.cast<int>();
+    return this->write_array_data(tmp.data(), nel, iElementSize);
+}
+
+//=============================================================================================================
+
 QList<FiffDirEntry::SPtr> FiffStream::make_dir(bool *ok)
 {
     FiffTag::SPtr t_pTag;
@@ -43,6 +43,7 @@
 
 #include "fiff_global.h"
 #include "fiff_types.h"
+#include "fiff_file.h"
 #include "fiff_id.h"
 
 #include "fiff_dir_node.h"
@@ -507,7 +508,9 @@ public:
      * @param[in] info           The measurement info block of the source file.
      * @param[out] cals          A copy of the calibration values.
      * @param[in] sel            Which channels will be included in the output file (optional).
-     * @param[in] bResetRange    Flag whether to reset the channel range to 1.0. Default is true.
+     * @param[in] bResetRange    Flag whether to reset the channel range to 1.0. Default is true. Ignored for integer
+     *                           storage, which keeps range*cal as the size of one ADC step.
+     * @param[in] iDataType      Storage type of the raw buffers: FIFFT_FLOAT (default), FIFFT_SHORT or FIFFT_INT.
      *
      * @return the started fiff file.
      */
@@ -515,7 +518,8 @@ public:
                                               const FiffInfo& info,
                                               Eigen::RowVectorXd& cals,
                                               Eigen::MatrixXi sel = defaultMatrixXi,
-                                              bool bResetRange = true);
+                                              bool bResetRange = true,
+                                              fiff_int_t iDataType = FIFFT_FLOAT);
 
     //=========================================================================================================
     /**
@@ -799,7 +803,10 @@ public:
      *
      * ### MNE toolbox root function ###
      *
-     * Writes a raw buffer.
+     * Writes a raw buffer. Every row is divided by its calibration factor and stored in the data type chosen in
+     * start_writing_raw. Integer samples are rounded and values outside the type range are clipped. A warning is
+     * issued once per channel if a nonzero channel is quantised to all zeros or its rounding error exceeds half of
+     * its signal (RMS). This happens if range*cal is not the size of one ADC step of the channel.
      *
      * @param[in] buf        the buffer to write.
      * @param[in] cals       calibration factors.
@@ -836,6 +843,14 @@ public:
      */
     bool write_raw_buffer(const Eigen::MatrixXd& buf);
 
+    //=========================================================================================================
+    /**
+     * Returns the data type of the raw buffers written to this stream.
+     *
+     * @return FIFFT_FLOAT, FIFFT_SHORT or FIFFT_INT.
+     */
+    inline fiff_int_t raw_data_type() const;
+
     //=========================================================================================================
     /**
      * Writes a string tag
@@ -857,7 +872,53 @@ public:
      */
     void write_rt_command(fiff_int_t command, const QString& data);
 
+    //=========================================================================================================
+    /**
+     * Writes an array of 2, 4 or 8 byte elements in the byte order of the stream. The elements are byte
+     * swapped as a whole into a scratch buffer, which is kept for the next call, and handed to the device
+     * with a single write per 16 MB.
+     *
+     * @param[in] data           The elements to write.
+     * @param[in] nel            Number of elements.
+     * @param[in] elementSize    Size of one element in bytes.
+     *
+     * @return true if all bytes were written, false otherwise.
+     */
+    bool write_array_data(const void* data, qint64 nel, int elementSize);
+
+    //=========================================================================================================
+    /**
+     * Reads an array of 2, 4 or 8 byte elements stored in the byte order of the stream with a single device
+     * read and converts it to the native byte order in place.
+     *
+     * @param[out] data          The elements to read to. Must hold nel elements.
+     * @param[in] nel            Number of elements.
+     * @param[in] elementSize    Size of one element in bytes.
+     *
+     * @return true if all bytes were read, false otherwise.
+     */
+    bool read_array_data(void* data, qint64 nel, int elementSize);
+
 private:
+    //=========================================================================================================
+    /**
+     * Returns whether the stream byte order differs from the native byte order.
+     *
+     * @return true if the elements need to be swapped.
+     */
+    inline bool needs_byte_swap() const;
+
+    //=========================================================================================================
+    /**
+     * Writes a FIFF_DATA_BUFFER tag in the raw data type of this stream. The samples are expected to be scaled
+     * already.
+     *
+     * @param[in] buf        the scaled buffer to write.
+     *
+     * @return true if succeeded, false otherwise.
+     */
+    bool write_raw_samples(const Eigen::MatrixXd& buf);
+
     //=========================================================================================================
     /**
      * Check that the file starts properly.
@@ -888,6 +949,10 @@ private:
     QList<FiffDirEntry::SPtr>   m_dir;  /**< This is the directory. If no directory exists, open automatically scans the file to create one. */
 //    int         nent;           /**< How many entries?. */ -> Use nent() instead
     FiffDirNode::SPtr           m_dirtree; /**< Directory compiled into a tree. */
+    QByteArray                  m_scratch; /**< Reused buffer for byte swapping arrays before they are written. */
+    fiff_int_t                  m_iRawDataType; /**< Data type of the written raw buffers, set by start_writing_raw. */
+    QStringList                 m_lRawChNames;  /**< Names of the channels of the written raw buffers, set by start_writing_raw. */
+    Eigen::Array<bool,Eigen::Dynamic,1> m_vecQuantisationWarned; /**< Channels which were already reported as too coarsely quantised. */
 //    char        *ext_file_name; /**< Name of the file holding the external data. */
 //    FILE        *ext_fd;        /**< The file descriptor of the above file if open . */
 
@@ -906,6 +971,26 @@ private:
 //    FILE        *ext_fd;        /**< The file descriptor of the above file if open . */
 //} *fiffFile,fiffFileRec;        /**< FIFF file handle. fiff_open() returns this. */
 };
+
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline fiff_int_t FiffStream::raw_data_type() const
+{
+    return m_iRawDataType;
+}
+
+//=============================================================================================================
+
+inline bool FiffStream::needs_byte_swap() const
+{
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+    return this->byteOrder() != QDataStream::BigEndian;
+#else
+    return this->byteOrder() != QDataStream::LittleEndian;
+#endif
+}
 } // NAMESPACE
 
 #endif // FIFF_STREAM_H
@@ -123,6 +123,7 @@ void ComputeFwdSettings::usage(char *name)
     fprintf(stderr,"\t--notrans         head and MRI coordinate systems are identical.\n");
     fprintf(stderr,"\t--meas name       take MEG sensor and EEG electrode locations from here\n");
     fprintf(stderr,"\t--bem  name       BEM model name\n");
+    fprintf(stderr,"\t--bemcache dir    reuse BEM solutions computed earlier for the same model from this directory\n");
     fprintf(stderr,"\t--origin x:y:z/mm use a sphere model with this origin (head coordinates/mm)\n");
     fprintf(stderr,"\t--eegscalp        scale the electrode locations to the surface of the scalp when using a sphere model\n");
     fprintf(stderr,"\t--eegmodels name  read EEG sphere model specifications from here.\n");
@@ -264,6 +265,14 @@ bool ComputeFwdSettings::check_args (int *argc,char **argv)
             }
             bemname = QString(argv[k+1]);
         }
+        else if (strcmp(argv[k],"--bemcache") == 0) {
+            found = 2;
+            if (k == *argc - 1) {
+                qCritical("--bemcache: argument required.");
+                return false;
+            }
+            bemcachedir = QString(argv[k+1]);
+        }
         else if (strcmp(argv[k],"--origin") == 0) {
             found = 2;
             if (k == *argc - 1) {
@@ -116,6 +116,7 @@ public:
     QString transname;          /**< head2mri transformation file. */
     bool mri_head_ident;        /**< Are the head and MRI coordinates the same?. */
     QString bemname;            /**< BEM model file. */
+    QString bemcachedir;        /**< Directory for cached BEM solutions (empty: no caching). */
     QString solname;            /**< Solution file. */
     QString mindistoutname;     /**< Output file for omitted source space points. */
     bool filter_spaces;         /**< Filter the source space points. */
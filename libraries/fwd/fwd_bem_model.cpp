@@ -53,7 +53,11 @@
 #include <fiff/fiff_stream.h>
 #include <fiff/fiff_named_matrix.h>
 
+#include <QCryptographicHash>
+#include <QDir>
 #include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
 #include <QList>
 #include <QThread>
 #include <QtConcurrent>
@@ -183,15 +187,104 @@ void fromFloatEigenMatrix_40(const Eigen::MatrixXf& from_mat, float **& to_mat)
     fromFloatEigenMatrix_40(from_mat, to_mat, from_mat.rows(), from_mat.cols());
 }
 
+#define LU_BLOCK_SIZE_40 128
+
+static void mne_parallel_column_blocks_40(int ncol, int min_width, const std::function<void(int,int)>& op)
+/*
+      * Split the columns [0,ncol) into one block per thread (at least min_width wide) and run op on them
+      */
+{
+    int width = qMax(min_width, (ncol + QThread::idealThreadCount() - 1) / qMax(1, QThread::idealThreadCount()));
+    QList<QPair<int,int> > blocks;
+
+    for (int c = 0; c < ncol; c += width)
+        blocks.append(QPair<int,int>(c, qMin(ncol, c + width)));
+
+    if (blocks.size() == 1) {
+        op(blocks[0].first, blocks[0].second);
+        return;
+    }
+
+    std::function<void(QPair<int,int>&)> blockOp = [&op](QPair<int,int>& block) {
+        op(block.first, block.second);
+    };
+
+    QtConcurrent::map(blocks, blockOp).waitForFinished();
+}
+
+static int mne_lu_factor_blocked_40(Eigen::Map<Eigen::MatrixXf>& a, Eigen::VectorXi& perm)
+/*
+      * Right-looking blocked LU decomposition with partial pivoting, P a = L U, computed in place.
+      * The trailing submatrix update is done in parallel column blocks.
+      */
+{
+    int n = a.rows();
+    int j,k,b,rest;
+    Eigen::Index p;
+
+    perm = Eigen::VectorXi::LinSpaced(n,0,n-1);
+
+    for (k = 0; k < n; k += LU_BLOCK_SIZE_40) {
+        b = qMin(LU_BLOCK_SIZE_40,n-k);
+        /*
+         * Factorize the panel
+         */
+        for (j = k; j < k+b; j++) {
+            if (a.col(j).tail(n-j).cwiseAbs().maxCoeff(&p) == 0.0)
+                return FAIL;
+            p += j;
+            if (p != j) {
+                a.row(j).swap(a.row(p));
+                std::swap(perm[j],perm[p]);
+            }
+            a.col(j).tail(n-j-1) /= a(j,j);
+            if (j+1 < k+b)
+                a.block(j+1,j+1,n-j-1,k+b-j-1).noalias() -= a.col(j).tail(n-j-1)*a.row(j).segment(j+1,k+b-j-1);
+        }
+        /*
+         * Update the block row of U and the trailing submatrix
+         */
+        rest = n-k-b;
+        if (rest > 0) {
+            mne_parallel_column_blocks_40(rest, 64, [&a,k,b,rest](int c0, int c1) {
+                a.block(k,k,b,b).triangularView<Eigen::UnitLower>().solveInPlace(a.block(k,k+b+c0,b,c1-c0));
+                a.block(k+b,k+b+c0,rest,c1-c0).noalias() -= a.block(k+b,k,rest,b)*a.block(k,k+b+c0,b,c1-c0);
+            });
+        }
+    }
+    return OK;
+}
+
 float **mne_lu_invert_40(float **mat,int dim)
 /*
-      * Invert a matrix using the LU decomposition from
-      * LAPACK
+      * Invert a matrix using a blocked LU decomposition
+      * The matrix is expected in the contiguous storage of ALLOC_CMATRIX_40 and is
+      * inverted in place. Mapping the row-major storage column-major gives the transpose,
+      * whose inverse is the transposed inverse, i.e., the inverse in row-major storage.
       */
 {
-    Eigen::MatrixXf eigen_mat = toFloatEigenMatrix_40(mat, dim, dim);
-    Eigen::MatrixXf eigen_mat_inv = eigen_mat.inverse();
-    fromFloatEigenMatrix_40(eigen_mat_inv, mat);
+    Eigen::Map<Eigen::MatrixXf> a(mat[0],dim,dim);
+    Eigen::VectorXi perm;
+
+    if (mne_lu_factor_blocked_40(a,perm) != OK) {
+        printf("Singular matrix in mne_lu_invert_40\n");
+        return NULL;
+    }
+    /*
+     * Solve L U X = P for the inverse, column blocks are independent
+     */
+    Eigen::MatrixXf inv(dim,dim);
+
+    mne_parallel_column_blocks_40(dim, LU_BLOCK_SIZE_40, [&a,&inv,&perm,dim](int c0, int c1) {
+        inv.middleCols(c0,c1-c0).setZero();
+        for (int j = 0; j < dim; j++)
+            if (perm[j] >= c0 && perm[j] < c1)
+                inv(j,perm[j]) = 1.0;
+        a.triangularView<Eigen::UnitLower>().solveInPlace(inv.middleCols(c0,c1-c0));
+        a.triangularView<Eigen::Upper>().solveInPlace(inv.middleCols(c0,c1-c0));
+    });
+
+    a = inv;
     return mat;
 }
 
@@ -345,6 +438,8 @@ static struct {
 #define BEM_SUFFIX     "-bem.fif"
 #define BEM_SOL_SUFFIX "-bem-sol.fif"
 
+static QString bem_solution_cache_dir;
+
 //============================= misc_util.c =============================
 
 static QString strip_from(const QString& s, const QString& suffix)
@@ -1518,7 +1613,98 @@ int FwdBemModel::fwd_bem_load_recompute_solution(const QString& name, int bem_me
     }
     if (bem_method == FWD_BEM_UNKNOWN)
         bem_method = FWD_BEM_LINEAR_COLL;
-    return fwd_bem_compute_solution(m,bem_method);
+
+    QString cache_name;
+    if (!force_recompute)
+        cache_name = fwd_bem_make_solution_cache_name(m,bem_method);
+    if (!cache_name.isEmpty() && QFile::exists(cache_name)) {
+        solres = fwd_bem_load_solution(cache_name,bem_method,m);
+        if (solres == TRUE) {
+            fprintf(stderr,"\nLoaded cached %s BEM solution from %s\n",fwd_bem_explain_method(m->bem_method).toUtf8().constData(),cache_name.toUtf8().constData());
+            return OK;
+        }
+        fprintf(stderr,"Ignoring unusable cached BEM solution %s\n",cache_name.toUtf8().constData());
+    }
+    if (fwd_bem_compute_solution(m,bem_method) != OK)
+        return FAIL;
+    if (!cache_name.isEmpty()) {
+        if (fwd_bem_save_solution(cache_name,m) == OK)
+            fprintf(stderr,"Cached the BEM solution in %s\n",cache_name.toUtf8().constData());
+        else
+            fprintf(stderr,"Could not cache the BEM solution in %s\n",cache_name.toUtf8().constData());
+    }
+    return OK;
+}
+
+//=============================================================================================================
+
+void FwdBemModel::fwd_bem_set_solution_cache_dir(const QString& dir)
+{
+    bem_solution_cache_dir = dir;
+}
+
+//=============================================================================================================
+
+QString FwdBemModel::fwd_bem_make_solution_cache_name(FwdBemModel *m, int bem_method)
+/*
+ * The key covers everything the solution depends on
+ */
+{
+    if (bem_solution_cache_dir.isEmpty() || !m)
+        return QString();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    int k,p;
+
+    hash.addData(reinterpret_cast<const char*>(&bem_method),sizeof(int));
+    hash.addData(reinterpret_cast<const char*>(&m->nsurf),sizeof(int));
+    hash.addData(reinterpret_cast<const char*>(&m->ip_approach_limit),sizeof(float));
+    for (k = 0; k < m->nsurf; k++) {
+        MneSurfaceOld* s = m->surfs[k];
+        hash.addData(reinterpret_cast<const char*>(&s->id),sizeof(int));
+        hash.addData(reinterpret_cast<const char*>(&s->np),sizeof(int));
+        hash.addData(reinterpret_cast<const char*>(&s->ntri),sizeof(int));
+        hash.addData(reinterpret_cast<const char*>(&m->sigma[k]),sizeof(float));
+        for (p = 0; p < s->np; p++)
+            hash.addData(reinterpret_cast<const char*>(s->rr[p]),3*sizeof(float));
+        for (p = 0; p < s->ntri; p++)
+            hash.addData(reinterpret_cast<const char*>(s->itris[p]),3*sizeof(int));
+    }
+    return QDir(bem_solution_cache_dir).filePath(QString::fromLatin1(hash.result().toHex()) + BEM_SOL_SUFFIX);
+}
+
+//=============================================================================================================
+
+int FwdBemModel::fwd_bem_save_solution(const QString& name, FwdBemModel *m)
+{
+    if (!m || !m->solution || m->nsol <= 0)
+        return FAIL;
+
+    if (!QDir().mkpath(QFileInfo(name).absolutePath()))
+        return FAIL;
+
+    /*
+     * QSaveFile writes into a unique temporary file next to the target and renames it atomically on commit,
+     * so that concurrent runs neither see a partial solution nor write into each other's temporary file
+     */
+    QSaveFile file(name);
+    {
+        FiffStream::SPtr stream = FiffStream::start_file(file);
+        if (!stream)
+            return FAIL;
+
+        fiff_int_t method = (m->bem_method == FWD_BEM_LINEAR_COLL) ? FIFFV_BEM_APPROX_LINEAR : FIFFV_BEM_APPROX_CONST;
+        Map<Matrix<float,Dynamic,Dynamic,RowMajor> > sol(m->solution[0],m->nsol,m->nsol);
+
+        stream->start_block(FIFFB_BEM);
+        stream->write_int(FIFF_BEM_APPROX,&method);
+        stream->write_float_matrix(FIFF_BEM_POT_SOLUTION,sol);
+        stream->end_block(FIFFB_BEM);
+        stream->end_file();
+    }
+    if (!file.commit())
+        return FAIL;
+    return OK;
 }
 
 //=============================================================================================================
@@ -245,6 +245,38 @@ public:
                                         int         force_recompute,
                                         FwdBemModel* m);
 
+    //=========================================================================================================
+    /**
+     * Sets the directory used to cache computed BEM solutions. An empty string disables the cache (default).
+     *
+     * @param[in] dir    The cache directory.
+     */
+    static void fwd_bem_set_solution_cache_dir(const QString& dir);
+
+    //=========================================================================================================
+    /**
+     * Returns the cache file name of the solution for the given model geometry, conductivities and method.
+     * The name is a SHA-1 digest of the surface vertices, triangulations and conductivities.
+     *
+     * @param[in] m            The BEM model.
+     * @param[in] bem_method   The BEM approximation method.
+     *
+     * @return The cache file name or an empty string if the cache is disabled.
+     */
+    static QString fwd_bem_make_solution_cache_name(FwdBemModel* m, int bem_method);
+
+    //=========================================================================================================
+    /**
+     * Writes the potential solution attached to the model into a fif file which can be read back with
+     * fwd_bem_load_solution.
+     *
+     * @param[in] name   The output file name.
+     * @param[in] m      The BEM model with a computed solution.
+     *
+     * @return OK on success, FAIL otherwise.
+     */
+    static int fwd_bem_save_solution(const QString& name, FwdBemModel* m);
+
     //============================= fwd_bem_pot.c =============================
 
     static float fwd_bem_inf_field(float *rd,      /* Dipole position */
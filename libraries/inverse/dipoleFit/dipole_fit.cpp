@@ -6,6 +6,8 @@
 
 #include <string.h>
 #include <QScopedPointer>
+#include <QVector>
+#include <QtConcurrent>
 
 using namespace INVERSELIB;
 using namespace MNELIB;
@@ -46,6 +48,10 @@ using namespace FWDLIB;
 
 #define SEG_LEN 10.0
 
+#define FIT_BATCH 512       /* How many raw data time points are collected before fitting them */
+
+#define FIT_CHUNK 32        /* How many consecutive time points are fitted together (one warm start sequence) */
+
 #define EPS_VALUES 0.05
 
 //=============================================================================================================
@@ -546,6 +552,183 @@ int mne_get_values_from_data_ch (float time,      /* Interesting time point */
     return (0);
 }
 
+namespace INVERSELIB
+{
+
+typedef struct {
+    DipoleFitData* fit;         /* Fitting data for this thread */
+    GuessData*     guess;       /* The initial guesses (read only) */
+    float          *times;      /* Time points of this chunk */
+    float          **data;      /* The projected and whitened data vectors, one for each time point */
+    const int      *cand;       /* The best guesses for each time point, best first */
+    int            ncand;       /* Candidates stored for each time point */
+    int            ntime;       /* How many time points */
+    int            warm_start;  /* Start each fit from the previous one? */
+    float          rd_prev[3];  /* The previous dipole position in this chunk (warm start only) */
+    int            have_prev;   /* Is rd_prev valid? */
+    int            verbose;
+    int            live;        /* Report the results as they come (single chunk only) */
+    int            nprev;       /* Number of dipoles fitted before this chunk (for reporting) */
+    ECD            *dips;       /* The results */
+    int            *fitted;     /* Which fits succeeded */
+} *fitChunkArg,fitChunkArgRec;
+
+}
+
+static void fit_one_chunk(fitChunkArg& arg)
+/*
+ * Fit the time points of one chunk in order
+ */
+{
+    int   nfit = arg->nprev;
+    int   report_interval = 10;
+    int   k,ncand;
+    const int *cand;
+
+    for (k = 0; k < arg->ntime; k++) {
+        cand = arg->cand + k*arg->ncand;
+        for (ncand = 0; ncand < arg->ncand && cand[ncand] >= 0; ncand++)
+            ;
+        arg->fitted[k] = DipoleFitData::fit_one_whitened(arg->fit,arg->guess,arg->times[k],arg->data[k],cand,ncand,arg->verbose,arg->dips[k],
+                                                         arg->warm_start && arg->have_prev ? arg->rd_prev : NULL);
+        if (arg->warm_start && arg->fitted[k]) {
+            arg->rd_prev[0] = arg->dips[k].rd[0];
+            arg->rd_prev[1] = arg->dips[k].rd[1];
+            arg->rd_prev[2] = arg->dips[k].rd[2];
+            arg->have_prev = TRUE;
+        }
+        if (!arg->live)
+            continue;
+        if (!arg->fitted[k])
+            printf("t = %7.1f ms : %s\n",1000*arg->times[k],"fit failed");
+        else {
+            nfit++;
+            if (arg->verbose)
+                arg->dips[k].print(stdout);
+            else if (nfit % report_interval == 0)
+                fprintf(stderr,"%d..",nfit);
+        }
+    }
+}
+
+static void fit_chunk_list(QList<fitChunkArg>& chunks)
+/*
+ * Fit the chunks assigned to one thread in order
+ */
+{
+    for (int k = 0; k < chunks.size(); k++)
+        fit_one_chunk(chunks[k]);
+}
+
+static int fit_time_points(DipoleFitData* fit,
+                           GuessData*     guess,
+                           float          *times,
+                           float          **data,
+                           int            ntime,
+                           int            nthreads,
+                           int            warm_start,
+                           int            verbose,
+                           ECDSet&        set)
+/*
+ * Fit a batch of time points, split into contiguous chunks of FIT_CHUNK time points.
+ * The initial guesses of the whole batch are scored with one matrix product first.
+ * The chunks are distributed over nthreads threads, each working on its own duplicate of the fitting data.
+ * With warm start each chunk starts from the best guess and every further fit of the chunk may start from
+ * the previous one. The chunks do not depend on the number of threads, so neither do the results.
+ * The results are added to the set in time order.
+ */
+{
+    QList<fitChunkArg> args;
+    QVector<ECD>       dips(ntime);
+    QVector<int>       fitted(ntime);
+    int                nchunk   = (ntime + FIT_CHUNK - 1)/FIT_CHUNK;
+    int                nworker  = qMax(1,qMin(nthreads,nchunk));
+    int                nchan    = fit->nmeg+fit->neeg;
+    int                report_interval = 10;
+    int                k,j,first,nfit;
+    fitChunkArg        arg;
+    QVector<DipoleFitData*>       fits(nworker);
+    QVector<QList<fitChunkArg> >  workers(nworker);
+    Eigen::MatrixXf    whitened;
+    Eigen::MatrixXi    cand;
+    Eigen::MatrixXf    cand_good;
+
+    if (ntime <= 0)
+        return OK;
+    /*
+     * Whiten the data and find the best guesses for all time points at once.
+     * Time points which cannot be whitened are left at zero and get no guesses.
+     */
+    whitened.setZero(nchan,ntime);
+    for (k = 0; k < ntime; k++)
+        if (DipoleFitData::whiten_fit_data(fit,data[k]) == OK)
+            whitened.col(k) = Eigen::Map<Eigen::VectorXf>(data[k],nchan);
+    guess->find_best_guesses(whitened,DIPOLE_FIT_LIMIT,fit->guess_ncand,cand,cand_good);
+
+    for (k = 0; k < nworker; k++)
+        fits[k] = nworker > 1 ? DipoleFitData::create_thread_duplicate(fit) : fit;
+
+    for (k = 0, first = 0; k < nchunk; k++) {
+        arg = MALLOC(1,fitChunkArgRec);
+        arg->fit        = fits[k % nworker];
+        arg->guess      = guess;
+        arg->ntime      = qMin(FIT_CHUNK,ntime-first);
+        arg->times      = times + first;
+        arg->data       = data + first;
+        arg->cand       = cand.data() + first*cand.rows();
+        arg->ncand      = cand.rows();
+        arg->warm_start = warm_start;
+        arg->have_prev  = FALSE;
+        arg->verbose    = nworker > 1 ? FALSE : verbose;     /* Simplex reports from several threads would be interleaved */
+        arg->live       = nworker == 1;
+        arg->nprev      = set.size();
+        arg->dips       = dips.data() + first;
+        arg->fitted     = fitted.data() + first;
+        first += arg->ntime;
+        args.append(arg);
+        workers[k % nworker].append(arg);
+    }
+
+    if (nworker > 1)
+        QtConcurrent::blockingMap(workers,fit_chunk_list);
+    else {
+        /*
+         * One thread fits the chunks in order and reports the results as they come
+         */
+        for (k = 0, nfit = set.size(); k < nchunk; k++) {
+            args[k]->nprev = nfit;
+            fit_one_chunk(args[k]);
+            for (j = 0; j < args[k]->ntime; j++)
+                if (args[k]->fitted[j])
+                    nfit++;
+        }
+    }
+
+    for (k = 0; k < ntime; k++) {
+        if (nworker == 1) {
+            if (fitted[k])
+                set.addEcd(dips[k]);
+            continue;
+        }
+        if (!fitted[k])
+            printf("t = %7.1f ms : %s\n",1000*times[k],"fit failed");
+        else {
+            set.addEcd(dips[k]);
+            if (verbose)
+                dips[k].print(stdout);
+            else if (set.size() % report_interval == 0)
+                fprintf(stderr,"%d..",set.size());
+        }
+    }
+
+    for (k = 0; k < args.size(); k++)
+        FREE(args[k]);
+    for (k = 0; k < nworker; k++)
+        if (nworker > 1)
+            DipoleFitData::free_thread_duplicate(fits[k]);
+    return OK;
+}
+
 //=============================================================================================================
 // DEFINE MEMBER METHODS
 //=============================================================================================================
@@ -594,6 +777,7 @@ ECDSet DipoleFit::calculateFit() const
         goto out;
 
     fit_data->fit_mag_dipoles = settings->fit_mag_dipoles;
+    fit_data->guess_ncand     = settings->guess_ncand;
     if (settings->is_raw) {
         int c;
         float t1,t2;
@@ -670,11 +854,11 @@ ECDSet DipoleFit::calculateFit() const
              1000*settings->tmin,1000*settings->tmax,1000*settings->tstep,1000*settings->integ);
 
     if (raw) {
-        if (fit_dipoles_raw(settings->measname,raw,sel,fit_data,guess.take(),settings->tmin,settings->tmax,settings->tstep,settings->integ,settings->verbose) == FAIL)
+        if (fit_dipoles_raw(settings->measname,raw,sel,fit_data,guess.take(),settings->tmin,settings->tmax,settings->tstep,settings->integ,settings->verbose,settings->nthreads,settings->warm_start) == FAIL)
             goto out;
     }
     else {
-        if (fit_dipoles(settings->measname,data,fit_data,guess.take(),settings->tmin,settings->tmax,settings->tstep,settings->integ,settings->verbose,set) == FAIL)
+        if (fit_dipoles(settings->measname,data,fit_data,guess.take(),settings->tmin,settings->tmax,settings->tstep,settings->integ,settings->verbose,set,settings->nthreads,settings->warm_start) == FAIL)
             goto out;
     }
     printf("%d dipoles fitted\n",set.size());
@@ -686,52 +870,55 @@ out : {
 
 //=============================================================================================================
 
-int DipoleFit::fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set)
+int DipoleFit::fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set, int nthreads, bool warm_start)
 {
-    float *one = MALLOC(data->nchan,float);
+    float **vals;
+    float *times;
     float time;
     ECDSet set;
-    ECD   dip;
-    int   s;
-    int   report_interval = 10;
+    int   s,ntime,nmax;
 
     set.dataname = dataname;
 
-    fprintf(stderr,"Fitting...%c",verbose ? '\n' : '\0');
-    for (s = 0, time = tmin; time < tmax; s++, time = tmin  + s*tstep) {
-        /*
-     * Pick the data point
+    for (nmax = 0, time = tmin; time < tmax; nmax++, time = tmin + nmax*tstep)
+        ;
+    if (nmax == 0) {
+        p_set = set;
+        return OK;
+    }
+    vals  = ALLOC_CMATRIX(nmax,data->nchan);
+    times = MALLOC(nmax,float);
+    /*
+     * Pick the data points
      */
+    for (s = 0, ntime = 0, time = tmin; time < tmax; s++, time = tmin  + s*tstep) {
         if (mne_get_values_from_data(time,integ,data->current->data,data->current->np,data->nchan,data->current->tmin,
-                                     1.0/data->current->tstep,FALSE,one) == FAIL) {
+                                     1.0/data->current->tstep,FALSE,vals[ntime]) == FAIL) {
             fprintf(stderr,"Cannot pick time: %7.1f ms\n",1000*time);
             continue;
         }
-
-        if (!DipoleFitData::fit_one(fit,guess,time,one,verbose,dip))
-            printf("t = %7.1f ms : %s\n",1000*time,"error (tbd: catch)");
-        else {
-            set.addEcd(dip);
-            if (verbose)
-                dip.print(stdout);
-            else {
-                if (set.size() % report_interval == 0)
-                    fprintf(stderr,"%d..",set.size());
-            }
-        }
+        times[ntime++] = time;
     }
+    if (nthreads > 1)
+        fprintf(stderr,"Fitting %d time points in %d threads...%c",ntime,nthreads,verbose ? '\n' : '\0');
+    else
+        fprintf(stderr,"Fitting...%c",verbose ? '\n' : '\0');
+    fit_time_points(fit,guess,times,vals,ntime,nthreads,warm_start,verbose,set);
     if (!verbose)
         fprintf(stderr,"[done]\n");
-    FREE(one);
+    FREE_CMATRIX(vals);
+    FREE(times);
     p_set = set;
     return OK;
 }
 
 //=============================================================================================================
 
-int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set)
+int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set, int nthreads, bool warm_start)
 {
-    float *one    = MALLOC(sel->nchan,float);
+    float **vals  = ALLOC_CMATRIX(FIT_BATCH,sel->nchan);
+    float *times  = MALLOC(FIT_BATCH,float);
+    int   nbatch  = 0;
     float sfreq   = raw->info->sfreq;
     float myinteg = integ > 0.0 ? 2*integ : 0.1;
     int   overlap = ceil(myinteg*sfreq);
@@ -742,9 +929,7 @@ int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSe
     int   s,picks;
     float time,stime;
     float **data  = ALLOC_CMATRIX(sel->nchan,length);
-    ECD    dip;
     ECDSet set;
-    int    report_interval = 10;
 
     set.dataname = dataname;
 
@@ -767,43 +952,40 @@ int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSe
         /*
      * Get the values
      */
-        if (mne_get_values_from_data_ch (time,integ,data,length,sel->nchan,stime,sfreq,FALSE,one) == FAIL) {
+        if (mne_get_values_from_data_ch (time,integ,data,length,sel->nchan,stime,sfreq,FALSE,vals[nbatch]) == FAIL) {
             fprintf(stderr,"Cannot pick time: %8.3f s\n",time);
             continue;
         }
+        times[nbatch++] = time;
         /*
-     * Fit
+     * Fit when a batch is complete
      */
-        if (!DipoleFitData::fit_one(fit,guess,time,one,verbose,dip))
-            qWarning() << "Error";
-        else {
-            set.addEcd(dip);
-            if (verbose)
-                dip.print(stdout);
-            else {
-                if (set.size() % report_interval == 0)
-                    fprintf(stderr,"%d..",set.size());
-            }
+        if (nbatch == FIT_BATCH) {
+            fit_time_points(fit,guess,times,vals,nbatch,nthreads,warm_start,verbose,set);
+            nbatch = 0;
         }
     }
+    fit_time_points(fit,guess,times,vals,nbatch,nthreads,warm_start,verbose,set);
     if (!verbose)
         fprintf(stderr,"[done]\n");
     FREE_CMATRIX(data);
-    FREE(one);
+    FREE_CMATRIX(vals);
+    FREE(times);
     p_set = set;
     return OK;
 
 bad : {
         FREE_CMATRIX(data);
-        FREE(one);
+        FREE_CMATRIX(vals);
+        FREE(times);
         return FAIL;
     }
 }
 
 //=============================================================================================================
 
-int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose)
+int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, int nthreads, bool warm_start)
 {
     ECDSet set;
-    return fit_dipoles_raw(dataname, raw, sel, fit, guess, tmin, tmax, tstep, integ, verbose, set);
+    return fit_dipoles_raw(dataname, raw, sel, fit, guess, tmin, tmax, tstep, integ, verbose, set, nthreads, warm_start);
 }
@@ -112,10 +112,12 @@ public:
      * @param[in] integ      Integration time.
      * @param[in] verbose    Verbose output?.
      * @param[out] p_set     the fitted ECD Set.
+     * @param[in] nthreads   Number of threads to fit the time points with (default 1).
+     * @param[in] warm_start Start each fit from the previous time point's dipole if it explains the data better than the best guess. The previous dipole is only used within chunks of consecutive time points, so the results do not depend on nthreads.
      *
      * @return true when successful.
      */
-    static int fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set);
+    static int fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set, int nthreads = 1, bool warm_start = false);
 
     //=========================================================================================================
     /**
@@ -134,10 +136,12 @@ public:
      * @param[in] integ      Integration time.
      * @param[in] verbose    Verbose output?.
      * @param[out] p_set     Return all results here. Warning: for large data files this may take a lot of memory.
+     * @param[in] nthreads   Number of threads to fit the time points with (default 1).
+     * @param[in] warm_start Start each fit from the previous time point's dipole if it explains the data better than the best guess. The previous dipole is only used within chunks of consecutive time points, so the results do not depend on nthreads.
      *
      * @return true when successful.
      */
-    static int fit_dipoles_raw(const QString& dataname, MNELIB::MneRawData* raw, MNELIB::mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set);
+    static int fit_dipoles_raw(const QString& dataname, MNELIB::MneRawData* raw, MNELIB::mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set, int nthreads = 1, bool warm_start = false);
 
     //=========================================================================================================
     /**
@@ -155,10 +159,12 @@ public:
      * @param[in] tstep      Time step to use.
      * @param[in] integ      Integration time.
      * @param[in] verbose    Verbose output?.
+     * @param[in] nthreads   Number of threads to fit the time points with (default 1).
+     * @param[in] warm_start Start each fit from the previous time point's dipole if it explains the data better than the best guess. The previous dipole is only used within chunks of consecutive time points, so the results do not depend on nthreads.
      *
      * @return true when successful.
      */
-    static int fit_dipoles_raw(const QString& dataname, MNELIB::MneRawData* raw, MNELIB::mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose);
+    static int fit_dipoles_raw(const QString& dataname, MNELIB::MneRawData* raw, MNELIB::mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, int nthreads = 1, bool warm_start = false);
 
 private:
     DipoleFitSettings* settings;
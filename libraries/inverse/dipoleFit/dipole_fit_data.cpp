@@ -3355,6 +3355,7 @@ DipoleFitData::DipoleFitData()
 , funcs (NULL)
 , column_norm (COLUMN_NORM_NONE)
 , fit_mag_dipoles (FALSE)
+, guess_ncand (1)
 {
     r0[0] = 0.0f;
     r0[1] = 0.0f;
@@ -3559,6 +3560,160 @@ out :
 
 //=============================================================================================================
 
+static FwdBemModel* dup_bem_model(FwdBemModel* orig)
+/*
+ * Share everything except the workspace for the infinite-medium potentials
+ */
+{
+    FwdBemModel* res = new FwdBemModel;
+
+    *res    = *orig;
+    res->v0 = NULL;
+    return res;
+}
+
+static void free_dup_bem_model(FwdBemModel* m)
+{
+    if (!m)
+        return;
+    FREE_3(m->v0);
+    /*
+     * Detach the shared parts so that the destructor leaves them alone
+     */
+    m->surfs.clear();
+    m->nsurf       = 0;
+    m->ntri        = NULL;
+    m->np          = NULL;
+    m->sigma       = NULL;
+    m->gamma       = NULL;
+    m->source_mult = NULL;
+    m->field_mult  = NULL;
+    m->head_mri_t  = NULL;
+    m->solution    = NULL;
+    m->v0          = NULL;
+    delete m;
+}
+
+static FwdCompData* dup_comp_data(FwdCompData* orig, FwdBemModel* orig_bem, FwdBemModel* bem)
+/*
+ * The compensation set and the work areas are modified during the field computations
+ */
+{
+    FwdCompData* res = new FwdCompData;
+
+    *res = *orig;
+    res->work     = NULL;
+    res->vec_work = NULL;
+    res->set      = orig->set ? new MneCTFCompDataSet(*(orig->set)) : NULL;
+    if (orig_bem && orig->client == orig_bem)
+        res->client = bem;
+    return res;
+}
+
+static void free_dup_comp_data(FwdCompData* comp)
+{
+    if (!comp)
+        return;
+    comp->comp_coils  = NULL;
+    comp->client      = NULL;
+    comp->client_free = NULL;
+    delete comp;
+}
+
+static dipoleFitFuncs dup_dipole_fit_funcs(dipoleFitFuncs orig, FwdBemModel* orig_bem, FwdBemModel* bem)
+
+{
+    dipoleFitFuncs f;
+
+    if (!orig)
+        return NULL;
+
+    f = new_dipole_fit_funcs();
+    *f = *orig;
+    if (orig->meg_client && orig->meg_client_free == FwdCompData::fwd_free_comp_data)
+        f->meg_client = dup_comp_data((FwdCompData*)orig->meg_client,orig_bem,bem);
+    if (orig_bem && orig->eeg_client == orig_bem)
+        f->eeg_client = bem;
+    return f;
+}
+
+static void free_dup_dipole_fit_funcs(dipoleFitFuncs f)
+
+{
+    if (!f)
+        return;
+
+    if (f->meg_client && f->meg_client_free == FwdCompData::fwd_free_comp_data)
+        free_dup_comp_data((FwdCompData*)f->meg_client);
+    FREE_3(f);
+    return;
+}
+
+//=============================================================================================================
+
+DipoleFitData* DipoleFitData::create_thread_duplicate(DipoleFitData *d)
+{
+    DipoleFitData* res;
+
+    if (!d)
+        return NULL;
+
+    res = new DipoleFitData;
+    *res = *d;
+
+    res->bem_model        = d->bem_model ? dup_bem_model(d->bem_model) : NULL;
+    res->sphere_funcs     = dup_dipole_fit_funcs(d->sphere_funcs,d->bem_model,res->bem_model);
+    res->bem_funcs        = dup_dipole_fit_funcs(d->bem_funcs,d->bem_model,res->bem_model);
+    res->mag_dipole_funcs = dup_dipole_fit_funcs(d->mag_dipole_funcs,d->bem_model,res->bem_model);
+
+    if (d->funcs == d->bem_funcs)
+        res->funcs = res->bem_funcs;
+    else if (d->funcs == d->mag_dipole_funcs)
+        res->funcs = res->mag_dipole_funcs;
+    else
+        res->funcs = res->sphere_funcs;
+
+    res->user      = NULL;
+    res->user_free = NULL;
+
+    return res;
+}
+
+//=============================================================================================================
+
+void DipoleFitData::free_thread_duplicate(DipoleFitData *d)
+{
+    if (!d)
+        return;
+
+    free_dup_dipole_fit_funcs(d->sphere_funcs);
+    free_dup_dipole_fit_funcs(d->bem_funcs);
+    free_dup_dipole_fit_funcs(d->mag_dipole_funcs);
+    free_dup_bem_model(d->bem_model);
+    /*
+     * Everything else belongs to the original
+     */
+    d->sphere_funcs     = NULL;
+    d->bem_funcs        = NULL;
+    d->mag_dipole_funcs = NULL;
+    d->funcs            = NULL;
+    d->bem_model        = NULL;
+    d->mri_head_t       = NULL;
+    d->meg_head_t       = NULL;
+    d->meg_coils        = NULL;
+    d->eeg_els          = NULL;
+    d->eeg_model        = NULL;
+    d->noise            = NULL;
+    d->noise_orig       = NULL;
+    d->pick             = NULL;
+    d->proj             = NULL;
+    d->user             = NULL;
+    d->user_free        = NULL;
+    delete d;
+}
+
+//=============================================================================================================
+
 MneCovMatrix* DipoleFitData::ad_hoc_noise(FwdCoilSet *meg, FwdCoilSet *eeg, float grad_std, float mag_std, float eeg_std)
 /*
      * Specify constant noise values
@@ -4363,48 +4518,6 @@ static float fit_eval(float *rd,int npar,void *user)
     return fuser->B2-Bm2;
 }
 
-static int find_best_guess(float     *B,         /* The whitened data */
-                           int       nch,
-                           GuessData* guess,	 /* Guesses */
-                           float     limit,	 /* Pseudoradial component omission limit */
-                           int       *bestp,	 /* Which is the best */
-                           float     *goodp)	 /* Best goodness of fit */
-/*
- * Thanks to the precomputed SVD everything is really simple
- */
-{
-    int    k,c;
-    double B2,Bm2,this_good,one;
-    int    best = -1;
-    float  good = 0.0;
-    DipoleForward* fwd;
-    int    ncomp;
-
-    B2 = mne_dot_vectors_3(B,B,nch);
-    for (k = 0; k < guess->nguess; k++) {
-        fwd = guess->guess_fwd[k];
-        if (fwd->nch == nch) {
-            ncomp = fwd->sing[2]/fwd->sing[0] > limit ? 3 : 2;
-            for (c = 0, Bm2 = 0.0; c < ncomp; c++) {
-                one = mne_dot_vectors_3(fwd->uu[c],B,nch);
-                Bm2 = Bm2 + one*one;
-            }
-            this_good = 1.0 - (B2 - Bm2)/B2;
-            if (this_good > good) {
-                best = k;
-                good = this_good;
-            }
-        }
-    }
-    if (best < 0) {
-        printf("No reasonable initial guess found.");
-        return FAIL;
-    }
-     *bestp = best;
-     *goodp = good;
-    return OK;
-}
-
 static float **make_initial_dipole_simplex(float  *r0,
                                            float  size)
 /*
@@ -4663,12 +4776,55 @@ bool DipoleFitData::fit_one(DipoleFitData* fit,	            /* Precomputed fitti
                     float         time,              /* Which time is it? */
                     float         *B,	            /* The field to fit */
                     int           verbose,
-                    ECD&          res               /* The fitted dipole */
+                    ECD&          res,              /* The fitted dipole */
+                    const float   *rd_start         /* Optional starting point, e.g., the previous fit */
                     )
+{
+    MatrixXi cand;
+    MatrixXf cand_good;
+    int      ncand;
+
+    if (whiten_fit_data(fit,B) == FAIL)
+        return false;
+    /*
+   * Get the initial guesses: all of them are scored with one matrix product
+   */
+    if (!guess->find_best_guesses(Map<MatrixXf>(B,fit->nmeg+fit->neeg,1),DIPOLE_FIT_LIMIT,fit->guess_ncand,cand,cand_good)) {
+        printf("No reasonable initial guess found.");
+        return false;
+    }
+    for (ncand = 0; ncand < cand.rows() && cand(ncand,0) >= 0; ncand++)
+        ;
+    return fit_one_whitened(fit,guess,time,B,cand.data(),ncand,verbose,res,rd_start);
+}
+
+//=============================================================================================================
+
+int DipoleFitData::whiten_fit_data(DipoleFitData* fit, float *B)
+{
+    int nchan = fit->nmeg+fit->neeg;
+
+    if (MneProjOp::mne_proj_op_proj_vector(fit->proj,B,nchan,TRUE) == FAIL)
+        return FAIL;
+    return mne_whiten_one_data(B,B,nchan,fit->noise);
+}
+
+//=============================================================================================================
+
+bool DipoleFitData::fit_one_whitened(DipoleFitData* fit,   /* Precomputed fitting data */
+                             GuessData*     guess,         /* The initial guesses */
+                             float         time,           /* Which time is it? */
+                             float         *B,             /* The projected and whitened field to fit */
+                             const int     *cand,          /* The guesses to start from, best first */
+                             int           ncand,
+                             int           verbose,
+                             ECD&          res,            /* The fitted dipole */
+                             const float   *rd_start       /* Optional starting point, e.g., the previous fit */
+                             )
 {
     float  **simplex       = NULL;	       /* The simplex */
     float  vals[4];			       /* Values at the vertices */
-    float  limit           = 0.2;	               /* (pseudo) radial component omission limit */
+    float  limit           = DIPOLE_FIT_LIMIT;      /* (pseudo) radial component omission limit */
     float  size            = 1e-2;	       /* Size of the initial simplex */
     float  ftol[]          = { 1e-2, 1e-2 };     /* Tolerances on the the two passes */
     float  atol[]          = { 0.2e-3, 0.2e-3 }; /* If dipole movement between two iterations is less than this,
@@ -4677,24 +4833,17 @@ bool DipoleFitData::fit_one(DipoleFitData* fit,	            /* Precomputed fitti
     int    max_eval        = 1000;	       /* Limit for fit function evaluations */
     int    report_interval = verbose ? 1 : -1;   /* How often to report the intermediate result */
 
-    int        best;
-    float      good,rd_guess[3],rd_final[3],Q[3],final_val;
+    float      rd_guess[3],rd_final[3],Q[3],final_val;
+    float      this_rd[3],this_val;
     fitDipUserRec user;
-    int        k,p,neval,neval_tot,nchan,ncomp;
-    int        fit_fail;
+    int        k,p,c,neval,neval_tot,nchan,ncomp;
+    int        fit_fail,this_fail,this_ok,have_fit;
+    float      **starts = NULL;
 
     nchan = fit->nmeg+fit->neeg;
     user.fwd = NULL;
 
-    if (MneProjOp::mne_proj_op_proj_vector(fit->proj,B,nchan,TRUE) == FAIL)
-        goto bad;
-
-    if (mne_whiten_one_data(B,B,nchan,fit->noise) == FAIL)
-        goto bad;
-    /*
-   * Get the initial guess
-   */
-    if (find_best_guess(B,nchan,guess,limit,&best,&good) < 0)
+    if (ncand <= 0)
         goto bad;
 
     user.limit = limit;
@@ -4704,49 +4853,90 @@ bool DipoleFitData::fit_one(DipoleFitData* fit,	            /* Precomputed fitti
     user.report_dim = FALSE;
     fit->user  = &user;
 
-    VEC_COPY_3(rd_guess,guess->rr[best]);
-    VEC_COPY_3(rd_final,guess->rr[best]);
+    starts = ALLOC_CMATRIX_3(ncand,3);
+    for (c = 0; c < ncand; c++)
+        VEC_COPY_3(starts[c],guess->rr[cand[c]]);
+    /*
+   * Warm start: the given location is inserted in front of the candidates if it explains the data better than the best guess.
+   * The other candidates move back by one and the last one is dropped.
+   */
+    if (rd_start) {
+        float rd_try[3];
+
+        VEC_COPY_3(rd_try,rd_start);
+        fit->funcs = fit->sphere_funcs;
+        if (fit_eval(rd_try,3,fit) < fit_eval(starts[0],3,fit)) {
+            for (c = ncand-1; c > 0; c--)
+                VEC_COPY_3(starts[c],starts[c-1]);
+            VEC_COPY_3(starts[0],rd_try);
+        }
+    }
+    VEC_COPY_3(rd_final,starts[0]);
 
     neval_tot = 0;
-    fit_fail = FALSE;
-    for (k = 0; k < ntol; k++) {
-        /*
-     * Do first pass with the sphere model
-     */
-        if (k == 0)
-            fit->funcs = fit->sphere_funcs;
-        else
-            fit->funcs = !fit->bemname.isEmpty() ? fit->bem_funcs : fit->sphere_funcs;
-
-        simplex = make_initial_dipole_simplex(rd_guess,size);
-        for (p = 0; p < 4; p++)
-            vals[p] = fit_eval(simplex[p],3,fit);
-        if (simplex_minimize(simplex,           /* The initial simplex */
-                             vals,              /* Function values at the vertices */
-                             3,                 /* Number of variables */
-                             ftol[k],           /* Relative convergence tolerance for the target function */
-                             atol[k],           /* Absolute tolerance for the change in the parameters */
-                             fit_eval,          /* The function to be evaluated */
-                             fit,               /* Data to be passed to the above function in each evaluation */
-                             max_eval,          /* Maximum number of function evaluations */
-                             &neval,            /* Number of function evaluations */
-                             report_interval,   /* How often to report (-1 = no_reporting) */
-                             report_func) != OK) {
+    fit_fail  = FALSE;
+    have_fit  = FALSE;
+    final_val = 0.0;
+    /*
+   * Refine each candidate and keep the best result
+   */
+    for (c = 0; c < ncand; c++) {
+        VEC_COPY_3(rd_guess,starts[c]);
+        VEC_COPY_3(this_rd,starts[c]);
+        this_fail = FALSE;
+        this_ok   = TRUE;
+        this_val  = 0.0;
+        for (k = 0; k < ntol; k++) {
+            /*
+         * Do first pass with the sphere model
+         */
             if (k == 0)
-                goto bad;
-            else {
-                printf("\nWarning (t = %8.1f ms) : g = %6.1f %% final val = %7.3f rtol = %f\n",
-                       1000*time,100*(1 - vals[0]/user.B2),vals[0],rtol(vals,4));
-                fit_fail = TRUE;
+                fit->funcs = fit->sphere_funcs;
+            else
+                fit->funcs = !fit->bemname.isEmpty() ? fit->bem_funcs : fit->sphere_funcs;
+
+            simplex = make_initial_dipole_simplex(rd_guess,size);
+            for (p = 0; p < 4; p++)
+                vals[p] = fit_eval(simplex[p],3,fit);
+            if (simplex_minimize(simplex,           /* The initial simplex */
+                                 vals,              /* Function values at the vertices */
+                                 3,                 /* Number of variables */
+                                 ftol[k],           /* Relative convergence tolerance for the target function */
+                                 atol[k],           /* Absolute tolerance for the change in the parameters */
+                                 fit_eval,          /* The function to be evaluated */
+                                 fit,               /* Data to be passed to the above function in each evaluation */
+                                 max_eval,          /* Maximum number of function evaluations */
+                                 &neval,            /* Number of function evaluations */
+                                 report_interval,   /* How often to report (-1 = no_reporting) */
+                                 report_func) != OK) {
+                if (k == 0) {
+                    this_ok = FALSE;
+                    neval_tot += neval;
+                    FREE_CMATRIX_3(simplex); simplex = NULL;
+                    break;
+                }
+                else {
+                    printf("\nWarning (t = %8.1f ms) : g = %6.1f %% final val = %7.3f rtol = %f\n",
+                           1000*time,100*(1 - vals[0]/user.B2),vals[0],rtol(vals,4));
+                    this_fail = TRUE;
+                }
             }
-        }
-        VEC_COPY_3(rd_final,simplex[0]);
-        VEC_COPY_3(rd_guess,simplex[0]);
-        FREE_CMATRIX_3(simplex); simplex = NULL;
+            VEC_COPY_3(this_rd,simplex[0]);
+            VEC_COPY_3(rd_guess,simplex[0]);
+            FREE_CMATRIX_3(simplex); simplex = NULL;
 
-        neval_tot += neval;
-        final_val  = vals[0];
+            neval_tot += neval;
+            this_val   = vals[0];
+        }
+        if (this_ok && (!have_fit || this_val < final_val)) {
+            VEC_COPY_3(rd_final,this_rd);
+            final_val = this_val;
+            fit_fail  = this_fail;
+            have_fit  = TRUE;
+        }
     }
+    if (!have_fit)
+        goto bad;
     /*
    * Confidence limits should be computed here
    */
@@ -4774,12 +4964,14 @@ bool DipoleFitData::fit_one(DipoleFitData* fit,	            /* Precomputed fitti
         goto bad;
     delete user.fwd;
     FREE_CMATRIX_3(simplex);
+    FREE_CMATRIX_3(starts);
 
     return true;
 
 bad : {
         delete user.fwd;
         FREE_CMATRIX_3(simplex);
+        FREE_CMATRIX_3(starts);
         return false;
     }
 }
@@ -67,6 +67,8 @@
 #define COLUMN_NORM_COMP 1	    /* Componentwise normalization */
 #define COLUMN_NORM_LOC  2	    /* Dipole locationwise normalization */
 
+#define DIPOLE_FIT_LIMIT 0.2f      /* (Pseudo) radial component omission limit */
+
 //=============================================================================================================
 // DEFINE NAMESPACE INVERSELIB
 //=============================================================================================================
@@ -177,8 +179,58 @@ public:
      * @param[in] B          The field to fit.
      * @param[in] verbose.
      * @param[in] res        The fitted dipole.
+     * @param[in] rd_start   Optional starting location (e.g. the previous fit). It is used instead of the best
+     *                       guess if it explains more of the data.
+     */
+    static bool fit_one(DipoleFitData* fit, GuessData* guess, float time, float *B, int verbose, ECD& res, const float *rd_start = NULL);
+
+    //=========================================================================================================
+    /**
+     * Apply the projection and the noise whitening of the fitting data to a data vector in place.
+     *
+     * @param[in] fit        Precomputed fitting data.
+     * @param[in,out] B      The data vector.
+     *
+     * @return OK on success, FAIL otherwise.
+     */
+    static int whiten_fit_data(DipoleFitData* fit, float *B);
+
+    //=========================================================================================================
+    /**
+     * Fit a single dipole to data which have already been projected and whitened, starting from given guesses.
+     * The guesses are refined in order and the best result is kept.
+     *
+     * @param[in] fit        Precomputed fitting data.
+     * @param[in] guess      The initial guesses.
+     * @param[in] time       Which time is it?.
+     * @param[in] B          The projected and whitened field to fit.
+     * @param[in] cand       Indices of the guesses to start from, best first.
+     * @param[in] ncand      Number of guesses in cand.
+     * @param[in] verbose.
+     * @param[in] res        The fitted dipole.
+     * @param[in] rd_start   Optional starting location (e.g. the previous fit).
+     */
+    static bool fit_one_whitened(DipoleFitData* fit, GuessData* guess, float time, float *B, const int *cand, int ncand, int verbose, ECD& res, const float *rd_start = NULL);
+
+    //=========================================================================================================
+    /**
+     * Create a duplicate of the fitting data which can be used by a fitting thread concurrently with the
+     * original. The read-only parts (coils, noise covariance, projection, solution matrices) are shared,
+     * the forward calculation workspaces are private to the duplicate.
+     *
+     * @param[in] d      The fitting data to duplicate.
+     *
+     * @return The duplicate, to be released with free_thread_duplicate.
+     */
+    static DipoleFitData* create_thread_duplicate(DipoleFitData* d);
+
+    //=========================================================================================================
+    /**
+     * Release a duplicate created with create_thread_duplicate without touching the shared data.
+     *
+     * @param[in] d      The duplicate.
      */
-    static bool fit_one(DipoleFitData* fit, GuessData* guess, float time, float *B, int verbose, ECD& res);
+    static void free_thread_duplicate(DipoleFitData* d);
 
 //============================= dipole_forward.c
 
@@ -219,6 +271,7 @@ public:
       MNELIB::MneProjOp*        proj;               /**< The projection operator to use. */
       int               column_norm;        /**< What kind of column normalization to apply to the forward solution. */
       int               fit_mag_dipoles;    /**< Fit magnetic dipoles?. */
+      int               guess_ncand;        /**< Number of best initial guesses refined with the simplex. */
       void              *user;              /**< User data for anything we need. */
       fitUserFreeFunc   user_free;          /**< Function to free the above. */
 
@@ -2,6 +2,8 @@
 
 #include "dipole_fit_settings.h"
 
+#include <QThread>
+
 using namespace Eigen;
 using namespace INVERSELIB;
 
@@ -103,6 +105,8 @@ void DipoleFitSettings::initMembers()
     do_baseline  = false;         
     setno        = 1;             
     verbose      = false;
+    nthreads     = 1;
+    warm_start   = false;
     omit_data_proj = false;
 
          
@@ -110,6 +114,7 @@ void DipoleFitSettings::initMembers()
     scale_eeg_pos  = false;     
     mag_reg      = 0.1f;         
     fit_mag_dipoles = false;
+    guess_ncand  = 1;
 
     grad_reg     = 0.1f;         
     eeg_reg      = 0.1f;                  
@@ -262,7 +267,10 @@ void DipoleFitSettings::usage(char *name)
     printf("\t--exclude dist/mm Exclude points which are closer than this distance from the CM of the inner skull surface (default =  %6.1f mm).\n",1000*guess_exclude);
     printf("\t--mindist dist/mm Exclude points which are closer than this distance from the inner skull surface  (default = %6.1f mm).\n",1000*guess_mindist);
     printf("\t--grid    dist/mm Source space grid size (default = %6.1f mm).\n",1000*guess_grid);
+    printf("\t--guesscand n     Refine the n best initial guesses and keep the best fit (default = 1).\n");
     printf("\t--magdip          Fit magnetic dipoles instead of current dipoles.\n");
+    printf("\t--threads n       Fit the time points in n parallel threads (0 = one per processor, default = 1).\n");
+    printf("\t--warmstart       Start each fit from the previous dipole if it explains the data better than the best guess (within chunks of consecutive time points).\n");
     printf("\nOutput:\n\n");
     printf("\t--dip     name    xfit dip format output file name\n");
     printf("\t--bdip    name    xfit bdip format output file name\n");
@@ -803,6 +811,18 @@ bool DipoleFitSettings::check_args (int *argc,char **argv)
             filter.size       = filter_size;
             filter.taper_size = filter_size/2;
         }
+        else if (strcmp(argv[k],"--guesscand") == 0) {
+            found = 2;
+            if (k == *argc - 1) {
+                qCritical ("--guesscand: argument required.");
+                return false;
+            }
+            if (sscanf(argv[k+1],"%d",&ival) != 1 || ival < 1) {
+                qCritical() << "Illegal number of guess candidates:" << argv[k+1];
+                return false;
+            }
+            guess_ncand = ival;
+        }
         else if (strcmp(argv[k],"--magdip") == 0) {
             found = 1;
             fit_mag_dipoles = true;
@@ -827,6 +847,22 @@ bool DipoleFitSettings::check_args (int *argc,char **argv)
             found = 1;
             verbose = true;
         }
+        else if (strcmp(argv[k],"--threads") == 0) {
+            found = 2;
+            if (k == *argc - 1) {
+                qCritical ("--threads: argument required.");
+                return false;
+            }
+            if (sscanf(argv[k+1],"%d",&ival) != 1 || ival < 0) {
+                qCritical() << "Illegal number of threads:" << argv[k+1];
+                return false;
+            }
+            nthreads = ival > 0 ? ival : QThread::idealThreadCount();
+        }
+        else if (strcmp(argv[k],"--warmstart") == 0) {
+            found = 1;
+            warm_start = true;
+        }
         if (found) {
             for (int p = k; p < *argc-found; p++)
                 argv[p] = argv[p+found];
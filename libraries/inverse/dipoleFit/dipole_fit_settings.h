@@ -144,6 +144,8 @@ float guess_rad;       			/**< Radius of spherical guess surface. */
     bool  do_baseline;         		/**< Are both baseline limits set?. */
     int   setno;             		/**< Which data set. */
     bool  verbose;
+    int   nthreads;                 /**< Number of threads used to fit the time points. */
+    bool  warm_start;               /**< Start each fit from the previous one?. */
     MNELIB::mneFilterDefRec filter;
     QStringList projnames;              /**< Projection file names. */
     bool omit_data_proj;
@@ -154,6 +156,7 @@ float guess_rad;       			/**< Radius of spherical guess surface. */
     bool    scale_eeg_pos;     		/**< Scale the electrode locations to scalp in the sphere model. */
     float  mag_reg;         		/**< Noise-covariance matrix regularization for MEG (magnetometers and axial gradiometers) . */
     bool   fit_mag_dipoles;
+    int    guess_ncand;             /**< Number of best initial guesses to refine. */
 
     float  grad_reg;         		/**< Noise-covariance matrix regularization for EEG (planar gradiometers). */
     float  eeg_reg;         		/**< Noise-covariance matrix regularization for EEG . */
@@ -49,6 +49,8 @@
 
 #include <QFile>
 
+#include <algorithm>
+
 //=============================================================================================================
 // USED NAMESPACES
 //=============================================================================================================
@@ -92,6 +94,8 @@ using namespace INVERSELIB;
 
 #define ALLOC_CMATRIX_16(x,y) mne_cmatrix_16((x),(y))
 
+#define GUESS_BLOCK 1024    /* Number of guesses scored with one matrix product */
+
 static void matrix_error_16(int kind, int nr, int nc)
 
 {
@@ -264,6 +268,7 @@ GuessData::GuessData(const QString &guessname, const QString &guess_surfname, fl
 #endif
     }
     f->funcs = orig;
+    make_guess_matrix();
 
     fprintf(stderr,"[done %d sources]\n",p);
 
@@ -427,7 +432,77 @@ bool GuessData::compute_guess_fields(DipoleFitData* f)
 #endif
     }
     f->funcs = orig;
+    make_guess_matrix();
     printf("[done %d sources]\n",this->nguess);
 
     return true;
 }
+
+//=============================================================================================================
+
+void GuessData::make_guess_matrix()
+{
+    int nch = (nguess > 0 && guess_fwd[0]) ? guess_fwd[0]->nch : 0;
+
+    guess_uu.resize(nch,3*nguess);
+    guess_sing_ratio.resize(nguess);
+    for (int k = 0; k < nguess; k++) {
+        DipoleForward* fwd = guess_fwd[k];
+        for (int c = 0; c < 3; c++)
+            guess_uu.col(3*k+c) = Map<VectorXf>(fwd->uu[c],nch);
+        guess_sing_ratio[k] = fwd->sing[2]/fwd->sing[0];
+    }
+}
+
+//=============================================================================================================
+
+bool GuessData::find_best_guesses(const MatrixXf& B, float limit, int ncand, MatrixXi& best, MatrixXf& good) const
+{
+    int     ntime = B.cols();
+    int     first,nblk,g,k,c,t;
+    float   Bm2,this_good;
+    MatrixXf P;
+    VectorXf B2;
+
+    ncand = std::max(1,ncand);
+    best.setConstant(ncand,ntime,-1);
+    good.setZero(ncand,ntime);
+
+    if (guess_uu.rows() != B.rows() || guess_uu.cols() != 3*nguess) {
+        printf("The guess fields do not match the data (%d vs. %d channels).\n",(int)guess_uu.rows(),(int)B.rows());
+        return false;
+    }
+    B2 = B.colwise().squaredNorm().transpose();
+    /*
+     * Project the data on the field patterns of a block of guesses at a time
+     */
+    for (first = 0; first < nguess; first += GUESS_BLOCK) {
+        nblk = std::min(GUESS_BLOCK,nguess-first);
+        P.noalias() = guess_uu.middleCols(3*first,3*nblk).transpose()*B;
+        for (t = 0; t < ntime; t++) {
+            if (B2[t] <= 0.0f)
+                continue;
+            for (k = 0, g = first; k < nblk; k++, g++) {
+                Bm2 = P(3*k,t)*P(3*k,t) + P(3*k+1,t)*P(3*k+1,t);
+                if (guess_sing_ratio[g] > limit)
+                    Bm2 += P(3*k+2,t)*P(3*k+2,t);
+                this_good = Bm2/B2[t];
+                if (this_good <= good(ncand-1,t))
+                    continue;
+                /*
+                 * Insert into the sorted candidate list
+                 */
+                for (c = ncand-1; c > 0 && this_good > good(c-1,t); c--) {
+                    good(c,t) = good(c-1,t);
+                    best(c,t) = best(c-1,t);
+                }
+                good(c,t) = this_good;
+                best(c,t) = g;
+            }
+        }
+    }
+    for (t = 0; t < ntime; t++)
+        if (best(0,t) < 0)
+            return false;
+    return true;
+}
@@ -134,10 +134,33 @@ public:
      */
     bool compute_guess_fields(DipoleFitData* f);
 
+    //=========================================================================================================
+    /**
+     * Collects the whitened left singular vectors of all guess fields into one contiguous matrix so that
+     * all guesses can be scored with a single matrix product.
+     */
+    void make_guess_matrix();
+
+    //=========================================================================================================
+    /**
+     * Scores all guesses against one or more whitened data vectors and returns the best candidates.
+     *
+     * @param[in] B          The whitened data, one column for each time point.
+     * @param[in] limit      Pseudoradial component omission limit.
+     * @param[in] ncand      How many candidates to return for each time point.
+     * @param[out] best      Indices of the best guesses (ncand x ntime), best first, -1 where not available.
+     * @param[out] good      The corresponding goodness-of-fit values.
+     *
+     * @return true when a reasonable guess was found for every time point.
+     */
+    bool find_best_guesses(const Eigen::MatrixXf& B, float limit, int ncand, Eigen::MatrixXi& best, Eigen::MatrixXf& good) const;
+
 public:
     float          **rr;            /**< These are the guess dipole locations. */
     DipoleForward** guess_fwd;      /**< Forward solutions for the guesses. */
     int            nguess;          /**< How many sources. */
+    Eigen::MatrixXf guess_uu;       /**< Left singular vectors of the guess fields, three columns per guess. */
+    Eigen::VectorXf guess_sing_ratio;   /**< Ratio of the smallest to the largest singular value for each guess. */
 
 // ### OLD STRUCT ###
 //    typedef struct {
@@ -68,6 +68,9 @@ using namespace FIFFLIB;
 MinimumNorm::MinimumNorm(const MNEInverseOperator &p_inverseOperator, float lambda, const QString method)
 : m_inverseOperator(p_inverseOperator)
 , inverseSetup(false)
+, m_bPickNormal(false)
+, m_iBaseNave(-1)
+, m_iNave(-1)
 {
     this->setRegularization(lambda);
     this->setMethod(method);
@@ -78,6 +81,9 @@ MinimumNorm::MinimumNorm(const MNEInverseOperator &p_inverseOperator, float lamb
 MinimumNorm::MinimumNorm(const MNEInverseOperator &p_inverseOperator, float lambda, bool dSPM, bool sLORETA)
 : m_inverseOperator(p_inverseOperator)
 , inverseSetup(false)
+, m_bPickNormal(false)
+, m_iBaseNave(-1)
+, m_iNave(-1)
 {
     this->setRegularization(lambda);
     this->setMethod(dSPM, sLORETA);
@@ -237,6 +243,11 @@ MNESourceEstimate MinimumNorm::calculateInverse(const MatrixXd &data, float tmin
 
 void MinimumNorm::doInverseSetup(qint32 nave, bool pick_normal)
 {
+    if(inverseSetup && pick_normal == m_bPickNormal) {
+        updateNoiseNormalization(nave);
+        return;
+    }
+
     //
     //   Set up the inverse according to the parameters
     //
@@ -247,11 +258,58 @@ void MinimumNorm::doInverseSetup(qint32 nave, bool pick_normal)
 
     std::cout << "K " << K.rows() << " x " << K.cols() << std::endl;
 
+    //
+    //   Cache the noise normalization, which is the only part depending on nave
+    //
+    m_vecBaseNoiseNorm.resize(inv.noisenorm.nonZeros());
+    qint32 i = 0;
+    for(qint32 k = 0; k < inv.noisenorm.outerSize(); ++k) {
+        for(SparseMatrix<double>::InnerIterator it(inv.noisenorm, k); it; ++it) {
+            m_vecBaseNoiseNorm[i++] = it.value();
+        }
+    }
+
+    m_bPickNormal = pick_normal;
+    m_iBaseNave = nave;
+    m_iNave = nave;
+
     inverseSetup = true;
 }
 
 //=============================================================================================================
 
+void MinimumNorm::updateNoiseNormalization(qint32 nave)
+{
+    if(nave == m_iNave) {
+        return;
+    }
+
+    if(nave <= 0) {
+        qWarning("MinimumNorm::updateNoiseNormalization - The number of averages should be positive");
+        return;
+    }
+
+    //
+    //   The noise covariance scales with 1/nave, the noise normalization with sqrt(nave)
+    //
+    double dScale = sqrt(static_cast<double>(nave) / static_cast<double>(m_iBaseNave));
+
+    qint32 i = 0;
+    for(qint32 k = 0; k < inv.noisenorm.outerSize(); ++k) {
+        for(SparseMatrix<double>::InnerIterator it(inv.noisenorm, k); it; ++it) {
+            it.valueRef() = dScale * m_vecBaseNoiseNorm[i++];
+        }
+    }
+
+    if(m_sMethod.compare("MNE") != 0) {
+        noise_norm = inv.noisenorm;
+    }
+
+    m_iNave = nave;
+}
+
+//=============================================================================================================
+
 const char* MinimumNorm::getName() const
 {
     return "Minimum Norm Estimate";
@@ -306,6 +364,8 @@ void MinimumNorm::setMethod(bool dSPM, bool sLORETA)
             m_sMethod = QString("MNE");
 
     }
+
+    inverseSetup = false;
 }
 
 //=============================================================================================================
@@ -313,4 +373,6 @@ void MinimumNorm::setMethod(bool dSPM, bool sLORETA)
 void MinimumNorm::setRegularization(float lambda)
 {
     m_fLambda = lambda;
+
+    inverseSetup = false;
 }
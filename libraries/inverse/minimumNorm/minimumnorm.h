@@ -116,7 +116,10 @@ public:
 
     //=========================================================================================================
     /**
-     * Perform the inverse setup: Prepares this inverse operator and assembles the kernel.
+     * Perform the inverse setup: Prepares this inverse operator and assembles the kernel. The assembled kernel does
+     * not depend on the number of averages, only the dSPM/sLORETA noise normalization scales with sqrt(nave).
+     * Once set up, subsequent calls with the same pick_normal setting only rescale the cached noise normalization.
+     * The covariances and eigen leads of the prepared inverse operator keep the scaling of the last full setup.
      *
      * @param[in] nave           Number of averages to use.
      * @param[in] pick_normal    If True, rather than pooling the orientations by taking the norm, only the.
@@ -182,6 +185,14 @@ public:
     inline Eigen::MatrixXd& getKernel();
 
 private:
+    //=========================================================================================================
+    /**
+     * Rescales the cached noise normalization of the prepared inverse operator to a new number of averages.
+     *
+     * @param[in] nave           Number of averages to use.
+     */
+    void updateNoiseNormalization(qint32 nave);
+
     MNELIB::MNEInverseOperator m_inverseOperator;   /**< The inverse operator. */
     float m_fLambda;                                /**< Regularization parameter. */
     QString m_sMethod;                              /**< Selected method. */
@@ -189,6 +200,10 @@ private:
     bool m_bdSPM;                                   /**< Do dSPM method. */
 
     bool inverseSetup;                              /**< Inverse Setup Calcluated. */
+    bool m_bPickNormal;                             /**< The pick_normal setting of the cached kernel. */
+    qint32 m_iBaseNave;                             /**< The number of averages the inverse operator was prepared for. */
+    qint32 m_iNave;                                 /**< The number of averages the noise normalization is scaled to. */
+    Eigen::VectorXd m_vecBaseNoiseNorm;             /**< The noise normalization factors for m_iBaseNave. */
     MNELIB::MNEInverseOperator inv;                 /**< The setup inverse operator. */
     Eigen::SparseMatrix<double> noise_norm;         /**< The noise normalization. */
     QList<Eigen::VectorXi> vertno;                  /**< The vertices numbers. */
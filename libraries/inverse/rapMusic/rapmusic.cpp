@@ -67,6 +67,7 @@ RapMusic::RapMusic()
 , m_ppPairIdxCombinations(NULL)
 , m_iMaxNumThreads(1)
 , m_bIsInit(false)
+, m_bUsePrecomputedSubspaces(true)
 , m_iSamplesStcWindow(-1)
 , m_fStcOverlap(-1)
 {
@@ -83,6 +84,7 @@ RapMusic::RapMusic(MNEForwardSolution& p_pFwd, bool p_bSparsed, int p_iN, double
 , m_ppPairIdxCombinations(NULL)
 , m_iMaxNumThreads(1)
 , m_bIsInit(false)
+, m_bUsePrecomputedSubspaces(true)
 , m_iSamplesStcWindow(-1)
 , m_fStcOverlap(-1)
 {
@@ -459,53 +461,21 @@ MNESourceEstimate RapMusic::calculateInverse(const MatrixXd& p_matMeasurement, Q
         MatrixXT t_matU_B;
         useFullRank(t_svdProj_Phi_S.matrixU(), t_svdProj_Phi_S.singularValues().asDiagonal(), t_matU_B);
 
-        //Inits
-        VectorXT t_vecRoh(m_iNumLeadFieldCombinations,1);
-        t_vecRoh.setZero();
-
         //subcorr benchmark
         //Stop the time
         clock_t start_subcorr, end_subcorr;
         start_subcorr = clock();
 
-        //Multithreading correlation calculation
-        #ifdef _OPENMP
-        #pragma omp parallel num_threads(m_iMaxNumThreads)
-        #endif
-        {
-        #ifdef _OPENMP
-        #pragma omp for
-        #endif
-            for(int i = 0; i < m_iNumLeadFieldCombinations; i++)
-            {
-                //new Version: calculate matrix multiplication before
-                //Create Lead Field combinations -> It would be better to use a pointer construction, to increase performance
-                MatrixX6T t_matProj_G(t_matProj_LeadField.rows(),6);
-
-                int idx1 = m_ppPairIdxCombinations[i]->x1;
-                int idx2 = m_ppPairIdxCombinations[i]->x2;
-
-                RapMusic::getGainMatrixPair(t_matProj_LeadField, t_matProj_G, idx1, idx2);
-
-                t_vecRoh(i) = RapMusic::subcorr(t_matProj_G, t_matU_B);//t_vecRoh holds the correlations roh_k
-            }
-        }
+        //Find the maximum of correlation
+        int t_iIdx1 = 0;
+        int t_iIdx2 = 0;
+        double t_val_roh_k;
+        qint64 t_iNumPruned = 0;
 
-//         if(r==0)
-//         {
-//             std::fstream filestr;
-//             std::stringstream filename;
-//             filename << "Roh_gold.txt";
-//
-//             filestr.open ( filename.str().c_str(), std::fstream::out);
-//             for(int i = 0; i < m_iNumLeadFieldCombinations; ++i)
-//             {
-//               filestr << t_vecRoh(i) << "\n";
-//             }
-//             filestr.close();
-//
-//             //exit(0);
-//         }
+        if(m_bUsePrecomputedSubspaces)
+            t_val_roh_k = findBestPair(t_matProj_LeadField, t_matU_B, t_iIdx1, t_iIdx2, t_iNumPruned);
+        else
+            t_val_roh_k = findBestPairExhaustive(t_matProj_LeadField, t_matU_B, t_iIdx1, t_iIdx2);
 
         //subcorr benchmark
         end_subcorr = clock();
@@ -513,20 +483,12 @@ MNESourceEstimate RapMusic::calculateInverse(const MatrixXd& p_matMeasurement, Q
         float t_fSubcorrElapsedTime = ( (float)(end_subcorr-start_subcorr) / (float)CLOCKS_PER_SEC ) * 1000.0f;
         std::cout << "Time Elapsed: " << t_fSubcorrElapsedTime << " ms" << std::endl;
 
-        //Find the maximum of correlation - can't put this in the for loop because it's running in different threads.
-        double t_val_roh_k;
-
-        VectorXT::Index t_iMaxIdx;
-
-        t_val_roh_k = t_vecRoh.maxCoeff(&t_iMaxIdx);//p_vecCor = ^roh_k
-
-        //get positions in sparsed leadfield from index combinations;
-        int t_iIdx1 = m_ppPairIdxCombinations[t_iMaxIdx]->x1;
-        int t_iIdx2 = m_ppPairIdxCombinations[t_iMaxIdx]->x2;
-
         // (Idx+1) because of MATLAB positions -> starting with 1 not with 0
         std::cout << "Iteration: " << r+1 << " of " << t_iMaxSearch
-            << "; Correlation: " << t_val_roh_k<< "; Position (Idx+1): " << t_iIdx1+1 << " - " << t_iIdx2+1 <<"\n\n";
+            << "; Correlation: " << t_val_roh_k<< "; Position (Idx+1): " << t_iIdx1+1 << " - " << t_iIdx2+1;
+        if(m_bUsePrecomputedSubspaces)
+            std::cout << "; Pruned pairs: " << t_iNumPruned << " of " << (qint64)m_iNumGridPoints*(m_iNumGridPoints-1)/2;
+        std::cout << "\n\n";
 
         //Calculations with the max correlated dipole pair G_k_1 -> ToDo Obsolet when taking direkt Projected Lead Field
         MatrixX6T t_matG_k_1(m_ForwardSolution.sol->data.rows(),6);
@@ -607,6 +569,202 @@ int RapMusic::calcPhi_s(const MatrixXT& p_matMeasurement, MatrixXT* &p_pMatPhi_s
 
 //=============================================================================================================
 
+double RapMusic::findBestPair(const MatrixXT& p_matProj_LeadField,
+                              const MatrixXT& p_matU_B,
+                              int& p_iIdx1,
+                              int& p_iIdx2,
+                              qint64& p_iNumPruned) const
+{
+    int t_iNumPoints = p_matProj_LeadField.cols()/3;
+    int t_iNumChannels = p_matProj_LeadField.rows();
+
+    //Step 1: Orthonormal basis Q_i of every projected source lead field from the eigendecomposition of its 3 x 3
+    //Gram matrix. Directions which are not resolved are kept as zero columns.
+    MatrixXT t_matQ = MatrixXT::Zero(t_iNumChannels, 3*t_iNumPoints);
+    VectorXT t_vecSigma(3*t_iNumPoints);
+
+    #ifdef _OPENMP
+    #pragma omp parallel for num_threads(m_iMaxNumThreads)
+    #endif
+    for(int i = 0; i < t_iNumPoints; ++i)
+    {
+        Eigen::Matrix3d t_matGram = p_matProj_LeadField.middleCols(3*i,3).transpose() * p_matProj_LeadField.middleCols(3*i,3);
+        Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> t_eigGram(t_matGram);
+
+        for(int k = 0; k < 3; ++k)
+        {
+            double t_dLambda = t_eigGram.eigenvalues()(k);
+            t_vecSigma(3*i+k) = t_dLambda > 0 ? sqrt(t_dLambda) : 0;
+
+            if(t_dLambda > 0)
+                t_matQ.col(3*i+k) = p_matProj_LeadField.middleCols(3*i,3) * t_eigGram.eigenvectors().col(k) / t_vecSigma(3*i+k);
+        }
+    }
+
+    //lt. Mosher 1998: Only Retain those Components that correspond to nonzero singular values
+    double t_dTol = 0.00001 * t_vecSigma.maxCoeff();
+    VectorXT t_vecMask(3*t_iNumPoints);
+
+    for(int k = 0; k < 3*t_iNumPoints; ++k)
+    {
+        t_vecMask(k) = t_vecSigma(k) > t_dTol ? 1.0 : 0.0;
+        if(t_vecMask(k) == 0.0)
+            t_matQ.col(k).setZero();
+    }
+
+    //Step 2: Projection of all bases onto the signal subspace and single source correlations rho_i
+    MatrixXT t_matB = t_matQ.transpose() * p_matU_B;
+    VectorXT t_vecRoh2(t_iNumPoints);
+
+    for(int i = 0; i < t_iNumPoints; ++i)
+    {
+        Eigen::Matrix3d t_matH = t_matB.middleRows(3*i,3) * t_matB.middleRows(3*i,3).transpose();
+        t_vecRoh2(i) = Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d>(t_matH, Eigen::EigenvaluesOnly).eigenvalues()(2);
+    }
+
+    //The pair (i,i) spans the subspace of source i only -> the best single source is a lower bound for the maximum
+    VectorXT::Index t_iMaxIdx;
+    double t_dBestRoh2 = t_vecRoh2.maxCoeff(&t_iMaxIdx);
+    p_iIdx1 = t_iMaxIdx;
+    p_iIdx2 = t_iMaxIdx;
+
+    p_iNumPruned = 0;
+
+    //Step 3: Pair correlations from the 6 x 6 Gram matrices M = [Q_i Q_j]^T [Q_i Q_j] and H = [B_i; B_j] [B_i; B_j]^T
+    #ifdef _OPENMP
+    #pragma omp parallel num_threads(m_iMaxNumThreads)
+    #endif
+    {
+        double t_dLocalBestRoh2 = t_dBestRoh2;
+        int t_iLocalIdx1 = p_iIdx1;
+        int t_iLocalIdx2 = p_iIdx2;
+        qint64 t_iLocalNumPruned = 0;
+
+        Matrix6T t_matM, t_matH, t_matW, t_matC;
+
+    #ifdef _OPENMP
+    #pragma omp for schedule(dynamic)
+    #endif
+        for(int i = 0; i < t_iNumPoints - 1; ++i)
+        {
+            int t_iNumRight = t_iNumPoints - i - 1;
+
+            MatrixXT t_matS = t_matQ.middleCols(3*i,3).transpose() * t_matQ.rightCols(3*t_iNumRight);
+            MatrixXT t_matH_ij = t_matB.middleRows(3*i,3) * t_matB.bottomRows(3*t_iNumRight).transpose();
+
+            t_matM.setZero();
+            t_matM.topLeftCorner<3,3>() = t_vecMask.segment(3*i,3).asDiagonal();
+            t_matH.topLeftCorner<3,3>() = t_matB.middleRows(3*i,3) * t_matB.middleRows(3*i,3).transpose();
+
+            for(int jj = 0; jj < t_iNumRight; ++jj)
+            {
+                int j = i + 1 + jj;
+
+                //Pruning: for x = Q_i a + Q_j b it is ||x||^2 >= (1 - s) (||a||^2 + ||b||^2) with s = ||Q_i^T Q_j||
+                //-> rho_ij^2 <= (rho_i^2 + rho_j^2) / (1 - s)
+                double t_dS = t_matS.middleCols(3*jj,3).norm();
+                if(t_dS < 1.0 && t_vecRoh2(i) + t_vecRoh2(j) < (1.0 - t_dS) * t_dLocalBestRoh2)
+                {
+                    ++t_iLocalNumPruned;
+                    continue;
+                }
+
+                t_matM.topRightCorner<3,3>() = t_matS.middleCols(3*jj,3);
+                t_matM.bottomLeftCorner<3,3>() = t_matS.middleCols(3*jj,3).transpose();
+                t_matM.bottomRightCorner<3,3>() = t_vecMask.segment(3*j,3).asDiagonal();
+
+                t_matH.topRightCorner<3,3>() = t_matH_ij.middleCols(3*jj,3);
+                t_matH.bottomLeftCorner<3,3>() = t_matH_ij.middleCols(3*jj,3).transpose();
+                t_matH.bottomRightCorner<3,3>() = t_matB.middleRows(3*j,3) * t_matB.middleRows(3*j,3).transpose();
+
+                //Orthonormalize the pair basis W = V_M * Lambda_M^-1/2, the squared correlation is the largest
+                //eigenvalue of W^T H W
+                Eigen::SelfAdjointEigenSolver<Matrix6T> t_eigM(t_matM);
+
+                t_matW.setZero();
+                for(int k = 0; k < 6; ++k)
+                    if(t_eigM.eigenvalues()(k) > 0.0000000001)
+                        t_matW.col(k) = t_eigM.eigenvectors().col(k) / sqrt(t_eigM.eigenvalues()(k));
+
+                t_matC = t_matW.transpose() * t_matH * t_matW;
+
+                double t_dRoh2 = Eigen::SelfAdjointEigenSolver<Matrix6T>(t_matC, Eigen::EigenvaluesOnly).eigenvalues()(5);
+
+                if(t_dRoh2 > t_dLocalBestRoh2)
+                {
+                    t_dLocalBestRoh2 = t_dRoh2;
+                    t_iLocalIdx1 = i;
+                    t_iLocalIdx2 = j;
+                }
+            }
+        }
+
+    #ifdef _OPENMP
+    #pragma omp critical
+    #endif
+        {
+            p_iNumPruned += t_iLocalNumPruned;
+
+            if(t_dLocalBestRoh2 > t_dBestRoh2)
+            {
+                t_dBestRoh2 = t_dLocalBestRoh2;
+                p_iIdx1 = t_iLocalIdx1;
+                p_iIdx2 = t_iLocalIdx2;
+            }
+        }
+    }
+
+    return sqrt(t_dBestRoh2 > 0 ? t_dBestRoh2 : 0);
+}
+
+//=============================================================================================================
+
+double RapMusic::findBestPairExhaustive(const MatrixXT& p_matProj_LeadField,
+                                        const MatrixXT& p_matU_B,
+                                        int& p_iIdx1,
+                                        int& p_iIdx2) const
+{
+    //Inits
+    VectorXT t_vecRoh(m_iNumLeadFieldCombinations,1);
+    t_vecRoh.setZero();
+
+    //Multithreading correlation calculation
+    #ifdef _OPENMP
+    #pragma omp parallel num_threads(m_iMaxNumThreads)
+    #endif
+    {
+    #ifdef _OPENMP
+    #pragma omp for
+    #endif
+        for(int i = 0; i < m_iNumLeadFieldCombinations; i++)
+        {
+            //new Version: calculate matrix multiplication before
+            //Create Lead Field combinations -> It would be better to use a pointer construction, to increase performance
+            MatrixX6T t_matProj_G(p_matProj_LeadField.rows(),6);
+
+            int idx1 = m_ppPairIdxCombinations[i]->x1;
+            int idx2 = m_ppPairIdxCombinations[i]->x2;
+
+            RapMusic::getGainMatrixPair(p_matProj_LeadField, t_matProj_G, idx1, idx2);
+
+            t_vecRoh(i) = RapMusic::subcorr(t_matProj_G, p_matU_B);//t_vecRoh holds the correlations roh_k
+        }
+    }
+
+    //Find the maximum of correlation - can't put this in the for loop because it's running in different threads.
+    VectorXT::Index t_iMaxIdx;
+
+    double t_val_roh_k = t_vecRoh.maxCoeff(&t_iMaxIdx);//p_vecCor = ^roh_k
+
+    //get positions in sparsed leadfield from index combinations;
+    p_iIdx1 = m_ppPairIdxCombinations[t_iMaxIdx]->x1;
+    p_iIdx2 = m_ppPairIdxCombinations[t_iMaxIdx]->x2;
+
+    return t_val_roh_k;
+}
+
+//=============================================================================================================
+
 double RapMusic::subcorr(MatrixX6T& p_matProj_G, const MatrixXT& p_matU_B)
 {
     //Orthogonalisierungstest wegen performance weggelassen -> ohne is es viel schneller
@@ -881,3 +1039,10 @@ void RapMusic::setStcAttr(int p_iSampStcWin, float p_fStcOverlap)
     m_iSamplesStcWindow = p_iSampStcWin;
     m_fStcOverlap = p_fStcOverlap;
 }
+
+//=============================================================================================================
+
+void RapMusic::setUsePrecomputedSubspaces(bool p_bUse)
+{
+    m_bUsePrecomputedSubspaces = p_bUse;
+}
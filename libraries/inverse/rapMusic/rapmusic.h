@@ -58,6 +58,7 @@
 #include <Eigen/Core>
 #include <Eigen/SVD>
 #include <Eigen/LU>
+#include <Eigen/Eigenvalues>
 
 //=============================================================================================================
 // DEFINE NAMESPACE INVERSELIB
@@ -165,7 +166,53 @@ public:
      */
     void setStcAttr(int p_iSampStcWin, float p_fStcOverlap);
 
+    //=========================================================================================================
+    /**
+     * Sets whether the dipole pair scan uses the precomputed source subspaces with pair pruning (default) or the
+     * exhaustive evaluation of subcorr for every lead field pair combination.
+     *
+     * @param[in] p_bUse     True when the precomputed source subspaces should be used.
+     */
+    void setUsePrecomputedSubspaces(bool p_bUse);
+
 protected:
+    //=========================================================================================================
+    /**
+     * Finds the dipole pair with the maximal subspace correlation. An orthonormal basis of each projected source
+     * lead field and its projection onto U_B are computed once. The correlation of a pair then follows from the
+     * 6 x 6 Gram matrices of the two bases, without building and decomposing the m x 6 pair lead field. Pairs are
+     * skipped when their correlation bound (rho_i^2 + rho_j^2) / (1 - ||Q_i^T Q_j||) from the single source
+     * correlations rho_i, rho_j cannot exceed the best correlation found so far.
+     *
+     * @param[in] p_matProj_LeadField    The projected lead field (m x 3 * number of grid points).
+     * @param[in] p_matU_B               The matrix U is the subspace projection of the orthogonal projected Phi_s.
+     * @param[out] p_iIdx1               Index one of the best correlated pair.
+     * @param[out] p_iIdx2               Index two of the best correlated pair.
+     * @param[out] p_iNumPruned          Number of pairs skipped by the correlation bound.
+     * @return   The maximal subspace correlation.
+     */
+    double findBestPair(const MatrixXT& p_matProj_LeadField,
+                        const MatrixXT& p_matU_B,
+                        int& p_iIdx1,
+                        int& p_iIdx2,
+                        qint64& p_iNumPruned) const;
+
+    //=========================================================================================================
+    /**
+     * Finds the dipole pair with the maximal subspace correlation by evaluating subcorr for every lead field pair
+     * combination.
+     *
+     * @param[in] p_matProj_LeadField    The projected lead field (m x 3 * number of grid points).
+     * @param[in] p_matU_B               The matrix U is the subspace projection of the orthogonal projected Phi_s.
+     * @param[out] p_iIdx1               Index one of the best correlated pair.
+     * @param[out] p_iIdx2               Index two of the best correlated pair.
+     * @return   The maximal subspace correlation.
+     */
+    double findBestPairExhaustive(const MatrixXT& p_matProj_LeadField,
+                                  const MatrixXT& p_matU_B,
+                                  int& p_iIdx1,
+                                  int& p_iIdx2) const;
+
     //=========================================================================================================
     /**
      * Computes the signal subspace Phi_s out of the measurement F.
@@ -312,6 +359,8 @@ protected:
 
     bool m_bIsInit; /**< Whether the algorithm is initialized. */
 
+    bool m_bUsePrecomputedSubspaces;    /**< Whether the pair scan uses the precomputed source subspaces. */
+
     //Stc stuff
     int m_iSamplesStcWindow;    /**< Number of samples per localization window. */
     float m_fStcOverlap;        /**< Percentage of localization window overlap. */
@@ -123,35 +123,51 @@ MNEEpochDataList MNEEpochDataList::readEpochs(const FiffRawData& raw,
 
     fiff_int_t event_samp, from, to;
     fiff_int_t dropCount = 0;
-    MatrixXd timesDummy;
-    MatrixXd times;
 
-    QScopedPointer<MNEEpochData> epoch(Q_NULLPTR);
+    QVector<QPair<int,int> > ranges(count);
 
     for (p = 0; p < count; ++p) {
-        // Read a data segment
         event_samp = events(selected(p),0);
         from = event_samp + tmin*raw.info.sfreq;
         to   = event_samp + floor(tmax*raw.info.sfreq + 0.5);
+        ranges[p] = qMakePair(from, to);
+    }
 
-        epoch.reset(new MNEEpochData());
+    // Read all data segments in one pass over the raw buffers and check each epoch for artifacts as soon as it is
+    // complete, while the remaining epochs are still being read
+    QList<MatrixXd> lEpochData;
+    QVector<QFuture<bool> > vecRejectFutures(count);
+
+    raw.read_raw_segments(lEpochData,
+                          ranges,
+                          picksNew,
+                          [&](int iEpoch) {
+        if(lEpochData.at(iEpoch).size() == 0) {
+            return;
+        }
 
-        if(raw.read_raw_segment(epoch->epoch, timesDummy, from, to, picksNew)) {
-            if (p == 0) {
-                times.resize(1, to-from+1);
-                for (qint32 i = 0; i < times.cols(); ++i)
-                    times(0, i) = ((float)(from-event_samp+i)) / raw.info.sfreq;
-            }
+        const MatrixXd* pEpochData = &lEpochData.at(iEpoch);
+        vecRejectFutures[iEpoch] = QtConcurrent::run([pEpochData, &raw, &mapReject, &lExcludeChs]() {
+            return checkForArtifact(*pEpochData,
+                                    raw.info,
+                                    mapReject,
+                                    lExcludeChs);
+        });
+    });
+
+    QScopedPointer<MNEEpochData> epoch(Q_NULLPTR);
+
+    for (p = 0; p < count; ++p) {
+        if(lEpochData.at(p).size() > 0) {
+            epoch.reset(new MNEEpochData());
+
+            epoch->bReject = vecRejectFutures[p].result();
+            epoch->epoch.swap(lEpochData[p]);
 
             epoch->event = event;
             epoch->tmin = tmin;
             epoch->tmax = tmax;
 
-            epoch->bReject = checkForArtifact(epoch->epoch,
-                                              raw.info,
-                                              mapReject,
-                                              lExcludeChs);
-
             if (epoch->bReject) {
                 dropCount++;
             }
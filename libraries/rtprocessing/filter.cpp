@@ -41,12 +41,15 @@
 
 #include <utils/mnemath.h>
 #include <fiff/fiff_raw_data.h>
+#include <utils/generics/readaheadbuffer.h>
+#include <utils/generics/writebehindbuffer.h>
 
 //=============================================================================================================
 // QT INCLUDES
 //=============================================================================================================
 
 #include <QDebug>
+#include <QThread>
 
 //=============================================================================================================
 // EIGEN INCLUDES
@@ -64,6 +67,20 @@ using namespace Eigen;
 using namespace FIFFLIB;
 using namespace UTILSLIB;
 
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+/**
+ * One block of raw data read ahead by filterFile.
+ */
+struct FilterFileBlock
+{
+    fiff_int_t first;       /**< First sample of the block. */
+    fiff_int_t last;        /**< Last sample of the block. */
+    MatrixXd matData;       /**< The raw data of the block. */
+};
+
 //=============================================================================================================
 // DEFINE GLOBAL RTPROCESSINGLIB METHODS
 //=============================================================================================================
@@ -140,58 +157,169 @@ bool RTPROCESSINGLIB::filterFile(QIODevice &pIODevice,
     float quantum_sec = iSize/pFiffRawData->info.sfreq;
     fiff_int_t quantum = ceil(quantum_sec*pFiffRawData->info.sfreq);
 
-    // Read, filter and write the data
-    bool first_buffer = true;
+    // Read, filter and write the data. The next blocks are read from disk while the current one is filtered and
+    // the filtered blocks are written in the background.
+    bool bReadError = false;
+    fiff_int_t firstRead = from;
 
-    fiff_int_t first, last;
-    MatrixXd matData, matDataOverlap;
-    MatrixXd times;
+    ReadAheadBuffer<FilterFileBlock> readBuffer([&](FilterFileBlock& block) {
+        if(firstRead >= to) {
+            return false;
+        }
 
-    for(first = from; first < to; first+=quantum) {
-        last = first+quantum-1;
-        if (last > to) {
-            last = to;
+        block.first = firstRead;
+        block.last = firstRead+quantum-1;
+        if (block.last > to) {
+            block.last = to;
         }
+        firstRead += quantum;
 
-        if (!pFiffRawData->read_raw_segment(matData, times, mult, first, last, sel)) {
+        MatrixXd times;
+        if (!pFiffRawData->read_raw_segment(block.matData, times, mult, block.first, block.last, sel)) {
             qWarning("[Filter::filterData] Error during read_raw_segment\n");
+            bReadError = true;
             return false;
         }
 
-        qInfo() << "Filtering and writing block" << first << "to" << last;
+        return true;
+    });
 
-        if (first_buffer) {
-           if (first > 0) {
-               outfid->write_int(FIFF_FIRST_SAMPLE,&first);
-           }
-           first_buffer = false;
-        }
+    FilterFileBlock block;
 
-        matData = filterDataBlock(matData,
+    if(!readBuffer.pop(block)) {
+        outfid->finish_writing_raw();
+        return !bReadError;
+    }
+
+    if (block.first > 0) {
+        outfid->write_int(FIFF_FIRST_SAMPLE,&block.first);
+    }
+
+    WriteBehindBuffer<MatrixXd> writeBuffer([&](MatrixXd& matData) {
+        return outfid->write_raw_buffer(matData, cals);
+    });
+
+    MatrixXd matData, matDataOverlap;
+
+    do {
+        qInfo() << "Filtering and writing block" << block.first << "to" << block.last;
+
+        matData = filterDataBlock(block.matData,
                                   vecPicks,
                                   filterKernel,
                                   bUseThreads);
 
-        if(first == from) {
-            outfid->write_raw_buffer(matData.block(0,iOrder/2,matData.rows(),matData.cols()-iOrder), cals);
-        } else if(first + quantum >= to) {
-            matData.block(0,0,matData.rows(),iOrder) += matDataOverlap;
-            outfid->write_raw_buffer(matData.block(0,0,matData.rows(),matData.cols()-iOrder), cals);
+        if(block.first == from) {
+            writeBuffer.push(matData.block(0,iOrder/2,matData.rows(),matData.cols()-iOrder));
         } else {
             matData.block(0,0,matData.rows(),iOrder) += matDataOverlap;
-            outfid->write_raw_buffer(matData.block(0,0,matData.rows(),matData.cols()-iOrder), cals);
+            writeBuffer.push(matData.block(0,0,matData.rows(),matData.cols()-iOrder));
         }
 
         matDataOverlap = matData.block(0,matData.cols()-iOrder,matData.rows(),iOrder);
+    } while(readBuffer.pop(block));
+
+    bool bWritten = writeBuffer.finish();
+    if(!bWritten) {
+        qWarning("[Filter::filterData] Error during write_raw_buffer\n");
     }
 
     outfid->finish_writing_raw();
 
-    return true;
+    return bWritten && !bReadError;
 }
 
 //=============================================================================================================
 
+bool RTPROCESSINGLIB::filterFile(QIODevice &pIODevice,
+                                 QSharedPointer<FiffRawData> pFiffRawData,
+                                 const IirFilter& iirFilter,
+                                 const RowVectorXi& vecPicks,
+                                 bool bZeroPhase)
+{
+    RowVectorXd cals;
+    SparseMatrix<double> mult;
+    RowVectorXi sel;
+    FiffStream::SPtr outfid = FiffStream::start_writing_raw(pIODevice, pFiffRawData->info, cals);
+
+    //Setup reading parameters
+    fiff_int_t from = pFiffRawData->first_samp;
+    fiff_int_t to = pFiffRawData->last_samp;
+    fiff_int_t quantum = ceil(10.0 * pFiffRawData->info.sfreq);
+
+    if (from > 0) {
+        outfid->write_int(FIFF_FIRST_SAMPLE,&from);
+    }
+
+    bool bReadError = false;
+
+    WriteBehindBuffer<MatrixXd> writeBuffer([&](MatrixXd& matData) {
+        return outfid->write_raw_buffer(matData, cals);
+    });
+
+    if(bZeroPhase) {
+        // Forward-backward filtering needs all samples at once
+        MatrixXd matData, times;
+
+        if (!pFiffRawData->read_raw_segment(matData, times, mult, from, to, sel)) {
+            qWarning("[Filter::filterFile] Error during read_raw_segment\n");
+            bReadError = true;
+        } else {
+            qInfo() << "Filtering block" << from << "to" << to;
+
+            matData = iirFilter.applyZeroPhaseFilter(matData, vecPicks);
+
+            for(int i = 0; i < matData.cols(); i += quantum) {
+                writeBuffer.push(matData.middleCols(i, std::min(int(quantum), int(matData.cols()) - i)));
+            }
+        }
+    } else {
+        // Causal filtering, the filter state is carried from block to block
+        IirFilter filter = iirFilter;
+        filter.reset();
+
+        fiff_int_t firstRead = from;
+
+        ReadAheadBuffer<FilterFileBlock> readBuffer([&](FilterFileBlock& block) {
+            if(firstRead > to) {
+                return false;
+            }
+
+            block.first = firstRead;
+            block.last = std::min(firstRead + quantum - 1, to);
+            firstRead += quantum;
+
+            MatrixXd times;
+            if (!pFiffRawData->read_raw_segment(block.matData, times, mult, block.first, block.last, sel)) {
+                qWarning("[Filter::filterFile] Error during read_raw_segment\n");
+                bReadError = true;
+                return false;
+            }
+
+            return true;
+        });
+
+        FilterFileBlock block;
+
+        while(readBuffer.pop(block)) {
+            qInfo() << "Filtering and writing block" << block.first << "to" << block.last;
+
+            filter.applyFilter(block.matData, vecPicks);
+            writeBuffer.push(std::move(block.matData));
+        }
+    }
+
+    bool bWritten = writeBuffer.finish();
+    if(!bWritten) {
+        qWarning("[Filter::filterFile] Error during write_raw_buffer\n");
+    }
+
+    outfid->finish_writing_raw();
+
+    return bWritten && !bReadError;
+}
+//=============================================================================================================
+
 MatrixXd RTPROCESSINGLIB::filterData(const MatrixXd& mataData,
                                      int type,
                                      double dCenterfreq,
@@ -322,26 +450,15 @@ MatrixXd RTPROCESSINGLIB::filterDataBlock(const MatrixXd& mataData,
         return mataData;
     }
 
-    // Setup filters to the correct length, so we do not have to do this everytime we call the FFT filter function
+    // Transform the filter coefficients once for all channels
     FilterKernel filterKernelSetup = filterKernel;
     filterKernelSetup.prepareFilter(mataData.cols());
+    const RowVectorXcd vecFftCoeff = filterKernelSetup.getFftCoefficients();
+    const int iFftLength = 2 * (vecFftCoeff.cols() - 1);
 
-    // Do the concurrent filtering
     RowVectorXi vecPicksNew = vecPicks;
     if(vecPicksNew.cols() == 0) {
-        vecPicksNew = RowVectorXi::LinSpaced(mataData.rows(), 0, mataData.rows());
-    }
-
-    // Generate QList structure which can be handled by the QConcurrent framework
-    QList<FilterObject> timeData;
-
-    // Only select channels specified in vecPicksNew
-    FilterObject data;
-    for(qint32 i = 0; i < vecPicksNew.cols(); ++i) {
-        data.filterKernel = filterKernelSetup;
-        data.iRow = vecPicksNew[i];
-        data.vecData = mataData.row(vecPicksNew[i]);
-        timeData.append(data);
+        vecPicksNew = RowVectorXi::LinSpaced(mataData.rows(), 0, mataData.rows() - 1);
     }
 
     // Copy in data from last data block. This is necessary in order to also delay channels which are not filtered
@@ -349,22 +466,67 @@ MatrixXd RTPROCESSINGLIB::filterDataBlock(const MatrixXd& mataData,
     matDataOut.setZero();
     matDataOut.block(0, iOrder/2, mataData.rows(), mataData.cols()) = mataData;
 
-    if(bUseThreads) {
-        QFuture<void> future = QtConcurrent::map(timeData,
-                                                 filterChannel);
-        future.waitForFinished();
-    } else {
-        for(int i = 0; i < timeData.size(); ++i) {
-            filterChannel(timeData[i]);
-        }
+    // Split the picked channels into one fixed range per thread. Each range is filtered in blocks of channels which
+    // are gathered into a contiguous column-major matrix, transformed and written back into matDataOut in place.
+    const int iNumChannels = vecPicksNew.cols();
+    const int iNumRanges = bUseThreads ? std::max(1, std::min(QThread::idealThreadCount(), iNumChannels)) : 1;
+
+    QList<QPair<int,int> > lRanges;
+    for(int i = 0; i < iNumRanges; ++i) {
+        lRanges.append(qMakePair(i * iNumChannels / iNumRanges, (i + 1) * iNumChannels / iNumRanges));
     }
 
-    // Do the overlap add method and store in matDataOut
-    RowVectorXd tempData;
+    std::function<void(QPair<int,int>&)> filterRangeLambda = [&](QPair<int,int>& range) {
+        const int iBlockSize = 16;
+        const int iNumOut = matDataOut.cols();
+
+        #ifdef EIGEN_FFTW_DEFAULT
+        fftw_make_planner_thread_safe();
+        #endif
+
+        Eigen::FFT<double> fft;
+        fft.SetFlag(fft.HalfSpectrum);
+
+        MatrixXd matTime(iFftLength, iBlockSize);
+        VectorXd vecTime(iFftLength);
+        VectorXcd vecFreq;
+
+        for(int iFirst = range.first; iFirst < range.second; iFirst += iBlockSize) {
+            const int iNumBlock = std::min(iBlockSize, range.second - iFirst);
 
-    for(int r = 0; r < timeData.size(); r++) {
-        // Write the newly calculated filtered data to the filter data matrix. This data has a delay of iOrder/2 in front and back
-        matDataOut.row(timeData.at(r).iRow) = timeData.at(r).vecData;
+            // Gather the channels sample by sample, so neighbouring channels are read from the same cache lines
+            matTime.setZero();
+            for(int t = 0; t < mataData.cols(); ++t) {
+                for(int j = 0; j < iNumBlock; ++j) {
+                    matTime(t, j) = mataData(vecPicksNew[iFirst + j], t);
+                }
+            }
+
+            for(int j = 0; j < iNumBlock; ++j) {
+                vecTime = matTime.col(j);
+                fft.fwd(vecFreq, vecTime);
+                vecFreq = vecFreq.cwiseProduct(vecFftCoeff.transpose());
+                fft.inv(vecTime, vecFreq, iFftLength);
+                matTime.col(j) = vecTime;
+            }
+
+            // Write back the filtered data. This data has a delay of iOrder/2 in front and back
+            for(int t = 0; t < iNumOut; ++t) {
+                for(int j = 0; j < iNumBlock; ++j) {
+                    matDataOut(vecPicksNew[iFirst + j], t) = matTime(t, j);
+                }
+            }
+        }
+    };
+
+    if(bUseThreads && iNumRanges > 1) {
+        QFuture<void> future = QtConcurrent::map(lRanges,
+                                                 filterRangeLambda);
+        future.waitForFinished();
+    } else {
+        for(int i = 0; i < lRanges.size(); ++i) {
+            filterRangeLambda(lRanges[i]);
+        }
     }
 
     return matDataOut;
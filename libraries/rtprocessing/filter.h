@@ -43,6 +43,7 @@
 #include "rtprocessing_global.h"
 
 #include "helpers/filterkernel.h"
+#include "helpers/iirfilter.h"
 
 #include <fiff/fiff_info.h>
 
@@ -130,6 +131,27 @@ RTPROCESINGSHARED_EXPORT bool filterFile(QIODevice& pIODevice,
                                          const Eigen::RowVectorXi &vecPicks = Eigen::RowVectorXi(),
                                          bool bUseThreads = false);
 
+//=========================================================================================================
+/**
+ * Filters data from an input file with an IIR filter and writes the filtered data to a pIODevice.
+ *
+ * @param[in] pIODevice            The IO device to write to.
+ * @param[in] pFiffRawData         The fiff raw data object to read from.
+ * @param[in] iirFilter            The IIR filter to use.
+ * @param[in] vecPicks             Channel indexes to filter. Default is filter all channels.
+ * @param[in] bZeroPhase           Whether to filter forward and backward (zero phase). This reads the whole file into
+ *                                 memory, so only use it for files which fit into memory. Otherwise the file is
+ *                                 filtered causally block by block with constant memory use, which delays the signal
+ *                                 by the filter's group delay. Default is set to false.
+ *
+ * @return Returns true if successfull, false otherwise.
+ */
+RTPROCESINGSHARED_EXPORT bool filterFile(QIODevice& pIODevice,
+                                         QSharedPointer<FIFFLIB::FiffRawData> pFiffRawData,
+                                         const RTPROCESSINGLIB::IirFilter& iirFilter,
+                                         const Eigen::RowVectorXi &vecPicks = Eigen::RowVectorXi(),
+                                         bool bZeroPhase = false);
+
 //=========================================================================================================
 /**
  * Creates a user designed filter kernel and filters the raw input data.
@@ -0,0 +1,314 @@
+//=============================================================================================================
+/**
+ * @file     filterpartitioned.cpp
+ * @author   MNE-CPP Authors
+ * @since    0.1.9
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, MNE-CPP Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    Definition of the FilterPartitioned class.
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "filterpartitioned.h"
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtConcurrent/QtConcurrent>
+#include <QDebug>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace RTPROCESSINGLIB;
+using namespace Eigen;
+
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+FilterPartitioned::FilterPartitioned(int iPartitionSize)
+: m_iPartitionSizeSet(iPartitionSize > 0 ? iPartitionSize : 0)
+, m_iPartitionSize(0)
+, m_iNumKernelPartitions(0)
+, m_iGroupDelay(0)
+, m_iBufferDelay(0)
+{
+}
+
+//=============================================================================================================
+
+MatrixXd FilterPartitioned::calculate(const MatrixXd& matData,
+                                      const FilterKernel& filterKernel,
+                                      const RowVectorXi& vecPicks,
+                                      bool bUseThreads)
+{
+    if(matData.cols() == 0) {
+        return matData;
+    }
+
+    #ifdef EIGEN_FFTW_DEFAULT
+    fftw_make_planner_thread_safe();
+    #endif
+
+    // Setup anew if the filter, the picks or the channel number changed
+    const RowVectorXd vecCoeff = filterKernel.getCoefficients();
+
+    if(vecCoeff.cols() == 0) {
+        qWarning() << "[FilterPartitioned::calculate] Filter kernel has no coefficients. Returning.";
+        return matData;
+    }
+
+    if(m_matKernelSpectra.size() == 0
+       || m_matDelayLine.rows() != matData.rows()
+       || m_vecCoeff.cols() != vecCoeff.cols() || m_vecCoeff != vecCoeff
+       || m_vecPicks.cols() != vecPicks.cols() || m_vecPicks != vecPicks) {
+        if(m_iPartitionSizeSet > 0) {
+            m_iPartitionSize = m_iPartitionSizeSet;
+        } else {
+            // Largest power of two which fits into the data block, but not longer than the filter
+            int iMaxSize = 1;
+            while(iMaxSize < vecCoeff.cols()) {
+                iMaxSize *= 2;
+            }
+
+            m_iPartitionSize = 1;
+            while(m_iPartitionSize * 2 <= matData.cols() && m_iPartitionSize < iMaxSize) {
+                m_iPartitionSize *= 2;
+            }
+        }
+
+        setup(filterKernel,
+              matData.rows(),
+              vecPicks);
+    }
+
+    // Prepend the input which did not fill a whole partition during the last call
+    MatrixXd matCombined;
+    if(m_matInputBuffer.cols() > 0) {
+        matCombined.resize(matData.rows(), m_matInputBuffer.cols() + matData.cols());
+        matCombined << m_matInputBuffer, matData;
+    }
+    const MatrixXd& matInput = m_matInputBuffer.cols() > 0 ? matCombined : matData;
+
+    const int iNumProcessed = (matInput.cols() / m_iPartitionSize) * m_iPartitionSize;
+    MatrixXd matProcessed(matInput.rows(), iNumProcessed);
+
+    if(iNumProcessed > 0) {
+        // Filter the picked channels
+        if(bUseThreads) {
+            std::function<void(ChannelState&)> filterLambda = [&](ChannelState& state) {
+                filterChannel(state,
+                              matInput,
+                              matProcessed);
+            };
+
+            QFuture<void> future = QtConcurrent::map(m_channelStates,
+                                                     filterLambda);
+            future.waitForFinished();
+        } else {
+            for(int i = 0; i < m_channelStates.size(); ++i) {
+                filterChannel(m_channelStates[i],
+                              matInput,
+                              matProcessed);
+            }
+        }
+
+        // Delay the remaining channels by the group delay of the filter
+        RowVectorXd vecDelayed(m_iGroupDelay + iNumProcessed);
+
+        for(int i = 0; i < m_vecUnfilteredRows.size(); ++i) {
+            const int iRow = m_vecUnfilteredRows.at(i);
+
+            vecDelayed << m_matDelayLine.row(iRow), matInput.row(iRow).head(iNumProcessed);
+            matProcessed.row(iRow) = vecDelayed.head(iNumProcessed);
+            m_matDelayLine.row(iRow) = vecDelayed.tail(m_iGroupDelay);
+        }
+    }
+
+    m_matInputBuffer = matInput.rightCols(matInput.cols() - iNumProcessed);
+
+    // Append to the output which was not returned yet. If there are not enough samples, pad with zeros up to the
+    // maximal buffering delay of one partition, so the delay stays constant for all following blocks.
+    const int iNumAvailable = m_matOutputBuffer.cols() + iNumProcessed;
+    const int iNumMissing = iNumAvailable < matData.cols() ? m_iPartitionSize - 1 - m_iBufferDelay : 0;
+
+    MatrixXd matOutput(matData.rows(), iNumAvailable + iNumMissing);
+    matOutput << MatrixXd::Zero(matData.rows(), iNumMissing), m_matOutputBuffer, matProcessed;
+    m_iBufferDelay += iNumMissing;
+
+    m_matOutputBuffer = matOutput.rightCols(matOutput.cols() - matData.cols());
+
+    return matOutput.leftCols(matData.cols());
+}
+
+//=============================================================================================================
+
+void FilterPartitioned::setPartitionSize(int iPartitionSize)
+{
+    m_iPartitionSizeSet = iPartitionSize > 0 ? iPartitionSize : 0;
+    reset();
+}
+
+//=============================================================================================================
+
+int FilterPartitioned::getPartitionSize() const
+{
+    return m_iPartitionSize;
+}
+
+//=============================================================================================================
+
+int FilterPartitioned::getDelay() const
+{
+    return m_iGroupDelay + m_iBufferDelay;
+}
+
+//=============================================================================================================
+
+void FilterPartitioned::reset()
+{
+    m_iPartitionSize = 0;
+    m_iNumKernelPartitions = 0;
+    m_iGroupDelay = 0;
+    m_iBufferDelay = 0;
+
+    m_vecCoeff.resize(0);
+    m_vecPicks.resize(0);
+    m_matKernelSpectra.resize(0,0);
+    m_channelStates.clear();
+    m_vecUnfilteredRows.clear();
+
+    m_matInputBuffer.resize(0,0);
+    m_matOutputBuffer.resize(0,0);
+    m_matDelayLine.resize(0,0);
+}
+
+//=============================================================================================================
+
+void FilterPartitioned::setup(const FilterKernel& filterKernel,
+                              int iRows,
+                              const RowVectorXi& vecPicks)
+{
+    const int iPartitionSize = m_iPartitionSize;
+    const int iFftLength = 2 * iPartitionSize;
+
+    m_vecCoeff = filterKernel.getCoefficients();
+    m_vecPicks = vecPicks;
+    m_iNumKernelPartitions = (m_vecCoeff.cols() + iPartitionSize - 1) / iPartitionSize;
+    m_iGroupDelay = m_vecCoeff.cols() / 2;
+    m_iBufferDelay = 0;
+
+    // Transform the zero padded kernel partitions
+    Eigen::FFT<double> fft;
+    fft.SetFlag(fft.HalfSpectrum);
+
+    VectorXd vecPartition(iFftLength);
+    VectorXcd vecSpectrum;
+    m_matKernelSpectra.resize(iPartitionSize + 1, m_iNumKernelPartitions);
+
+    for(int p = 0; p < m_iNumKernelPartitions; ++p) {
+        const int iLength = std::min(iPartitionSize, int(m_vecCoeff.cols()) - p * iPartitionSize);
+
+        vecPartition.setZero();
+        vecPartition.head(iLength) = m_vecCoeff.segment(p * iPartitionSize, iLength).transpose();
+
+        fft.fwd(vecSpectrum, vecPartition);
+        m_matKernelSpectra.col(p) = vecSpectrum;
+    }
+
+    // Setup the channel states. The FFT objects are planned here once and reused for all following blocks.
+    QVector<bool> vecFiltered(iRows, vecPicks.cols() == 0);
+    for(int i = 0; i < vecPicks.cols(); ++i) {
+        if(vecPicks[i] >= 0 && vecPicks[i] < iRows) {
+            vecFiltered[vecPicks[i]] = true;
+        }
+    }
+
+    ChannelState state;
+    state.iFdlIndex = 0;
+    state.fft.SetFlag(state.fft.HalfSpectrum);
+    state.vecTimeBuffer = VectorXd::Zero(iFftLength);
+    state.vecTimeOut = VectorXd::Zero(iFftLength);
+    state.matFdl = MatrixXcd::Zero(iPartitionSize + 1, m_iNumKernelPartitions);
+    state.fft.fwd(state.vecAccumulator, state.vecTimeBuffer);
+    state.fft.inv(state.vecTimeOut, state.vecAccumulator, iFftLength);
+
+    m_channelStates.clear();
+    m_vecUnfilteredRows.clear();
+
+    for(int i = 0; i < iRows; ++i) {
+        if(vecFiltered[i]) {
+            state.iRow = i;
+            m_channelStates.append(state);
+        } else {
+            m_vecUnfilteredRows.append(i);
+        }
+    }
+
+    m_matInputBuffer.resize(iRows, 0);
+    m_matOutputBuffer.resize(iRows, 0);
+    m_matDelayLine = MatrixXd::Zero(iRows, m_iGroupDelay);
+}
+
+//=============================================================================================================
+
+void FilterPartitioned::filterChannel(ChannelState& state,
+                                      const MatrixXd& matInput,
+                                      MatrixXd& matOutput) const
+{
+    const int iPartitionSize = m_iPartitionSize;
+    const int iFftLength = 2 * iPartitionSize;
+    const int iNumPartitions = matInput.cols() / iPartitionSize;
+
+    for(int k = 0; k < iNumPartitions; ++k) {
+        // Slide the input window by one partition and transform it into the newest delay line slot
+        state.vecTimeBuffer.head(iPartitionSize) = state.vecTimeBuffer.tail(iPartitionSize);
+        state.vecTimeBuffer.tail(iPartitionSize) = matInput.row(state.iRow).segment(k * iPartitionSize, iPartitionSize).transpose();
+
+        state.iFdlIndex = (state.iFdlIndex + 1) % m_iNumKernelPartitions;
+        state.fft.fwd(state.vecAccumulator, state.vecTimeBuffer);
+        state.matFdl.col(state.iFdlIndex) = state.vecAccumulator;
+
+        // Multiply each kernel partition with the input spectrum of the matching age and accumulate
+        state.vecAccumulator = m_matKernelSpectra.col(0).cwiseProduct(state.matFdl.col(state.iFdlIndex));
+
+        for(int p = 1; p < m_iNumKernelPartitions; ++p) {
+            const int iSlot = (state.iFdlIndex - p + m_iNumKernelPartitions) % m_iNumKernelPartitions;
+            state.vecAccumulator += m_matKernelSpectra.col(p).cwiseProduct(state.matFdl.col(iSlot));
+        }
+
+        // The second half of the circular convolution is the valid linear convolution result
+        state.fft.inv(state.vecTimeOut, state.vecAccumulator, iFftLength);
+        matOutput.row(state.iRow).segment(k * iPartitionSize, iPartitionSize) = state.vecTimeOut.tail(iPartitionSize).transpose();
+    }
+}
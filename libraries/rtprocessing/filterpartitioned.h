@@ -0,0 +1,201 @@
+//=============================================================================================================
+/**
+ * @file     filterpartitioned.h
+ * @author   MNE-CPP Authors
+ * @since    0.1.9
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, MNE-CPP Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    Declaration of the FilterPartitioned class.
+ *
+ */
+
+#ifndef FILTERPARTITIONED_RTPROCESSING_H
+#define FILTERPARTITIONED_RTPROCESSING_H
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rtprocessing_global.h"
+
+#include "helpers/filterkernel.h"
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QVector>
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+#include <unsupported/Eigen/FFT>
+
+//=============================================================================================================
+// DEFINE NAMESPACE RTPROCESSINGLIB
+//=============================================================================================================
+
+namespace RTPROCESSINGLIB
+{
+
+//=============================================================================================================
+/**
+ * Streaming FIR filtering with uniformly partitioned overlap-save convolution. The filter kernel is split into
+ * partitions of iPartitionSize taps which are transformed once. Every channel keeps a frequency-domain delay line
+ * of its past input partitions, so each new partition of data costs one forward and one inverse FFT of length
+ * 2*iPartitionSize, independent of the filter order. The FFT objects are kept between calls.
+ *
+ * The output is causal: it has the group delay of the filter kernel (half the filter length) plus a buffering
+ * delay of less than iPartitionSize samples if the incoming blocks are not a multiple of the partition size.
+ * Channels which are not filtered are delayed by the same amount. Small partitions lower the latency, large
+ * partitions increase the throughput.
+ *
+ * @brief Low latency streaming FIR filtering with uniformly partitioned overlap-save convolution.
+ */
+class RTPROCESINGSHARED_EXPORT FilterPartitioned
+{
+public:
+    typedef QSharedPointer<FilterPartitioned> SPtr;             /**< Shared pointer type for FilterPartitioned. */
+    typedef QSharedPointer<const FilterPartitioned> ConstSPtr;  /**< Const shared pointer type for FilterPartitioned. */
+
+    //=========================================================================================================
+    /**
+     * Constructs a FilterPartitioned object.
+     *
+     * @param[in] iPartitionSize   The partition size in samples. Default is 0, which derives the partition size
+     *                             from the size of the first data block.
+     */
+    explicit FilterPartitioned(int iPartitionSize = 0);
+
+    //=========================================================================================================
+    /**
+     * Filters the next block of a continuous data stream. Blocks may have any number of samples.
+     *
+     * @param[in] matData          The data block which is to be filtered.
+     * @param[in] filterKernel     The filter kernel to use. A changed kernel resets the filter state.
+     * @param[in] vecPicks         Channel indexes to filter. Default is filter all channels.
+     * @param[in] bUseThreads      Whether to use multiple threads. Default is set to true.
+     *
+     * @return The filtered data with the same size as matData.
+     */
+    Eigen::MatrixXd calculate(const Eigen::MatrixXd& matData,
+                              const RTPROCESSINGLIB::FilterKernel& filterKernel,
+                              const Eigen::RowVectorXi& vecPicks = Eigen::RowVectorXi(),
+                              bool bUseThreads = true);
+
+    //=========================================================================================================
+    /**
+     * Sets the partition size. This resets the filter state.
+     *
+     * @param[in] iPartitionSize   The partition size in samples. 0 derives the partition size from the size of
+     *                             the next data block.
+     */
+    void setPartitionSize(int iPartitionSize);
+
+    //=========================================================================================================
+    /**
+     * Returns the partition size which is currently used.
+     *
+     * @return The partition size in samples. 0 if it was not derived yet.
+     */
+    int getPartitionSize() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the total delay of the output in samples, i.e. the group delay of the filter kernel plus the
+     * buffering delay.
+     *
+     * @return The delay in samples.
+     */
+    int getDelay() const;
+
+    //=========================================================================================================
+    /**
+     * Resets the filter state.
+     */
+    void reset();
+
+private:
+    //=========================================================================================================
+    /**
+     * The state of one filtered channel.
+     */
+    struct ChannelState {
+        int                     iRow;               /**< The row of the channel in the data matrix. */
+        int                     iFdlIndex;          /**< The slot of the newest spectrum in the delay line. */
+        Eigen::FFT<double>      fft;                /**< The FFT object of this channel. */
+        Eigen::VectorXd         vecTimeBuffer;      /**< The last two input partitions. */
+        Eigen::VectorXd         vecTimeOut;         /**< Holds the inverse FFT result. */
+        Eigen::VectorXcd        vecAccumulator;     /**< Holds the sum of the partition products. */
+        Eigen::MatrixXcd        matFdl;             /**< The frequency-domain delay line, one input spectrum per column. */
+    };
+
+    //=========================================================================================================
+    /**
+     * Partitions and transforms the filter kernel and initializes the channel states.
+     *
+     * @param[in] filterKernel     The filter kernel.
+     * @param[in] iRows            The number of rows of the data.
+     * @param[in] vecPicks         Channel indexes to filter.
+     */
+    void setup(const RTPROCESSINGLIB::FilterKernel& filterKernel,
+               int iRows,
+               const Eigen::RowVectorXi& vecPicks);
+
+    //=========================================================================================================
+    /**
+     * Filters consecutive partitions of one channel.
+     *
+     * @param[in, out] state       The channel state.
+     * @param[in] matInput         The input data. Only whole partitions are filtered.
+     * @param[out] matOutput       The output matrix, the row state.iRow is written.
+     */
+    void filterChannel(ChannelState& state,
+                       const Eigen::MatrixXd& matInput,
+                       Eigen::MatrixXd& matOutput) const;
+
+    int                         m_iPartitionSizeSet;        /**< The partition size set by the user, 0 for automatic. */
+    int                         m_iPartitionSize;           /**< The partition size currently used. */
+    int                         m_iNumKernelPartitions;     /**< The number of kernel partitions. */
+    int                         m_iGroupDelay;              /**< The group delay of the filter kernel. */
+    int                         m_iBufferDelay;             /**< The buffering delay of the output. */
+
+    Eigen::RowVectorXd          m_vecCoeff;                 /**< The coefficients of the current filter kernel. */
+    Eigen::RowVectorXi          m_vecPicks;                 /**< The currently filtered channels. */
+    Eigen::MatrixXcd            m_matKernelSpectra;         /**< The spectra of the kernel partitions, one per column. */
+    QVector<ChannelState>       m_channelStates;            /**< The states of the filtered channels. */
+    QVector<int>                m_vecUnfilteredRows;        /**< The rows of the channels which are only delayed. */
+
+    Eigen::MatrixXd             m_matInputBuffer;           /**< Input samples not filling a whole partition yet. */
+    Eigen::MatrixXd             m_matOutputBuffer;          /**< Output samples not returned yet. */
+    Eigen::MatrixXd             m_matDelayLine;             /**< The last m_iGroupDelay input samples of all channels. */
+};
+} // NAMESPACE
+
+#endif // FILTERPARTITIONED_RTPROCESSING_H
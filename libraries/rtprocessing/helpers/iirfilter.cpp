@@ -0,0 +1,613 @@
+//=============================================================================================================
+/**
+ * @file     iirfilter.cpp
+ * @author   MNE-CPP Authors
+ * @since    0.1.9
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, MNE-CPP Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    Definition of the IirFilter class.
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "iirfilter.h"
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+#include <algorithm>
+#include <complex>
+#include <vector>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Dense>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace RTPROCESSINGLIB;
+using namespace Eigen;
+
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+typedef std::complex<double> Complex;
+
+//=============================================================================================================
+
+static Complex prodNegative(const std::vector<Complex>& vecRoots)
+{
+    Complex result(1.0, 0.0);
+    for(size_t i = 0; i < vecRoots.size(); ++i) {
+        result *= -vecRoots[i];
+    }
+    return result;
+}
+
+//=============================================================================================================
+
+static void lowpassToBandpass(std::vector<Complex>& vecRoots,
+                              double dW0,
+                              double dBw)
+{
+    std::vector<Complex> vecResult;
+    vecResult.reserve(2 * vecRoots.size());
+
+    for(size_t i = 0; i < vecRoots.size(); ++i) {
+        Complex root = vecRoots[i] * dBw / 2.0;
+        Complex root2 = std::sqrt(root * root - dW0 * dW0);
+        vecResult.push_back(root + root2);
+        vecResult.push_back(root - root2);
+    }
+
+    vecRoots = vecResult;
+}
+
+//=============================================================================================================
+
+static void lowpassToBandstop(std::vector<Complex>& vecRoots,
+                              double dW0,
+                              double dBw)
+{
+    std::vector<Complex> vecResult;
+    vecResult.reserve(2 * vecRoots.size());
+
+    for(size_t i = 0; i < vecRoots.size(); ++i) {
+        Complex root = (dBw / 2.0) / vecRoots[i];
+        Complex root2 = std::sqrt(root * root - dW0 * dW0);
+        vecResult.push_back(root + root2);
+        vecResult.push_back(root - root2);
+    }
+
+    vecRoots = vecResult;
+}
+
+//=============================================================================================================
+
+/**
+ * Groups the roots into second order pairs. Complex roots are paired with their conjugate, real roots are paired
+ * from both ends of their sorted list. An odd real root is returned as a single element group at the end.
+ */
+static std::vector<std::vector<Complex> > pairRoots(const std::vector<Complex>& vecRoots)
+{
+    const double dTol = 1e-10;
+    std::vector<std::vector<Complex> > vecPairs;
+    std::vector<double> vecReal;
+
+    for(size_t i = 0; i < vecRoots.size(); ++i) {
+        if(std::abs(vecRoots[i].imag()) <= dTol * std::max(1.0, std::abs(vecRoots[i]))) {
+            vecReal.push_back(vecRoots[i].real());
+        } else if(vecRoots[i].imag() > 0) {
+            vecPairs.push_back({vecRoots[i], std::conj(vecRoots[i])});
+        }
+    }
+
+    std::sort(vecReal.begin(), vecReal.end());
+
+    size_t iLow = 0;
+    size_t iHigh = vecReal.size();
+    while(iHigh - iLow >= 2) {
+        vecPairs.push_back({Complex(vecReal[iLow], 0.0), Complex(vecReal[iHigh - 1], 0.0)});
+        ++iLow;
+        --iHigh;
+    }
+
+    if(iHigh - iLow == 1) {
+        vecPairs.push_back({Complex(vecReal[iLow], 0.0)});
+    }
+
+    return vecPairs;
+}
+
+//=============================================================================================================
+// INIT STATIC MEMBERS
+//=============================================================================================================
+
+QVector<RTPROCESSINGLIB::FilterParameter> IirFilter::m_designMethods ({
+    FilterParameter(QString("Butterworth"), QString("A butterworth filter")),
+    FilterParameter(QString("Chebyshev"), QString("A chebyshev type I filter"))
+});
+
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+IirFilter::IirFilter()
+: m_sFreq(1000)
+, m_dCenterFreq(0.5)
+, m_dBandwidth(0.1)
+, m_dRipple(1.0)
+, m_iFilterOrder(4)
+, m_iDesignMethod(m_designMethods.indexOf(FilterParameter("Butterworth")))
+, m_iFilterType(FilterKernel::m_filterTypes.indexOf(FilterParameter("BPF")))
+, m_sFilterName("Unknown")
+{
+    designFilter();
+}
+
+//=============================================================================================================
+
+IirFilter::IirFilter(const QString& sFilterName,
+                     int iFilterType,
+                     int iOrder,
+                     double dCenterfreq,
+                     double dBandwidth,
+                     double dSFreq,
+                     int iDesignMethod,
+                     double dRipple)
+: m_sFreq(dSFreq)
+, m_dCenterFreq(dCenterfreq)
+, m_dBandwidth(dBandwidth)
+, m_dRipple(dRipple)
+, m_iFilterOrder(iOrder)
+, m_iDesignMethod(iDesignMethod)
+, m_iFilterType(iFilterType)
+, m_sFilterName(sFilterName)
+{
+    if(iOrder < 1) {
+       qWarning() << "[IirFilter::IirFilter] Filter order must be at least 1. Setting order to 1.";
+       m_iFilterOrder = 1;
+    }
+
+    designFilter();
+}
+
+//=============================================================================================================
+
+void IirFilter::applyFilter(MatrixXd& matData,
+                            const RowVectorXi& vecPicks)
+{
+    const int iNumChannels = vecPicks.cols() > 0 ? vecPicks.cols() : matData.rows();
+
+    // Reset the states if the channels changed
+    if(m_matState.rows() != iNumChannels
+       || m_vecStatePicks.cols() != vecPicks.cols()
+       || m_vecStatePicks != vecPicks) {
+        m_matState = MatrixXd::Zero(iNumChannels, 2 * m_matSos.rows());
+        m_vecStatePicks = vecPicks;
+    }
+
+    if(vecPicks.cols() == 0) {
+        filterSections(matData, m_matState, false);
+        return;
+    }
+
+    MatrixXd matPicked(vecPicks.cols(), matData.cols());
+    for(int i = 0; i < vecPicks.cols(); ++i) {
+        matPicked.row(i) = matData.row(vecPicks[i]);
+    }
+
+    filterSections(matPicked, m_matState, false);
+
+    for(int i = 0; i < vecPicks.cols(); ++i) {
+        matData.row(vecPicks[i]) = matPicked.row(i);
+    }
+}
+
+//=============================================================================================================
+
+MatrixXd IirFilter::applyZeroPhaseFilter(const MatrixXd& matData,
+                                         const RowVectorXi& vecPicks) const
+{
+    MatrixXd matDataOut = matData;
+
+    if(matData.cols() < 2) {
+        return matDataOut;
+    }
+
+    RowVectorXi vecPicksNew = vecPicks;
+    if(vecPicksNew.cols() == 0) {
+        vecPicksNew = RowVectorXi::LinSpaced(matData.rows(), 0, matData.rows() - 1);
+    }
+
+    // Extend the data by odd reflection at both ends. First order sections do not count for the pad length.
+    const int iNumFirstOrder = std::min((m_matSos.col(2).array() == 0.0).count(), (m_matSos.col(5).array() == 0.0).count());
+    const int iPadLength = std::min(3 * (2 * int(m_matSos.rows()) + 1 - iNumFirstOrder), int(matData.cols()) - 1);
+    const int iNumSamples = matData.cols();
+    MatrixXd matExt(vecPicksNew.cols(), iNumSamples + 2 * iPadLength);
+
+    for(int i = 0; i < vecPicksNew.cols(); ++i) {
+        const RowVectorXd vecRow = matData.row(vecPicksNew[i]);
+
+        matExt.row(i).segment(iPadLength, iNumSamples) = vecRow;
+        for(int t = 0; t < iPadLength; ++t) {
+            matExt(i, t) = 2.0 * vecRow(0) - vecRow(iPadLength - t);
+            matExt(i, iPadLength + iNumSamples + t) = 2.0 * vecRow(iNumSamples - 1) - vecRow(iNumSamples - 2 - t);
+        }
+    }
+
+    // Forward and backward pass, both starting from the steady state of their first sample
+    const VectorXd vecStepState = stepResponseState();
+
+    MatrixXd matState = matExt.col(0) * vecStepState.transpose();
+    filterSections(matExt, matState, false);
+
+    matState = matExt.col(matExt.cols() - 1) * vecStepState.transpose();
+    filterSections(matExt, matState, true);
+
+    for(int i = 0; i < vecPicksNew.cols(); ++i) {
+        matDataOut.row(vecPicksNew[i]) = matExt.row(i).segment(iPadLength, iNumSamples);
+    }
+
+    return matDataOut;
+}
+
+//=============================================================================================================
+
+void IirFilter::reset()
+{
+    m_matState.resize(0,0);
+    m_vecStatePicks.resize(0);
+}
+
+//=============================================================================================================
+
+MatrixXd IirFilter::getSos() const
+{
+    return m_matSos;
+}
+
+//=============================================================================================================
+
+QString IirFilter::getName() const
+{
+    return m_sFilterName;
+}
+
+//=============================================================================================================
+
+void IirFilter::setName(const QString& sFilterName)
+{
+    m_sFilterName = sFilterName;
+}
+
+//=============================================================================================================
+
+double IirFilter::getSamplingFrequency() const
+{
+    return m_sFreq;
+}
+
+//=============================================================================================================
+
+int IirFilter::getFilterOrder() const
+{
+    return m_iFilterOrder;
+}
+
+//=============================================================================================================
+
+double IirFilter::getCenterFrequency() const
+{
+    return m_dCenterFreq;
+}
+
+//=============================================================================================================
+
+double IirFilter::getBandwidth() const
+{
+    return m_dBandwidth;
+}
+
+//=============================================================================================================
+
+double IirFilter::getRipple() const
+{
+    return m_dRipple;
+}
+
+//=============================================================================================================
+
+FilterParameter IirFilter::getDesignMethod() const
+{
+    if(m_iDesignMethod < 0 || m_iDesignMethod >= m_designMethods.size()) {
+        return m_designMethods.at(0);
+    }
+    return m_designMethods.at(m_iDesignMethod);
+}
+
+//=============================================================================================================
+
+FilterParameter IirFilter::getFilterType() const
+{
+    if(m_iFilterType < 0 || m_iFilterType >= FilterKernel::m_filterTypes.size()) {
+        return FilterKernel::m_filterTypes.last();
+    }
+    return FilterKernel::m_filterTypes.at(m_iFilterType);
+}
+
+//=============================================================================================================
+
+QString IirFilter::getShortDescription() const
+{
+    double dNyquist = m_sFreq / 2.0;
+    double dLow = 0.0;
+    double dHigh = 0.0;
+
+    switch(m_iFilterType) {
+        case 0:
+            dHigh = m_dCenterFreq * dNyquist;
+            break;
+
+        case 1:
+            dLow = m_dCenterFreq * dNyquist;
+            break;
+
+        default:
+            dLow = (m_dCenterFreq - m_dBandwidth/2) * dNyquist;
+            dHigh = (m_dCenterFreq + m_dBandwidth/2) * dNyquist;
+            break;
+    }
+
+    return QString(getDesignMethod().getName() + "  -  " + getFilterType().getName() + "  -  "
+                   + QString::number(dLow,'g',4) + "Hz to " + QString::number(dHigh,'g',4) + "Hz  -  "
+                   + "Ord: " + QString::number(m_iFilterOrder));
+}
+
+//=============================================================================================================
+
+void IirFilter::designFilter()
+{
+    const int N = m_iFilterOrder;
+
+    // Analog lowpass prototype with cut off frequency 1
+    std::vector<Complex> vecZeros;
+    std::vector<Complex> vecPoles;
+    double dGain = 1.0;
+
+    if(getDesignMethod().getName() == "Chebyshev") {
+        double dEps = std::sqrt(std::pow(10.0, 0.1 * m_dRipple) - 1.0);
+        double dMu = std::asinh(1.0 / dEps) / N;
+
+        for(int m = -N + 1; m < N; m += 2) {
+            double dTheta = M_PI * m / (2.0 * N);
+            vecPoles.push_back(-std::sinh(Complex(dMu, dTheta)));
+        }
+
+        dGain = prodNegative(vecPoles).real();
+        if(N % 2 == 0) {
+            dGain /= std::sqrt(1.0 + dEps * dEps);
+        }
+    } else {
+        for(int m = -N + 1; m < N; m += 2) {
+            vecPoles.push_back(-std::exp(Complex(0.0, M_PI * m / (2.0 * N))));
+        }
+    }
+
+    // Prewarp the frequencies for the bilinear transform. All frequencies are normed to nyquist, which
+    // corresponds to a sampling frequency of 2.
+    const double dFs = 2.0;
+    auto warp = [&](double dFreq) {
+        dFreq = std::min(std::max(dFreq, 1e-9), 1.0 - 1e-9);
+        return 2.0 * dFs * std::tan(M_PI * dFreq / dFs);
+    };
+
+    const int iDegree = vecPoles.size() - vecZeros.size();
+
+    switch(m_iFilterType) {
+        case 0: {
+            const double dW0 = warp(m_dCenterFreq);
+            for(size_t i = 0; i < vecPoles.size(); ++i) {
+                vecPoles[i] *= dW0;
+            }
+            dGain *= std::pow(dW0, iDegree);
+            break;
+        }
+
+        case 1: {
+            const double dW0 = warp(m_dCenterFreq);
+            dGain *= (prodNegative(vecZeros) / prodNegative(vecPoles)).real();
+            for(size_t i = 0; i < vecPoles.size(); ++i) {
+                vecPoles[i] = dW0 / vecPoles[i];
+            }
+            vecZeros.assign(iDegree, Complex(0.0, 0.0));
+            break;
+        }
+
+        case 2: {
+            const double dW1 = warp(m_dCenterFreq - m_dBandwidth/2);
+            const double dW2 = warp(m_dCenterFreq + m_dBandwidth/2);
+            const double dW0 = std::sqrt(dW1 * dW2);
+            const double dBw = dW2 - dW1;
+
+            lowpassToBandpass(vecPoles, dW0, dBw);
+            vecZeros.assign(iDegree, Complex(0.0, 0.0));
+            dGain *= std::pow(dBw, iDegree);
+            break;
+        }
+
+        default: {
+            const double dW1 = warp(m_dCenterFreq - m_dBandwidth/2);
+            const double dW2 = warp(m_dCenterFreq + m_dBandwidth/2);
+            const double dW0 = std::sqrt(dW1 * dW2);
+            const double dBw = dW2 - dW1;
+
+            dGain *= (prodNegative(vecZeros) / prodNegative(vecPoles)).real();
+            lowpassToBandstop(vecPoles, dW0, dBw);
+            vecZeros.assign(iDegree, Complex(0.0, dW0));
+            vecZeros.insert(vecZeros.end(), iDegree, Complex(0.0, -dW0));
+            break;
+        }
+    }
+
+    // Bilinear transform to the z-plane. Zeros at infinity are mapped to nyquist.
+    const double dFs2 = 2.0 * dFs;
+    Complex gainNum(1.0, 0.0);
+    Complex gainDen(1.0, 0.0);
+
+    for(size_t i = 0; i < vecZeros.size(); ++i) {
+        gainNum *= dFs2 - vecZeros[i];
+        vecZeros[i] = (dFs2 + vecZeros[i]) / (dFs2 - vecZeros[i]);
+    }
+
+    for(size_t i = 0; i < vecPoles.size(); ++i) {
+        gainDen *= dFs2 - vecPoles[i];
+        vecPoles[i] = (dFs2 + vecPoles[i]) / (dFs2 - vecPoles[i]);
+    }
+
+    vecZeros.insert(vecZeros.end(), vecPoles.size() - vecZeros.size(), Complex(-1.0, 0.0));
+    dGain *= (gainNum / gainDen).real();
+
+    // Pair the poles and zeros to second order sections. Each pole pair gets the nearest zero pair, beginning with
+    // the poles closest to the unit circle.
+    std::vector<std::vector<Complex> > vecPolePairs = pairRoots(vecPoles);
+    std::vector<std::vector<Complex> > vecZeroPairs = pairRoots(vecZeros);
+
+    std::sort(vecPolePairs.begin(), vecPolePairs.end(), [](const std::vector<Complex>& a, const std::vector<Complex>& b) {
+        if(a.size() != b.size()) {
+            return a.size() < b.size();
+        }
+        return std::abs(a[0]) > std::abs(b[0]);
+    });
+
+    m_matSos = MatrixXd::Zero(vecPolePairs.size(), 6);
+
+    for(size_t s = 0; s < vecPolePairs.size(); ++s) {
+        const std::vector<Complex>& poles = vecPolePairs[s];
+
+        size_t iBest = 0;
+        double dBestDist = -1.0;
+        for(size_t j = 0; j < vecZeroPairs.size(); ++j) {
+            if(vecZeroPairs[j].size() != poles.size()) {
+                continue;
+            }
+            double dDist = std::abs(vecZeroPairs[j][0] - poles[0]);
+            if(dBestDist < 0 || dDist < dBestDist) {
+                dBestDist = dDist;
+                iBest = j;
+            }
+        }
+
+        std::vector<Complex> zeros = vecZeroPairs[iBest];
+        vecZeroPairs.erase(vecZeroPairs.begin() + iBest);
+
+        if(poles.size() == 2) {
+            m_matSos.row(s) << 1.0, -(zeros[0] + zeros[1]).real(), (zeros[0] * zeros[1]).real(),
+                               1.0, -(poles[0] + poles[1]).real(), (poles[0] * poles[1]).real();
+        } else {
+            m_matSos.row(s) << 1.0, -zeros[0].real(), 0.0,
+                               1.0, -poles[0].real(), 0.0;
+        }
+    }
+
+    m_matSos.block(0, 0, 1, 3) *= dGain;
+
+    reset();
+}
+
+//=============================================================================================================
+
+void IirFilter::filterSections(MatrixXd& matData,
+                               MatrixXd& matState,
+                               bool bReverse) const
+{
+    const int iNumSections = m_matSos.rows();
+    const int iNumSamples = matData.cols();
+
+    ArrayXd x(matData.rows());
+    ArrayXd y(matData.rows());
+
+    // Transposed direct form II, all channels of one sample at once
+    for(int i = 0; i < iNumSamples; ++i) {
+        const int t = bReverse ? iNumSamples - 1 - i : i;
+        x = matData.col(t).array();
+
+        for(int s = 0; s < iNumSections; ++s) {
+            const double b0 = m_matSos(s,0);
+            const double b1 = m_matSos(s,1);
+            const double b2 = m_matSos(s,2);
+            const double a1 = m_matSos(s,4);
+            const double a2 = m_matSos(s,5);
+
+            y = b0 * x + matState.col(2*s).array();
+            matState.col(2*s).array() = b1 * x - a1 * y + matState.col(2*s+1).array();
+            matState.col(2*s+1).array() = b2 * x - a2 * y;
+            x = y;
+        }
+
+        matData.col(t) = x.matrix();
+    }
+}
+
+//=============================================================================================================
+
+VectorXd IirFilter::stepResponseState() const
+{
+    VectorXd vecState(2 * m_matSos.rows());
+    double dScale = 1.0;
+
+    for(int s = 0; s < m_matSos.rows(); ++s) {
+        const double b0 = m_matSos(s,0);
+        const double b1 = m_matSos(s,1);
+        const double b2 = m_matSos(s,2);
+        const double a1 = m_matSos(s,4);
+        const double a2 = m_matSos(s,5);
+
+        Matrix2d matIminusA;
+        matIminusA << 1.0 + a1, -1.0,
+                      a2, 1.0;
+        Vector2d vecB(b1 - a1 * b0, b2 - a2 * b0);
+
+        vecState.segment(2*s, 2) = dScale * matIminusA.partialPivLu().solve(vecB);
+        dScale *= (b0 + b1 + b2) / (1.0 + a1 + a2);
+    }
+
+    return vecState;
+}
@@ -0,0 +1,216 @@
+//=============================================================================================================
+/**
+ * @file     iirfilter.h
+ * @author   MNE-CPP Authors
+ * @since    0.1.9
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, MNE-CPP Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    The IirFilter class designs Butterworth and Chebyshev IIR filters as cascades of second order
+ *           sections (biquads) and applies them to continuous multichannel data streams.
+ *
+ */
+
+#ifndef IIRFILTER_H
+#define IIRFILTER_H
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../rtprocessing_global.h"
+
+#include "filterkernel.h"
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QString>
+#include <QVector>
+#include <QSharedPointer>
+
+//=============================================================================================================
+// DEFINE NAMESPACE RTPROCESSINGLIB
+//=============================================================================================================
+
+namespace RTPROCESSINGLIB
+{
+
+//=============================================================================================================
+/**
+ * The IirFilter class designs Butterworth and Chebyshev (type I) IIR filters via the bilinear transform and
+ * stores them as a cascade of second order sections. The filter keeps one state per section and channel, so
+ * consecutive data blocks of a stream can be filtered without transients at the block borders. All channels
+ * are processed together, sample by sample.
+ *
+ * @brief The IirFilter class provides IIR filter design and streaming application with second order sections.
+ */
+class RTPROCESINGSHARED_EXPORT IirFilter
+{
+public:
+    typedef QSharedPointer<IirFilter> SPtr;             /**< Shared pointer type for IirFilter. */
+    typedef QSharedPointer<const IirFilter> ConstSPtr;  /**< Const shared pointer type for IirFilter. */
+
+    //=========================================================================================================
+    /**
+     * Creates a default IirFilter object, a fourth order Butterworth band pass.
+     */
+    IirFilter();
+
+    //=========================================================================================================
+    /**
+     * Constructs an IirFilter object
+     *
+     * @param[in] sFilterName      Defines the name of the generated filter.
+     * @param[in] iFilterType      Type of the filter: LPF, HPF, BPF, NOTCH (from FilterKernel::m_filterTypes).
+     * @param[in] iOrder           The order of the analog prototype. Band pass and notch filters have twice this order.
+     * @param[in] dCenterfreq      The cut off frequency (LPF, HPF) or the center frequency (BPF, NOTCH) - normed to sFreq/2 (nyquist).
+     * @param[in] dBandwidth       Ignored if FilterType is set to LPF,HPF. If NOTCH/BPF: bandwidth of stop-/passband - normed to sFreq/2 (nyquist).
+     * @param[in] dSFreq           The sampling frequency.
+     * @param[in] iDesignMethod    The design method to use. Choose between Butterworth and Chebyshev (from m_designMethods).
+     * @param[in] dRipple          The pass band ripple in dB. Only used by the Chebyshev design. Default is 1 dB.
+     */
+    IirFilter(const QString& sFilterName,
+              int iFilterType,
+              int iOrder,
+              double dCenterfreq,
+              double dBandwidth,
+              double dSFreq,
+              int iDesignMethod,
+              double dRipple = 1.0);
+
+    //=========================================================================================================
+    /**
+     * Filters the next block of a continuous data stream in place. The filter state of each channel is kept
+     * for the next block.
+     *
+     * @param[in, out] matData     The data block, channels in rows. The picked rows are overwritten with the filtered data.
+     * @param[in] vecPicks         Channel indexes to filter. Default is filter all channels.
+     */
+    void applyFilter(Eigen::MatrixXd& matData,
+                     const Eigen::RowVectorXi& vecPicks = Eigen::RowVectorXi());
+
+    //=========================================================================================================
+    /**
+     * Filters data which is present all at once forward and backward, which results in zero phase distortion
+     * and squares the magnitude response. The data is extended by odd reflection at both ends and the filter
+     * states are initialized with the steady state of the first sample to avoid edge transients. The streaming
+     * state is not touched.
+     *
+     * @param[in] matData          The data, channels in rows.
+     * @param[in] vecPicks         Channel indexes to filter. Default is filter all channels.
+     *
+     * @return The filtered data with the same size as matData.
+     */
+    Eigen::MatrixXd applyZeroPhaseFilter(const Eigen::MatrixXd& matData,
+                                         const Eigen::RowVectorXi& vecPicks = Eigen::RowVectorXi()) const;
+
+    //=========================================================================================================
+    /**
+     * Resets the streaming state of all channels.
+     */
+    void reset();
+
+    //=========================================================================================================
+    /**
+     * Returns the second order sections, one section per row in the form [b0 b1 b2 1 a1 a2]. The overall gain
+     * is contained in the first section.
+     *
+     * @return The second order sections.
+     */
+    Eigen::MatrixXd getSos() const;
+
+    QString getName() const;
+    void setName(const QString& sFilterName);
+
+    double getSamplingFrequency() const;
+    int getFilterOrder() const;
+    double getCenterFrequency() const;
+    double getBandwidth() const;
+    double getRipple() const;
+
+    FilterParameter getDesignMethod() const;
+    FilterParameter getFilterType() const;
+
+    QString getShortDescription() const;
+
+    static QVector<FilterParameter> m_designMethods;  /**< Vector of possible IIR filter design methods. */
+
+private:
+    //=========================================================================================================
+    /**
+     * Designs the second order sections with the given parameters.
+     */
+    void designFilter();
+
+    //=========================================================================================================
+    /**
+     * Filters the rows of a data matrix with the given section states. The channels are processed together for
+     * each sample.
+     *
+     * @param[in, out] matData     The data, one channel per row. Gets overwritten with the filtered data.
+     * @param[in, out] matState    The section states, one row per channel, two columns per section.
+     * @param[in] bReverse         Whether to run backwards in time.
+     */
+    void filterSections(Eigen::MatrixXd& matData,
+                        Eigen::MatrixXd& matState,
+                        bool bReverse) const;
+
+    //=========================================================================================================
+    /**
+     * Computes the section states which correspond to the steady state response to a unit step input.
+     *
+     * @return The states, two entries per section.
+     */
+    Eigen::VectorXd stepResponseState() const;
+
+    double              m_sFreq;                    /**< The sampling frequency. */
+    double              m_dCenterFreq;              /**< The cut off or center frequency, normed to nyquist. */
+    double              m_dBandwidth;               /**< The bandwidth, normed to nyquist. */
+    double              m_dRipple;                  /**< The pass band ripple in dB. */
+    int                 m_iFilterOrder;             /**< The order of the analog prototype. */
+    int                 m_iDesignMethod;            /**< The design method of the filter instance. */
+    int                 m_iFilterType;              /**< The type of the filter instance. */
+    QString             m_sFilterName;              /**< The name of the filter. */
+
+    Eigen::MatrixXd     m_matSos;                   /**< The second order sections, one per row. */
+    Eigen::MatrixXd     m_matState;                 /**< The streaming states, one row per channel, two columns per section. */
+    Eigen::RowVectorXi  m_vecStatePicks;            /**< The channels the streaming states belong to. */
+};
+} // NAMESPACE RTPROCESSINGLIB
+
+#ifndef metatype_iirfilter
+#define metatype_iirfilter
+Q_DECLARE_METATYPE(RTPROCESSINGLIB::IirFilter)
+#endif
+
+#endif // IIRFILTER_H
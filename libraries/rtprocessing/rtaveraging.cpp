@@ -85,6 +85,7 @@ RtAveragingWorker::RtAveragingWorker(quint32 numAverages,
 , m_iTriggerChIndex(-1)
 , m_iNewTriggerIndex(iTriggerIndex)
 , m_bDoBaselineCorrection(false)
+, m_iTimeStamp(-1)
 , m_pairBaselineSec(qMakePair(float(iBaselineFromMSecs),float(iBaselineToMSecs)))
 , m_bActivateThreshold(false)
 {
@@ -103,12 +104,15 @@ RtAveragingWorker::RtAveragingWorker(quint32 numAverages,
 
 //=============================================================================================================
 
-void RtAveragingWorker::doWork(const MatrixXd& rawSegment)
+void RtAveragingWorker::doWork(const MatrixXd& rawSegment,
+                               qint64 iTimeStamp)
 {
     if(this->thread()->isInterruptionRequested()) {
         return;
     }
 
+    m_iTimeStamp = iTimeStamp;
+
     if(controlValuesChanged()) {
         reset();
     }
@@ -351,7 +355,7 @@ void RtAveragingWorker::emitEvoked(double dTriggerType, QStringList& lResponsibl
     }
 
     if(m_stimEvokedSet.evoked.size() > 0) {
-        emit resultReady(m_stimEvokedSet, lResponsibleTriggerTypes);
+        emit resultReady(m_stimEvokedSet, lResponsibleTriggerTypes, m_iTimeStamp);
     }
 
 //    qDebug()<<"RtAveragingWorker::emitEvoked() - dTriggerType:" << dTriggerType;
@@ -603,18 +607,22 @@ RtAveraging::~RtAveraging()
 
 //=============================================================================================================
 
-void RtAveraging::append(const MatrixXd &data)
+void RtAveraging::append(const MatrixXd &data,
+                         qint64 iTimeStamp)
 {
-    emit operate(data);
+    emit operate(data,
+                 iTimeStamp);
 }
 
 //=============================================================================================================
 
 void RtAveraging::handleResults(const FiffEvokedSet& evokedStimSet,
-                          const QStringList &lResponsibleTriggerTypes)
+                          const QStringList &lResponsibleTriggerTypes,
+                          qint64 iTimeStamp)
 {
     emit evokedStim(evokedStimSet,
-                    lResponsibleTriggerTypes);
+                    lResponsibleTriggerTypes,
+                    iTimeStamp);
 }
 
 //=============================================================================================================
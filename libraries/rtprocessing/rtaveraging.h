@@ -110,8 +110,11 @@ public:
      * Perform one single HPI fit.
      *
      * @param[in] t_mat           Data to estimate the HPI positions from.
+     * @param[in] iTimeStamp      The time stamp (microseconds since epoch) of the data. Evoked sets completed by this
+     *                            data are emitted with it. Defaults to -1 (no time stamp).
      */
-    void doWork(const Eigen::MatrixXd& matData);
+    void doWork(const Eigen::MatrixXd& matData,
+                qint64 iTimeStamp = -1);
 
     //=========================================================================================================
     /**
@@ -249,6 +252,7 @@ protected:
     bool                                            m_bActivateThreshold;       /**< Whether to do threshold artifact reduction or not. */
 
     bool                                            m_bDoBaselineCorrection;    /**< Whether to perform baseline correction. */
+    qint64                                          m_iTimeStamp;               /**< Time stamp of the data block which is currently processed. */
 
     QPair<float,float>                              m_pairBaselineSec;          /**< Baseline information in seconds form where the seconds are seen relative to the trigger, meaning they can also be negative [from to]*/
     QPair<float,float>                              m_pairBaselineSamp;         /**< Baseline information in samples form where the seconds are seen relative to the trigger, meaning they can also be negative [from to]*/
@@ -270,9 +274,11 @@ signals:
      *
      * @param[in] evokedStimSet              The evoked stimulus data set.
      * @param[in] lResponsibleTriggerTypes   List of all trigger types which lead to the recent emit of a new evoked set.
+     * @param[in] iTimeStamp                 The time stamp of the data block which completed the evoked set, -1 if unknown.
      */
     void resultReady(const FIFFLIB::FiffEvokedSet& evokedStimSet,
-                     const QStringList& lResponsibleTriggerTypes);
+                     const QStringList& lResponsibleTriggerTypes,
+                     qint64 iTimeStamp);
 };
 
 //=============================================================================================================
@@ -321,9 +327,12 @@ public:
     /**
      * Slot to receive incoming data.
      *
-     * @param[in] data  Data to calculate the average from.
+     * @param[in] data          Data to calculate the average from.
+     * @param[in] iTimeStamp    The time stamp (microseconds since epoch) of the data, which is handed on with the evoked
+     *                          sets the data completes. Defaults to -1 (no time stamp).
      */
-    void append(const Eigen::MatrixXd &data);
+    void append(const Eigen::MatrixXd &data,
+                qint64 iTimeStamp = -1);
 
     //=========================================================================================================
     /**
@@ -435,14 +444,17 @@ protected:
      * Handles the results.
      */
     void handleResults(const FIFFLIB::FiffEvokedSet& evokedStimSet,
-                       const QStringList& lResponsibleTriggerTypes);
+                       const QStringList& lResponsibleTriggerTypes,
+                       qint64 iTimeStamp);
 
     QThread             m_workerThread;         /**< The worker thread. */
 
 signals:
     void evokedStim(const FIFFLIB::FiffEvokedSet& evokedStimSet,
-                    const QStringList& lResponsibleTriggerTypes);
-    void operate(const Eigen::MatrixXd& matData);
+                    const QStringList& lResponsibleTriggerTypes,
+                    qint64 iTimeStamp);
+    void operate(const Eigen::MatrixXd& matData,
+                 qint64 iTimeStamp);
     void averageNumberChanged(qint32 numAve);
     void averagePreStimChanged(qint32 samples,
                                qint32 secs);
@@ -40,13 +40,13 @@
 
 #include "rtcov.h"
 
+#include <cmath>
 
 //=============================================================================================================
 // QT INCLUDES
 //=============================================================================================================
 
 #include <QDebug>
-#include <QtConcurrent>
 
 //=============================================================================================================
 // USED NAMESPACES
@@ -61,9 +61,18 @@ using namespace Eigen;
 //=============================================================================================================
 
 RtCov::RtCov(QSharedPointer<FIFFLIB::FiffInfo> pFiffInfo)
-: m_fiffInfo(*pFiffInfo)
-, m_iSamples(0)
+: m_iSamples(0)
+, m_dWeightSum(0.0)
+, m_dWeightSquareSum(0.0)
+, m_dForgettingFactor(1.0)
+, m_fiffInfo(*pFiffInfo)
 {
+    for(int i = 0; i<m_fiffInfo.chs.size(); i++) {
+        if(m_fiffInfo.chs.at(i).kind != FIFFV_MEG_CH &&
+           m_fiffInfo.chs.at(i).kind != FIFFV_EEG_CH) {
+            m_lExclude << m_fiffInfo.chs.at(i).ch_name;
+        }
+    }
 }
 
 //=============================================================================================================
@@ -76,93 +85,112 @@ FiffCov RtCov::estimateCovariance(const Eigen::MatrixXd& matData,
         return FiffCov();
     }
 
-    m_lData.append(matData);
+    accumulate(matData);
     m_iSamples += matData.cols();
 
     if(m_iSamples < iNewMaxSamples) {
         return FiffCov();
     }
 
-    QFuture<RtCovComputeResult> result = QtConcurrent::mappedReduced(m_lData,
-                                                                     compute,
-                                                                     reduce);
+    // Unbiased normalization for weighted samples, this is N-1 if all weights are 1
+    const double dNorm = m_dWeightSum > 0.0 ? m_dWeightSum - m_dWeightSquareSum / m_dWeightSum : 0.0;
 
-    result.waitForFinished();
-
-    RtCovComputeResult finalResult = result.result();
+    if(dNorm <= 0.0) {
+        qWarning() << "[RtCov::estimateCovariance] Number of samples too small. Regularization not possible. Returning empty covariance estimation.";
+        return FiffCov();
+    }
 
     //Final computation
     FiffCov computedCov;
-    computedCov.data = finalResult.matData;
-
-    QStringList exclude;
-    for(int i = 0; i<m_fiffInfo.chs.size(); i++) {
-        if(m_fiffInfo.chs.at(i).kind != FIFFV_MEG_CH &&
-           m_fiffInfo.chs.at(i).kind != FIFFV_EEG_CH) {
-            exclude << m_fiffInfo.chs.at(i).ch_name;
-        }
-    }
-    bool doProj = true;
-
-    if(m_iSamples > 0) {
-        finalResult.mu /= (float)m_iSamples;
-        computedCov.data.array() -= m_iSamples * (finalResult.mu * finalResult.mu.transpose()).array();
-        computedCov.data.array() /= (m_iSamples - 1);
-
-        computedCov.kind = FIFFV_MNE_NOISE_COV;
-        computedCov.diag = false;
-        computedCov.dim = computedCov.data.rows();
+    computedCov.data = m_matSumSquares.selfadjointView<Lower>();
+    computedCov.data.noalias() -= (m_vecSum * m_vecSum.transpose()) / m_dWeightSum;
+    computedCov.data /= dNorm;
 
-        //ToDo do picks
-        computedCov.names = m_fiffInfo.ch_names;
-        computedCov.projs = m_fiffInfo.projs;
-        computedCov.bads = m_fiffInfo.bads;
-        computedCov.nfree = m_iSamples;
+    computedCov.kind = FIFFV_MNE_NOISE_COV;
+    computedCov.diag = false;
+    computedCov.dim = computedCov.data.rows();
 
-        // regularize noise covariance
-        computedCov = computedCov.regularize(m_fiffInfo, 0.05, 0.05, 0.1, doProj, exclude);
+    //ToDo do picks
+    computedCov.names = m_fiffInfo.ch_names;
+    computedCov.projs = m_fiffInfo.projs;
+    computedCov.bads = m_fiffInfo.bads;
+    computedCov.nfree = qRound(m_dWeightSum * m_dWeightSum / m_dWeightSquareSum);
 
-//            qint32 samples = rawSegment.cols();
-//            VectorXf mu = rawSegment.rowwise().sum().array() / (float)samples;
-
-//            MatrixXf noise_covariance = rawSegment * rawSegment.transpose();// noise_covariance == raw_covariance
-//            noise_covariance.array() -= samples * (mu * mu.transpose()).array();
-//            noise_covariance.array() /= (samples - 1);
+    // regularize noise covariance
+    bool doProj = true;
+    computedCov = computedCov.regularize(m_fiffInfo, 0.05, 0.05, 0.1, doProj, m_lExclude);
 
-//            std::cout << "Noise Covariance:\n" << noise_covariance.block(0,0,10,10) << std::endl;
+    // Start a new window, unless older samples are forgotten exponentially anyway
+    if(m_dForgettingFactor >= 1.0) {
+        reset();
+    }
+    m_iSamples = 0;
 
-//            printf("%d raw buffer (%d x %d) generated\r\n", count, tmp.rows(), tmp.cols());
+    return computedCov;
+}
 
-        m_lData.clear();
-        m_iSamples = 0;
+//=============================================================================================================
 
-        return computedCov;
-    } else {
-        qWarning() << "[RtCov::estimateCovariance] Number of samples equals zero. Regularization not possible. Returning empty covariance estimation.";
-        return FiffCov();
+void RtCov::setForgettingFactor(double dForgettingFactor)
+{
+    if(dForgettingFactor <= 0.0 || dForgettingFactor > 1.0) {
+        qWarning() << "[RtCov::setForgettingFactor] Forgetting factor must be in (0,1]. Using 1.";
+        dForgettingFactor = 1.0;
     }
 
+    m_dForgettingFactor = dForgettingFactor;
 }
 
 //=============================================================================================================
 
-RtCovComputeResult RtCov::compute(const MatrixXd &matData)
+void RtCov::reset()
 {
-    RtCovComputeResult result;
-    result.mu = matData.rowwise().sum();
-    result.matData = matData * matData.transpose();
-    return result;
+    m_iSamples = 0;
+    m_dWeightSum = 0.0;
+    m_dWeightSquareSum = 0.0;
+    m_vecSum.resize(0);
+    m_matSumSquares.resize(0,0);
 }
 
 //=============================================================================================================
 
-void RtCov::reduce(RtCovComputeResult& finalResult, const RtCovComputeResult &tempResult)
+void RtCov::accumulate(const MatrixXd &matData)
 {
-    if(finalResult.matData.size() == 0 || finalResult.mu.size() == 0) {
-        finalResult.mu = tempResult.mu;
-        finalResult.matData = tempResult.matData;
-    } else {
-        finalResult.mu += tempResult.mu;
-        finalResult.matData += tempResult.matData;
+    const int iNumChannels = matData.rows();
+    const int iNumSamples = matData.cols();
+
+    if(iNumSamples == 0) {
+        return;
     }
+
+    if(m_vecSum.size() != iNumChannels) {
+        m_dWeightSum = 0.0;
+        m_dWeightSquareSum = 0.0;
+        m_vecSum = VectorXd::Zero(iNumChannels);
+        m_matSumSquares = MatrixXd::Zero(iNumChannels, iNumChannels);
+    }
+
+    if(m_dForgettingFactor >= 1.0) {
+        m_vecSum += matData.rowwise().sum();
+        m_matSumSquares.selfadjointView<Lower>().rankUpdate(matData);
+        m_dWeightSum += iNumSamples;
+        m_dWeightSquareSum += iNumSamples;
+        return;
+    }
+
+    // Sample t of the block gets the weight lambda^(n-1-t), the old estimate decays by lambda^n
+    const double dDecay = std::pow(m_dForgettingFactor, iNumSamples);
+    RowVectorXd vecWeights(iNumSamples);
+    for(int t = 0; t < iNumSamples; ++t) {
+        vecWeights(t) = std::pow(m_dForgettingFactor, iNumSamples - 1 - t);
+    }
+
+    m_vecSum *= dDecay;
+    m_vecSum += matData * vecWeights.transpose();
+
+    m_matSumSquares.triangularView<Lower>() *= dDecay;
+    m_matSumSquares.selfadjointView<Lower>().rankUpdate(matData * vecWeights.cwiseSqrt().asDiagonal());
+
+    m_dWeightSum = m_dWeightSum * dDecay + vecWeights.sum();
+    m_dWeightSquareSum = m_dWeightSquareSum * dDecay * dDecay + vecWeights.squaredNorm();
 }
@@ -50,6 +50,7 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
+#include <QStringList>
 #include <QThread>
 
 //=============================================================================================================
@@ -73,18 +74,13 @@ namespace FIFFLIB {
 namespace RTPROCESSINGLIB
 {
 
-//=============================================================================================================
-// RTPROCESSINGLIB FORWARD DECLARATIONS
-//=============================================================================================================
-
-struct RtCovComputeResult {
-    Eigen::VectorXd mu;
-    Eigen::MatrixXd matData;
-};
-
 //=============================================================================================================
 /**
- * Real-time covariance worker.
+ * Real-time covariance worker. Each incoming data block is folded into a running sum and a running sum of
+ * outer products on arrival, so the memory does not depend on the number of samples. A regularized covariance
+ * is published every time the configured number of samples arrived. Optionally, older samples are down
+ * weighted exponentially, which results in a sliding window estimate. The weighted sum of outer products is
+ * normalized with the unbiased W - sum(w^2)/W, W being the sum of the weights, which is N-1 for equal weights.
  *
  * @brief Real-time covariance worker.
  */
@@ -97,38 +93,53 @@ public:
 
     //=========================================================================================================
     /**
-     * Perform actual covariance estimation.
+     * Folds a data block into the running estimate and returns a new covariance estimation once
+     * iNewMaxSamples samples arrived since the last one.
+     *
+     * @param[in] matData          Data to estimate the covariance from.
+     * @param[in] iNewMaxSamples   The number of samples after which a new covariance is published.
      *
-     * @param[in] inputData  Data to estimate the covariance from.
+     * @return The regularized covariance estimation, or an empty covariance if it is not time to publish yet.
      */
     FIFFLIB::FiffCov estimateCovariance(const Eigen::MatrixXd& matData,
                                         int iNewMaxSamples);
 
-protected:
     //=========================================================================================================
     /**
-     * Computer multiplication with transposed.
+     * Sets the per sample forgetting factor. With a factor of 1 (default) all samples are weighted equally and
+     * the running estimate is cleared after each published covariance. With a factor below 1, the weight of a
+     * sample decays by this factor with each following sample and the running estimate is kept, which results
+     * in a sliding window with an effective length of 1/(1-dForgettingFactor) samples.
      *
-     * @param[in] matData  Data to self multiply with.
-     *
-     * @return   The multiplication result.
+     * @param[in] dForgettingFactor    The forgetting factor in (0,1].
+     */
+    void setForgettingFactor(double dForgettingFactor);
+
+    //=========================================================================================================
+    /**
+     * Clears the running estimate.
      */
-    static RtCovComputeResult compute(const Eigen::MatrixXd &matData);
+    void reset();
 
+protected:
     //=========================================================================================================
     /**
-     * Computer multiplication with transposed.
+     * Folds a data block into the running sum and the running sum of outer products.
      *
-     * @param[out]   finalResult     The final covariance estimation.
-     * @param[in]   tempResult      The intermediate result from the compute function.
+     * @param[in] matData  Data block, channels in rows.
      */
-    static void reduce(RtCovComputeResult& finalResult, const RtCovComputeResult &tempResult);
+    void accumulate(const Eigen::MatrixXd& matData);
 
-    int                     m_iSamples;                 /**< The number of stored samples. */
+    int                     m_iSamples;                 /**< The number of samples since the last published covariance. */
+    double                  m_dWeightSum;               /**< The sum of the sample weights in the running estimate. */
+    double                  m_dWeightSquareSum;         /**< The sum of the squared sample weights in the running estimate. */
+    double                  m_dForgettingFactor;        /**< The per sample forgetting factor. */
 
-    QList<Eigen::MatrixXd>  m_lData;                    /**< The stored data blocks. */
+    Eigen::VectorXd         m_vecSum;                   /**< The weighted running sum of the samples. */
+    Eigen::MatrixXd         m_matSumSquares;            /**< The weighted running sum of the outer products, lower triangle. */
 
     FIFFLIB::FiffInfo       m_fiffInfo;                 /**< Holds the fiff measurement information. */
+    QStringList             m_lExclude;                 /**< The channels which are excluded from the regularization. */
 };
 
 //=============================================================================================================
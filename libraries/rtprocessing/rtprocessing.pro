@@ -87,6 +87,7 @@ SOURCES += \
     rtnoise.cpp \
     rthpis.cpp \
     filter.cpp \
+    filterpartitioned.cpp \
     rtconnectivity.cpp \
     sphara.cpp \
     detecttrigger.cpp \
@@ -94,6 +95,7 @@ SOURCES += \
     helpers/parksmcclellan.cpp \
     helpers/filterkernel.cpp \
     helpers/filterio.cpp \
+    helpers/iirfilter.cpp \
 
 HEADERS +=  \
     icp.h \
@@ -105,6 +107,7 @@ HEADERS +=  \
     rtnoise.h \
     rthpis.h \
     filter.h \
+    filterpartitioned.h \
     detecttrigger.h \
     sphara.h \
     rtconnectivity.h \
@@ -112,6 +115,7 @@ HEADERS +=  \
     helpers/parksmcclellan.h \
     helpers/filterkernel.h \
     helpers/filterio.h \
+    helpers/iirfilter.h \
 
 INCLUDEPATH += $${EIGEN_INCLUDE_DIR}
 INCLUDEPATH += $${MNE_INCLUDE_DIR}
@@ -0,0 +1,214 @@
+//=============================================================================================================
+/**
+ * @file     readaheadbuffer.h
+ * @author   MNE-CPP Authors
+ * @since    0.1.9
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, MNE-CPP Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    ReadAheadBuffer class declaration.
+ *
+ */
+
+#ifndef READAHEADBUFFER_H
+#define READAHEADBUFFER_H
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../utils_global.h"
+
+#include <deque>
+#include <functional>
+#include <thread>
+#include <utility>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSharedPointer>
+#include <QWaitCondition>
+
+//=============================================================================================================
+// DEFINE NAMESPACE UTILSLIB
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+//=============================================================================================================
+/**
+ * TEMPLATE READ AHEAD BUFFER
+ *
+ * Runs a producer function on a background thread and keeps up to a fixed number of its results in a queue, so
+ * that producing the next elements (e.g., reading and decoding the next raw data blocks from disk) overlaps with
+ * the processing of the current one. The producer is called until it returns false.
+ *
+ * @brief The TEMPLATE READ AHEAD BUFFER provides a bounded queue filled by a background producer thread.
+ */
+template<typename _Tp>
+class ReadAheadBuffer
+{
+public:
+    typedef QSharedPointer<ReadAheadBuffer> SPtr;              /**< Shared pointer type for ReadAheadBuffer. */
+    typedef QSharedPointer<const ReadAheadBuffer> ConstSPtr;   /**< Const shared pointer type for ReadAheadBuffer. */
+
+    typedef std::function<bool(_Tp&)> Producer;                /**< Fills the next element, returns false when done. */
+
+    //=========================================================================================================
+    /**
+     * Constructs a ReadAheadBuffer and starts the producer thread.
+     *
+     * @param[in] producer           the function producing the elements.
+     * @param[in] uiMaxNumElements   number of elements which are produced ahead.
+     */
+    explicit ReadAheadBuffer(const Producer& producer,
+                             unsigned int uiMaxNumElements = 4);
+
+    //=========================================================================================================
+    /**
+     * Stops the producer thread and destroys the ReadAheadBuffer. Elements which were not popped are discarded.
+     */
+    ~ReadAheadBuffer();
+
+    //=========================================================================================================
+    /**
+     * Returns the next element (first in first out). Blocks until the producer delivered it.
+     *
+     * @param[out] element   the element.
+     *
+     * @return true if an element was returned, false if the producer is done and all elements were popped.
+     */
+    inline bool pop(_Tp& element);
+
+private:
+    //=========================================================================================================
+    /**
+     * The producer thread loop.
+     */
+    void run();
+
+    Producer        m_producer;             /**< The producer function.*/
+    unsigned int    m_uiMaxNumElements;     /**< Holds the maximal number of queued elements.*/
+    std::deque<_Tp> m_queue;                /**< Holds the produced elements.*/
+    QMutex          m_mutex;                /**< Guards the queue and flags.*/
+    QWaitCondition  m_notEmpty;             /**< Signaled when an element was queued or the producer finished.*/
+    QWaitCondition  m_notFull;              /**< Signaled when an element was popped or the buffer is stopped.*/
+    bool            m_bProducerDone;        /**< Whether the producer returned false.*/
+    bool            m_bStop;                /**< Whether the buffer is being destroyed.*/
+    std::thread     m_thread;               /**< The producer thread.*/
+};
+
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+template<typename _Tp>
+ReadAheadBuffer<_Tp>::ReadAheadBuffer(const Producer& producer,
+                                      unsigned int uiMaxNumElements)
+: m_producer(producer)
+, m_uiMaxNumElements(uiMaxNumElements > 0 ? uiMaxNumElements : 1)
+, m_bProducerDone(false)
+, m_bStop(false)
+{
+    m_thread = std::thread(&ReadAheadBuffer<_Tp>::run, this);
+}
+
+//=============================================================================================================
+
+template<typename _Tp>
+ReadAheadBuffer<_Tp>::~ReadAheadBuffer()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_bStop = true;
+        m_notFull.wakeAll();
+    }
+
+    if(m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+//=============================================================================================================
+
+template<typename _Tp>
+inline bool ReadAheadBuffer<_Tp>::pop(_Tp& element)
+{
+    QMutexLocker locker(&m_mutex);
+
+    while(m_queue.empty() && !m_bProducerDone) {
+        m_notEmpty.wait(&m_mutex);
+    }
+
+    if(m_queue.empty()) {
+        return false;
+    }
+
+    element = std::move(m_queue.front());
+    m_queue.pop_front();
+    m_notFull.wakeAll();
+
+    return true;
+}
+
+//=============================================================================================================
+
+template<typename _Tp>
+void ReadAheadBuffer<_Tp>::run()
+{
+    while(true) {
+        _Tp element;
+        const bool bProduced = m_producer(element);
+
+        QMutexLocker locker(&m_mutex);
+
+        if(!bProduced || m_bStop) {
+            m_bProducerDone = true;
+            m_notEmpty.wakeAll();
+            return;
+        }
+
+        while(m_queue.size() >= m_uiMaxNumElements && !m_bStop) {
+            m_notFull.wait(&m_mutex);
+        }
+
+        if(m_bStop) {
+            m_bProducerDone = true;
+            m_notEmpty.wakeAll();
+            return;
+        }
+
+        m_queue.push_back(std::move(element));
+        m_notEmpty.wakeAll();
+    }
+}
+} // NAMESPACE
+
+#endif // READAHEADBUFFER_H
@@ -0,0 +1,349 @@
+//=============================================================================================================
+/**
+ * @file     ringbuffer.h
+ * @author   MNE-CPP Authors
+ * @since    0.1.9
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, MNE-CPP Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    RingBuffer class declaration.
+ *
+ */
+
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../utils_global.h"
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSharedPointer>
+#include <QWaitCondition>
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+//=============================================================================================================
+// DEFINE NAMESPACE UTILSLIB
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+//=============================================================================================================
+/**
+ * TEMPLATE RING BUFFER
+ *
+ * Lock-free single-producer/single-consumer ring buffer. Exactly one thread may push and exactly one (other)
+ * thread may pop. The slots are allocated once and reused: push assigns into a slot (which does not reallocate
+ * for Eigen matrices of unchanged size) or lets the caller fill the slot in place, and pop swaps the slot with the
+ * given element, so no element is deep-copied on the way out. Handing over an element costs two atomic index
+ * updates. Only when the buffer is full (push) or empty (pop) the calling thread sleeps on a wait condition,
+ * for at most the timeout given at construction.
+ *
+ * Offers the push/pop/getFreeElements interface of CircularBuffer, so it can replace a CircularBuffer which is
+ * used by a single producer and a single consumer.
+ *
+ * @brief The TEMPLATE RING BUFFER provides a lock-free single-producer/single-consumer ring buffer.
+ */
+template<typename _Tp>
+class RingBuffer
+{
+public:
+    typedef QSharedPointer<RingBuffer> SPtr;              /**< Shared pointer type for RingBuffer. */
+    typedef QSharedPointer<const RingBuffer> ConstSPtr;   /**< Const shared pointer type for RingBuffer. */
+
+    //=========================================================================================================
+    /**
+     * Constructs a RingBuffer.
+     *
+     * @param[in] uiMaxNumElements   length of buffer.
+     * @param[in] iTimeout           maximal time in ms push and pop wait for a free or used slot. 0 never waits.
+     */
+    explicit RingBuffer(unsigned int uiMaxNumElements,
+                        int iTimeout = 1000);
+
+    //=========================================================================================================
+    /**
+     * Adds an element at the end of the buffer by assigning it to the next free slot. Producer thread only.
+     *
+     * @param[in] element    the element to add.
+     *
+     * @return false if no slot became free within the timeout, true otherwise.
+     */
+    inline bool push(const _Tp& element);
+
+    //=========================================================================================================
+    /**
+     * Adds an element at the end of the buffer by moving it into the next free slot. Producer thread only.
+     *
+     * @param[in] element    the element to add. It is left in a valid but unspecified state.
+     *
+     * @return false if no slot became free within the timeout, true otherwise.
+     */
+    inline bool push(_Tp&& element);
+
+    //=========================================================================================================
+    /**
+     * Adds an element at the end of the buffer by letting fill write it directly into the next free slot.
+     * The slot holds an element previously handed out by pop, i.e. a matrix of the last block size, so filling it
+     * does not allocate. Producer thread only.
+     *
+     * @param[in] fill   callable with signature void(_Tp&) which writes the new element into the given slot.
+     *
+     * @return false if no slot became free within the timeout, true otherwise.
+     */
+    template<typename Filler>
+    inline bool pushInPlace(const Filler& fill);
+
+    //=========================================================================================================
+    /**
+     * Returns the first element (first in first out) by swapping it with element. The previous content of element
+     * stays in the buffer as storage for a later push. Consumer thread only.
+     *
+     * @param[out] element   the first element.
+     *
+     * @return false if no element became available within the timeout, true otherwise.
+     */
+    inline bool pop(_Tp& element);
+
+    //=========================================================================================================
+    /**
+     * Drops all elements. Must not be called while push or pop are running.
+     */
+    void clear();
+
+    //=========================================================================================================
+    /**
+     * Returns the number of elements available for reading.
+     */
+    inline int getFreeElementsRead() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the number of free slots available for writing.
+     */
+    inline int getFreeElementsWrite() const;
+
+private:
+    //=========================================================================================================
+    /**
+     * Returns immediately if ready returns true, otherwise sleeps until it does or the timeout expired.
+     *
+     * @param[in] ready  callable returning whether the calling side can proceed.
+     *
+     * @return the final result of ready.
+     */
+    template<typename Predicate>
+    inline bool waitFor(const Predicate& ready);
+
+    //=========================================================================================================
+    /**
+     * Wakes the other side if it is sleeping in waitFor.
+     */
+    inline void wakeWaiting();
+
+    std::vector<_Tp>        m_vecSlots;             /**< Holds the preallocated slots.*/
+    unsigned int            m_uiMaxNumElements;     /**< Holds the maximal number of buffer elements.*/
+    int                     m_iTimeout;             /**< Holds the timeout value after which push and pop return false.*/
+
+    std::atomic<quint64>    m_iNumPushed;           /**< Number of elements pushed so far, written by the producer only.*/
+    char                    m_cPadding[64];         /**< Keeps producer and consumer counters on different cache lines.*/
+    std::atomic<quint64>    m_iNumPopped;           /**< Number of elements popped so far, written by the consumer only.*/
+
+    std::atomic<int>        m_iNumWaiting;          /**< Number of threads sleeping in waitFor.*/
+    QMutex                  m_mutex;                /**< Guards the wait condition.*/
+    QWaitCondition          m_waitCondition;        /**< Signaled whenever an element was pushed or popped while a thread sleeps.*/
+};
+
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+template<typename _Tp>
+RingBuffer<_Tp>::RingBuffer(unsigned int uiMaxNumElements,
+                            int iTimeout)
+: m_vecSlots(uiMaxNumElements > 0 ? uiMaxNumElements : 1)
+, m_uiMaxNumElements(uiMaxNumElements > 0 ? uiMaxNumElements : 1)
+, m_iTimeout(iTimeout)
+, m_iNumPushed(0)
+, m_iNumPopped(0)
+, m_iNumWaiting(0)
+{
+}
+
+//=============================================================================================================
+
+template<typename _Tp>
+inline bool RingBuffer<_Tp>::push(const _Tp& element)
+{
+    return pushInPlace([&element](_Tp& slot) { slot = element; });
+}
+
+//=============================================================================================================
+
+template<typename _Tp>
+inline bool RingBuffer<_Tp>::push(_Tp&& element)
+{
+    return pushInPlace([&element](_Tp& slot) { slot = std::move(element); });
+}
+
+//=============================================================================================================
+
+template<typename _Tp>
+template<typename Filler>
+inline bool RingBuffer<_Tp>::pushInPlace(const Filler& fill)
+{
+    if(!waitFor([this]() { return getFreeElementsWrite() > 0; })) {
+        return false;
+    }
+
+    quint64 iNumPushed = m_iNumPushed.load(std::memory_order_relaxed);
+    fill(m_vecSlots[iNumPushed % m_uiMaxNumElements]);
+    m_iNumPushed.store(iNumPushed + 1);
+
+    wakeWaiting();
+
+    return true;
+}
+
+//=============================================================================================================
+
+template<typename _Tp>
+inline bool RingBuffer<_Tp>::pop(_Tp& element)
+{
+    if(!waitFor([this]() { return getFreeElementsRead() > 0; })) {
+        return false;
+    }
+
+    quint64 iNumPopped = m_iNumPopped.load(std::memory_order_relaxed);
+    using std::swap;
+    swap(element, m_vecSlots[iNumPopped % m_uiMaxNumElements]);
+    m_iNumPopped.store(iNumPopped + 1);
+
+    wakeWaiting();
+
+    return true;
+}
+
+//=============================================================================================================
+
+template<typename _Tp>
+void RingBuffer<_Tp>::clear()
+{
+    m_iNumPopped.store(m_iNumPushed.load());
+}
+
+//=============================================================================================================
+
+template<typename _Tp>
+inline int RingBuffer<_Tp>::getFreeElementsRead() const
+{
+    return static_cast<int>(m_iNumPushed.load() - m_iNumPopped.load());
+}
+
+//=============================================================================================================
+
+template<typename _Tp>
+inline int RingBuffer<_Tp>::getFreeElementsWrite() const
+{
+    return static_cast<int>(m_uiMaxNumElements) - getFreeElementsRead();
+}
+
+//=============================================================================================================
+
+template<typename _Tp>
+template<typename Predicate>
+inline bool RingBuffer<_Tp>::waitFor(const Predicate& ready)
+{
+    if(ready()) {
+        return true;
+    }
+
+    if(m_iTimeout <= 0) {
+        return false;
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    // Announce the sleeper before checking again. Together with the sequentially consistent counter updates this
+    // guarantees that either the check sees the other side's update or the other side sees the sleeper and wakes it.
+    m_iNumWaiting.fetch_add(1);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    bool bReady = ready();
+    while(!bReady) {
+        qint64 iRemaining = m_iTimeout - timer.elapsed();
+        if(iRemaining <= 0) {
+            break;
+        }
+
+        m_waitCondition.wait(&m_mutex, static_cast<unsigned long>(iRemaining));
+        bReady = ready();
+    }
+
+    m_iNumWaiting.fetch_sub(1);
+
+    return bReady;
+}
+
+//=============================================================================================================
+
+template<typename _Tp>
+inline void RingBuffer<_Tp>::wakeWaiting()
+{
+    if(m_iNumWaiting.load() > 0) {
+        QMutexLocker locker(&m_mutex);
+        m_waitCondition.wakeAll();
+    }
+}
+
+//=============================================================================================================
+// TYPEDEF
+//=============================================================================================================
+
+typedef RingBuffer< Eigen::MatrixXd >        RingBuffer_Matrix_double;       /**< Defines RingBuffer of Eigen::MatrixXd type.*/
+typedef RingBuffer< Eigen::MatrixXf >        RingBuffer_Matrix_float;        /**< Defines RingBuffer of Eigen::MatrixXf type.*/
+} // NAMESPACE
+
+#endif // RINGBUFFER_H
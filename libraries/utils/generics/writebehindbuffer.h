@@ -0,0 +1,233 @@
+//=============================================================================================================
+/**
+ * @file     writebehindbuffer.h
+ * @author   MNE-CPP Authors
+ * @since    0.1.9
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, MNE-CPP Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    WriteBehindBuffer class declaration.
+ *
+ */
+
+#ifndef WRITEBEHINDBUFFER_H
+#define WRITEBEHINDBUFFER_H
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../utils_global.h"
+
+#include <deque>
+#include <functional>
+#include <thread>
+#include <utility>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSharedPointer>
+#include <QWaitCondition>
+
+//=============================================================================================================
+// DEFINE NAMESPACE UTILSLIB
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+//=============================================================================================================
+/**
+ * TEMPLATE WRITE BEHIND BUFFER
+ *
+ * Hands pushed elements to a consumer function running on a background thread (e.g., writing raw data blocks to
+ * disk), so the pushing thread can continue with the next element. Up to a fixed number of elements are queued,
+ * push blocks while the queue is full. Elements are consumed in the order they were pushed.
+ *
+ * @brief The TEMPLATE WRITE BEHIND BUFFER provides a bounded queue drained by a background consumer thread.
+ */
+template<typename _Tp>
+class WriteBehindBuffer
+{
+public:
+    typedef QSharedPointer<WriteBehindBuffer> SPtr;              /**< Shared pointer type for WriteBehindBuffer. */
+    typedef QSharedPointer<const WriteBehindBuffer> ConstSPtr;   /**< Const shared pointer type for WriteBehindBuffer. */
+
+    typedef std::function<bool(_Tp&)> Consumer;                  /**< Consumes one element, returns false on error. */
+
+    //=========================================================================================================
+    /**
+     * Constructs a WriteBehindBuffer and starts the consumer thread.
+     *
+     * @param[in] consumer           the function consuming the elements.
+     * @param[in] uiMaxNumElements   number of elements which can be queued.
+     */
+    explicit WriteBehindBuffer(const Consumer& consumer,
+                               unsigned int uiMaxNumElements = 4);
+
+    //=========================================================================================================
+    /**
+     * Consumes all queued elements, stops the consumer thread and destroys the WriteBehindBuffer.
+     */
+    ~WriteBehindBuffer();
+
+    //=========================================================================================================
+    /**
+     * Queues an element for the consumer. Blocks while the queue is full.
+     *
+     * @param[in] element    the element. It is moved into the queue.
+     *
+     * @return false if finish was already called, true otherwise.
+     */
+    inline bool push(_Tp element);
+
+    //=========================================================================================================
+    /**
+     * Waits until all queued elements were consumed and stops the consumer thread. Call this before using the
+     * resources of the consumer (e.g., the output stream) from another thread again.
+     *
+     * @return true if the consumer succeeded for all elements, false otherwise.
+     */
+    bool finish();
+
+private:
+    //=========================================================================================================
+    /**
+     * The consumer thread loop.
+     */
+    void run();
+
+    Consumer        m_consumer;             /**< The consumer function.*/
+    unsigned int    m_uiMaxNumElements;     /**< Holds the maximal number of queued elements.*/
+    std::deque<_Tp> m_queue;                /**< Holds the pushed elements.*/
+    QMutex          m_mutex;                /**< Guards the queue and flags.*/
+    QWaitCondition  m_notEmpty;             /**< Signaled when an element was queued or the buffer finishes.*/
+    QWaitCondition  m_notFull;              /**< Signaled when an element was taken by the consumer.*/
+    bool            m_bFinish;              /**< Whether no more elements will be pushed.*/
+    bool            m_bError;               /**< Whether the consumer failed for any element.*/
+    std::thread     m_thread;               /**< The consumer thread.*/
+};
+
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+template<typename _Tp>
+WriteBehindBuffer<_Tp>::WriteBehindBuffer(const Consumer& consumer,
+                                          unsigned int uiMaxNumElements)
+: m_consumer(consumer)
+, m_uiMaxNumElements(uiMaxNumElements > 0 ? uiMaxNumElements : 1)
+, m_bFinish(false)
+, m_bError(false)
+{
+    m_thread = std::thread(&WriteBehindBuffer<_Tp>::run, this);
+}
+
+//=============================================================================================================
+
+template<typename _Tp>
+WriteBehindBuffer<_Tp>::~WriteBehindBuffer()
+{
+    finish();
+}
+
+//=============================================================================================================
+
+template<typename _Tp>
+inline bool WriteBehindBuffer<_Tp>::push(_Tp element)
+{
+    QMutexLocker locker(&m_mutex);
+
+    while(m_queue.size() >= m_uiMaxNumElements && !m_bFinish) {
+        m_notFull.wait(&m_mutex);
+    }
+
+    if(m_bFinish) {
+        return false;
+    }
+
+    m_queue.push_back(std::move(element));
+    m_notEmpty.wakeAll();
+
+    return true;
+}
+
+//=============================================================================================================
+
+template<typename _Tp>
+bool WriteBehindBuffer<_Tp>::finish()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_bFinish = true;
+        m_notEmpty.wakeAll();
+        m_notFull.wakeAll();
+    }
+
+    if(m_thread.joinable()) {
+        m_thread.join();
+    }
+
+    QMutexLocker locker(&m_mutex);
+    return !m_bError;
+}
+
+//=============================================================================================================
+
+template<typename _Tp>
+void WriteBehindBuffer<_Tp>::run()
+{
+    while(true) {
+        _Tp element;
+
+        {
+            QMutexLocker locker(&m_mutex);
+
+            while(m_queue.empty() && !m_bFinish) {
+                m_notEmpty.wait(&m_mutex);
+            }
+
+            if(m_queue.empty()) {
+                return;
+            }
+
+            element = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_notFull.wakeAll();
+        }
+
+        if(!m_consumer(element)) {
+            QMutexLocker locker(&m_mutex);
+            m_bError = true;
+        }
+    }
+}
+} // NAMESPACE
+
+#endif // WRITEBEHINDBUFFER_H
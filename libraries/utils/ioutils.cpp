@@ -39,6 +39,15 @@
 
 #include "ioutils.h"
 
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 //=============================================================================================================
 // QT INCLUDES
 //=============================================================================================================
@@ -237,6 +246,69 @@ void IOUtils::swap_doublep(double *source)
 
 //=============================================================================================================
 
+void IOUtils::swap_array(const void *source, void *dest, qint64 count, int elementSize)
+{
+    const unsigned char *csource = static_cast<const unsigned char *>(source);
+    unsigned char *cdest = static_cast<unsigned char *>(dest);
+    const qint64 nbytes = count * elementSize;
+    qint64 i = 0;
+
+    if(elementSize != 2 && elementSize != 4 && elementSize != 8) {
+        if(source != dest)
+            std::memmove(cdest, csource, nbytes);
+        for(qint64 k = 0; k < count; ++k)
+            std::reverse(cdest + k * elementSize, cdest + (k + 1) * elementSize);
+        return;
+    }
+
+#if defined(__SSSE3__)
+    const __m128i mask = elementSize == 2 ? _mm_setr_epi8(1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14)
+                       : elementSize == 4 ? _mm_setr_epi8(3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12)
+                                          : _mm_setr_epi8(7,6,5,4,3,2,1,0,15,14,13,12,11,10,9,8);
+    for(; i + 16 <= nbytes; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(csource + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(cdest + i), _mm_shuffle_epi8(v, mask));
+    }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    for(; i + 16 <= nbytes; i += 16) {
+        uint8x16_t v = vld1q_u8(csource + i);
+        v = elementSize == 2 ? vrev16q_u8(v) : elementSize == 4 ? vrev32q_u8(v) : vrev64q_u8(v);
+        vst1q_u8(cdest + i, v);
+    }
+#endif
+
+    //
+    // Remaining elements, written such that compilers without the above instruction sets can still vectorize it
+    //
+    if(elementSize == 2) {
+        for(; i < nbytes; i += 2) {
+            quint16 v;
+            std::memcpy(&v, csource + i, 2);
+            v = static_cast<quint16>((v >> 8) | (v << 8));
+            std::memcpy(cdest + i, &v, 2);
+        }
+    } else if(elementSize == 4) {
+        for(; i < nbytes; i += 4) {
+            quint32 v;
+            std::memcpy(&v, csource + i, 4);
+            v = (v >> 24) | ((v >> 8) & 0x0000FF00u) | ((v << 8) & 0x00FF0000u) | (v << 24);
+            std::memcpy(cdest + i, &v, 4);
+        }
+    } else {
+        for(; i < nbytes; i += 8) {
+            quint64 v;
+            std::memcpy(&v, csource + i, 8);
+            v = ((v >> 56) & 0x00000000000000FFull) | ((v >> 40) & 0x000000000000FF00ull)
+              | ((v >> 24) & 0x0000000000FF0000ull) | ((v >>  8) & 0x00000000FF000000ull)
+              | ((v <<  8) & 0x000000FF00000000ull) | ((v << 24) & 0x0000FF0000000000ull)
+              | ((v << 40) & 0x00FF000000000000ull) | ((v << 56) & 0xFF00000000000000ull);
+            std::memcpy(cdest + i, &v, 8);
+        }
+    }
+}
+
+//=============================================================================================================
+
 QStringList IOUtils::get_new_chnames_conventions(const QStringList& chNames)
 {
     QStringList result;
@@ -184,6 +184,19 @@ public:
      */
     static void swap_doublep(double *source);
 
+    //=========================================================================================================
+    /**
+     * Reverses the byte order of each element of an array. The conversion runs 16 bytes at a time with SSSE3 or
+     * NEON shuffles when the compiler targets them and falls back to a scalar loop otherwise. Source and
+     * destination may be the same array for an in-place swap, but must not overlap otherwise.
+     *
+     * @param[in] source         the elements to swap.
+     * @param[out] dest          the swapped elements.
+     * @param[in] count          number of elements.
+     * @param[in] elementSize    size of one element in bytes: 2, 4 or 8.
+     */
+    static void swap_array(const void *source, void *dest, qint64 count, int elementSize);
+
     //=========================================================================================================
     /**
      * Write Eigen Matrix to file
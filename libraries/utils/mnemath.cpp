@@ -54,6 +54,8 @@
 //=============================================================================================================
 
 #include <QDebug>
+#include <QThread>
+#include <QtConcurrent>
 
 //=============================================================================================================
 // USED NAMESPACES
@@ -126,6 +128,79 @@ double MNEMath::getConditionSlope(const MatrixXd& A,
 
 //=============================================================================================================
 
+void MNEMath::thinSvdFromGram(const MatrixXd& A,
+                              VectorXd& s,
+                              MatrixXd& U,
+                              MatrixXd& V)
+{
+    if(A.rows() > A.cols()) {
+        MatrixXd At = A.transpose();
+        thinSvdFromGram(At, s, V, U);
+        return;
+    }
+
+    int iRows = A.rows();
+    int iCols = A.cols();
+
+    // Split the columns into one block per thread
+    int iNumberBlocks = qMax(1, qMin(QThread::idealThreadCount(), iCols));
+    int iBlockSize = (iCols + iNumberBlocks - 1) / iNumberBlocks;
+    iNumberBlocks = (iCols + iBlockSize - 1) / iBlockSize;
+
+    QList<int> lBlocks;
+
+    for(int i = 0; i < iNumberBlocks; ++i) {
+        lBlocks.append(i);
+    }
+
+    // Gram matrix, each block adds its columns to its own lower triangle
+    QVector<MatrixXd> vecGram(iNumberBlocks, MatrixXd::Zero(iRows, iRows));
+    MatrixXd* pGram = vecGram.data();
+
+    std::function<void(int&)> gramLambda = [&](int& iBlock) {
+        int iStart = iBlock * iBlockSize;
+        pGram[iBlock].selfadjointView<Lower>().rankUpdate(A.middleCols(iStart, qMin(iBlockSize, iCols - iStart)));
+    };
+
+    QtConcurrent::map(lBlocks, gramLambda).waitForFinished();
+
+    MatrixXd matGram = vecGram.at(0);
+
+    for(int i = 1; i < vecGram.size(); ++i) {
+        matGram += vecGram.at(i);
+    }
+
+    // Eigenvalues are returned in ascending order
+    SelfAdjointEigenSolver<MatrixXd> eigenSolver(matGram);
+
+    VectorXd vecEig = eigenSolver.eigenvalues().reverse();
+    U = eigenSolver.eigenvectors().rowwise().reverse();
+
+    double dTol = vecEig(0) * iRows * std::numeric_limits<double>::epsilon();
+    s = VectorXd::Zero(iRows);
+    MatrixXd matUScaled = MatrixXd::Zero(iRows, iRows);
+
+    for(int i = 0; i < iRows; ++i) {
+        if(vecEig(i) > dTol) {
+            s(i) = sqrt(vecEig(i));
+            matUScaled.col(i) = U.col(i) / s(i);
+        }
+    }
+
+    // Right singular vectors, each block computes its rows of V
+    V.resize(iCols, iRows);
+
+    std::function<void(int&)> rightLambda = [&](int& iBlock) {
+        int iStart = iBlock * iBlockSize;
+        int iNumber = qMin(iBlockSize, iCols - iStart);
+        V.middleRows(iStart, iNumber).noalias() = A.middleCols(iStart, iNumber).transpose() * matUScaled;
+    };
+
+    QtConcurrent::map(lBlocks, rightLambda).waitForFinished();
+}
+
+//=============================================================================================================
+
 void MNEMath::get_whitener(MatrixXd &A,
                            bool pca,
                            QString ch_type,
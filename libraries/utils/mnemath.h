@@ -147,6 +147,24 @@ public:
     static double getConditionSlope(const Eigen::MatrixXd& A,
                                     Eigen::VectorXd &s);
 
+    //=========================================================================================================
+    /**
+     * Computes the thin singular value decomposition A = U * diag(s) * V^T of a wide matrix (rows << cols) via the
+     * eigendecomposition of its Gram matrix A * A^T. The Gram matrix and the right singular vectors V = A^T * U / s
+     * are computed blockwise in parallel. This is considerably faster than a JacobiSVD for matrices like whitened
+     * lead fields. Singular values, which can not be resolved by the Gram matrix (s^2 <= s_max^2 * rows * eps), are
+     * set to zero together with their right singular vector. Tall matrices are decomposed via their transpose.
+     *
+     * @param[in] A          Matrix to decompose.
+     * @param[out] s         The singular values in descending order.
+     * @param[out] U         The left singular vectors.
+     * @param[out] V         The right singular vectors.
+     */
+    static void thinSvdFromGram(const Eigen::MatrixXd& A,
+                                Eigen::VectorXd& s,
+                                Eigen::MatrixXd& U,
+                                Eigen::MatrixXd& V);
+
     //=========================================================================================================
     /**
      * Returns the whitener of a given matrix.
@@ -91,6 +91,7 @@ MNETracer::~MNETracer()
 void MNETracer::enable(const std::string &jsonFileName)
 {
     ms_OutputFileStream.open(jsonFileName);
+    ms_bIsFirstEvent = true;
     writeHeader();
     setZeroTime();
     if (ms_OutputFileStream.is_open())
@@ -144,12 +145,37 @@ void MNETracer::stop()
 
 void MNETracer::traceQuantity(const std::string &name, long val)
 {
+    if (!ms_bIsEnabled)
+        return;
+
     long long timeNow = getTimeNow() - ms_iZeroTime;
     std::string s;
     s.append("{\"name\":\"").append(name).append("\",\"ph\":\"C\",\"ts\":");
     s.append(std::to_string(timeNow)).append(",\"pid\":1,\"tid\":1");
     s.append(",\"args\":{\"").append(name).append("\":").append(std::to_string(val)).append("}}\n");
-    writeToFile(s);
+    writeEvent(s);
+}
+
+//=============================================================================================================
+
+void MNETracer::traceCompleteEvent(const std::string &name, const std::string &category, long long beginTime, long long duration)
+{
+    if (!ms_bIsEnabled)
+        return;
+
+    std::string s;
+    s.append("{\"name\":\"").append(name).append("\",\"cat\":\"").append(category).append("\",");
+    s.append("\"ph\":\"X\",\"ts\":").append(std::to_string(beginTime - ms_iZeroTime));
+    s.append(",\"dur\":").append(std::to_string(duration)).append(",\"pid\":1,\"tid\":");
+    s.append(getThreadId()).append("}\n");
+    writeEvent(s);
+}
+
+//=============================================================================================================
+
+bool MNETracer::isEnabled()
+{
+    return ms_bIsEnabled;
 }
 
 //=============================================================================================================
@@ -194,9 +220,16 @@ long long MNETracer::getTimeNow()
 //=============================================================================================================
 
 void MNETracer::registerThreadId()
+{
+    m_iThreadId = getThreadId();
+}
+
+//=============================================================================================================
+
+std::string MNETracer::getThreadId()
 {
     auto longId = std::hash<std::thread::id>{}(std::this_thread::get_id());
-    m_iThreadId = std::to_string(longId).substr(0, 5);
+    return std::to_string(longId).substr(0, 5);
 }
 
 //=============================================================================================================
@@ -267,18 +300,29 @@ void MNETracer::writeToFile(const std::string& str)
 
 //=============================================================================================================
 
+void MNETracer::writeEvent(const std::string& event)
+{
+    ms_outFileMutex.lock();
+    if(ms_OutputFileStream.is_open()) {
+        if(!ms_bIsFirstEvent) {
+            ms_OutputFileStream << ",";
+        }
+        ms_OutputFileStream << event;
+        ms_bIsFirstEvent = false;
+    }
+    ms_outFileMutex.unlock();
+}
+
+//=============================================================================================================
+
 void MNETracer::writeBeginEvent()
 {
     std::string s;
-    if (!ms_bIsFirstEvent)
-        s.append(",");
-
     s.append("{\"name\":\"").append(m_sFunctionName).append("\",\"cat\":\"bst\",");
     s.append("\"ph\":\"B\",\"ts\":").append(std::to_string(m_iBeginTime)).append(",\"pid\":1,\"tid\":");
     s.append(m_iThreadId).append(",\"args\":{\"file path\":\"").append(m_sFileName).append("\",\"line number\":");
     s.append(std::to_string(m_iLineNumber)).append("}}\n");
-    writeToFile(s);
-    ms_bIsFirstEvent = false;
+    writeEvent(s);
 }
 
 //=============================================================================================================
@@ -286,11 +330,11 @@ void MNETracer::writeBeginEvent()
 void MNETracer::writeEndEvent()
 {
     std::string s;
-    s.append(",{\"name\":\"").append(m_sFunctionName).append("\",\"cat\":\"bst\",");
+    s.append("{\"name\":\"").append(m_sFunctionName).append("\",\"cat\":\"bst\",");
     s.append("\"ph\":\"E\",\"ts\":").append(std::to_string(m_iEndTime)).append(",\"pid\":1,\"tid\":");
     s.append(m_iThreadId).append(",\"args\":{\"file path\":\"").append(m_sFileName).append("\",\"line number\":");
     s.append(std::to_string(m_iLineNumber)).append("}}\n");
-    writeToFile(s);
+    writeEvent(s);
 }
 
 //=============================================================================================================
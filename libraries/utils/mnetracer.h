@@ -48,7 +48,7 @@
 #define MNE_TRACE()
 #define MNE_TRACER_ENABLE(FILENAME)
 #define MNE_TRACER_DISABLE
-#define MNE_TRACE_VALUE()
+#define MNE_TRACE_VALUE(NAME, VALUE)
 #endif
 
 #ifdef MNE_TRACE_MEMORY
@@ -177,6 +177,28 @@ public:
      */
     static void traceQuantity(const std::string& name, long val);
 
+    /**
+     * @brief traceCompleteEvent Writes an event of type X (complete) to the output file. Unlike MNE_TRACE() scopes, the begin and
+     * duration are supplied by the caller, which allows to trace work that is timed elsewhere (i.e. per-block processing in a pipeline).
+     * @param name Name of the event.
+     * @param category Category of the event, used by the Chrome Tracer app to filter events.
+     * @param beginTime Begin of the event as returned by getTimeNow (in microseconds).
+     * @param duration Duration of the event in microseconds.
+     */
+    static void traceCompleteEvent(const std::string& name, const std::string& category, long long beginTime, long long duration);
+
+    /**
+     * @brief isEnabled Returns whether the tracer is currently writing events to an output file.
+     * @return true if enabled.
+     */
+    static bool isEnabled();
+
+    /**
+     * @brief getTimeNow Wrapper function over chronos std library functionality to get the tick of this instant (in microseconds).
+     * @return The actual time now in microseconds.
+     */
+    static long long getTimeNow();
+
     /**
      * Getter function for the member variable that defines whether the output should be printed to terminal, or only to a file.
      * @return bool value.
@@ -209,16 +231,23 @@ private:
     static void writeToFile(const std::string& str);
 
     /**
-     * @brief setZeroTime Sets the zero time, which is the time that will be considered zero in the tracer result. Typically, this is called
-     * by the enable function.
+     * @brief writeEvent Writes a single json event to the output file, prepending the separating comma if other events have been
+     * written before.
+     * @param event The json event to write.
      */
-    static void setZeroTime();
+    static void writeEvent(const std::string& event);
 
     /**
-     * @brief getTimeNow Wrapper function over chronos std library functionality to get the tick of this instant (in microseconds).
-     * @return The actual time now in microseconds.
+     * @brief getThreadId Returns a string identifying the calling thread. The same thread will always have the same stringId.
+     * @return The thread identifier.
      */
-    static long long getTimeNow();
+    static std::string getThreadId();
+
+    /**
+     * @brief setZeroTime Sets the zero time, which is the time that will be considered zero in the tracer result. Typically, this is called
+     * by the enable function.
+     */
+    static void setZeroTime();
 
     /**
      * @brief initialize Formats the fileName, FunctionName and line of code text shown in each event saved to the output file.
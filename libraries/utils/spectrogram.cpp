@@ -41,7 +41,6 @@
 // EIGEN INCLUDES
 //=============================================================================================================
 
-#include <Eigen/SparseCore>
 #include <unsupported/Eigen/FFT>
 
 //=============================================================================================================
@@ -49,7 +48,6 @@
 //=============================================================================================================
 
 #include <QDebug>
-#include <QElapsedTimer>
 #include <QThread>
 #include <QtConcurrent>
 
@@ -60,102 +58,185 @@
 using namespace UTILSLIB;
 using namespace Eigen;
 
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+struct SpectrogramFrameRange {
+    int iChannel;
+    int iFrameStart;
+    int iFrameEnd;
+};
+
 //=============================================================================================================
 // DEFINE MEMBER METHODS
 //=============================================================================================================
 
-MatrixXd Spectrogram::makeSpectrogram(VectorXd signal, qint32 windowSize = 0)
+MatrixXd Spectrogram::makeSpectrogram(VectorXd signal, qint32 windowSize)
 {
-    //QElapsedTimer timer;
-    //timer.start();
-
     signal.array() -= signal.mean();
-    QList<SpectogramInputData> lData;
-    int iThreadSize = QThread::idealThreadCount()*2;
-    int iStepsSize = signal.rows()/iThreadSize;
-    int iResidual = signal.rows()%iThreadSize;
-
-    SpectogramInputData dataTemp;
-    dataTemp.vecInputData = signal;
-    dataTemp.window_size = windowSize;
-    if(dataTemp.window_size == 0) {
-        dataTemp.window_size = signal.rows()/15;
-    }
 
-    for (int i = 0; i < iThreadSize; ++i) {
-        dataTemp.iRangeLow = i*iStepsSize;
-        dataTemp.iRangeHigh = i*iStepsSize+iStepsSize;
-        lData.append(dataTemp);
+    if(windowSize <= 0) {
+        windowSize = signal.rows()/15;
     }
 
-    dataTemp.iRangeLow = iThreadSize*iStepsSize;
-    dataTemp.iRangeHigh = iThreadSize*iStepsSize+iResidual;
-    lData.append(dataTemp);
+    VectorXd vecWindow = gaussWindow(qMax(windowSize, 1));
+    int iNfft = 2;
 
-    QFuture<MatrixXd> resultMat = QtConcurrent::mappedReduced(lData,
-                                                              compute,
-                                                              reduce);
-    resultMat.waitForFinished();
+    while(iNfft < vecWindow.rows()) {
+        iNfft *= 2;
+    }
 
-    //qDebug() << "Spectrogram::make_spectrogram - timer.elapsed()" << timer.elapsed();
-    return resultMat.result();
+    // One frame per sample. Drop the nyquist bin, so that the rows span [0, sfreq/2) as before.
+    return makeStft(signal, vecWindow, 1, iNfft).topRows(iNfft/2);
 }
 
 //=============================================================================================================
 
-VectorXd Spectrogram::gaussWindow(qint32 sample_count, qreal scale, quint32 translation)
+MatrixXd Spectrogram::makeStft(const VectorXd& vecSignal,
+                               const VectorXd& vecWindow,
+                               qint32 iHopSize,
+                               qint32 iNfft)
 {
-    VectorXd gauss = VectorXd::Zero(sample_count);
+    QList<MatrixXd> lResult = makeStft(MatrixXd(vecSignal.transpose()), vecWindow, iHopSize, iNfft);
 
-    for(qint32 n = 0; n < sample_count; n++)
-    {
-        qreal t = (qreal(n) - translation) / scale;
-        gauss[n] = exp(-3.14 * pow(t, 2))*pow(sqrt(scale),(-1))*pow(qreal(2),(0.25));
+    if(lResult.isEmpty()) {
+        return MatrixXd();
     }
 
-    return gauss;
+    return lResult.first();
 }
 
 //=============================================================================================================
 
-MatrixXd Spectrogram::compute(const SpectogramInputData& inputData)
+QList<MatrixXd> Spectrogram::makeStft(const MatrixXd& matSignals,
+                                      const VectorXd& vecWindow,
+                                      qint32 iHopSize,
+                                      qint32 iNfft)
 {
+    QList<MatrixXd> lResult;
+
+    if(matSignals.size() == 0 || vecWindow.rows() == 0 || iHopSize <= 0) {
+        qWarning() << "Spectrogram::makeStft - Empty input, empty window or non positive hop size. Returning.";
+        return lResult;
+    }
+
+    if(iNfft <= 0) {
+        iNfft = 2;
+
+        while(iNfft < vecWindow.rows()) {
+            iNfft *= 2;
+        }
+    } else if(iNfft < vecWindow.rows()) {
+        qWarning() << "Spectrogram::makeStft - FFT length is smaller than the window length. Using the window length.";
+        iNfft = vecWindow.rows();
+    }
+
     #ifdef EIGEN_FFTW_DEFAULT
         fftw_make_planner_thread_safe();
     #endif
 
-    Eigen::FFT<double> fft;
-    MatrixXd tf_matrix = MatrixXd::Zero(inputData.vecInputData.rows()/2, inputData.vecInputData.rows());
-    VectorXd envelope, windowed_sig, real_coeffs;
-    VectorXcd fft_win_sig;
-    qint32 window_size = inputData.window_size;
+    int iNumberFrames = (matSignals.cols() + iHopSize - 1) / iHopSize;
+    int iNumberChannels = matSignals.rows();
 
-    for(quint32 translate = inputData.iRangeLow; translate < inputData.iRangeHigh; translate++) {
-        envelope = gaussWindow(inputData.vecInputData.rows(), window_size, translate);
+    // Preallocate the output, the jobs write their frames directly into it
+    for(int i = 0; i < iNumberChannels; ++i) {
+        lResult.append(MatrixXd(iNfft/2 + 1, iNumberFrames));
+    }
 
-        windowed_sig = VectorXd::Zero(inputData.vecInputData.rows());
-        fft_win_sig = VectorXcd::Zero(inputData.vecInputData.rows());
+    // Split channels and frames into about four jobs per thread
+    int iNumberJobs = 4 * qMax(QThread::idealThreadCount(), 1);
+    int iFramesPerJob = qMax(1, int((qint64(iNumberFrames) * iNumberChannels + iNumberJobs - 1) / iNumberJobs));
+    iFramesPerJob = qMin(iFramesPerJob, iNumberFrames);
 
-        windowed_sig = inputData.vecInputData.array() * envelope.array();\
+    QList<SpectrogramFrameRange> lJobs;
+    SpectrogramFrameRange job;
 
-        fft.fwd(fft_win_sig, windowed_sig);
+    for(job.iChannel = 0; job.iChannel < iNumberChannels; ++job.iChannel) {
+        for(job.iFrameStart = 0; job.iFrameStart < iNumberFrames; job.iFrameStart += iFramesPerJob) {
+            job.iFrameEnd = qMin(job.iFrameStart + iFramesPerJob, iNumberFrames);
+            lJobs.append(job);
+        }
+    }
 
-        real_coeffs = fft_win_sig.segment(0,inputData.vecInputData.rows()/2).array().abs2();
+    QVector<MatrixXd*> vecResults;
 
-        tf_matrix.col(translate) = real_coeffs;
+    for(int i = 0; i < lResult.size(); ++i) {
+        vecResults.append(&lResult[i]);
     }
 
-    return tf_matrix;
+    std::function<void(const SpectrogramFrameRange&)> computeLambda = [&](const SpectrogramFrameRange& range) {
+        computeFrames(matSignals,
+                      range.iChannel,
+                      vecWindow,
+                      iHopSize,
+                      iNfft,
+                      range.iFrameStart,
+                      range.iFrameEnd,
+                      *vecResults.at(range.iChannel));
+    };
+
+    QFuture<void> future = QtConcurrent::map(lJobs,
+                                             computeLambda);
+    future.waitForFinished();
+
+    return lResult;
 }
 
 //=============================================================================================================
 
-void Spectrogram::reduce(MatrixXd &resultData,
-                         const MatrixXd &data)
+VectorXd Spectrogram::gaussWindow(qreal scale)
 {
-    if(resultData.size() == 0) {
-        resultData = data;
-    } else {
-        resultData += data;
+    // exp(-3.14 * 2.5^2) is below 1e-8, the window is truncated there
+    int iHalfWidth = int(ceil(2.5 * scale));
+    VectorXd gauss = VectorXd::Zero(2 * iHalfWidth + 1);
+
+    for(qint32 n = 0; n < gauss.rows(); n++)
+    {
+        qreal t = qreal(n - iHalfWidth) / scale;
+        gauss[n] = exp(-3.14 * pow(t, 2))*pow(sqrt(scale),(-1))*pow(qreal(2),(0.25));
+    }
+
+    return gauss;
+}
+
+//=============================================================================================================
+
+void Spectrogram::computeFrames(const MatrixXd& matSignals,
+                                int iChannel,
+                                const VectorXd& vecWindow,
+                                int iHopSize,
+                                int iNfft,
+                                int iFrameStart,
+                                int iFrameEnd,
+                                MatrixXd& matResult)
+{
+    FFT<double> fft;
+    fft.SetFlag(fft.HalfSpectrum);
+
+    int iNumberSamples = matSignals.cols();
+    int iWindowLength = vecWindow.rows();
+    int iHalfWidth = iWindowLength / 2;
+    int iFirst, iLast, iCenter;
+
+    VectorXd vecFrame = VectorXd::Zero(iNfft);
+    VectorXcd vecSpectrum(iNfft/2 + 1);
+
+    for(int k = iFrameStart; k < iFrameEnd; ++k) {
+        iCenter = k * iHopSize;
+
+        // Window samples which fall inside the signal
+        iFirst = qMax(0, iHalfWidth - iCenter);
+        iLast = qMin(iWindowLength, iNumberSamples - iCenter + iHalfWidth);
+
+        vecFrame.setZero();
+
+        if(iLast > iFirst) {
+            vecFrame.segment(iFirst, iLast - iFirst) = matSignals.row(iChannel).segment(iCenter - iHalfWidth + iFirst, iLast - iFirst).transpose().cwiseProduct(vecWindow.segment(iFirst, iLast - iFirst));
+        }
+
+        fft.fwd(vecSpectrum, vecFrame);
+
+        matResult.col(k) = vecSpectrum.head(iNfft/2 + 1).cwiseAbs2();
     }
 }
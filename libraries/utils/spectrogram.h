@@ -40,6 +40,12 @@
 
 #include "utils_global.h"
 
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QList>
+
 //=============================================================================================================
 // EIGEN INCLUDES
 //=============================================================================================================
@@ -53,65 +59,98 @@
 namespace UTILSLIB
 {
 
-struct SpectogramInputData {
-    Eigen::VectorXd vecInputData;
-    quint32 iRangeLow;
-    quint32 iRangeHigh;
-    qint32 window_size;
-};
-
+//=============================================================================================================
+/**
+ * Short-time Fourier transform based spectrograms. A window of bounded support is moved over the signal by a
+ * fixed hop size. Each frame is centered at sample k*hop, samples outside of the signal are treated as zeros.
+ *
+ * @brief Short-time Fourier transform based spectrograms.
+ */
 class UTILSSHARED_EXPORT Spectrogram
 {
 
 public:
     //=========================================================================================================
     /**
-     * Calculates the spectrogram (tf-representation) of a given signal
+     * Calculates the spectrogram (tf-representation) of a given signal. The signal is demeaned and a gaussian
+     * window is moved sample by sample over the signal, i.e. the result has one column per sample. The frequency
+     * axis is sampled with the FFT length of the window support and spans [0, sfreq/2).
      *
      * @param[in] signal         input-signal to calculate spectrogram of.
      * @param[in] windowSize     size of the window which is used (resolution in time an frequency is depending on it).
+     *                           Default is 0, which uses a fifteenth of the signal length.
      *
      * @return spectrogram-matrix (tf-representation of the input signal).
      */
     static Eigen::MatrixXd makeSpectrogram(Eigen::VectorXd signal,
-                                           qint32 windowSize);
+                                           qint32 windowSize = 0);
 
-private:
     //=========================================================================================================
     /**
-     * Calculates a gaussean window function
+     * Calculates the power of the short-time Fourier transform of a signal.
      *
-     * @param[in] sample_count   number of samples.
-     * @param[in] scale          window width.
-     * @param[in] translation    translation of the window among a signal.
+     * @param[in] vecSignal      The input signal.
+     * @param[in] vecWindow      The window. Its length defines the support of each frame.
+     * @param[in] iHopSize       The number of samples between two frames.
+     * @param[in] iNfft          The FFT length. Default is 0, which uses the next power of two of the window length.
      *
-     * @return samples of window-vector.
+     * @return The power spectrogram with iNfft/2+1 rows (frequency bins) and one column per frame.
      */
-    static Eigen::VectorXd gaussWindow (qint32 sample_count,
-                                        qreal scale,
-                                        quint32 translation);
+    static Eigen::MatrixXd makeStft(const Eigen::VectorXd& vecSignal,
+                                    const Eigen::VectorXd& vecWindow,
+                                    qint32 iHopSize,
+                                    qint32 iNfft = 0);
 
     //=========================================================================================================
     /**
-     * Calculates the spectogram matrix for a given input data matrix.
+     * Calculates the power of the short-time Fourier transform of several channels at once. The computation is
+     * parallelized over channels and frames.
      *
-     * @param[in] data       The input data.
+     * @param[in] matSignals     The input signals, one channel per row.
+     * @param[in] vecWindow      The window. Its length defines the support of each frame.
+     * @param[in] iHopSize       The number of samples between two frames.
+     * @param[in] iNfft          The FFT length. Default is 0, which uses the next power of two of the window length.
      *
-     * @return               The spectogram matrix.
+     * @return The power spectrogram of each channel with iNfft/2+1 rows (frequency bins) and one column per frame.
      */
-    static Eigen::MatrixXd compute(const SpectogramInputData& data);
+    static QList<Eigen::MatrixXd> makeStft(const Eigen::MatrixXd& matSignals,
+                                           const Eigen::VectorXd& vecWindow,
+                                           qint32 iHopSize,
+                                           qint32 iNfft = 0);
 
     //=========================================================================================================
     /**
-     * Sums up (reduces) the in parallel processed spectogram matrix.
+     * Calculates a gaussian window, which is truncated where it has decayed to a negligible value.
+     *
+     * @param[in] scale          window width.
      *
-     * @param[out] resultData    The result data.
-     * @param[in] data          The incoming, temporary result data.
+     * @return samples of window-vector.
      */
-    static void reduce(Eigen::MatrixXd &resultData,
-                       const Eigen::MatrixXd &data);
+    static Eigen::VectorXd gaussWindow(qreal scale);
+
+private:
+    //=========================================================================================================
+    /**
+     * Calculates a range of frames of the short-time Fourier transform of one channel.
+     *
+     * @param[in] matSignals     The input signals, one channel per row.
+     * @param[in] iChannel       The channel to transform.
+     * @param[in] vecWindow      The window.
+     * @param[in] iHopSize       The number of samples between two frames.
+     * @param[in] iNfft          The FFT length.
+     * @param[in] iFrameStart    The first frame to calculate.
+     * @param[in] iFrameEnd      The frame after the last frame to calculate.
+     * @param[out] matResult     The preallocated power spectrogram to write the frames to.
+     */
+    static void computeFrames(const Eigen::MatrixXd& matSignals,
+                              int iChannel,
+                              const Eigen::VectorXd& vecWindow,
+                              int iHopSize,
+                              int iNfft,
+                              int iFrameStart,
+                              int iFrameEnd,
+                              Eigen::MatrixXd& matResult);
 };
 }//namespace
 
 #endif // SPECTROGRAM_H
-
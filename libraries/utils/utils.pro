@@ -90,6 +90,9 @@ HEADERS += \
     sphere.h \
     simplex_algorithm.h \
     generics/circularbuffer.h \
+    generics/ringbuffer.h \
+    generics/readaheadbuffer.h \
+    generics/writebehindbuffer.h \
     generics/commandpattern.h \
     generics/observerpattern.h \
     generics/applicationlogger.h \
@@ -70,6 +70,7 @@ private slots:
     void initTestCase();
     void dipoleFitSimple();
     void dipoleFitAdvanced();
+    void dipoleFitThreads();
     void cleanupTestCase();
 
 private:
@@ -258,6 +259,65 @@ void TestDipoleFit::dipoleFitAdvanced()
 
 //=============================================================================================================
 
+void TestDipoleFit::dipoleFitThreads()
+{
+    QFile testFile;
+
+    //*********************************************************************************************************
+    // Dipole Fit Settings
+    //*********************************************************************************************************
+
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Dipole Fit Settings >>>>>>>>>>>>>>>>>>>>>>>>>\n");
+
+    //Following is equivalent to: --meas ./mne-cpp-test-data/MEG/sample/sample_audvis-ave.fif --set 1 --meg
+    //--eeg --tmin 0 --tmax 300 --tstep 5 --bmin -100 --bmax 0 --warmstart --dip ./mne-cpp-test-data/Result/dip_fit_threads.dat
+    //The time window spans several fitting chunks, so that the chunks are distributed over the threads
+    DipoleFitSettings settings;
+    testFile.setFileName(QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/MEG/sample/sample_audvis-ave.fif"); QVERIFY( testFile.exists() );
+    settings.measname = testFile.fileName();
+    settings.is_raw = false;
+    settings.setno = 1;
+    settings.include_meg = true;
+    settings.include_eeg = true;
+    settings.tmin = 0.0f;
+    settings.tmax = 300.0f/1000.0f;
+    settings.tstep = 5.0f/1000.0f;
+    settings.bmin = -100.0f/1000.0f;
+    settings.bmax = 0.0f/1000.0f;
+    settings.warm_start = true;
+    settings.dipname = QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/Result/dip_fit_threads.dat";
+
+    settings.checkIntegrity();
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Dipole Fit Settings Finished <<<<<<<<<<<<<<<<<<<<<<<<<\n");
+
+    //*********************************************************************************************************
+    // Compare sequential and threaded Dipole Fit
+    //*********************************************************************************************************
+
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Compute sequential Dipole Fit >>>>>>>>>>>>>>>>>>>>>>>>>\n");
+
+    settings.nthreads = 1;
+    DipoleFit dipFitSequential(&settings);
+    m_refECDSet = dipFitSequential.calculateFit();
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Compute sequential Dipole Fit Finished <<<<<<<<<<<<<<<<<<<<<<<<<\n");
+
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Compute threaded Dipole Fit >>>>>>>>>>>>>>>>>>>>>>>>>\n");
+
+    settings.nthreads = 4;
+    DipoleFit dipFitThreaded(&settings);
+    m_ECDSet = dipFitThreaded.calculateFit();
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Compute threaded Dipole Fit Finished <<<<<<<<<<<<<<<<<<<<<<<<<\n");
+
+    QVERIFY( m_refECDSet.size() > 32 );
+
+    compareFit();
+}
+
+//=============================================================================================================
+
 void TestDipoleFit::compareFit()
 {
     //*********************************************************************************************************
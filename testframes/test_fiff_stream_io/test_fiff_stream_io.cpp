@@ -0,0 +1,464 @@
+//=============================================================================================================
+/**
+ * @file     test_fiff_stream_io.cpp
+ * @author   MNE-CPP Authors
+ * @since    0.1.9
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, MNE-CPP Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    Test and benchmark of the bulk array encoding and decoding in FiffStream.
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/generics/applicationlogger.h>
+#include <utils/ioutils.h>
+
+#include <fiff/fiff_stream.h>
+#include <fiff/fiff_tag.h>
+#include <fiff/fiff_info.h>
+#include <fiff/fiff_raw_data.h>
+#include <fiff/fiff_file.h>
+#include <fiff/fiff_constants.h>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Dense>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace UTILSLIB;
+using namespace Eigen;
+
+//=============================================================================================================
+/**
+ * DECLARE CLASS TestFiffStreamIO
+ *
+ * @brief The TestFiffStreamIO class compares the bulk array writers and readers of FiffStream with the element
+ *        wise QDataStream encoding and reports the throughput of both.
+ *
+ */
+class TestFiffStreamIO: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestFiffStreamIO();
+
+private slots:
+    void initTestCase();
+    void compareSwapArray();
+    void compareWriteFloat();
+    void compareFloatMatrixRoundTrip();
+    void compareDoubleRoundTrip();
+    void compareReadArrayData();
+    void compareIntegerRawRoundTrip_data();
+    void compareIntegerRawRoundTrip();
+    void benchmarkElementWiseWrite();
+    void benchmarkBulkWrite();
+    void benchmarkElementWiseRead();
+    void benchmarkBulkRead();
+    void reportThroughput();
+    void cleanupTestCase();
+
+private:
+    void writeElementWise(QByteArray& block) const;
+    void readElementWise(const QByteArray& block, MatrixXf& data) const;
+    FiffInfo integerRawInfo() const;
+
+    MatrixXf m_matRawBuffer;
+    QByteArray m_blockRawBuffer;
+};
+
+//=============================================================================================================
+
+TestFiffStreamIO::TestFiffStreamIO()
+{
+}
+
+//=============================================================================================================
+
+void TestFiffStreamIO::initTestCase()
+{
+    qInstallMessageHandler(UTILSLIB::ApplicationLogger::customLogWriter);
+
+    // Typical raw buffer of a 306 channel MEG system
+    std::srand(1);
+    m_matRawBuffer = MatrixXf::Random(306, 1000);
+
+    writeElementWise(m_blockRawBuffer);
+}
+
+//=============================================================================================================
+
+void TestFiffStreamIO::compareSwapArray()
+{
+    // Odd counts exercise both the vectorized part and the scalar tail
+    const int iCount = 37;
+
+    QVector<qint16> vecShort(iCount), vecShortSwapped(iCount);
+    QVector<qint32> vecInt(iCount), vecIntSwapped(iCount);
+    QVector<qint64> vecLong(iCount), vecLongSwapped(iCount);
+    for(int i = 0; i < iCount; ++i) {
+        vecShort[i] = static_cast<qint16>(std::rand());
+        vecInt[i] = static_cast<qint32>(std::rand());
+        vecLong[i] = static_cast<qint64>(std::rand()) << 31 | std::rand();
+    }
+
+    IOUtils::swap_array(vecShort.constData(), vecShortSwapped.data(), iCount, 2);
+    IOUtils::swap_array(vecInt.constData(), vecIntSwapped.data(), iCount, 4);
+    IOUtils::swap_array(vecLong.constData(), vecLongSwapped.data(), iCount, 8);
+
+    for(int i = 0; i < iCount; ++i) {
+        QCOMPARE(vecShortSwapped[i], IOUtils::swap_short(vecShort[i]));
+        QCOMPARE(vecIntSwapped[i], IOUtils::swap_int(vecInt[i]));
+        QCOMPARE(vecLongSwapped[i], IOUtils::swap_long(vecLong[i]));
+    }
+
+    // In place
+    IOUtils::swap_array(vecIntSwapped.data(), vecIntSwapped.data(), iCount, 4);
+    QCOMPARE(vecIntSwapped, vecInt);
+}
+
+//=============================================================================================================
+
+void TestFiffStreamIO::compareWriteFloat()
+{
+    QByteArray blockBulk;
+    FiffStream t_FiffStreamOut(&blockBulk, QIODevice::WriteOnly);
+    t_FiffStreamOut.write_float(FIFF_DATA_BUFFER, m_matRawBuffer.data(), m_matRawBuffer.size());
+
+    QCOMPARE(blockBulk, m_blockRawBuffer);
+}
+
+//=============================================================================================================
+
+void TestFiffStreamIO::compareFloatMatrixRoundTrip()
+{
+    QByteArray block;
+    FiffStream t_FiffStreamOut(&block, QIODevice::WriteOnly);
+    t_FiffStreamOut.write_float_matrix(FIFF_MNE_COV, m_matRawBuffer);
+
+    FiffStream t_FiffStreamIn(&block, QIODevice::ReadOnly);
+    FiffTag::SPtr t_pTag;
+    QVERIFY(t_FiffStreamIn.read_tag(t_pTag));
+
+    // FIFF matrices are stored row-major, the tag maps them column-major
+    MatrixXf matRead = t_pTag->toFloatMatrix().transpose();
+    QCOMPARE(static_cast<int>(matRead.rows()), static_cast<int>(m_matRawBuffer.rows()));
+    QCOMPARE(static_cast<int>(matRead.cols()), static_cast<int>(m_matRawBuffer.cols()));
+    QVERIFY(matRead == m_matRawBuffer);
+}
+
+//=============================================================================================================
+
+void TestFiffStreamIO::compareDoubleRoundTrip()
+{
+    VectorXd vecData = VectorXd::Random(101);
+
+    QByteArray block;
+    FiffStream t_FiffStreamOut(&block, QIODevice::WriteOnly);
+    t_FiffStreamOut.write_double(FIFF_MNE_COV_EIGENVALUES, vecData.data(), vecData.size());
+
+    // Tag header plus full double precision payload
+    QCOMPARE(block.size(), 16 + 8 * static_cast<int>(vecData.size()));
+
+    FiffStream t_FiffStreamIn(&block, QIODevice::ReadOnly);
+    FiffTag::SPtr t_pTag;
+    QVERIFY(t_FiffStreamIn.read_tag(t_pTag));
+
+    QVERIFY(Map<VectorXd>(t_pTag->toDouble(), vecData.size()) == vecData);
+}
+
+//=============================================================================================================
+
+void TestFiffStreamIO::compareReadArrayData()
+{
+    MatrixXf matRead(m_matRawBuffer.rows(), m_matRawBuffer.cols());
+
+    FiffStream t_FiffStreamIn(&m_blockRawBuffer, QIODevice::ReadOnly);
+    t_FiffStreamIn.skipRawData(16);
+    QVERIFY(t_FiffStreamIn.read_array_data(matRead.data(), matRead.size(), 4));
+
+    QVERIFY(matRead == m_matRawBuffer);
+}
+
+//=============================================================================================================
+
+void TestFiffStreamIO::compareIntegerRawRoundTrip_data()
+{
+    QTest::addColumn<int>("iDataType");
+    QTest::addColumn<int>("iMaxCount");
+    QTest::addColumn<int>("iBytesPerSample");
+
+    QTest::newRow("short") << static_cast<int>(FIFFT_SHORT) << 32767 << 2;
+    QTest::newRow("int") << static_cast<int>(FIFFT_INT) << 8388607 << 4;
+}
+
+//=============================================================================================================
+
+void TestFiffStreamIO::compareIntegerRawRoundTrip()
+{
+    QFETCH(int, iDataType);
+    QFETCH(int, iMaxCount);
+    QFETCH(int, iBytesPerSample);
+
+    const FiffInfo info = integerRawInfo();
+    const int iNumSamples = 500;
+
+    // Whole ADC counts in physical units, including both ends of the ADC range
+    MatrixXi matCounts = (ArrayXXd::Random(info.nchan, iNumSamples) * iMaxCount).round().cast<int>().matrix();
+    matCounts(0,0) = iMaxCount;
+    matCounts(0,1) = -iMaxCount;
+    RowVectorXd vecLsb(info.nchan);
+    for(int k = 0; k < info.nchan; ++k)
+        vecLsb[k] = info.chs[k].range*info.chs[k].cal;
+    const MatrixXd matData = vecLsb.transpose().asDiagonal() * matCounts.cast<double>();
+
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    QFile t_fileOut(tempDir.filePath("integer_raw.fif"));
+
+    RowVectorXd cals;
+    MatrixXi sel;
+    FiffStream::SPtr outfid = FiffStream::start_writing_raw(t_fileOut, info, cals, sel, true, iDataType);
+    QCOMPARE(outfid->raw_data_type(), iDataType);
+    QVERIFY(cals.isApprox(vecLsb));
+    fiff_int_t first = 0;
+    outfid->write_int(FIFF_FIRST_SAMPLE, &first);
+    QVERIFY(outfid->write_raw_buffer(matData.leftCols(200), cals));
+    QVERIFY(outfid->write_raw_buffer(matData.rightCols(iNumSamples - 200), cals));
+    outfid->finish_writing_raw();
+
+    // The raw buffers take exactly the integer payload
+    QVERIFY(t_fileOut.open(QIODevice::ReadOnly));
+    QByteArray blockFile = t_fileOut.readAll();
+    t_fileOut.close();
+
+    FiffRawData rawFromFile(t_fileOut);
+    QCOMPARE(rawFromFile.rawdir.size(), 2);
+    QCOMPARE(rawFromFile.rawdir[0].ent->type, static_cast<fiff_int_t>(iDataType));
+    QCOMPARE(rawFromFile.rawdir[0].ent->size, static_cast<fiff_int_t>(info.nchan * 200 * iBytesPerSample));
+
+    // Memory mapped route
+    MatrixXd matRead, matTimes;
+    QVERIFY(rawFromFile.read_raw_segment(matRead, matTimes));
+    QVERIFY(matRead.isApprox(matData, 1e-12));
+
+    // Tag route
+    QBuffer bufferIn(&blockFile);
+    FiffRawData rawFromBuffer(bufferIn);
+    QVERIFY(rawFromBuffer.read_raw_segment(matRead, matTimes, 100, 399));
+    QVERIFY(matRead.isApprox(matData.middleCols(100, 300), 1e-12));
+}
+
+//=============================================================================================================
+
+void TestFiffStreamIO::benchmarkElementWiseWrite()
+{
+    QByteArray block;
+    QBENCHMARK {
+        writeElementWise(block);
+    }
+}
+
+//=============================================================================================================
+
+void TestFiffStreamIO::benchmarkBulkWrite()
+{
+    QByteArray block;
+    QBENCHMARK {
+        block.clear();
+        FiffStream t_FiffStreamOut(&block, QIODevice::WriteOnly);
+        t_FiffStreamOut.write_float(FIFF_DATA_BUFFER, m_matRawBuffer.data(), m_matRawBuffer.size());
+    }
+}
+
+//=============================================================================================================
+
+void TestFiffStreamIO::benchmarkElementWiseRead()
+{
+    MatrixXf matRead;
+    QBENCHMARK {
+        readElementWise(m_blockRawBuffer, matRead);
+    }
+}
+
+//=============================================================================================================
+
+void TestFiffStreamIO::benchmarkBulkRead()
+{
+    MatrixXf matRead(m_matRawBuffer.rows(), m_matRawBuffer.cols());
+    QBENCHMARK {
+        FiffStream t_FiffStreamIn(&m_blockRawBuffer, QIODevice::ReadOnly);
+        t_FiffStreamIn.skipRawData(16);
+        t_FiffStreamIn.read_array_data(matRead.data(), matRead.size(), 4);
+    }
+}
+
+//=============================================================================================================
+
+void TestFiffStreamIO::reportThroughput()
+{
+    const int iRepetitions = 20;
+    const double dMegaBytes = iRepetitions * m_blockRawBuffer.size() / (1024.0 * 1024.0);
+    QElapsedTimer timer;
+    QByteArray block;
+    MatrixXf matRead(m_matRawBuffer.rows(), m_matRawBuffer.cols());
+
+    timer.start();
+    for(int i = 0; i < iRepetitions; ++i)
+        writeElementWise(block);
+    double dElementWiseWrite = dMegaBytes / qMax<qint64>(1, timer.nsecsElapsed()) * 1e9;
+
+    timer.start();
+    for(int i = 0; i < iRepetitions; ++i) {
+        block.clear();
+        FiffStream t_FiffStreamOut(&block, QIODevice::WriteOnly);
+        t_FiffStreamOut.write_float(FIFF_DATA_BUFFER, m_matRawBuffer.data(), m_matRawBuffer.size());
+    }
+    double dBulkWrite = dMegaBytes / qMax<qint64>(1, timer.nsecsElapsed()) * 1e9;
+
+    timer.start();
+    for(int i = 0; i < iRepetitions; ++i)
+        readElementWise(m_blockRawBuffer, matRead);
+    double dElementWiseRead = dMegaBytes / qMax<qint64>(1, timer.nsecsElapsed()) * 1e9;
+
+    timer.start();
+    for(int i = 0; i < iRepetitions; ++i) {
+        FiffStream t_FiffStreamIn(&m_blockRawBuffer, QIODevice::ReadOnly);
+        t_FiffStreamIn.skipRawData(16);
+        t_FiffStreamIn.read_array_data(matRead.data(), matRead.size(), 4);
+    }
+    double dBulkRead = dMegaBytes / qMax<qint64>(1, timer.nsecsElapsed()) * 1e9;
+
+    qInfo("Raw buffer %dx%d write: element wise %.1f MB/s, bulk %.1f MB/s",
+          static_cast<int>(m_matRawBuffer.rows()), static_cast<int>(m_matRawBuffer.cols()), dElementWiseWrite, dBulkWrite);
+    qInfo("Raw buffer %dx%d read:  element wise %.1f MB/s, bulk %.1f MB/s",
+          static_cast<int>(m_matRawBuffer.rows()), static_cast<int>(m_matRawBuffer.cols()), dElementWiseRead, dBulkRead);
+}
+
+//=============================================================================================================
+
+void TestFiffStreamIO::cleanupTestCase()
+{
+}
+
+//=============================================================================================================
+
+void TestFiffStreamIO::writeElementWise(QByteArray& block) const
+{
+    // The encoding FiffStream::write_float used before the bulk writers
+    block.clear();
+    QDataStream t_DataStream(&block, QIODevice::WriteOnly);
+    t_DataStream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    t_DataStream.setByteOrder(QDataStream::BigEndian);
+    t_DataStream.setVersion(QDataStream::Qt_5_0);
+
+    t_DataStream << (qint32)FIFF_DATA_BUFFER;
+    t_DataStream << (qint32)FIFFT_FLOAT;
+    t_DataStream << (qint32)(4 * m_matRawBuffer.size());
+    t_DataStream << (qint32)FIFFV_NEXT_SEQ;
+
+    const float* pData = m_matRawBuffer.data();
+    for(qint32 i = 0; i < m_matRawBuffer.size(); ++i)
+        t_DataStream << pData[i];
+}
+
+//=============================================================================================================
+
+void TestFiffStreamIO::readElementWise(const QByteArray& block, MatrixXf& data) const
+{
+    QDataStream t_DataStream(block);
+    t_DataStream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    t_DataStream.setByteOrder(QDataStream::BigEndian);
+    t_DataStream.setVersion(QDataStream::Qt_5_0);
+    t_DataStream.skipRawData(16);
+
+    data.resize(m_matRawBuffer.rows(), m_matRawBuffer.cols());
+    float* pData = data.data();
+    for(qint32 i = 0; i < data.size(); ++i)
+        t_DataStream >> pData[i];
+}
+
+//=============================================================================================================
+
+FiffInfo TestFiffStreamIO::integerRawInfo() const
+{
+    // ADC steps of a typical MEG/EEG system: magnetometers, gradiometers and EEG
+    FiffInfo info;
+    info.sfreq = 1000.0f;
+    info.nchan = 3;
+
+    FiffChInfo ch;
+    ch.kind = FIFFV_MEG_CH;
+    ch.unit = FIFF_UNIT_T;
+    ch.range = 1.0f;
+    ch.cal = 3.1e-14f;
+    ch.ch_name = "MEG 0111";
+    info.chs << ch;
+
+    ch.unit = FIFF_UNIT_T_M;
+    ch.range = 1.0f;
+    ch.cal = 1.6e-12f;
+    ch.ch_name = "MEG 0112";
+    info.chs << ch;
+
+    ch.kind = FIFFV_EEG_CH;
+    ch.unit = FIFF_UNIT_V;
+    ch.range = 2.0f;
+    ch.cal = 1.9e-7f;
+    ch.ch_name = "EEG 001";
+    info.chs << ch;
+
+    for(int k = 0; k < info.nchan; ++k)
+        info.ch_names << info.chs[k].ch_name;
+
+    return info;
+}
+
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestFiffStreamIO)
+#include "test_fiff_stream_io.moc"
@@ -45,6 +45,8 @@
 #include <fiff/fiff.h>
 #include <rtprocessing/helpers/filterkernel.h>
 #include <rtprocessing/filter.h>
+#include <rtprocessing/filterpartitioned.h>
+#include <rtprocessing/helpers/iirfilter.h>
 
 #include <Eigen/Dense>
 
@@ -84,10 +86,13 @@ private slots:
     void initTestCase();
     void compareData();
     void compareTimes();
+    void comparePartitioned();
+    void compareIir();
     void cleanupTestCase();
 
 private:
     double dEpsilon;
+    double dSFreq;
     int iOrder;
 
     MatrixXd mFirstInData;
@@ -151,7 +156,7 @@ void TestFiltering::initTestCase()
     // initialize filter settings
     QString sFilterName = "example_cosine";
     int type = FilterKernel::m_filterTypes.indexOf(FilterParameter("BPF"));
-    double dSFreq = rawFirstInRaw.info.sfreq;
+    dSFreq = rawFirstInRaw.info.sfreq;
     double dCenterfreq = 10;
     double dBandwidth = 10;
     double dTransition = 1;
@@ -231,6 +236,93 @@ void TestFiltering::compareTimes()
     QVERIFY( mTimesDiff.sum() < dEpsilon );
 }
 
+//=============================================================================================================
+
+void TestFiltering::comparePartitioned()
+{
+    // Stream the first channels through the partitioned filter in blocks which are no multiple of the partition size
+    MatrixXd mData = mFirstInData.topRows(4);
+    RowVectorXi vPicks(2);
+    vPicks << 0, 2;
+
+    FilterKernel filterKernel("example_cosine",
+                              FilterKernel::m_filterTypes.indexOf(FilterParameter("BPF")),
+                              iOrder,
+                              10.0/(dSFreq/2.0),
+                              10.0/(dSFreq/2.0),
+                              1.0/(dSFreq/2.0),
+                              dSFreq,
+                              FilterKernel::m_designMethods.indexOf(FilterParameter("Cosine")));
+
+    FilterPartitioned filterPartitioned(128);
+    MatrixXd mPartitioned(mData.rows(), mData.cols());
+    int iBlockSize = 200;
+
+    for(int i = 0; i < mData.cols(); i += iBlockSize) {
+        int iSize = std::min(iBlockSize, int(mData.cols()) - i);
+        mPartitioned.middleCols(i, iSize) = filterPartitioned.calculate(mData.middleCols(i, iSize),
+                                                                        filterKernel,
+                                                                        vPicks,
+                                                                        false);
+    }
+
+    // The reference is the full convolution, which is delayed by half the filter length as well
+    MatrixXd mReference = filterDataBlock(mData,
+                                          vPicks,
+                                          filterKernel,
+                                          false);
+
+    int iBufferDelay = filterPartitioned.getDelay() - filterKernel.getCoefficients().cols()/2;
+    int iLength = mData.cols() - filterPartitioned.getDelay();
+    MatrixXd mDataDiff = mPartitioned.block(0, filterPartitioned.getDelay(), mData.rows(), iLength)
+                         - mReference.block(0, filterPartitioned.getDelay() - iBufferDelay, mData.rows(), iLength);
+
+    QVERIFY( mDataDiff.cwiseAbs().maxCoeff() < dEpsilon * mData.cwiseAbs().maxCoeff() );
+}
+
+//=============================================================================================================
+
+void TestFiltering::compareIir()
+{
+    MatrixXd mData = mFirstInData.topRows(4);
+
+    IirFilter iirFilter("example_butterworth",
+                        FilterKernel::m_filterTypes.indexOf(FilterParameter("BPF")),
+                        4,
+                        10.0/(dSFreq/2.0),
+                        10.0/(dSFreq/2.0),
+                        dSFreq,
+                        IirFilter::m_designMethods.indexOf(FilterParameter("Butterworth")));
+
+    // Filtering block by block must give the same result as filtering all data at once
+    MatrixXd mWhole = mData;
+    iirFilter.applyFilter(mWhole);
+    iirFilter.reset();
+
+    MatrixXd mStreamed = mData;
+    int iBlockSize = 200;
+
+    for(int i = 0; i < mData.cols(); i += iBlockSize) {
+        int iSize = std::min(iBlockSize, int(mData.cols()) - i);
+        MatrixXd mBlock = mStreamed.middleCols(i, iSize);
+        iirFilter.applyFilter(mBlock);
+        mStreamed.middleCols(i, iSize) = mBlock;
+    }
+
+    QVERIFY( (mWhole - mStreamed).cwiseAbs().maxCoeff() < dEpsilon * mData.cwiseAbs().maxCoeff() );
+
+    // A sinusoid in the pass band must pass the zero phase filter without delay
+    RowVectorXd vecSine(2000);
+    for(int i = 0; i < vecSine.cols(); ++i) {
+        vecSine(i) = sin(2.0 * M_PI * 10.0 * i / dSFreq);
+    }
+
+    RowVectorXd vecSineDiff = iirFilter.applyZeroPhaseFilter(vecSine).row(0) - vecSine;
+    QVERIFY( vecSineDiff.segment(500, 1000).cwiseAbs().maxCoeff() < 0.01 );
+}
+
+//=============================================================================================================
+
 void TestFiltering::cleanupTestCase()
 {
 }
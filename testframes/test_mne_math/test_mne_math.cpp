@@ -0,0 +1,211 @@
+//=============================================================================================================
+/**
+ * @file     test_mne_math.cpp
+ * @author   MNE-CPP Authors
+ * @since    0.1.9
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, MNE-CPP Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    Test and benchmark of the Gram matrix based thin SVD in MNEMath.
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/generics/applicationlogger.h>
+#include <utils/mnemath.h>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Dense>
+#include <Eigen/SVD>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+//=============================================================================================================
+/**
+ * DECLARE CLASS TestMneMath
+ *
+ * @brief The TestMneMath class compares the Gram matrix based thin SVD against Eigen's JacobiSVD
+ *
+ */
+class TestMneMath: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestMneMath();
+
+private slots:
+    void initTestCase();
+    void compareSingularValues();
+    void compareReconstruction();
+    void compareOrthogonality();
+    void compareTransposed();
+    void benchmarkJacobiSvd();
+    void benchmarkThinSvdFromGram();
+    void cleanupTestCase();
+
+private:
+    double dEpsilon;
+
+    MatrixXd m_matGain;
+    JacobiSVD<MatrixXd> m_svd;
+
+    VectorXd m_vecSing;
+    MatrixXd m_matU;
+    MatrixXd m_matV;
+};
+
+//=============================================================================================================
+
+TestMneMath::TestMneMath()
+: dEpsilon(1e-8)
+{
+}
+
+//=============================================================================================================
+
+void TestMneMath::initTestCase()
+{
+    qInstallMessageHandler(UTILSLIB::ApplicationLogger::customLogWriter);
+    qDebug() << "Epsilon" << dEpsilon;
+
+    // Wide matrix with the shape and a decaying spectrum similar to a whitened MEG lead field
+    int iRows = 306;
+    int iCols = 2000;
+
+    std::srand(1);
+    MatrixXd matQLeft = HouseholderQR<MatrixXd>(MatrixXd::Random(iRows, iRows)).householderQ();
+    MatrixXd matQRight = HouseholderQR<MatrixXd>(MatrixXd::Random(iCols, iRows)).householderQ() * MatrixXd::Identity(iCols, iRows);
+
+    VectorXd vecSing(iRows);
+    for(int i = 0; i < iRows; ++i) {
+        vecSing(i) = std::pow(10.0, -4.0 * i / iRows);
+    }
+
+    m_matGain = matQLeft * vecSing.asDiagonal() * matQRight.transpose();
+
+    m_svd.compute(m_matGain, ComputeThinU | ComputeThinV);
+    MNEMath::thinSvdFromGram(m_matGain, m_vecSing, m_matU, m_matV);
+}
+
+//=============================================================================================================
+
+void TestMneMath::compareSingularValues()
+{
+    QCOMPARE(m_vecSing.size(), m_svd.singularValues().size());
+
+    double dDiff = (m_vecSing - m_svd.singularValues()).cwiseAbs().maxCoeff() / m_svd.singularValues()(0);
+    QVERIFY(dDiff < dEpsilon);
+}
+
+//=============================================================================================================
+
+void TestMneMath::compareReconstruction()
+{
+    QCOMPARE(static_cast<int>(m_matU.rows()), static_cast<int>(m_matGain.rows()));
+    QCOMPARE(static_cast<int>(m_matV.rows()), static_cast<int>(m_matGain.cols()));
+
+    double dDiff = (m_matU * m_vecSing.asDiagonal() * m_matV.transpose() - m_matGain).norm() / m_matGain.norm();
+    QVERIFY(dDiff < dEpsilon);
+}
+
+//=============================================================================================================
+
+void TestMneMath::compareOrthogonality()
+{
+    // The right singular vectors lose orthogonality with eps * cond^2, which is ~1e-8 for a condition of 1e4
+    int iRank = m_vecSing.size();
+    double dDiffU = (m_matU.transpose() * m_matU - MatrixXd::Identity(iRank, iRank)).cwiseAbs().maxCoeff();
+    double dDiffV = (m_matV.transpose() * m_matV - MatrixXd::Identity(iRank, iRank)).cwiseAbs().maxCoeff();
+
+    QVERIFY(dDiffU < dEpsilon);
+    QVERIFY(dDiffV < 10 * dEpsilon);
+}
+
+//=============================================================================================================
+
+void TestMneMath::compareTransposed()
+{
+    VectorXd vecSing;
+    MatrixXd matU, matV;
+    MatrixXd matGainT = m_matGain.transpose();
+
+    MNEMath::thinSvdFromGram(matGainT, vecSing, matU, matV);
+
+    QCOMPARE(static_cast<int>(matU.rows()), static_cast<int>(matGainT.rows()));
+    QVERIFY((vecSing - m_vecSing).cwiseAbs().maxCoeff() / m_vecSing(0) < dEpsilon);
+    QVERIFY((matU * vecSing.asDiagonal() * matV.transpose() - matGainT).norm() / m_matGain.norm() < dEpsilon);
+}
+
+//=============================================================================================================
+
+void TestMneMath::benchmarkJacobiSvd()
+{
+    QBENCHMARK {
+        JacobiSVD<MatrixXd> svd(m_matGain, ComputeThinU | ComputeThinV);
+    }
+}
+
+//=============================================================================================================
+
+void TestMneMath::benchmarkThinSvdFromGram()
+{
+    VectorXd vecSing;
+    MatrixXd matU, matV;
+
+    QBENCHMARK {
+        MNEMath::thinSvdFromGram(m_matGain, vecSing, matU, matV);
+    }
+}
+
+//=============================================================================================================
+
+void TestMneMath::cleanupTestCase()
+{
+}
+
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestMneMath)
+#include "test_mne_math.moc"
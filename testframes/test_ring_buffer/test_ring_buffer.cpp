@@ -0,0 +1,280 @@
+//=============================================================================================================
+/**
+ * @file     test_ring_buffer.cpp
+ * @author   MNE-CPP Authors
+ * @since    0.1.9
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, MNE-CPP Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    Test and benchmark of the lock-free RingBuffer against the semaphore based CircularBuffer.
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/generics/applicationlogger.h>
+#include <utils/generics/circularbuffer.h>
+#include <utils/generics/ringbuffer.h>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QtConcurrent>
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define NUM_CHANNELS    376     // Channels of the MNE sample data raw file streamed by the FiffSimulator
+#define BLOCK_SIZE      100     // Samples per block, i.e. 10 blocks/s at 1 kHz
+#define BUFFER_SIZE     40      // Buffer length used by the MNE Scan plugins
+#define NUM_BLOCKS      500     // Blocks streamed per benchmark iteration
+
+//=============================================================================================================
+/**
+ * Streams iNumBlocks copies of matBlock from a producer thread through the buffer to the calling thread.
+ *
+ * @param[in] buffer     the buffer to stream through.
+ * @param[in] matBlock   the block which is pushed.
+ * @param[in] iNumBlocks number of blocks to stream.
+ *
+ * @return the sum of the first coefficient of all popped blocks.
+ */
+template<typename Buffer>
+double streamBlocks(Buffer& buffer,
+                    const MatrixXd& matBlock,
+                    int iNumBlocks)
+{
+    QFuture<void> future = QtConcurrent::run([&buffer, &matBlock, iNumBlocks]() {
+        for(int i = 0; i < iNumBlocks; ++i) {
+            while(!buffer.push(matBlock)) {
+            }
+        }
+    });
+
+    MatrixXd matData;
+    double dSum = 0.0;
+    for(int i = 0; i < iNumBlocks; ++i) {
+        while(!buffer.pop(matData)) {
+        }
+        dSum += matData(0,0);
+    }
+
+    future.waitForFinished();
+
+    return dSum;
+}
+
+//=============================================================================================================
+/**
+ * DECLARE CLASS TestRingBuffer
+ *
+ * @brief The TestRingBuffer class tests the RingBuffer and benchmarks it against the CircularBuffer
+ *
+ */
+class TestRingBuffer: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRingBuffer();
+
+private slots:
+    void initTestCase();
+    void compareOrder();
+    void compareFullAndEmpty();
+    void compareTimeout();
+    void benchmarkCircularBuffer();
+    void benchmarkRingBuffer();
+    void cleanupTestCase();
+
+private:
+    MatrixXd m_matBlock;
+};
+
+//=============================================================================================================
+
+TestRingBuffer::TestRingBuffer()
+{
+}
+
+//=============================================================================================================
+
+void TestRingBuffer::initTestCase()
+{
+    qInstallMessageHandler(UTILSLIB::ApplicationLogger::customLogWriter);
+
+    m_matBlock = MatrixXd::Constant(NUM_CHANNELS, BLOCK_SIZE, 1.0);
+}
+
+//=============================================================================================================
+
+void TestRingBuffer::compareOrder()
+{
+    // Small buffer so producer and consumer frequently wait for each other
+    RingBuffer_Matrix_double buffer(4);
+    int iNumBlocks = 10000;
+
+    QFuture<void> future = QtConcurrent::run([&buffer, iNumBlocks]() {
+        MatrixXd matBlock(3, 5);
+        for(int i = 0; i < iNumBlocks; ++i) {
+            matBlock.setConstant(i);
+            switch(i % 3) {
+                case 0:
+                    while(!buffer.push(matBlock)) {
+                    }
+                    break;
+                case 1: {
+                    MatrixXd matCopy = matBlock;
+                    while(!buffer.push(std::move(matCopy))) {
+                    }
+                    break;
+                }
+                default:
+                    while(!buffer.pushInPlace([i](MatrixXd& matSlot) { matSlot.setConstant(3, 5, i); })) {
+                    }
+                    break;
+            }
+        }
+    });
+
+    MatrixXd matData;
+    bool bInOrder = true;
+    for(int i = 0; i < iNumBlocks && bInOrder; ++i) {
+        while(!buffer.pop(matData)) {
+        }
+        bInOrder = matData.rows() == 3 && matData.cols() == 5 && matData.minCoeff() == i && matData.maxCoeff() == i;
+    }
+
+    future.waitForFinished();
+
+    QVERIFY(bInOrder);
+    QCOMPARE(buffer.getFreeElementsRead(), 0);
+}
+
+//=============================================================================================================
+
+void TestRingBuffer::compareFullAndEmpty()
+{
+    RingBuffer<int> buffer(2, 0);
+    int iValue = 0;
+
+    QVERIFY(!buffer.pop(iValue));
+    QVERIFY(buffer.push(1));
+    QVERIFY(buffer.push(2));
+    QVERIFY(!buffer.push(3));
+    QCOMPARE(buffer.getFreeElementsRead(), 2);
+    QCOMPARE(buffer.getFreeElementsWrite(), 0);
+
+    QVERIFY(buffer.pop(iValue));
+    QCOMPARE(iValue, 1);
+
+    buffer.clear();
+    QCOMPARE(buffer.getFreeElementsRead(), 0);
+    QVERIFY(!buffer.pop(iValue));
+}
+
+//=============================================================================================================
+
+void TestRingBuffer::compareTimeout()
+{
+    RingBuffer<int> buffer(1, 50);
+    int iValue = 0;
+
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY(!buffer.pop(iValue));
+    QVERIFY(timer.elapsed() >= 45);
+
+    // A push from another thread wakes the waiting consumer before the timeout
+    RingBuffer<int> bufferLong(1, 10000);
+    timer.restart();
+    QFuture<void> future = QtConcurrent::run([&bufferLong]() {
+        QThread::msleep(20);
+        bufferLong.push(42);
+    });
+    QVERIFY(bufferLong.pop(iValue));
+    QCOMPARE(iValue, 42);
+    QVERIFY(timer.elapsed() < 5000);
+    future.waitForFinished();
+}
+
+//=============================================================================================================
+
+void TestRingBuffer::benchmarkCircularBuffer()
+{
+    CircularBuffer_Matrix_double buffer(BUFFER_SIZE);
+    double dSum = 0.0;
+
+    QBENCHMARK {
+        dSum = streamBlocks(buffer, m_matBlock, NUM_BLOCKS);
+    }
+
+    QCOMPARE(dSum, double(NUM_BLOCKS));
+}
+
+//=============================================================================================================
+
+void TestRingBuffer::benchmarkRingBuffer()
+{
+    RingBuffer_Matrix_double buffer(BUFFER_SIZE);
+    double dSum = 0.0;
+
+    QBENCHMARK {
+        dSum = streamBlocks(buffer, m_matBlock, NUM_BLOCKS);
+    }
+
+    QCOMPARE(dSum, double(NUM_BLOCKS));
+}
+
+//=============================================================================================================
+
+void TestRingBuffer::cleanupTestCase()
+{
+}
+
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestRingBuffer)
+#include "test_ring_buffer.moc"
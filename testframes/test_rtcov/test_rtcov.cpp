@@ -0,0 +1,231 @@
+//=============================================================================================================
+/**
+ * @file     test_rtcov.cpp
+ * @author   MNE-CPP Authors
+ * @since    0.1.9
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, MNE-CPP Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    Test of the incremental covariance estimation of RtCov against batch computations.
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/generics/applicationlogger.h>
+
+#include <fiff/fiff.h>
+#include <fiff/fiff_cov.h>
+#include <rtprocessing/rtcov.h>
+
+#include <cmath>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace RTPROCESSINGLIB;
+using namespace Eigen;
+
+//=============================================================================================================
+/**
+ * DECLARE CLASS TestRtCov
+ *
+ * @brief The TestRtCov class checks the covariance published by RtCov against a covariance computed from all
+ * samples at once.
+ *
+ */
+class TestRtCov: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRtCov();
+
+private slots:
+    void initTestCase();
+    void compareBatchCovariance();
+    void compareWeightedCovariance();
+    void cleanupTestCase();
+
+private:
+    //=========================================================================================================
+    /**
+     * Streams the data block by block through RtCov and returns the covariance published after the last block.
+     *
+     * @param[in] dForgettingFactor    The forgetting factor of RtCov.
+     *
+     * @return The published covariance.
+     */
+    FiffCov streamCovariance(double dForgettingFactor);
+
+    //=========================================================================================================
+    /**
+     * Computes the weighted covariance of all samples at once and regularizes it the same way as RtCov.
+     *
+     * @param[in] vecWeights   The weight of each sample.
+     *
+     * @return The regularized covariance.
+     */
+    FiffCov batchCovariance(const RowVectorXd& vecWeights);
+
+    double                      dEpsilon;
+    int                         iBlockSize;
+
+    QSharedPointer<FiffInfo>    pFiffInfo;
+    MatrixXd                    matData;
+};
+
+//=============================================================================================================
+
+TestRtCov::TestRtCov()
+: dEpsilon(1e-8)
+, iBlockSize(200)
+{
+}
+
+//=============================================================================================================
+
+void TestRtCov::initTestCase()
+{
+    qInstallMessageHandler(UTILSLIB::ApplicationLogger::customLogWriter);
+
+    QFile t_fileIn(QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/MEG/sample/sample_audvis_trunc_raw.fif");
+    FiffRawData raw(t_fileIn);
+
+    pFiffInfo = QSharedPointer<FiffInfo>(new FiffInfo(raw.info));
+
+    // 15 blocks with an odd number of blocks per published covariance
+    MatrixXd matTimes;
+    QVERIFY(raw.read_raw_segment(matData, matTimes, raw.first_samp, raw.first_samp + 15 * iBlockSize - 1));
+}
+
+//=============================================================================================================
+
+void TestRtCov::compareBatchCovariance()
+{
+    FiffCov covStream = streamCovariance(1.0);
+    FiffCov covBatch = batchCovariance(RowVectorXd::Ones(matData.cols()));
+
+    QVERIFY(!covStream.names.isEmpty());
+    QCOMPARE(covStream.dim, covBatch.dim);
+    QCOMPARE(covStream.nfree, static_cast<int>(matData.cols()));
+    QVERIFY((covStream.data - covBatch.data).cwiseAbs().maxCoeff() < dEpsilon * covBatch.data.cwiseAbs().maxCoeff());
+}
+
+//=============================================================================================================
+
+void TestRtCov::compareWeightedCovariance()
+{
+    const double dForgettingFactor = 0.999;
+
+    RowVectorXd vecWeights(matData.cols());
+    for(int t = 0; t < matData.cols(); ++t) {
+        vecWeights(t) = std::pow(dForgettingFactor, matData.cols() - 1 - t);
+    }
+
+    FiffCov covStream = streamCovariance(dForgettingFactor);
+    FiffCov covBatch = batchCovariance(vecWeights);
+
+    QVERIFY(!covStream.names.isEmpty());
+    QCOMPARE(covStream.nfree, covBatch.nfree);
+    QVERIFY((covStream.data - covBatch.data).cwiseAbs().maxCoeff() < dEpsilon * covBatch.data.cwiseAbs().maxCoeff());
+}
+
+//=============================================================================================================
+
+void TestRtCov::cleanupTestCase()
+{
+}
+
+//=============================================================================================================
+
+FiffCov TestRtCov::streamCovariance(double dForgettingFactor)
+{
+    RtCov rtCov(pFiffInfo);
+    rtCov.setForgettingFactor(dForgettingFactor);
+
+    FiffCov cov;
+    for(int i = 0; i < matData.cols(); i += iBlockSize) {
+        cov = rtCov.estimateCovariance(matData.middleCols(i, iBlockSize), matData.cols());
+
+        // Nothing must be published before all samples arrived
+        if(i + iBlockSize < matData.cols()) {
+            if(!cov.names.isEmpty()) {
+                return FiffCov();
+            }
+        }
+    }
+
+    return cov;
+}
+
+//=============================================================================================================
+
+FiffCov TestRtCov::batchCovariance(const RowVectorXd& vecWeights)
+{
+    const double dWeightSum = vecWeights.sum();
+    const double dWeightSquareSum = vecWeights.squaredNorm();
+
+    VectorXd vecMean = (matData * vecWeights.transpose()) / dWeightSum;
+    MatrixXd matCentered = matData.colwise() - vecMean;
+
+    FiffCov cov;
+    cov.data = matCentered * vecWeights.asDiagonal() * matCentered.transpose();
+    cov.data /= dWeightSum - dWeightSquareSum / dWeightSum;
+    cov.kind = FIFFV_MNE_NOISE_COV;
+    cov.diag = false;
+    cov.dim = cov.data.rows();
+    cov.names = pFiffInfo->ch_names;
+    cov.projs = pFiffInfo->projs;
+    cov.bads = pFiffInfo->bads;
+    cov.nfree = qRound(dWeightSum * dWeightSum / dWeightSquareSum);
+
+    QStringList lExclude;
+    for(int i = 0; i < pFiffInfo->chs.size(); ++i) {
+        if(pFiffInfo->chs.at(i).kind != FIFFV_MEG_CH &&
+           pFiffInfo->chs.at(i).kind != FIFFV_EEG_CH) {
+            lExclude << pFiffInfo->chs.at(i).ch_name;
+        }
+    }
+
+    return cov.regularize(*pFiffInfo, 0.05, 0.05, 0.1, true, lExclude);
+}
+
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestRtCov)
+#include "test_rtcov.moc"
@@ -52,6 +52,10 @@
 #include <connectivity/metrics/crosscorrelation.h>
 #include <connectivity/connectivitysettings.h>
 #include <connectivity/network/network.h>
+#include <connectivity/network/networknode.h>
+#include <connectivity/network/networkedge.h>
+
+#include <limits>
 
 //=============================================================================================================
 // QT INCLUDES
@@ -97,6 +101,7 @@ private slots:
     void spectralConnectivityCoherence();
     void spectralConnectivityImagCoherence();
     void spectralConnectivityXCOR();
+    void networkEdgeViews();
     void cleanupTestCase();
 
 private:
@@ -385,6 +390,99 @@ void TestSpectralConnectivity::compareConnectivity()
 
 //=============================================================================================================
 
+void TestSpectralConnectivity::networkEdgeViews()
+{
+    //*********************************************************************************************************
+    // Compute and threshold Connectivity
+    //*********************************************************************************************************
+
+    Network network = Coherence::calculate(m_connectivitySettings);
+    network.setThreshold(0.5 * network.getMinMaxFullWeights().second);
+
+    MatrixXd matFull = network.getFullConnectivityMatrix();
+    MatrixXd matThresholded = network.getThresholdedConnectivityMatrix();
+    VectorXi vecDegrees = network.getThresholdedDegrees();
+
+    //*********************************************************************************************************
+    // Compare against the edge and node objects
+    //*********************************************************************************************************
+
+    MatrixXd matFullEdges = MatrixXd::Zero(matFull.rows(), matFull.cols());
+
+    for(int i = 0; i < network.getFullEdges().size(); ++i) {
+        NetworkEdge::SPtr pEdge = network.getFullEdges().at(i);
+        matFullEdges(pEdge->getStartNodeID(), pEdge->getEndNodeID()) = pEdge->getWeight();
+        matFullEdges(pEdge->getEndNodeID(), pEdge->getStartNodeID()) = pEdge->getWeight();
+    }
+
+    QVERIFY((matFull - matFullEdges).cwiseAbs().maxCoeff() < dEpsilon);
+    QCOMPARE(int(network.getThresholdedAdjacency().nonZeros()), 2 * network.getThresholdedEdges().size());
+
+    for(int i = 0; i < network.getNodes().size(); ++i) {
+        QCOMPARE(vecDegrees(i), int(network.getNodes().at(i)->getThresholdedDegree()));
+    }
+
+    QVERIFY((matThresholded.array() == 0.0 || matThresholded.array().abs() >= network.getThreshold()).all());
+
+    // The thresholded range is the range of the active weights, not the threshold
+    ArrayXd vecActive = matThresholded.array().abs();
+    double dMinActive = (vecActive > 0.0).select(vecActive, std::numeric_limits<double>::max()).minCoeff();
+    QVERIFY(fabs(network.getMinMaxThresholdedWeights().first - dMinActive) < dEpsilon);
+    QVERIFY(fabs(network.getMinMaxThresholdedWeights().second - vecActive.maxCoeff()) < dEpsilon);
+
+    //*********************************************************************************************************
+    // Compare the edge count against a network built via append(), which drops self edges
+    //*********************************************************************************************************
+
+    int iNumberNodes = network.getNodes().size();
+
+    Network networkAppended;
+    for(int i = 0; i < iNumberNodes; ++i) {
+        networkAppended.append(NetworkNode::SPtr(new NetworkNode(i, RowVectorXf::Zero(3))));
+    }
+
+    MatrixXd matWeight(1,1);
+    NetworkEdge::SPtr pEdge;
+
+    for(int i = 0; i < iNumberNodes; ++i) {
+        for(int j = i; j < iNumberNodes; ++j) {
+            matWeight << matFull(i,j);
+            pEdge = NetworkEdge::SPtr(new NetworkEdge(i, j, matWeight));
+            networkAppended.getNodeAt(i)->append(pEdge);
+            networkAppended.getNodeAt(j)->append(pEdge);
+            networkAppended.append(pEdge);
+        }
+    }
+
+    QCOMPARE(network.getFullEdges().size(), iNumberNodes * (iNumberNodes - 1) / 2);
+    QCOMPARE(network.getFullEdges().size(), networkAppended.getFullEdges().size());
+    QCOMPARE(network.getFullDistribution(), networkAppended.getFullDistribution());
+
+    for(int i = 0; i < iNumberNodes; ++i) {
+        QCOMPARE(int(network.getNodes().at(i)->getFullDegree()), iNumberNodes - 1);
+    }
+
+    //*********************************************************************************************************
+    // Normalizing rescales the packed weights and the edges alike and leaves copies untouched
+    //*********************************************************************************************************
+
+    Network networkNormalized = network;
+    networkNormalized.normalize();
+
+    double dMaxWeight = network.getMinMaxFullWeights().second;
+
+    QVERIFY((networkNormalized.getEdgeWeights() * dMaxWeight - network.getEdgeWeights()).cwiseAbs().maxCoeff() < dEpsilon);
+    QVERIFY((networkNormalized.getFullConnectivityMatrix() * dMaxWeight - matFull).cwiseAbs().maxCoeff() < dEpsilon);
+
+    for(int i = 0; i < networkNormalized.getFullEdges().size(); ++i) {
+        NetworkEdge::SPtr pNormalizedEdge = networkNormalized.getFullEdges().at(i);
+        QVERIFY(fabs(pNormalizedEdge->getWeight() * dMaxWeight - network.getFullEdges().at(i)->getWeight()) < dEpsilon);
+        QVERIFY((pNormalizedEdge->getMatrixWeight() * dMaxWeight - network.getEdgeWeights().col(i)).cwiseAbs().maxCoeff() < dEpsilon);
+    }
+}
+
+//=============================================================================================================
+
 void TestSpectralConnectivity::cleanupTestCase()
 {
 }
@@ -55,6 +55,10 @@ SUBDIRS += \
     test_hpiFit \
     test_mne_forward_solution \
     test_fiff_cov \
+    test_mne_math \
+    test_ring_buffer \
+    test_rtcov \
+    test_fiff_stream_io \
     test_fiff_digitizer \
     test_mne_msh_display_surface_set \
     test_mne_project_to_surface \